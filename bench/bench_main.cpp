@@ -0,0 +1,415 @@
+/*
+ * SectorFlux - LLM Proxy and Analytics
+ * Copyright (c) 2025 ParticleSector.com
+ *
+ * This software is dual-licensed:
+ * - GPL-3.0 for open source use
+ * - Commercial license for proprietary use
+ *
+ * See LICENSE and LICENSING.md for details.
+ */
+
+#include "load_driver.hpp"
+#include "mock_ollama.hpp"
+#include "process_stats.hpp"
+
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <charconv>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <thread>
+
+extern char** environ;
+
+namespace
+{
+
+using namespace sectorflux::bench;
+
+constexpr int kDefaultProxyPort = 18888;
+constexpr int kDefaultStreamPort = 18889;
+constexpr int kDefaultMockPort = 18434;
+constexpr auto kStartupTimeout = std::chrono::seconds(15);
+constexpr auto kShutdownTimeout = std::chrono::seconds(10);
+
+constexpr const char* kUsage =
+    "Usage: sectorflux_bench [options]\n"
+    "  --proxy-bin PATH        Start this SectorFlux binary against the mock\n"
+    "  --proxy-port N          Proxy port (default 18888)\n"
+    "  --stream-port N         Streaming port (default 18889)\n"
+    "  --proxy-pid N           Sample CPU and RSS of an already running proxy\n"
+    "  --proxy-log PATH        Where a started proxy writes its output (default /dev/null)\n"
+    "  --mock-port N           Mock Ollama port (default 18434)\n"
+    "  --concurrency N         Concurrent clients (default 8)\n"
+    "  --requests N            Requests per scenario (default 200)\n"
+    "  --tokens N              Tokens per response (default 64)\n"
+    "  --token-rate N          Tokens per second per response, 0 = unpaced (default 200)\n"
+    "  --tokens-per-chunk N    Tokens per streamed chunk (default 1)\n"
+    "  --prompt-eval-ms N      Mock delay before the first token (default 0)\n"
+    "  --prompts FILE          Replay prompts from a JSONL file\n"
+    "  --scenarios A,B,...     Scenarios to run (default all)\n";
+
+/**
+ * @brief A SectorFlux process started for the run.
+ */
+struct ProxyProcess
+{
+    pid_t pid = -1;
+    std::string db_path;
+};
+
+bool parseInt(const std::string& text, int& out)
+{
+    auto [end, ec] = std::from_chars(text.data(), text.data() + text.size(), out);
+    return ec == std::errc() && end == text.data() + text.size();
+}
+
+std::vector<std::string> split(const std::string& list)
+{
+    std::vector<std::string> items;
+    std::stringstream stream(list);
+    std::string item;
+    while (std::getline(stream, item, ','))
+    {
+        if (!item.empty())
+        {
+            items.push_back(item);
+        }
+    }
+    return items;
+}
+
+/**
+ * @brief Fork and exec SectorFlux with its upstream pointed at the mock.
+ *
+ * The environment is assembled before fork(): the mock's server threads are
+ * already running, so the child may only call async-signal-safe functions.
+ * Admission limits are lifted unless the caller's environment sets them, so
+ * the configured concurrency actually reaches the proxy.
+ */
+std::optional<std::string> startProxy(const std::string& binary,
+                                      const Endpoints& endpoints,
+                                      int concurrency,
+                                      const std::string& log_path,
+                                      ProxyProcess& proxy)
+{
+    proxy.db_path = "/tmp/sectorflux_bench_" + std::to_string(getpid()) + ".db";
+
+    std::map<std::string, std::string> env;
+    for (char** entry = environ; *entry != nullptr; ++entry)
+    {
+        std::string pair = *entry;
+        size_t eq = pair.find('=');
+        if (eq != std::string::npos)
+        {
+            env[pair.substr(0, eq)] = pair.substr(eq + 1);
+        }
+    }
+    env["OLLAMA_HOST"] = "http://" + endpoints.host + ":" + std::to_string(endpoints.mock_port);
+    env.erase("OLLAMA_HOSTS");
+    env["SECTORFLUX_PORT"] = std::to_string(endpoints.http_port);
+    env["SECTORFLUX_STREAM_PORT"] = std::to_string(endpoints.stream_port);
+    env["SECTORFLUX_DB"] = proxy.db_path;
+    env.try_emplace("SECTORFLUX_MAX_INFLIGHT_PER_MODEL", "0");
+    env.try_emplace("SECTORFLUX_MAX_INFLIGHT_PER_BACKEND", "0");
+    env.try_emplace("SECTORFLUX_CHAT_WORKERS", std::to_string(std::min(concurrency, 256)));
+
+    std::vector<std::string> env_strings;
+    for (const auto& [key, value] : env)
+    {
+        env_strings.push_back(key + "=" + value);
+    }
+    std::vector<char*> envp;
+    for (auto& entry : env_strings)
+    {
+        envp.push_back(entry.data());
+    }
+    envp.push_back(nullptr);
+    std::string argv0 = binary;
+    char* argv[] = {argv0.data(), nullptr};
+
+    int log_fd = ::open(log_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (log_fd < 0)
+    {
+        return "Cannot open " + log_path + ": " + std::strerror(errno);
+    }
+
+    proxy.pid = fork();
+    if (proxy.pid == 0)
+    {
+        dup2(log_fd, STDOUT_FILENO);
+        dup2(log_fd, STDERR_FILENO);
+        execve(argv0.c_str(), argv, envp.data());
+        _exit(127);
+    }
+    ::close(log_fd);
+    if (proxy.pid < 0)
+    {
+        return std::string("fork failed: ") + std::strerror(errno);
+    }
+
+    auto deadline = std::chrono::steady_clock::now() + kStartupTimeout;
+    while (std::chrono::steady_clock::now() < deadline)
+    {
+        int status = 0;
+        if (waitpid(proxy.pid, &status, WNOHANG) == proxy.pid)
+        {
+            proxy.pid = -1;
+            return "SectorFlux exited during startup; see " + log_path;
+        }
+        httplib::Client probe(endpoints.host, endpoints.http_port);
+        probe.set_connection_timeout(1, 0);
+        if (auto res = probe.Get("/api/version"); res && res->status == 200)
+        {
+            return std::nullopt;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+    return std::string("SectorFlux did not become ready in time");
+}
+
+void stopProxy(ProxyProcess& proxy)
+{
+    if (proxy.pid > 0)
+    {
+        kill(proxy.pid, SIGTERM);
+        auto deadline = std::chrono::steady_clock::now() + kShutdownTimeout;
+        int status = 0;
+        while (waitpid(proxy.pid, &status, WNOHANG) == 0)
+        {
+            if (std::chrono::steady_clock::now() > deadline)
+            {
+                kill(proxy.pid, SIGKILL);
+                waitpid(proxy.pid, &status, 0);
+                break;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        }
+        proxy.pid = -1;
+    }
+    if (!proxy.db_path.empty())
+    {
+        for (const char* suffix : {"", "-wal", "-shm"})
+        {
+            std::remove((proxy.db_path + suffix).c_str());
+        }
+    }
+}
+
+void printHeader()
+{
+    std::cout << std::left << std::setw(22) << "scenario" << std::right
+              << std::setw(7) << "ok" << std::setw(5) << "err"
+              << std::setw(9) << "req/s" << std::setw(10) << "tok/s"
+              << std::setw(9) << "p50 ms" << std::setw(9) << "p99 ms"
+              << std::setw(10) << "+p50 ms" << std::setw(10) << "+p99 ms"
+              << std::setw(11) << "+ttft p50" << std::setw(11) << "+ttft p99"
+              << std::setw(11) << "cpu ms/req" << std::setw(9) << "rss MB"
+              << std::setw(10) << "peak MB" << "\n";
+}
+
+void printRow(const ScenarioResult& result,
+              const std::optional<ProcessSample>& before,
+              const std::optional<ProcessSample>& after)
+{
+    auto rate = [&result](double count)
+    {
+        return result.wall_seconds > 0 ? count / result.wall_seconds : 0.0;
+    };
+    std::cout << std::fixed << std::left << std::setw(22) << result.name << std::right
+              << std::setw(7) << result.completed << std::setw(5) << result.errors
+              << std::setprecision(1)
+              << std::setw(9) << rate(static_cast<double>(result.completed))
+              << std::setw(10) << rate(static_cast<double>(result.tokens))
+              << std::setprecision(2)
+              << std::setw(9) << result.latency.p50 << std::setw(9) << result.latency.p99
+              << std::setw(10) << result.overhead.p50 << std::setw(10) << result.overhead.p99;
+    if (result.ttft_overhead.samples > 0)
+    {
+        std::cout << std::setw(11) << result.ttft_overhead.p50
+                  << std::setw(11) << result.ttft_overhead.p99;
+    }
+    else
+    {
+        std::cout << std::setw(11) << "-" << std::setw(11) << "-";
+    }
+    if (before && after && result.completed > 0)
+    {
+        double cpu_ms = (after->cpu_seconds - before->cpu_seconds) * 1000.0 /
+                        static_cast<double>(result.completed);
+        std::cout << std::setw(11) << cpu_ms << std::setprecision(1)
+                  << std::setw(9) << after->rss_kb / 1024.0
+                  << std::setw(10) << after->peak_rss_kb / 1024.0;
+    }
+    else
+    {
+        std::cout << std::setw(11) << "-" << std::setw(9) << "-" << std::setw(10) << "-";
+    }
+    std::cout << "\n";
+    if (!result.first_error.empty())
+    {
+        std::cout << "  first error: " << result.first_error << "\n";
+    }
+    std::cout.flush();
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    std::string proxy_bin;
+    std::string proxy_log = "/dev/null";
+    std::string prompts_path;
+    std::vector<std::string> scenario_list = scenarioNames();
+    int proxy_pid = -1;
+    Endpoints endpoints{.http_port = kDefaultProxyPort,
+                        .stream_port = kDefaultStreamPort,
+                        .mock_port = kDefaultMockPort};
+    LoadOptions options;
+    MockProfile profile;
+
+    std::map<std::string, int*> int_flags = {
+        {"--proxy-port", &endpoints.http_port},
+        {"--stream-port", &endpoints.stream_port},
+        {"--mock-port", &endpoints.mock_port},
+        {"--proxy-pid", &proxy_pid},
+        {"--concurrency", &options.concurrency},
+        {"--requests", &options.requests},
+        {"--tokens", &profile.tokens},
+        {"--tokens-per-chunk", &profile.tokens_per_chunk},
+        {"--prompt-eval-ms", &profile.prompt_eval_ms},
+    };
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string flag = argv[i];
+        if (flag == "--help" || flag == "-h")
+        {
+            std::cout << kUsage;
+            return 0;
+        }
+        if (i + 1 >= argc)
+        {
+            std::cerr << "Missing value for " << flag << "\n" << kUsage;
+            return 2;
+        }
+        std::string value = argv[++i];
+        int token_rate = 0;
+        if (auto it = int_flags.find(flag); it != int_flags.end())
+        {
+            if (!parseInt(value, *it->second) || *it->second < 0)
+            {
+                std::cerr << "Invalid value for " << flag << ": " << value << "\n";
+                return 2;
+            }
+        }
+        else if (flag == "--token-rate" && parseInt(value, token_rate) && token_rate >= 0)
+        {
+            profile.tokens_per_sec = token_rate;
+        }
+        else if (flag == "--proxy-bin")
+        {
+            proxy_bin = value;
+        }
+        else if (flag == "--proxy-log")
+        {
+            proxy_log = value;
+        }
+        else if (flag == "--prompts")
+        {
+            prompts_path = value;
+        }
+        else if (flag == "--scenarios")
+        {
+            scenario_list = split(value);
+        }
+        else
+        {
+            std::cerr << "Unknown option or invalid value: " << flag << " " << value << "\n"
+                      << kUsage;
+            return 2;
+        }
+    }
+    profile.tokens = std::max(profile.tokens, 1);
+    profile.tokens_per_chunk = std::max(profile.tokens_per_chunk, 1);
+
+    std::vector<Scenario> selected;
+    for (const auto& name : scenario_list)
+    {
+        auto scenario = findScenario(name);
+        if (!scenario)
+        {
+            std::cerr << "Unknown scenario: " << name << "\n";
+            return 2;
+        }
+        selected.push_back(*scenario);
+    }
+    if (!prompts_path.empty())
+    {
+        if (auto err = loadPrompts(prompts_path, options.prompts))
+        {
+            std::cerr << *err << "\n";
+            return 1;
+        }
+    }
+
+    // Every open stream holds a mock worker thread, plus headroom for probes
+    MockOllama mock(profile, static_cast<size_t>(options.concurrency) * 2 + 8);
+    if (auto err = mock.start(endpoints.mock_port))
+    {
+        std::cerr << *err << "\n";
+        return 1;
+    }
+
+    ProxyProcess proxy;
+    if (!proxy_bin.empty())
+    {
+        if (auto err = startProxy(proxy_bin, endpoints, options.concurrency, proxy_log, proxy))
+        {
+            std::cerr << *err << "\n";
+            stopProxy(proxy);
+            return 1;
+        }
+        proxy_pid = proxy.pid;
+    }
+
+    std::cout << "SectorFlux benchmark: " << options.concurrency << " clients, "
+              << options.requests << " requests per scenario, " << profile.tokens
+              << " tokens at " << profile.tokens_per_sec << " tok/s, "
+              << profile.tokens_per_chunk << " per chunk";
+    if (!options.prompts.empty())
+    {
+        std::cout << ", " << options.prompts.size() << " replayed prompts";
+    }
+    std::cout << "\n+ columns: time added outside the mock (cache hits: full latency)\n\n";
+    printHeader();
+
+    for (const auto& scenario : selected)
+    {
+        std::optional<ProcessSample> before;
+        if (proxy_pid > 0 && !scenario.direct)
+        {
+            before = sampleProcess(proxy_pid);
+        }
+        ScenarioResult result = runScenario(scenario, endpoints, options, mock);
+        std::optional<ProcessSample> after;
+        if (before)
+        {
+            after = sampleProcess(proxy_pid);
+        }
+        printRow(result, before, after);
+    }
+
+    stopProxy(proxy);
+    mock.stop();
+    return 0;
+}
@@ -0,0 +1,394 @@
+/*
+ * SectorFlux - LLM Proxy and Analytics
+ * Copyright (c) 2025 ParticleSector.com
+ *
+ * This software is dual-licensed:
+ * - GPL-3.0 for open source use
+ * - Commercial license for proprietary use
+ *
+ * See LICENSE and LICENSING.md for details.
+ */
+
+#include "load_driver.hpp"
+
+#include "ws_client.hpp"
+
+#include <httplib.h>
+#include <nlohmann/json.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <mutex>
+#include <thread>
+
+namespace sectorflux::bench
+{
+
+namespace
+{
+
+using Clock = std::chrono::steady_clock;
+
+constexpr const char* kModel = "bench";
+constexpr time_t kReadTimeoutSec = 300;
+
+const std::vector<Scenario>& scenarios()
+{
+    static const std::vector<Scenario> kScenarios = {
+        {.name = "direct_generate", .transport = Transport::Http, .direct = true},
+        {.name = "generate_miss", .transport = Transport::Http},
+        {.name = "generate_hit", .transport = Transport::Http, .cache_hit = true},
+        {.name = "chat_miss", .transport = Transport::Http, .chat = true},
+        {.name = "chat_hit", .transport = Transport::Http, .chat = true, .cache_hit = true},
+        {.name = "stream_generate_miss", .transport = Transport::Stream},
+        {.name = "stream_generate_hit", .transport = Transport::Stream, .cache_hit = true},
+        {.name = "ws_chat_miss", .transport = Transport::WebSocket, .chat = true},
+        {.name = "ws_chat_hit", .transport = Transport::WebSocket, .chat = true, .cache_hit = true},
+    };
+    return kScenarios;
+}
+
+// Process-wide so marker ids never repeat across scenarios
+std::atomic<uint64_t> next_request_id{1};
+
+double millis(Clock::duration duration)
+{
+    return std::chrono::duration<double, std::milli>(duration).count();
+}
+
+LatencySummary summarize(std::vector<double>& samples)
+{
+    LatencySummary summary;
+    summary.samples = samples.size();
+    if (samples.empty())
+    {
+        return summary;
+    }
+    std::sort(samples.begin(), samples.end());
+    auto at = [&samples](double quantile)
+    {
+        size_t index = static_cast<size_t>(quantile * static_cast<double>(samples.size() - 1) + 0.5);
+        return samples[index];
+    };
+    summary.p50 = at(0.50);
+    summary.p99 = at(0.99);
+    summary.max = samples.back();
+    return summary;
+}
+
+std::string requestBody(const Scenario& scenario, const std::string& prompt, uint64_t id)
+{
+    std::string text = prompt + " [" + MockOllama::marker(id) + "]";
+    nlohmann::json body = {{"model", kModel}};
+    if (scenario.chat)
+    {
+        body["messages"] = nlohmann::json::array({{{"role", "user"}, {"content", text}}});
+    }
+    else
+    {
+        body["prompt"] = text;
+    }
+    return body.dump();
+}
+
+/**
+ * @brief Timestamps of one request as the client saw it.
+ */
+struct Observation
+{
+    bool ok = false;
+    std::string error{};
+    Clock::time_point sent{};
+    Clock::time_point first_byte{};
+    Clock::time_point done{};
+};
+
+/**
+ * @brief One worker's connection, over whichever transport the scenario uses.
+ */
+class Connection
+{
+public:
+    Connection(const Scenario& scenario, const Endpoints& endpoints)
+        : scenario_(scenario),
+          http_(endpoints.host,
+                scenario.direct                          ? endpoints.mock_port
+                : scenario.transport == Transport::Stream ? endpoints.stream_port
+                                                          : endpoints.http_port),
+          endpoints_(endpoints)
+    {
+        http_.set_keep_alive(true);
+        http_.set_read_timeout(kReadTimeoutSec, 0);
+    }
+
+    Observation issue(const std::string& body)
+    {
+        if (scenario_.transport == Transport::WebSocket)
+        {
+            return issueWebSocket(body);
+        }
+
+        Observation observation;
+        httplib::Request req;
+        req.method = "POST";
+        req.path = scenario_.chat ? "/api/chat" : "/api/generate";
+        req.body = body;
+        req.set_header("Content-Type", "application/json");
+        bool received = false;
+        req.content_receiver = [&](const char*, size_t, uint64_t, uint64_t)
+        {
+            if (!received)
+            {
+                received = true;
+                observation.first_byte = Clock::now();
+            }
+            return true;
+        };
+
+        observation.sent = Clock::now();
+        auto result = http_.send(req);
+        observation.done = Clock::now();
+        if (!received)
+        {
+            observation.first_byte = observation.done;
+        }
+        if (!result)
+        {
+            observation.error = "HTTP error: " + httplib::to_string(result.error());
+        }
+        else if (result->status != 200)
+        {
+            observation.error = "HTTP status " + std::to_string(result->status);
+        }
+        else
+        {
+            observation.ok = true;
+        }
+        return observation;
+    }
+
+private:
+    Observation issueWebSocket(const std::string& body)
+    {
+        Observation observation;
+        if (!ws_.isOpen())
+        {
+            if (auto err = ws_.connect(endpoints_.host, endpoints_.http_port, "/ws/chat"))
+            {
+                observation.error = *err;
+                return observation;
+            }
+        }
+
+        observation.sent = Clock::now();
+        if (!ws_.sendText(body))
+        {
+            observation.error = "WebSocket send failed";
+            ws_.close();
+            return observation;
+        }
+        bool first = true;
+        while (auto message = ws_.receiveText())
+        {
+            if (first)
+            {
+                first = false;
+                observation.first_byte = Clock::now();
+            }
+            if (message->find("\"error\"") != std::string::npos)
+            {
+                observation.error = *message;
+                break;
+            }
+            if (message->find("\"done\":true") != std::string::npos ||
+                message->find("\"done\": true") != std::string::npos)
+            {
+                observation.ok = true;
+                break;
+            }
+        }
+        observation.done = Clock::now();
+        if (first)
+        {
+            observation.first_byte = observation.done;
+        }
+        if (!observation.ok && observation.error.empty())
+        {
+            observation.error = "WebSocket closed mid-response";
+        }
+        return observation;
+    }
+
+    const Scenario& scenario_;
+    httplib::Client http_;
+    WsClient ws_;
+    const Endpoints& endpoints_;
+};
+
+} // namespace
+
+std::optional<Scenario> findScenario(std::string_view name)
+{
+    for (const auto& scenario : scenarios())
+    {
+        if (scenario.name == name)
+        {
+            return scenario;
+        }
+    }
+    return std::nullopt;
+}
+
+std::vector<std::string> scenarioNames()
+{
+    std::vector<std::string> names;
+    for (const auto& scenario : scenarios())
+    {
+        names.push_back(scenario.name);
+    }
+    return names;
+}
+
+ScenarioResult runScenario(const Scenario& scenario,
+                           const Endpoints& endpoints,
+                           const LoadOptions& options,
+                           MockOllama& mock)
+{
+    ScenarioResult result;
+    result.name = scenario.name;
+
+    std::vector<std::string> synthetic;
+    const std::vector<std::string>* prompts = &options.prompts;
+    if (prompts->empty())
+    {
+        synthetic.push_back("Explain how a reverse proxy adds latency to a streaming response.");
+        prompts = &synthetic;
+    }
+
+    // A cache-hit run repeats one request, first served once so it is cached
+    uint64_t warm_id = 0;
+    std::string warm_body;
+    if (scenario.cache_hit)
+    {
+        warm_id = next_request_id++;
+        warm_body = requestBody(scenario, prompts->front(), warm_id);
+        Connection warmup(scenario, endpoints);
+        Observation observation = warmup.issue(warm_body);
+        if (!observation.ok)
+        {
+            result.errors = 1;
+            result.first_error = "Warm-up failed: " + observation.error;
+            return result;
+        }
+        mock.takeTiming(warm_id);
+    }
+
+    std::mutex results_mutex;
+    std::vector<double> latency;
+    std::vector<double> overhead;
+    std::vector<double> ttft_overhead;
+    std::atomic<int> remaining{options.requests};
+    std::atomic<size_t> prompt_cursor{0};
+
+    auto worker = [&]()
+    {
+        Connection connection(scenario, endpoints);
+        while (remaining.fetch_sub(1) > 0)
+        {
+            uint64_t id = warm_id;
+            std::string body = warm_body;
+            if (!scenario.cache_hit)
+            {
+                id = next_request_id++;
+                body = requestBody(scenario, (*prompts)[prompt_cursor++ % prompts->size()], id);
+            }
+
+            Observation observation = connection.issue(body);
+            auto timing = mock.takeTiming(id);
+
+            std::lock_guard<std::mutex> lock(results_mutex);
+            if (!observation.ok)
+            {
+                if (result.errors++ == 0)
+                {
+                    result.first_error = observation.error;
+                }
+                continue;
+            }
+            ++result.completed;
+            result.tokens += mock.profile().tokens;
+            latency.push_back(millis(observation.done - observation.sent));
+            if (timing)
+            {
+                // Time spent outside the mock: before it received the request and after it finished
+                overhead.push_back(millis((timing->received - observation.sent) +
+                                          (observation.done - timing->done)));
+                if (scenario.transport != Transport::Http || scenario.direct)
+                {
+                    ttft_overhead.push_back(millis(observation.first_byte - timing->first_byte));
+                }
+            }
+            else
+            {
+                overhead.push_back(millis(observation.done - observation.sent));
+            }
+        }
+    };
+
+    auto start = Clock::now();
+    std::vector<std::thread> workers;
+    for (int i = 0; i < std::max(1, options.concurrency); ++i)
+    {
+        workers.emplace_back(worker);
+    }
+    for (auto& thread : workers)
+    {
+        thread.join();
+    }
+    result.wall_seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    result.latency = summarize(latency);
+    result.overhead = summarize(overhead);
+    result.ttft_overhead = summarize(ttft_overhead);
+    return result;
+}
+
+std::optional<std::string> loadPrompts(const std::string& path, std::vector<std::string>& prompts)
+{
+    std::ifstream file(path);
+    if (!file)
+    {
+        return "Cannot open " + path;
+    }
+    std::string line;
+    while (std::getline(file, line))
+    {
+        if (line.empty())
+        {
+            continue;
+        }
+        auto parsed = nlohmann::json::parse(line, nullptr, false);
+        std::string prompt = line;
+        if (parsed.is_object())
+        {
+            for (const char* field : {"prompt", "body", "title"})
+            {
+                if (parsed.contains(field) && parsed[field].is_string())
+                {
+                    prompt = parsed[field].get<std::string>();
+                    break;
+                }
+            }
+        }
+        prompts.push_back(std::move(prompt));
+    }
+    if (prompts.empty())
+    {
+        return path + " contains no prompts";
+    }
+    return std::nullopt;
+}
+
+} // namespace sectorflux::bench
@@ -0,0 +1,137 @@
+/*
+ * SectorFlux - LLM Proxy and Analytics
+ * Copyright (c) 2025 ParticleSector.com
+ *
+ * This software is dual-licensed:
+ * - GPL-3.0 for open source use
+ * - Commercial license for proprietary use
+ *
+ * See LICENSE and LICENSING.md for details.
+ */
+
+#pragma once
+
+#include "mock_ollama.hpp"
+
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace sectorflux::bench
+{
+
+/**
+ * @brief How a scenario reaches the proxy.
+ */
+enum class Transport
+{
+    Http,      // Buffered Crow port
+    Stream,    // Chunked streaming port
+    WebSocket  // /ws/chat on the Crow port
+};
+
+/**
+ * @brief One row of the benchmark: an endpoint, a transport and a cache state.
+ */
+struct Scenario
+{
+    std::string name;
+    Transport transport = Transport::Http;
+    bool chat = false;       // /api/chat body instead of /api/generate
+    bool cache_hit = false;  // Repeat one warmed request instead of unique ones
+    bool direct = false;     // Bypass the proxy and hit the mock (measurement floor)
+};
+
+/**
+ * @brief Look up a predefined scenario by name.
+ * @return std::optional<Scenario> nullopt if unknown.
+ */
+[[nodiscard]] std::optional<Scenario> findScenario(std::string_view name);
+
+/**
+ * @brief Names of all predefined scenarios, in default run order.
+ */
+[[nodiscard]] std::vector<std::string> scenarioNames();
+
+/**
+ * @brief Where the proxy and the mock listen.
+ */
+struct Endpoints
+{
+    std::string host = "127.0.0.1";
+    int http_port = 0;
+    int stream_port = 0;
+    int mock_port = 0;
+};
+
+/**
+ * @brief Load shape shared by all scenarios.
+ */
+struct LoadOptions
+{
+    int concurrency = 8;
+    int requests = 200;                // Per scenario
+    std::vector<std::string> prompts;  // Workload, cycled; synthetic if empty
+};
+
+/**
+ * @brief Latency percentiles of one measured quantity, in milliseconds.
+ */
+struct LatencySummary
+{
+    size_t samples = 0;
+    double p50 = 0;
+    double p99 = 0;
+    double max = 0;
+};
+
+/**
+ * @brief What one scenario run observed.
+ */
+struct ScenarioResult
+{
+    std::string name;
+    size_t completed = 0;
+    size_t errors = 0;
+    std::string first_error{};
+    double wall_seconds = 0;
+    long long tokens = 0;
+
+    LatencySummary latency{};        // Client send to last byte
+    LatencySummary overhead{};       // Latency minus the mock's own service time
+    LatencySummary ttft_overhead{};  // Client first byte minus mock first byte
+};
+
+/**
+ * @brief Drive one scenario at the configured concurrency.
+ *
+ * Each worker keeps one connection and issues requests back to back. For
+ * requests the mock serves, the mock's timing is subtracted to isolate the
+ * time the proxy added; cache hits never reach the mock, so their overhead
+ * is their whole latency.
+ *
+ * @param scenario The scenario to run.
+ * @param endpoints Proxy and mock addresses.
+ * @param options Concurrency, request count and workload.
+ * @param mock The mock serving the proxy's upstream requests.
+ * @return ScenarioResult Counters and latency summaries.
+ */
+[[nodiscard]] ScenarioResult runScenario(const Scenario& scenario,
+                                         const Endpoints& endpoints,
+                                         const LoadOptions& options,
+                                         MockOllama& mock);
+
+/**
+ * @brief Load a replay workload: one prompt per JSONL line.
+ *
+ * Uses the line's "prompt" field, else "body", else "title", else the raw
+ * line, so both captured request logs and plain prompt lists work.
+ *
+ * @param path The JSONL file.
+ * @param prompts Receives the prompts (appended).
+ * @return std::optional<std::string> Error message on failure, nullopt on success.
+ */
+std::optional<std::string> loadPrompts(const std::string& path, std::vector<std::string>& prompts);
+
+} // namespace sectorflux::bench
@@ -0,0 +1,316 @@
+/*
+ * SectorFlux - LLM Proxy and Analytics
+ * Copyright (c) 2025 ParticleSector.com
+ *
+ * This software is dual-licensed:
+ * - GPL-3.0 for open source use
+ * - Commercial license for proprietary use
+ *
+ * See LICENSE and LICENSING.md for details.
+ */
+
+#include "api_json.hpp"
+#include "cache_key.hpp"
+#include "database.hpp"
+#include "proxy.hpp"
+
+#include <benchmark/benchmark.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+
+using sectorflux::CacheKey;
+using sectorflux::Database;
+
+constexpr const char* kCachedBody =
+    "{\"model\":\"bench\",\"response\":\"cached\",\"done\":false}\n"
+    "{\"model\":\"bench\",\"response\":\"\",\"done\":true,\"prompt_eval_count\":8,"
+    "\"eval_count\":1,\"eval_duration\":1000000}\n";
+constexpr auto kDrainPoll = std::chrono::milliseconds(1);
+constexpr long long kFillChunk = 2000;
+
+/**
+ * @brief A database in a temporary file, removed when the benchmark exits.
+ */
+class ScratchDatabase
+{
+public:
+    explicit ScratchDatabase(const std::string& name)
+        : path_("/tmp/sectorflux_microbench_" + std::to_string(getpid()) + "_" + name + ".db"),
+          db_(std::make_unique<Database>())
+    {
+        if (auto err = db_->init(path_))
+        {
+            std::fprintf(stderr, "Cannot open %s: %s\n", path_.c_str(), err->c_str());
+            std::abort();
+        }
+    }
+
+    ~ScratchDatabase()
+    {
+        // Close first so the writer's final checkpoint does not recreate the files
+        db_.reset();
+        for (const char* suffix : {"", "-wal", "-shm"})
+        {
+            std::remove((path_ + suffix).c_str());
+        }
+    }
+
+    ScratchDatabase(const ScratchDatabase&) = delete;
+    ScratchDatabase& operator=(const ScratchDatabase&) = delete;
+
+    Database& db()
+    {
+        return *db_;
+    }
+
+private:
+    std::string path_;
+    std::unique_ptr<Database> db_;
+};
+
+CacheKey cacheKeyFor(long long index)
+{
+    return sectorflux::makeCacheKey("/api/generate", "{\"prompt\":\"" + std::to_string(index) + "\"}");
+}
+
+/**
+ * @brief Block until the writer has committed the entry for key.
+ *
+ * The write queue is FIFO, so once the last enqueued key is readable every
+ * earlier one is too.
+ */
+void waitForCacheEntry(Database& db, const CacheKey& key)
+{
+    while (!db.getCachedResponse(key))
+    {
+        std::this_thread::sleep_for(kDrainPoll);
+    }
+}
+
+/**
+ * @brief A database holding rows cache entries, built once per size.
+ *
+ * Google Benchmark re-runs a function while calibrating its iteration count,
+ * so populated tables are shared across runs instead of rebuilt each time.
+ */
+Database& cacheWithRows(long long rows)
+{
+    static std::mutex mutex;
+    static std::map<long long, std::unique_ptr<ScratchDatabase>> databases;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    auto& scratch = databases[rows];
+    if (!scratch)
+    {
+        scratch = std::make_unique<ScratchDatabase>("cache_" + std::to_string(rows));
+        // Identical bodies deduplicate into one blob; rows differ only by key.
+        // Filled in chunks smaller than the write queue so nothing is shed.
+        auto body = std::make_shared<const std::string>(kCachedBody);
+        for (long long i = 0; i < rows; ++i)
+        {
+            scratch->db().cacheResponseAsync(cacheKeyFor(i), 200, body, nullptr);
+            if ((i + 1) % kFillChunk == 0 || i + 1 == rows)
+            {
+                waitForCacheEntry(scratch->db(), cacheKeyFor(i));
+            }
+        }
+    }
+    return scratch->db();
+}
+
+/**
+ * @brief Build an NDJSON generate response of roughly the given size.
+ */
+std::string ndjsonPayload(size_t bytes)
+{
+    const std::string line =
+        "{\"model\":\"bench\",\"created_at\":\"2025-01-01T00:00:00Z\","
+        "\"response\":\" token\",\"done\":false}\n";
+    std::string payload;
+    payload.reserve(bytes + 256);
+    while (payload.size() + line.size() < bytes)
+    {
+        payload += line;
+    }
+    payload +=
+        "{\"model\":\"bench\",\"created_at\":\"2025-01-01T00:00:00Z\",\"response\":\"\","
+        "\"done\":true,\"done_reason\":\"stop\",\"prompt_eval_count\":26,"
+        "\"prompt_eval_duration\":130000000,\"eval_count\":290,\"eval_duration\":4700000000}\n";
+    return payload;
+}
+
+sectorflux::LogEntry sampleLogEntry(int id)
+{
+    return sectorflux::LogEntry{
+        .id = id,
+        .timestamp = "2025-01-01 00:00:00",
+        .method = "POST",
+        .endpoint = "/api/generate",
+        .model = "llama3.2:latest",
+        .request_body = "",
+        .response_status = 200,
+        .response_body = "",
+        .duration_ms = 1834,
+        .prompt_tokens = 26,
+        .completion_tokens = 290,
+        .prompt_eval_duration_ms = 130,
+        .eval_duration_ms = 4700,
+        .ttft_ms = 152,
+        .queue_wait_ms = 0,
+        .is_starred = false,
+        .cache_hit = id % 3 == 0,
+        .backend = "http://localhost:11434",
+        .request_size = 96,
+        .response_size = 18432,
+        .capture = sectorflux::LogCapture::Full,
+    };
+}
+
+void BM_ExtractMetrics(benchmark::State& state)
+{
+    const std::string payload = ndjsonPayload(static_cast<size_t>(state.range(0)));
+    for (auto _ : state)
+    {
+        auto metrics = sectorflux::ProxyHandler::extractMetrics(payload);
+        benchmark::DoNotOptimize(metrics);
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) *
+                            static_cast<int64_t>(payload.size()));
+}
+BENCHMARK(BM_ExtractMetrics)->RangeMultiplier(4)->Range(1 << 10, 1 << 20);
+
+void BM_CacheLookup(benchmark::State& state)
+{
+    const long long rows = state.range(0);
+    Database& db = cacheWithRows(rows);
+    std::mt19937_64 rng(42);
+    std::uniform_int_distribution<long long> pick(0, rows - 1);
+    for (auto _ : state)
+    {
+        auto cached = db.getCachedResponse(cacheKeyFor(pick(rng)));
+        benchmark::DoNotOptimize(cached);
+    }
+}
+BENCHMARK(BM_CacheLookup)->Arg(10000)->Arg(100000)->Arg(1000000)->Unit(benchmark::kMicrosecond);
+
+void BM_CacheLookupMiss(benchmark::State& state)
+{
+    const long long rows = state.range(0);
+    Database& db = cacheWithRows(rows);
+    long long next = rows;
+    for (auto _ : state)
+    {
+        auto cached = db.getCachedResponse(cacheKeyFor(next++));
+        benchmark::DoNotOptimize(cached);
+    }
+}
+BENCHMARK(BM_CacheLookupMiss)->Arg(10000)->Arg(100000)->Arg(1000000)->Unit(benchmark::kMicrosecond);
+
+void BM_CacheStore(benchmark::State& state)
+{
+    const long long rows = state.range(0);
+    Database& db = cacheWithRows(rows);
+    auto body = std::make_shared<const std::string>(kCachedBody);
+    // Keys beyond the lookup range; the extra rows do not disturb later runs
+    static long long next = 1LL << 40;
+    long long first = next;
+    for (auto _ : state)
+    {
+        db.cacheResponseAsync(cacheKeyFor(next++), 200, body, nullptr);
+    }
+    // Include the writer's commit time, not just the enqueue
+    waitForCacheEntry(db, cacheKeyFor(next - 1));
+    state.SetItemsProcessed(next - first);
+}
+BENCHMARK(BM_CacheStore)->Arg(10000)->Arg(100000)->Arg(1000000)->Unit(benchmark::kMicrosecond)
+    ->UseRealTime();
+
+void BM_LogEnqueue(benchmark::State& state)
+{
+    static ScratchDatabase scratch("log");
+    auto response = std::make_shared<const std::string>(ndjsonPayload(4096));
+    const std::string request = "{\"model\":\"llama3.2:latest\",\"prompt\":\"Why is the sky blue?\"}";
+    for (auto _ : state)
+    {
+        scratch.db().logInteractionAsync(sectorflux::LogRecord{
+            .method = "POST",
+            .endpoint = "/api/generate",
+            .model = "llama3.2:latest",
+            .request_body = request,
+            .response_status = 200,
+            .response_body = response,
+            .duration_ms = 1834,
+            .prompt_tokens = 26,
+            .completion_tokens = 290,
+            .prompt_eval_duration_ms = 130,
+            .eval_duration_ms = 4700,
+            .ttft_ms = 152,
+        });
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_LogEnqueue)->ThreadRange(1, 16)->UseRealTime();
+
+void BM_DashboardSerialize(benchmark::State& state)
+{
+    std::vector<sectorflux::LogEntry> logs;
+    for (int i = 0; i < state.range(0); ++i)
+    {
+        logs.push_back(sampleLogEntry(i + 1));
+    }
+    sectorflux::LatencyStats latency;
+    for (const char* model : {"llama3.2:latest", "qwen2.5:7b", "mistral:latest"})
+    {
+        for (int i = 0; i < 100; ++i)
+        {
+            latency.record(model, "/api/generate",
+                           sectorflux::LatencySample{.duration_ms = 1000 + i * 17,
+                                                     .ttft_ms = 100 + i,
+                                                     .eval_duration_ms = 900 + i * 15,
+                                                     .completion_tokens = 200 + i});
+        }
+    }
+
+    // The same shape as one dashboard delta
+    for (auto _ : state)
+    {
+        crow::json::wvalue delta;
+        delta["type"] = "delta";
+        delta["logs"] = sectorflux::logListToJson(logs);
+        delta["metrics"]["latency"] = sectorflux::latencyToJson(latency);
+        std::string text = delta.dump();
+        benchmark::DoNotOptimize(text);
+    }
+}
+BENCHMARK(BM_DashboardSerialize)->Arg(1)->Arg(50)->Arg(500);
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    // Measure sustained throughput: producers wait for the writer rather
+    // than shedding writes, unless the environment picks another policy
+    setenv("SECTORFLUX_LOG_QUEUE_POLICY", "block", 0);
+
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv))
+    {
+        return 1;
+    }
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
@@ -0,0 +1,217 @@
+/*
+ * SectorFlux - LLM Proxy and Analytics
+ * Copyright (c) 2025 ParticleSector.com
+ *
+ * This software is dual-licensed:
+ * - GPL-3.0 for open source use
+ * - Commercial license for proprietary use
+ *
+ * See LICENSE and LICENSING.md for details.
+ */
+
+#include "mock_ollama.hpp"
+
+#include <charconv>
+#include <memory>
+#include <string_view>
+
+namespace sectorflux::bench
+{
+
+namespace
+{
+
+constexpr std::string_view kMarkerPrefix = "sfbench-";
+constexpr const char* kModel = "bench";
+constexpr long long kNanosecondsPerMillisecond = 1000000;
+
+std::optional<uint64_t> findMarker(const std::string& body)
+{
+    size_t pos = body.find(kMarkerPrefix);
+    if (pos == std::string::npos)
+    {
+        return std::nullopt;
+    }
+    const char* begin = body.data() + pos + kMarkerPrefix.size();
+    const char* end = body.data() + body.size();
+    uint64_t id = 0;
+    auto [parsed_end, ec] = std::from_chars(begin, end, id);
+    if (ec != std::errc() || parsed_end == begin)
+    {
+        return std::nullopt;
+    }
+    return id;
+}
+
+std::string tokenLine(bool chat, int index)
+{
+    std::string text = "tok" + std::to_string(index % 100) + " ";
+    if (chat)
+    {
+        return std::string("{\"model\":\"") + kModel +
+               "\",\"created_at\":\"2025-01-01T00:00:00Z\",\"message\":{\"role\":\"assistant\","
+               "\"content\":\"" + text + "\"},\"done\":false}\n";
+    }
+    return std::string("{\"model\":\"") + kModel +
+           "\",\"created_at\":\"2025-01-01T00:00:00Z\",\"response\":\"" + text +
+           "\",\"done\":false}\n";
+}
+
+std::string summaryLine(bool chat, const MockProfile& profile, long long eval_ms)
+{
+    std::string payload = chat ? "\"message\":{\"role\":\"assistant\",\"content\":\"\"}"
+                               : "\"response\":\"\"";
+    return std::string("{\"model\":\"") + kModel + "\",\"created_at\":\"2025-01-01T00:00:00Z\"," +
+           payload + ",\"done\":true,\"done_reason\":\"stop\",\"prompt_eval_count\":8," +
+           "\"prompt_eval_duration\":" +
+           std::to_string(profile.prompt_eval_ms * kNanosecondsPerMillisecond) +
+           ",\"eval_count\":" + std::to_string(profile.tokens) +
+           ",\"eval_duration\":" + std::to_string(eval_ms * kNanosecondsPerMillisecond) + "}\n";
+}
+
+} // namespace
+
+MockOllama::MockOllama(MockProfile profile, size_t threads) : profile_(profile)
+{
+    server_.new_task_queue = [threads]()
+    {
+        return new httplib::ThreadPool(threads);
+    };
+
+    server_.Post("/api/generate", [this](const httplib::Request& req, httplib::Response& res)
+    {
+        stream(req, res, false);
+    });
+    server_.Post("/api/chat", [this](const httplib::Request& req, httplib::Response& res)
+    {
+        stream(req, res, true);
+    });
+    server_.Get("/api/ps", [](const httplib::Request&, httplib::Response& res)
+    {
+        res.set_content(std::string("{\"models\":[{\"name\":\"") + kModel + "\",\"model\":\"" +
+                            kModel + "\"}]}",
+                        "application/json");
+    });
+    server_.Get("/api/tags", [](const httplib::Request&, httplib::Response& res)
+    {
+        res.set_content(std::string("{\"models\":[{\"name\":\"") + kModel + "\"}]}",
+                        "application/json");
+    });
+    server_.Get("/api/version", [](const httplib::Request&, httplib::Response& res)
+    {
+        res.set_content("{\"version\":\"0.0.0-bench\"}", "application/json");
+    });
+}
+
+MockOllama::~MockOllama()
+{
+    stop();
+}
+
+std::optional<std::string> MockOllama::start(int port)
+{
+    if (!server_.bind_to_port("127.0.0.1", port))
+    {
+        return "Mock Ollama cannot listen on port " + std::to_string(port);
+    }
+    thread_ = std::thread([this]()
+    {
+        server_.listen_after_bind();
+    });
+    server_.wait_until_ready();
+    return std::nullopt;
+}
+
+void MockOllama::stop()
+{
+    if (thread_.joinable())
+    {
+        server_.stop();
+        thread_.join();
+    }
+}
+
+std::optional<MockTiming> MockOllama::takeTiming(uint64_t id)
+{
+    std::lock_guard<std::mutex> lock(timings_mutex_);
+    auto it = timings_.find(id);
+    if (it == timings_.end() || it->second.done.time_since_epoch().count() == 0)
+    {
+        return std::nullopt;
+    }
+    MockTiming timing = it->second;
+    timings_.erase(it);
+    return timing;
+}
+
+std::string MockOllama::marker(uint64_t id)
+{
+    return std::string(kMarkerPrefix) + std::to_string(id);
+}
+
+void MockOllama::stream(const httplib::Request& req, httplib::Response& res, bool chat)
+{
+    const auto received = std::chrono::steady_clock::now();
+    const auto id = findMarker(req.body);
+    if (id)
+    {
+        std::lock_guard<std::mutex> lock(timings_mutex_);
+        timings_[*id] = MockTiming{.received = received, .first_byte = {}, .done = {}};
+    }
+
+    res.set_chunked_content_provider(
+        "application/x-ndjson",
+        [this, chat, id](size_t /*offset*/, httplib::DataSink& sink)
+        {
+            const auto interval =
+                profile_.tokens_per_sec > 0
+                    ? std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                          std::chrono::duration<double>(profile_.tokens_per_chunk /
+                                                        profile_.tokens_per_sec))
+                    : std::chrono::steady_clock::duration::zero();
+            std::this_thread::sleep_for(std::chrono::milliseconds(profile_.prompt_eval_ms));
+
+            // Paced against the start so sleep overshoot does not accumulate
+            auto start = std::chrono::steady_clock::now();
+            auto first_byte = start;
+            int sent = 0;
+            int chunk_index = 0;
+            while (sent < profile_.tokens)
+            {
+                std::string chunk;
+                for (int i = 0; i < profile_.tokens_per_chunk && sent < profile_.tokens; ++i)
+                {
+                    chunk += tokenLine(chat, sent++);
+                }
+                if (sent >= profile_.tokens)
+                {
+                    auto eval_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                                       std::chrono::steady_clock::now() - start)
+                                       .count();
+                    chunk += summaryLine(chat, profile_, eval_ms);
+                }
+
+                std::this_thread::sleep_until(start + interval * chunk_index);
+                if (chunk_index++ == 0)
+                {
+                    first_byte = std::chrono::steady_clock::now();
+                }
+                if (!sink.write(chunk.data(), chunk.size()))
+                {
+                    return false;
+                }
+            }
+            sink.done();
+
+            if (id)
+            {
+                std::lock_guard<std::mutex> lock(timings_mutex_);
+                auto& timing = timings_[*id];
+                timing.first_byte = first_byte;
+                timing.done = std::chrono::steady_clock::now();
+            }
+            return true;
+        });
+}
+
+} // namespace sectorflux::bench
@@ -0,0 +1,112 @@
+/*
+ * SectorFlux - LLM Proxy and Analytics
+ * Copyright (c) 2025 ParticleSector.com
+ *
+ * This software is dual-licensed:
+ * - GPL-3.0 for open source use
+ * - Commercial license for proprietary use
+ *
+ * See LICENSE and LICENSING.md for details.
+ */
+
+#pragma once
+
+#include <httplib.h>
+
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+namespace sectorflux::bench
+{
+
+/**
+ * @brief How the mock generates a response.
+ */
+struct MockProfile
+{
+    int tokens = 64;              // Token lines per response
+    double tokens_per_sec = 200;  // Generation pace; 0 streams as fast as possible
+    int tokens_per_chunk = 1;     // Token lines per write
+    int prompt_eval_ms = 0;       // Delay before the first token
+};
+
+/**
+ * @brief When the mock saw a request and sent its response, on the steady clock.
+ */
+struct MockTiming
+{
+    std::chrono::steady_clock::time_point received;
+    std::chrono::steady_clock::time_point first_byte;
+    std::chrono::steady_clock::time_point done;
+};
+
+/**
+ * @brief Stand-in for Ollama that streams NDJSON at a configured pace.
+ *
+ * Serves /api/generate and /api/chat (plus the /api/ps, /api/tags and
+ * /api/version probes SectorFlux makes). A request whose prompt carries
+ * marker(id) has its timing recorded, so the driver, running in the same
+ * process and on the same clock, can subtract the mock's own time from what
+ * it observed through the proxy.
+ */
+class MockOllama
+{
+public:
+    /**
+     * @brief Construct a new Mock Ollama object.
+     * @param profile Response shape and pacing.
+     * @param threads Server worker threads; each open stream occupies one.
+     */
+    MockOllama(MockProfile profile, size_t threads);
+    ~MockOllama();
+
+    // Delete copy operations
+    MockOllama(const MockOllama&) = delete;
+    MockOllama& operator=(const MockOllama&) = delete;
+
+    /**
+     * @brief Start serving on 127.0.0.1.
+     * @param port The port to listen on.
+     * @return std::optional<std::string> Error message on failure, nullopt on success.
+     */
+    std::optional<std::string> start(int port);
+
+    /**
+     * @brief Stop serving and join the server thread.
+     */
+    void stop();
+
+    /**
+     * @brief Take the timing recorded for a marked request.
+     * @return std::optional<MockTiming> nullopt if the mock never served it
+     *         (a cache hit) or it has not finished.
+     */
+    std::optional<MockTiming> takeTiming(uint64_t id);
+
+    /**
+     * @brief The prompt marker identifying request id to the mock.
+     */
+    [[nodiscard]] static std::string marker(uint64_t id);
+
+    [[nodiscard]] const MockProfile& profile() const
+    {
+        return profile_;
+    }
+
+private:
+    void stream(const httplib::Request& req, httplib::Response& res, bool chat);
+
+    const MockProfile profile_;
+    httplib::Server server_;
+    std::thread thread_;
+
+    std::mutex timings_mutex_;
+    std::unordered_map<uint64_t, MockTiming> timings_;
+};
+
+} // namespace sectorflux::bench
@@ -0,0 +1,71 @@
+/*
+ * SectorFlux - LLM Proxy and Analytics
+ * Copyright (c) 2025 ParticleSector.com
+ *
+ * This software is dual-licensed:
+ * - GPL-3.0 for open source use
+ * - Commercial license for proprietary use
+ *
+ * See LICENSE and LICENSING.md for details.
+ */
+
+#include "process_stats.hpp"
+
+#include <unistd.h>
+
+#include <fstream>
+#include <sstream>
+#include <string>
+
+namespace sectorflux::bench
+{
+
+std::optional<ProcessSample> sampleProcess(pid_t pid)
+{
+    const std::string base = "/proc/" + std::to_string(pid);
+    std::ifstream stat(base + "/stat");
+    std::string line;
+    if (!std::getline(stat, line))
+    {
+        return std::nullopt;
+    }
+    // The command name is parenthesised and may contain spaces; fields resume after it
+    size_t close_paren = line.rfind(')');
+    if (close_paren == std::string::npos)
+    {
+        return std::nullopt;
+    }
+    std::istringstream fields(line.substr(close_paren + 2));
+    std::string skip;
+    unsigned long long utime = 0;
+    unsigned long long stime = 0;
+    // Fields 3..13 precede utime (14) and stime (15)
+    for (int i = 3; i <= 13; ++i)
+    {
+        fields >> skip;
+    }
+    if (!(fields >> utime >> stime))
+    {
+        return std::nullopt;
+    }
+
+    ProcessSample sample;
+    sample.cpu_seconds = static_cast<double>(utime + stime) / static_cast<double>(sysconf(_SC_CLK_TCK));
+
+    std::ifstream status(base + "/status");
+    while (std::getline(status, line))
+    {
+        std::istringstream value(line.substr(line.find(':') + 1));
+        if (line.rfind("VmRSS:", 0) == 0)
+        {
+            value >> sample.rss_kb;
+        }
+        else if (line.rfind("VmHWM:", 0) == 0)
+        {
+            value >> sample.peak_rss_kb;
+        }
+    }
+    return sample;
+}
+
+} // namespace sectorflux::bench
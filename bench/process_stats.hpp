@@ -0,0 +1,38 @@
+/*
+ * SectorFlux - LLM Proxy and Analytics
+ * Copyright (c) 2025 ParticleSector.com
+ *
+ * This software is dual-licensed:
+ * - GPL-3.0 for open source use
+ * - Commercial license for proprietary use
+ *
+ * See LICENSE and LICENSING.md for details.
+ */
+
+#pragma once
+
+#include <sys/types.h>
+
+#include <optional>
+
+namespace sectorflux::bench
+{
+
+/**
+ * @brief Resource usage of a process at one instant.
+ */
+struct ProcessSample
+{
+    double cpu_seconds = 0;  // User plus system time since start
+    long rss_kb = 0;         // Current resident set
+    long peak_rss_kb = 0;    // High-water resident set
+};
+
+/**
+ * @brief Read a process's CPU time and memory from /proc.
+ * @param pid The process to sample.
+ * @return std::optional<ProcessSample> nullopt if /proc is unavailable or the process is gone.
+ */
+[[nodiscard]] std::optional<ProcessSample> sampleProcess(pid_t pid);
+
+} // namespace sectorflux::bench
@@ -0,0 +1,270 @@
+/*
+ * SectorFlux - LLM Proxy and Analytics
+ * Copyright (c) 2025 ParticleSector.com
+ *
+ * This software is dual-licensed:
+ * - GPL-3.0 for open source use
+ * - Commercial license for proprietary use
+ *
+ * See LICENSE and LICENSING.md for details.
+ */
+
+#include "ws_client.hpp"
+
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <random>
+
+namespace sectorflux::bench
+{
+
+namespace
+{
+
+constexpr size_t kMaxHandshakeBytes = 16384;
+
+std::string base64(const unsigned char* data, size_t size)
+{
+    static constexpr char kAlphabet[] =
+        "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    std::string out;
+    for (size_t i = 0; i < size; i += 3)
+    {
+        unsigned value = data[i] << 16;
+        if (i + 1 < size)
+        {
+            value |= data[i + 1] << 8;
+        }
+        if (i + 2 < size)
+        {
+            value |= data[i + 2];
+        }
+        out += kAlphabet[(value >> 18) & 0x3F];
+        out += kAlphabet[(value >> 12) & 0x3F];
+        out += i + 1 < size ? kAlphabet[(value >> 6) & 0x3F] : '=';
+        out += i + 2 < size ? kAlphabet[value & 0x3F] : '=';
+    }
+    return out;
+}
+
+std::mt19937& rng()
+{
+    thread_local std::mt19937 engine{std::random_device{}()};
+    return engine;
+}
+
+} // namespace
+
+WsClient::~WsClient()
+{
+    close();
+}
+
+std::optional<std::string> WsClient::connect(const std::string& host, int port, const std::string& path)
+{
+    addrinfo hints{};
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo* result = nullptr;
+    std::string service = std::to_string(port);
+    if (getaddrinfo(host.c_str(), service.c_str(), &hints, &result) != 0 || result == nullptr)
+    {
+        return "Cannot resolve " + host;
+    }
+    fd_ = ::socket(result->ai_family, result->ai_socktype, result->ai_protocol);
+    bool connected = fd_ >= 0 && ::connect(fd_, result->ai_addr, result->ai_addrlen) == 0;
+    freeaddrinfo(result);
+    if (!connected)
+    {
+        close();
+        return "Cannot connect to " + host + ":" + service;
+    }
+    int one = 1;
+    setsockopt(fd_, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+    std::array<unsigned char, 16> nonce;
+    for (auto& byte : nonce)
+    {
+        byte = static_cast<unsigned char>(rng()());
+    }
+    std::string request = "GET " + path + " HTTP/1.1\r\n"
+                          "Host: " + host + ":" + service + "\r\n"
+                          "Upgrade: websocket\r\n"
+                          "Connection: Upgrade\r\n"
+                          "Sec-WebSocket-Key: " + base64(nonce.data(), nonce.size()) + "\r\n"
+                          "Sec-WebSocket-Version: 13\r\n\r\n";
+    if (::send(fd_, request.data(), request.size(), MSG_NOSIGNAL) != static_cast<ssize_t>(request.size()))
+    {
+        close();
+        return std::string("Handshake send failed");
+    }
+
+    std::string response;
+    size_t header_end = std::string::npos;
+    while (header_end == std::string::npos)
+    {
+        char buffer[1024];
+        ssize_t n = ::recv(fd_, buffer, sizeof(buffer), 0);
+        if (n <= 0 || response.size() > kMaxHandshakeBytes)
+        {
+            close();
+            return std::string("Handshake response truncated");
+        }
+        response.append(buffer, static_cast<size_t>(n));
+        header_end = response.find("\r\n\r\n");
+    }
+    if (response.compare(0, 12, "HTTP/1.1 101") != 0)
+    {
+        close();
+        return "Upgrade refused: " + response.substr(0, response.find("\r\n"));
+    }
+    pending_ = response.substr(header_end + 4);
+    return std::nullopt;
+}
+
+bool WsClient::sendText(std::string_view text)
+{
+    return sendFrame(kOpText, text);
+}
+
+std::optional<std::string> WsClient::receiveText()
+{
+    std::string message;
+    while (fd_ >= 0)
+    {
+        unsigned char header[2];
+        if (!readExact(reinterpret_cast<char*>(header), sizeof(header)))
+        {
+            break;
+        }
+        bool fin = (header[0] & 0x80) != 0;
+        unsigned char opcode = header[0] & 0x0F;
+        uint64_t length = header[1] & 0x7F;
+        if (length == 126 || length == 127)
+        {
+            unsigned char extended[8];
+            size_t count = length == 126 ? 2 : 8;
+            if (!readExact(reinterpret_cast<char*>(extended), count))
+            {
+                break;
+            }
+            length = 0;
+            for (size_t i = 0; i < count; ++i)
+            {
+                length = (length << 8) | extended[i];
+            }
+        }
+        // Server frames are never masked (RFC 6455 5.1)
+        std::string payload(length, '\0');
+        if (length > 0 && !readExact(payload.data(), payload.size()))
+        {
+            break;
+        }
+
+        if (opcode == kOpPing)
+        {
+            sendFrame(kOpPong, payload);
+            continue;
+        }
+        if (opcode != kOpText && opcode != kOpContinuation)
+        {
+            break;
+        }
+        message += payload;
+        if (fin)
+        {
+            return message;
+        }
+    }
+    close();
+    return std::nullopt;
+}
+
+void WsClient::close()
+{
+    if (fd_ < 0)
+    {
+        return;
+    }
+    sendFrame(kOpClose, {});
+    ::close(fd_);
+    fd_ = -1;
+}
+
+bool WsClient::sendFrame(unsigned char opcode, std::string_view payload)
+{
+    if (fd_ < 0)
+    {
+        return false;
+    }
+    std::string frame;
+    frame += static_cast<char>(0x80 | opcode);
+    if (payload.size() < 126)
+    {
+        frame += static_cast<char>(0x80 | payload.size());
+    }
+    else if (payload.size() <= 0xFFFF)
+    {
+        frame += static_cast<char>(0x80 | 126);
+        frame += static_cast<char>((payload.size() >> 8) & 0xFF);
+        frame += static_cast<char>(payload.size() & 0xFF);
+    }
+    else
+    {
+        frame += static_cast<char>(0x80 | 127);
+        for (int shift = 56; shift >= 0; shift -= 8)
+        {
+            frame += static_cast<char>((static_cast<uint64_t>(payload.size()) >> shift) & 0xFF);
+        }
+    }
+
+    // Client frames must be masked (RFC 6455 5.3)
+    std::array<char, 4> mask;
+    for (auto& byte : mask)
+    {
+        byte = static_cast<char>(rng()());
+    }
+    frame.append(mask.data(), mask.size());
+    for (size_t i = 0; i < payload.size(); ++i)
+    {
+        frame += static_cast<char>(payload[i] ^ mask[i % 4]);
+    }
+
+    size_t sent = 0;
+    while (sent < frame.size())
+    {
+        ssize_t n = ::send(fd_, frame.data() + sent, frame.size() - sent, MSG_NOSIGNAL);
+        if (n <= 0)
+        {
+            return false;
+        }
+        sent += static_cast<size_t>(n);
+    }
+    return true;
+}
+
+bool WsClient::readExact(char* out, size_t size)
+{
+    size_t filled = std::min(size, pending_.size());
+    std::memcpy(out, pending_.data(), filled);
+    pending_.erase(0, filled);
+    while (filled < size)
+    {
+        ssize_t n = ::recv(fd_, out + filled, size - filled, 0);
+        if (n <= 0)
+        {
+            return false;
+        }
+        filled += static_cast<size_t>(n);
+    }
+    return true;
+}
+
+} // namespace sectorflux::bench
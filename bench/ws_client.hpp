@@ -0,0 +1,83 @@
+/*
+ * SectorFlux - LLM Proxy and Analytics
+ * Copyright (c) 2025 ParticleSector.com
+ *
+ * This software is dual-licensed:
+ * - GPL-3.0 for open source use
+ * - Commercial license for proprietary use
+ *
+ * See LICENSE and LICENSING.md for details.
+ */
+
+#pragma once
+
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace sectorflux::bench
+{
+
+/**
+ * @brief Minimal blocking RFC 6455 client, enough to drive /ws/chat.
+ *
+ * Text frames only: fragments are reassembled, pings answered, anything else
+ * ends the connection. POSIX sockets; the benchmark is Linux-only.
+ */
+class WsClient
+{
+public:
+    WsClient() = default;
+    ~WsClient();
+
+    // Delete copy operations
+    WsClient(const WsClient&) = delete;
+    WsClient& operator=(const WsClient&) = delete;
+
+    /**
+     * @brief Connect and perform the upgrade handshake.
+     * @param host IPv4 address or host name.
+     * @param port The port.
+     * @param path The request path, e.g. "/ws/chat".
+     * @return std::optional<std::string> Error message on failure, nullopt on success.
+     */
+    std::optional<std::string> connect(const std::string& host, int port, const std::string& path);
+
+    /**
+     * @brief Send one masked text frame.
+     * @return bool False if the connection failed.
+     */
+    bool sendText(std::string_view text);
+
+    /**
+     * @brief Block until the next complete text message.
+     * @return std::optional<std::string> nullopt on close or error.
+     */
+    std::optional<std::string> receiveText();
+
+    /**
+     * @brief Send a close frame and shut the socket.
+     */
+    void close();
+
+    [[nodiscard]] bool isOpen() const
+    {
+        return fd_ >= 0;
+    }
+
+private:
+    bool sendFrame(unsigned char opcode, std::string_view payload);
+    bool readExact(char* out, size_t size);
+
+    int fd_ = -1;
+    std::string pending_;  // Bytes read past the handshake response
+
+    // Constants
+    static constexpr unsigned char kOpContinuation = 0x0;
+    static constexpr unsigned char kOpText = 0x1;
+    static constexpr unsigned char kOpClose = 0x8;
+    static constexpr unsigned char kOpPing = 0x9;
+    static constexpr unsigned char kOpPong = 0xA;
+};
+
+} // namespace sectorflux::bench
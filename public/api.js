@@ -17,7 +17,8 @@ const API = {
 
     async fetchLogs() {
         const response = await fetch('/api/logs');
-        return response.json();
+        const page = await response.json();
+        return page.logs;
     },
 
     async fetchLog(id) {
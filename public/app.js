@@ -19,6 +19,7 @@ document.addEventListener('DOMContentLoaded', () => {
     const metricTotal = document.getElementById('metric-total');
     const metricLatency = document.getElementById('metric-latency');
     const metricCache = document.getElementById('metric-cache');
+    const latencyTableBody = document.querySelector('#latencyTable tbody');
 
     async function fetchMetrics() {
         try {
@@ -26,14 +27,29 @@ document.addEventListener('DOMContentLoaded', () => {
             metricTotal.textContent = data.total_requests;
             metricLatency.textContent = `${data.avg_latency_ms.toFixed(0)}ms`;
             metricCache.textContent = `${(data.cache_hit_rate * 100).toFixed(1)}%`;
+            if (data.latency) renderLatency(data.latency);
         } catch (error) {
             console.error('Error fetching metrics:', error);
         }
     }
 
+    // Rows currently shown on the dashboard, newest first
+    const kDashboardLogLimit = 50;
+    let dashboardLogs = [];
+
+    function mergeLogs(newLogs) {
+        const byId = new Map(dashboardLogs.map(log => [log.id, log]));
+        newLogs.forEach(log => byId.set(log.id, log));
+        dashboardLogs = [...byId.values()]
+            .sort((a, b) => b.id - a.id)
+            .slice(0, kDashboardLogLimit);
+        renderLogs(dashboardLogs);
+    }
+
     async function fetchLogs() {
         try {
             const data = await API.fetchLogs();
+            dashboardLogs = data;
             renderLogs(data);
             fetchMetrics(); // Update metrics when logs update
         } catch (error) {
@@ -41,6 +57,30 @@ document.addEventListener('DOMContentLoaded', () => {
         }
     }
 
+    function renderLatency(series) {
+        if (!latencyTableBody) return;
+        latencyTableBody.innerHTML = '';
+        series.forEach(entry => {
+            const row = document.createElement('tr');
+            const d = entry.duration_ms;
+            const queue = entry.queue_wait_ms.count > 0 ? `${entry.queue_wait_ms.p95}ms` : '-';
+            const ttft = entry.ttft_ms.count > 0 ? `${entry.ttft_ms.p95}ms` : '-';
+            const tps = entry.tokens_per_sec.count > 0 ? `${entry.tokens_per_sec.p50} t/s` : '-';
+            row.innerHTML = `
+                <td><span class="model-tag">${entry.model}</span></td>
+                <td>${entry.endpoint}</td>
+                <td>${d.count}</td>
+                <td>${d.p50}ms</td>
+                <td>${d.p95}ms</td>
+                <td>${d.p99}ms</td>
+                <td>${queue}</td>
+                <td>${ttft}</td>
+                <td>${tps}</td>
+            `;
+            latencyTableBody.appendChild(row);
+        });
+    }
+
     function renderLogs(logs) {
         logsTableBody.innerHTML = '';
         logs.forEach(log => {
@@ -62,6 +102,9 @@ document.addEventListener('DOMContentLoaded', () => {
 
             const starIcon = log.is_starred ? '★' : '☆';
             const starClass = log.is_starred ? 'star-btn starred' : 'star-btn';
+            // Only fully captured entries still hold the request to replay
+            const replayable = !log.capture || log.capture === 'full';
+            const replayAttrs = replayable ? '' : 'disabled title="Bodies were not captured in full"';
 
             row.innerHTML = `
                 <td><button class="${starClass}" data-id="${log.id}" data-starred="${log.is_starred}">${starIcon}</button></td>
@@ -75,7 +118,7 @@ document.addEventListener('DOMContentLoaded', () => {
                 <td>${tps}</td>
                 <td>
                     <button class="btn-sm view-btn" data-id="${log.id}">View</button>
-                    <button class="btn-sm replay-btn" data-id="${log.id}">Replay</button>
+                    <button class="btn-sm replay-btn" data-id="${log.id}" ${replayAttrs}>Replay</button>
                 </td>
             `;
             logsTableBody.appendChild(row);
@@ -88,7 +131,13 @@ document.addEventListener('DOMContentLoaded', () => {
                 const currentlyStarred = e.target.getAttribute('data-starred') === 'true';
                 const newStarred = !currentlyStarred;
 
+                const setCached = (starred) => {
+                    const cached = dashboardLogs.find(log => log.id === id);
+                    if (cached) cached.is_starred = starred;
+                };
+
                 // Optimistic UI update
+                setCached(newStarred);
                 e.target.textContent = newStarred ? '★' : '☆';
                 e.target.className = newStarred ? 'star-btn starred' : 'star-btn';
                 e.target.setAttribute('data-starred', newStarred);
@@ -98,6 +147,7 @@ document.addEventListener('DOMContentLoaded', () => {
                 } catch (error) {
                     console.error('Error updating starred status:', error);
                     // Revert on error
+                    setCached(currentlyStarred);
                     e.target.textContent = currentlyStarred ? '★' : '☆';
                     e.target.className = currentlyStarred ? 'star-btn starred' : 'star-btn';
                     e.target.setAttribute('data-starred', currentlyStarred);
@@ -371,12 +421,17 @@ document.addEventListener('DOMContentLoaded', () => {
 
         ws.onmessage = (event) => {
             try {
+                // A snapshot replaces the table; deltas only carry new rows
                 const data = JSON.parse(event.data);
-                if (data.logs) renderLogs(data.logs);
+                if (data.type === 'snapshot') {
+                    dashboardLogs = [];
+                }
+                if (data.logs) mergeLogs(data.logs);
                 if (data.metrics) {
                     metricTotal.textContent = data.metrics.total_requests;
                     metricLatency.textContent = `${data.metrics.avg_latency_ms.toFixed(0)}ms`;
                     metricCache.textContent = `${(data.metrics.cache_hit_rate * 100).toFixed(1)}%`;
+                    if (data.metrics.latency) renderLatency(data.metrics.latency);
                 }
                 if (data.running_model) {
                     if (runningModelName) {
@@ -12,17 +12,24 @@
 Embed UI files into a C++ header for single-binary distribution.
 
 This script converts HTML, CSS, and JS files into C++ byte arrays
-that can be included directly in the SectorFlux binary.
+that can be included directly in the SectorFlux binary. Each file is also
+embedded gzip- and (when the brotli module is installed) brotli-compressed,
+with a content hash ETag per variant, so the server can negotiate
+Content-Encoding and answer revalidations without work at runtime.
 """
 
+import gzip
+import hashlib
 import os
 
+try:
+    import brotli
+except ImportError:  # Optional: without it only gzip is offered
+    brotli = None
 
-def file_to_hex(filepath: str, var_name: str) -> str:
-    """Convert a file to a C++ hex array declaration."""
-    with open(filepath, 'rb') as f:
-        content = f.read()
 
+def bytes_to_hex(content: bytes, var_name: str) -> str:
+    """Convert bytes to a C++ hex array declaration."""
     hex_array = ', '.join([f'0x{b:02x}' for b in content])
     return (
         f'const unsigned char {var_name}[] = {{ {hex_array} }};\n'
@@ -30,34 +37,77 @@ def file_to_hex(filepath: str, var_name: str) -> str:
     )
 
 
+def compressed_variants(content: bytes) -> dict:
+    """Compress content; a coding that does not shrink it is left out."""
+    variants = {
+        # mtime=0 keeps the output, and so the build, reproducible
+        'gzip': gzip.compress(content, compresslevel=9, mtime=0),
+    }
+    if brotli is not None:
+        variants['br'] = brotli.compress(content, quality=11)
+    return {coding: data for coding, data in variants.items() if len(data) < len(content)}
+
+
+def embed_file(filepath: str, var_name: str, url_path: str, content_type: str) -> tuple:
+    """Emit the arrays for one file and return its kEmbeddedAssets entry."""
+    with open(filepath, 'rb') as f:
+        content = f.read()
+
+    digest = hashlib.sha256(content).hexdigest()[:32]
+    variants = compressed_variants(content)
+
+    code = bytes_to_hex(content, var_name)
+    fields = [f'"{url_path}"', f'"{content_type}"', var_name, f'{var_name}_len']
+    for coding in ('gzip', 'br'):
+        if coding in variants:
+            name = f'{var_name}_{coding}'
+            code += bytes_to_hex(variants[coding], name)
+            fields += [name, f'{name}_len']
+        else:
+            fields += ['nullptr', '0']
+    fields += [f'"\\"{digest}\\""', f'"\\"{digest}-gzip\\""', f'"\\"{digest}-br\\""']
+
+    sizes = ', '.join(f'{coding} {len(data)}' for coding, data in variants.items())
+    summary = f'{len(content)} bytes' + (f' ({sizes})' if sizes else '')
+    return code, '    {' + ', '.join(fields) + '},\n', summary
+
+
 def main() -> None:
     """Main entry point for the embed script."""
     script_dir = os.path.dirname(__file__)
     public_dir = os.path.join(script_dir, '..', 'public')
     output_file = os.path.join(script_dir, '..', 'src', 'embedded_ui.hpp')
 
+    # file name -> (variable name, URL path, Content-Type)
     files_to_embed = {
-        'index.html': 'index_html',
-        'app.js': 'app_js',
-        'api.js': 'api_js',
-        'style.css': 'style_css'
+        'index.html': ('index_html', '/', 'text/html; charset=utf-8'),
+        'app.js': ('app_js', '/app.js', 'application/javascript'),
+        'api.js': ('api_js', '/api.js', 'application/javascript'),
+        'style.css': ('style_css', '/style.css', 'text/css')
     }
 
     with open(output_file, 'w') as out:
         out.write('#pragma once\n\n')
         out.write('// Auto-generated file - do not edit manually\n')
         out.write('// Generated by scripts/embed_ui.py\n\n')
+        out.write('#include "static_assets.hpp"\n\n')
         out.write('#include <cstddef>\n\n')
 
-        for filename, var_name in files_to_embed.items():
+        entries = []
+        for filename, (var_name, url_path, content_type) in files_to_embed.items():
             filepath = os.path.join(public_dir, filename)
             if os.path.exists(filepath):
-                out.write(file_to_hex(filepath, var_name))
+                code, entry, summary = embed_file(filepath, var_name, url_path, content_type)
+                out.write(code)
                 out.write('\n')
-                print(f'Embedded {filename} as {var_name}')
+                entries.append(entry)
+                print(f'Embedded {filename} as {var_name}: {summary}')
             else:
                 print(f'Warning: {filename} not found at {filepath}')
 
+        out.write('const sectorflux::EmbeddedAsset kEmbeddedAssets[] = {\n')
+        out.writelines(entries)
+        out.write('};\n')
 
 if __name__ == '__main__':
     main()
@@ -0,0 +1,296 @@
+/*
+ * SectorFlux - LLM Proxy and Analytics
+ * Copyright (c) 2025 ParticleSector.com
+ *
+ * This software is dual-licensed:
+ * - GPL-3.0 for open source use
+ * - Commercial license for proprietary use
+ *
+ * See LICENSE and LICENSING.md for details.
+ */
+
+#include "admission_scheduler.hpp"
+
+#include <algorithm>
+#include <iterator>
+#include <utility>
+
+namespace sectorflux
+{
+
+Priority parsePriority(std::string_view name)
+{
+    if (name == "interactive")
+    {
+        return Priority::Interactive;
+    }
+    if (name == "batch")
+    {
+        return Priority::Batch;
+    }
+    return Priority::Normal;
+}
+
+const char* priorityName(Priority priority)
+{
+    switch (priority)
+    {
+        case Priority::Interactive: return "interactive";
+        case Priority::Normal: return "normal";
+        case Priority::Batch: return "batch";
+    }
+    return "normal";
+}
+
+AdmissionScheduler::Ticket::Ticket(Ticket&& other) noexcept
+    : scheduler_(std::exchange(other.scheduler_, nullptr)),
+      model_(std::move(other.model_)),
+      backend_(std::move(other.backend_)),
+      queue_wait_ms_(other.queue_wait_ms_)
+{
+}
+
+AdmissionScheduler::Ticket& AdmissionScheduler::Ticket::operator=(Ticket&& other) noexcept
+{
+    if (this != &other)
+    {
+        if (scheduler_)
+        {
+            scheduler_->release(model_, backend_);
+        }
+        scheduler_ = std::exchange(other.scheduler_, nullptr);
+        model_ = std::move(other.model_);
+        backend_ = std::move(other.backend_);
+        queue_wait_ms_ = other.queue_wait_ms_;
+    }
+    return *this;
+}
+
+AdmissionScheduler::Ticket::~Ticket()
+{
+    if (scheduler_)
+    {
+        scheduler_->release(model_, backend_);
+    }
+}
+
+AdmissionScheduler::AdmissionScheduler(size_t max_per_model, size_t max_per_backend)
+    : max_per_model_(max_per_model), max_per_backend_(max_per_backend)
+{
+}
+
+AdmissionScheduler::Ticket AdmissionScheduler::admit(
+    const std::string& model,
+    const std::vector<std::string>& backends,
+    const SchedulingHints& hints,
+    std::chrono::milliseconds timeout)
+{
+    const auto start = std::chrono::steady_clock::now();
+    if (backends.empty())
+    {
+        return Ticket{};
+    }
+    Waiter waiter{model, backends};
+    auto& queue = queues_[static_cast<size_t>(hints.priority)];
+
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    // Always go through the queue so arrivals cannot overtake waiting clients
+    auto& client_queue = queue.by_client[hints.client];
+    if (client_queue.empty())
+    {
+        queue.rotation.push_back(hints.client);
+    }
+    client_queue.push_back(&waiter);
+    ++queue.size;
+
+    if (dispatchLocked())
+    {
+        cv_.notify_all();
+    }
+
+    if (!cv_.wait_until(lock, start + timeout, [&waiter]() { return waiter.granted != nullptr; }))
+    {
+        removeLocked(queue, hints.client, &waiter);
+        ++timeouts_;
+        return Ticket{};
+    }
+
+    Ticket ticket;
+    ticket.scheduler_ = this;
+    ticket.model_ = model;
+    ticket.backend_ = *waiter.granted;
+    ticket.queue_wait_ms_ = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - start).count();
+    return ticket;
+}
+
+void AdmissionScheduler::setLimits(size_t max_per_model, size_t max_per_backend)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        max_per_model_ = max_per_model;
+        max_per_backend_ = max_per_backend;
+        if (!dispatchLocked())
+        {
+            return;
+        }
+    }
+    cv_.notify_all();
+}
+
+SchedulerStats AdmissionScheduler::stats() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    SchedulerStats stats;
+    for (size_t p = 0; p < kPriorityCount; ++p)
+    {
+        stats.queued[p] = queues_[p].size;
+    }
+    stats.in_flight = in_flight_;
+    stats.admitted = admitted_;
+    stats.timeouts = timeouts_;
+    return stats;
+}
+
+std::string AdmissionScheduler::slotKey(const std::string& model, const std::string& backend)
+{
+    // Ollama serializes work per model on each node, so the cap is per pair
+    return backend + '\n' + model;
+}
+
+const std::string* AdmissionScheduler::findCapacity(const Waiter& waiter) const
+{
+    auto below = [](const std::unordered_map<std::string, size_t>& counts,
+                    const std::string& key, size_t limit)
+    {
+        if (limit == 0)
+        {
+            return true;
+        }
+        auto it = counts.find(key);
+        return it == counts.end() || it->second < limit;
+    };
+
+    for (const auto& backend : waiter.backends)
+    {
+        if (below(model_in_flight_, slotKey(waiter.model, backend), max_per_model_) &&
+            below(backend_in_flight_, backend, max_per_backend_))
+        {
+            return &backend;
+        }
+    }
+    return nullptr;
+}
+
+void AdmissionScheduler::acquireSlot(const std::string& model, const std::string& backend)
+{
+    ++model_in_flight_[slotKey(model, backend)];
+    ++backend_in_flight_[backend];
+    ++in_flight_;
+    ++admitted_;
+}
+
+void AdmissionScheduler::release(const std::string& model, const std::string& backend)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto decrement = [](std::unordered_map<std::string, size_t>& counts, const std::string& key)
+        {
+            auto it = counts.find(key);
+            if (it != counts.end() && --it->second == 0)
+            {
+                counts.erase(it);
+            }
+        };
+        decrement(model_in_flight_, slotKey(model, backend));
+        decrement(backend_in_flight_, backend);
+        --in_flight_;
+
+        if (!dispatchLocked())
+        {
+            return;
+        }
+    }
+    cv_.notify_all();
+}
+
+bool AdmissionScheduler::dispatchLocked()
+{
+    bool granted_any = false;
+
+    // Strict priority between classes. Within a class each pass gives every
+    // waiting client one turn in rotation order, until a pass admits nobody.
+    // Served clients move behind the ones still waiting, so a client whose
+    // model is saturated keeps its place in line.
+    for (auto& queue : queues_)
+    {
+        bool progress = true;
+        while (progress && queue.size > 0)
+        {
+            progress = false;
+            std::deque<std::string> waiting;
+            std::deque<std::string> served;
+            for (auto& client : queue.rotation)
+            {
+                auto it = queue.by_client.find(client);
+                Waiter* head = it->second.front();
+                const std::string* backend = findCapacity(*head);
+                if (!backend)
+                {
+                    waiting.push_back(std::move(client));
+                    continue;
+                }
+
+                acquireSlot(head->model, *backend);
+                head->granted = backend;
+                it->second.pop_front();
+                --queue.size;
+                progress = true;
+                granted_any = true;
+
+                if (it->second.empty())
+                {
+                    queue.by_client.erase(it);
+                }
+                else
+                {
+                    served.push_back(std::move(client));
+                }
+            }
+
+            waiting.insert(waiting.end(),
+                           std::make_move_iterator(served.begin()),
+                           std::make_move_iterator(served.end()));
+            queue.rotation = std::move(waiting);
+        }
+    }
+
+    return granted_any;
+}
+
+void AdmissionScheduler::removeLocked(ClassQueue& queue, const std::string& client, Waiter* waiter)
+{
+    auto it = queue.by_client.find(client);
+    if (it == queue.by_client.end())
+    {
+        return;
+    }
+
+    auto& waiters = it->second;
+    auto pos = std::find(waiters.begin(), waiters.end(), waiter);
+    if (pos == waiters.end())
+    {
+        return;
+    }
+    waiters.erase(pos);
+    --queue.size;
+
+    if (waiters.empty())
+    {
+        queue.by_client.erase(it);
+        std::erase(queue.rotation, client);
+    }
+}
+
+}  // namespace sectorflux
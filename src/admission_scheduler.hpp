@@ -0,0 +1,206 @@
+/*
+ * SectorFlux - LLM Proxy and Analytics
+ * Copyright (c) 2025 ParticleSector.com
+ *
+ * This software is dual-licensed:
+ * - GPL-3.0 for open source use
+ * - Commercial license for proprietary use
+ *
+ * See LICENSE and LICENSING.md for details.
+ */
+
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace sectorflux
+{
+
+/**
+ * @brief Scheduling class of an upstream request, highest first.
+ */
+enum class Priority
+{
+    Interactive = 0,
+    Normal = 1,
+    Batch = 2,
+};
+
+inline constexpr size_t kPriorityCount = 3;
+
+/**
+ * @brief Parse an X-SectorFlux-Priority header value.
+ * @param name "interactive", "normal" or "batch" (case-sensitive).
+ * @return Priority The class; Normal for empty or unknown values.
+ */
+[[nodiscard]] Priority parsePriority(std::string_view name);
+
+/**
+ * @brief Get the configuration name of a priority class.
+ */
+[[nodiscard]] const char* priorityName(Priority priority);
+
+/**
+ * @brief Who is asking and how urgently; used to order waiting requests.
+ */
+struct SchedulingHints
+{
+    Priority priority = Priority::Normal;
+    std::string client;      // Fairness key, typically the remote address
+    std::string affinity{};  // Backend to prefer, e.g. one holding the conversation
+};
+
+/**
+ * @brief Occupancy and outcome counters of the scheduler.
+ */
+struct SchedulerStats
+{
+    std::array<size_t, kPriorityCount> queued{};
+    size_t in_flight = 0;
+    uint64_t admitted = 0;
+    uint64_t timeouts = 0;
+};
+
+/**
+ * @brief Admission control in front of the upstream.
+ *
+ * Caps in-flight requests per model on each backend and per backend
+ * overall (0 disables a cap).
+ * Requests over the cap wait in one queue per priority class. Higher
+ * classes are always served first, and within a class waiting clients
+ * take turns round-robin, so one agent flooding requests cannot starve
+ * the others. The scheduler is work-conserving: a waiter whose model is
+ * saturated does not block waiters behind it that target other models.
+ */
+class AdmissionScheduler
+{
+public:
+    /**
+     * @brief Permission to run one upstream request; releases its slot on destruction.
+     */
+    class Ticket
+    {
+    public:
+        Ticket() = default;
+        Ticket(Ticket&& other) noexcept;
+        Ticket& operator=(Ticket&& other) noexcept;
+        Ticket(const Ticket&) = delete;
+        Ticket& operator=(const Ticket&) = delete;
+        ~Ticket();
+
+        /**
+         * @brief Whether the request was admitted (false after a queue timeout).
+         */
+        explicit operator bool() const
+        {
+            return scheduler_ != nullptr;
+        }
+
+        /**
+         * @brief The backend the request was admitted to.
+         */
+        [[nodiscard]] const std::string& backend() const
+        {
+            return backend_;
+        }
+
+        /**
+         * @brief Time spent waiting for admission.
+         */
+        [[nodiscard]] long long queueWaitMs() const
+        {
+            return queue_wait_ms_;
+        }
+
+    private:
+        friend class AdmissionScheduler;
+
+        AdmissionScheduler* scheduler_ = nullptr;
+        std::string model_;
+        std::string backend_;
+        long long queue_wait_ms_ = 0;
+    };
+
+    /**
+     * @brief Construct a scheduler.
+     * @param max_per_model Maximum in-flight requests per model (0 = unlimited).
+     * @param max_per_backend Maximum in-flight requests per backend (0 = unlimited).
+     */
+    AdmissionScheduler(size_t max_per_model, size_t max_per_backend);
+
+    AdmissionScheduler(const AdmissionScheduler&) = delete;
+    AdmissionScheduler& operator=(const AdmissionScheduler&) = delete;
+
+    /**
+     * @brief Wait until a request may be sent upstream.
+     * @param model The model the request targets.
+     * @param backends Hosts that may serve it, most preferred first; the
+     *        first one with a free slot when the request's turn comes wins.
+     * @param hints Priority class and fairness key.
+     * @param timeout Maximum time to wait in the queue.
+     * @return Ticket An admitted ticket, or an empty one if the wait timed out.
+     */
+    [[nodiscard]] Ticket admit(
+        const std::string& model,
+        const std::vector<std::string>& backends,
+        const SchedulingHints& hints,
+        std::chrono::milliseconds timeout);
+
+    /**
+     * @brief Change the in-flight limits; waiters a raised limit frees are admitted now.
+     * @param max_per_model Maximum in-flight requests per model (0 = unlimited).
+     * @param max_per_backend Maximum in-flight requests per backend (0 = unlimited).
+     * @note Lowering a limit never interrupts admitted requests.
+     */
+    void setLimits(size_t max_per_model, size_t max_per_backend);
+
+    /**
+     * @brief Get queue depths and counters.
+     */
+    [[nodiscard]] SchedulerStats stats() const;
+
+private:
+    struct Waiter
+    {
+        const std::string& model;
+        const std::vector<std::string>& backends;
+        const std::string* granted = nullptr;  // Chosen entry of backends
+    };
+
+    struct ClassQueue
+    {
+        std::unordered_map<std::string, std::deque<Waiter*>> by_client;
+        std::deque<std::string> rotation;  // Clients with waiters, in turn order
+        size_t size = 0;
+    };
+
+    const std::string* findCapacity(const Waiter& waiter) const;
+    static std::string slotKey(const std::string& model, const std::string& backend);
+    void acquireSlot(const std::string& model, const std::string& backend);
+    void release(const std::string& model, const std::string& backend);
+    bool dispatchLocked();
+    void removeLocked(ClassQueue& queue, const std::string& client, Waiter* waiter);
+
+    mutable std::mutex mutex_;
+    size_t max_per_model_;
+    size_t max_per_backend_;
+    std::condition_variable cv_;
+    std::array<ClassQueue, kPriorityCount> queues_;
+    std::unordered_map<std::string, size_t> model_in_flight_;  // Keyed by slotKey()
+    std::unordered_map<std::string, size_t> backend_in_flight_;
+    size_t in_flight_ = 0;
+    uint64_t admitted_ = 0;
+    uint64_t timeouts_ = 0;
+};
+
+}  // namespace sectorflux
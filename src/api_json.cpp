@@ -0,0 +1,211 @@
+/*
+ * SectorFlux - LLM Proxy and Analytics
+ * Copyright (c) 2025 ParticleSector.com
+ *
+ * This software is dual-licensed:
+ * - GPL-3.0 for open source use
+ * - Commercial license for proprietary use
+ *
+ * See LICENSE and LICENSING.md for details.
+ */
+
+#include "api_json.hpp"
+
+#include <string>
+#include <utility>
+
+namespace sectorflux
+{
+
+crow::json::wvalue histogramToJson(const HistogramSnapshot& hist)
+{
+    crow::json::wvalue json;
+    json["count"] = hist.count;
+    json["mean"] = hist.count > 0 ? static_cast<double>(hist.sum) / hist.count : 0.0;
+    json["p50"] = hist.p50;
+    json["p95"] = hist.p95;
+    json["p99"] = hist.p99;
+    json["max"] = hist.max;
+    return json;
+}
+
+crow::json::wvalue latencyToJson(const LatencyStats& stats)
+{
+    std::vector<crow::json::wvalue> series_list;
+    for (const auto& series : stats.snapshot())
+    {
+        crow::json::wvalue entry;
+        entry["model"] = series.model;
+        entry["endpoint"] = series.endpoint;
+        entry["queue_wait_ms"] = histogramToJson(series.queue_wait_ms);
+        entry["duration_ms"] = histogramToJson(series.duration_ms);
+        entry["ttft_ms"] = histogramToJson(series.ttft_ms);
+        entry["prompt_eval_ms"] = histogramToJson(series.prompt_eval_ms);
+        entry["tokens_per_sec"] = histogramToJson(series.tokens_per_sec);
+        series_list.push_back(std::move(entry));
+    }
+    return crow::json::wvalue(std::move(series_list));
+}
+
+crow::json::wvalue logToJson(const LogEntry& log, bool include_bodies)
+{
+    crow::json::wvalue entry;
+    entry["id"] = log.id;
+    entry["timestamp"] = log.timestamp;
+    entry["method"] = log.method;
+    entry["endpoint"] = log.endpoint;
+    entry["model"] = log.model;
+    entry["response_status"] = log.response_status;
+    entry["duration_ms"] = log.duration_ms;
+    entry["prompt_tokens"] = log.prompt_tokens;
+    entry["completion_tokens"] = log.completion_tokens;
+    entry["prompt_eval_duration_ms"] = log.prompt_eval_duration_ms;
+    entry["eval_duration_ms"] = log.eval_duration_ms;
+    entry["ttft_ms"] = log.ttft_ms;
+    entry["queue_wait_ms"] = log.queue_wait_ms;
+    entry["request_size"] = log.request_size;
+    entry["response_size"] = log.response_size;
+    if (include_bodies)
+    {
+        entry["request_body"] = log.request_body;
+        entry["response_body"] = log.response_body;
+    }
+    entry["is_starred"] = log.is_starred;
+    entry["cache_hit"] = log.cache_hit;
+    entry["backend"] = log.backend;
+    entry["capture"] = logCaptureName(log.capture);
+    return entry;
+}
+
+crow::json::wvalue logListToJson(const std::vector<LogEntry>& logs)
+{
+    std::vector<crow::json::wvalue> log_list;
+    log_list.reserve(logs.size());
+    for (const auto& log : logs)
+    {
+        log_list.push_back(logToJson(log, false));
+    }
+    return crow::json::wvalue(std::move(log_list));
+}
+
+crow::json::wvalue traceToJson(int id, const std::vector<TraceSpan>& spans)
+{
+    std::vector<crow::json::wvalue> events;
+
+    crow::json::wvalue thread_name;
+    thread_name["name"] = "thread_name";
+    thread_name["ph"] = "M";
+    thread_name["pid"] = 1;
+    thread_name["tid"] = id;
+    thread_name["args"]["name"] = "request " + std::to_string(id);
+    events.push_back(std::move(thread_name));
+
+    uint64_t proxy_overhead_us = 0;
+    for (const auto& span : spans)
+    {
+        crow::json::wvalue event;
+        event["name"] = tracePhaseName(span.phase);
+        event["cat"] = "sectorflux";
+        event["ph"] = "X";
+        event["ts"] = span.start_us;
+        event["dur"] = span.duration_us;
+        event["pid"] = 1;
+        event["tid"] = id;
+        events.push_back(std::move(event));
+
+        if (isProxyPhase(span.phase))
+        {
+            proxy_overhead_us += span.duration_us;
+        }
+    }
+
+    crow::json::wvalue trace;
+    trace["traceEvents"] = std::move(events);
+    trace["displayTimeUnit"] = "ms";
+    trace["otherData"]["log_id"] = id;
+    trace["otherData"]["proxy_overhead_us"] = proxy_overhead_us;
+    return trace;
+}
+
+crow::json::wvalue timeseriesToJson(const std::vector<RollupPoint>& points,
+                                    RollupResolution resolution)
+{
+    const double width_sec = static_cast<double>(resolution);
+    std::vector<crow::json::wvalue> series_list;
+    std::vector<crow::json::wvalue> series_points;
+    for (size_t i = 0; i < points.size(); ++i)
+    {
+        const auto& point = points[i];
+        const auto& totals = point.totals;
+        crow::json::wvalue entry;
+        entry["timestamp"] = point.bucket_start;
+        entry["requests"] = totals.requests;
+        entry["requests_per_sec"] = static_cast<double>(totals.requests) / width_sec;
+        entry["tokens_per_sec"] = static_cast<double>(totals.completion_tokens) / width_sec;
+        entry["prompt_tokens"] = totals.prompt_tokens;
+        entry["completion_tokens"] = totals.completion_tokens;
+        entry["avg_duration_ms"] =
+            totals.requests > 0 ? static_cast<double>(totals.duration_ms) /
+                                      static_cast<double>(totals.requests)
+                                : 0.0;
+        entry["ttft_p95_ms"] = totals.ttft_ms.percentile(0.95);
+        entry["cache_hits"] = totals.cache_hits;
+        entry["cache_hit_rate"] =
+            totals.requests > 0 ? static_cast<double>(totals.cache_hits) /
+                                      static_cast<double>(totals.requests)
+                                : 0.0;
+        entry["errors"] = totals.errors;
+        series_points.push_back(std::move(entry));
+
+        // Points arrive ordered by model, so a series ends where the model changes
+        if (i + 1 == points.size() || points[i + 1].model != point.model)
+        {
+            crow::json::wvalue series;
+            series["model"] = point.model;
+            series["points"] = std::move(series_points);
+            series_list.push_back(std::move(series));
+            series_points.clear();
+        }
+    }
+    return crow::json::wvalue(std::move(series_list));
+}
+
+crow::json::wvalue runtimeConfigToJson(const RuntimeConfig& config)
+{
+    auto settings = config.current();
+    crow::json::wvalue json;
+    std::vector<crow::json::wvalue> restart_only;
+    for (const auto& field : RuntimeConfig::fields())
+    {
+        if (field.text != nullptr)
+        {
+            json["settings"][field.name] = settings.get()->*field.text;
+        }
+        else if (field.flag != nullptr)
+        {
+            json["settings"][field.name] = settings.get()->*field.flag;
+        }
+        else
+        {
+            json["settings"][field.name] = settings.get()->*field.number;
+        }
+        if (field.restart)
+        {
+            restart_only.emplace_back(std::string(field.name));
+        }
+    }
+
+    std::vector<crow::json::wvalue> pending_restart;
+    for (auto& name : config.pendingRestart())
+    {
+        pending_restart.emplace_back(std::move(name));
+    }
+
+    json["version"] = config.version();
+    json["path"] = config.path();
+    json["restart_only"] = std::move(restart_only);
+    json["pending_restart"] = std::move(pending_restart);
+    return json;
+}
+
+} // namespace sectorflux
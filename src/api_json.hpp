@@ -0,0 +1,69 @@
+/*
+ * SectorFlux - LLM Proxy and Analytics
+ * Copyright (c) 2025 ParticleSector.com
+ *
+ * This software is dual-licensed:
+ * - GPL-3.0 for open source use
+ * - Commercial license for proprietary use
+ *
+ * See LICENSE and LICENSING.md for details.
+ */
+
+#pragma once
+
+#include "database.hpp"
+#include "latency_histogram.hpp"
+#include "metric_rollups.hpp"
+#include "runtime_config.hpp"
+#include "trace.hpp"
+
+#include <crow.h>
+
+#include <vector>
+
+namespace sectorflux
+{
+
+/**
+ * @brief Serialize a histogram summary as {count, mean, p50, p95, p99, max}.
+ */
+[[nodiscard]] crow::json::wvalue histogramToJson(const HistogramSnapshot& hist);
+
+/**
+ * @brief Serialize the per-model, per-endpoint latency histograms.
+ */
+[[nodiscard]] crow::json::wvalue latencyToJson(const LatencyStats& stats);
+
+/**
+ * @brief Serialize a log entry; bodies are only included when requested.
+ */
+[[nodiscard]] crow::json::wvalue logToJson(const LogEntry& log, bool include_bodies);
+
+/**
+ * @brief Serialize log summaries (without bodies) as a JSON array.
+ *
+ * Used for /api/logs pages and for every dashboard snapshot and delta.
+ */
+[[nodiscard]] crow::json::wvalue logListToJson(const std::vector<LogEntry>& logs);
+
+/**
+ * @brief Render a request's spans in the Chrome trace event format.
+ *
+ * Loads in chrome://tracing or Perfetto; otherData carries the total time
+ * spent in SectorFlux itself.
+ */
+[[nodiscard]] crow::json::wvalue traceToJson(int id, const std::vector<TraceSpan>& spans);
+
+/**
+ * @brief Serialize rollup buckets as one series of points per model.
+ */
+[[nodiscard]] crow::json::wvalue timeseriesToJson(const std::vector<RollupPoint>& points,
+                                                  RollupResolution resolution);
+
+/**
+ * @brief Serialize the current runtime settings with the file they persist
+ *        to and the restart-only fields that changed since startup.
+ */
+[[nodiscard]] crow::json::wvalue runtimeConfigToJson(const RuntimeConfig& config);
+
+} // namespace sectorflux
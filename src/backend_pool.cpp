@@ -0,0 +1,265 @@
+/*
+ * SectorFlux - LLM Proxy and Analytics
+ * Copyright (c) 2025 ParticleSector.com
+ *
+ * This software is dual-licensed:
+ * - GPL-3.0 for open source use
+ * - Commercial license for proprietary use
+ *
+ * See LICENSE and LICENSING.md for details.
+ */
+
+#include "backend_pool.hpp"
+
+#include <crow.h>
+
+#include <algorithm>
+#include <chrono>
+#include <tuple>
+
+namespace sectorflux
+{
+
+BackendPool::Assignment::Assignment(Backend* backend) : backend_(backend)
+{
+    if (backend_)
+    {
+        backend_->outstanding.fetch_add(1, std::memory_order_relaxed);
+        backend_->requests.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+BackendPool::Assignment::~Assignment()
+{
+    if (backend_)
+    {
+        backend_->outstanding.fetch_sub(1, std::memory_order_relaxed);
+    }
+}
+
+BackendPool::BackendPool(std::vector<std::string> hosts, UpstreamPool& upstream_pool)
+    : upstream_pool_(upstream_pool)
+{
+    backends_.reserve(hosts.size());
+    for (auto& host : hosts)
+    {
+        backends_.push_back(std::make_unique<Backend>(std::move(host)));
+    }
+
+    probe_worker_ = std::jthread([this](std::stop_token stop_token)
+    {
+        probeLoop(stop_token);
+    });
+}
+
+BackendPool::~BackendPool()
+{
+    // Stop the prober before backends_ is torn down
+    probe_worker_.request_stop();
+    probe_cv_.notify_all();
+    if (probe_worker_.joinable())
+    {
+        probe_worker_.join();
+    }
+}
+
+std::string BackendPool::canonicalModel(std::string_view model)
+{
+    std::string name(model);
+    if (!name.empty() && name.find(':') == std::string::npos)
+    {
+        name += ":latest";
+    }
+    return name;
+}
+
+std::vector<std::string> BackendPool::rank(const std::string& model,
+                                           const std::string& affinity) const
+{
+    const std::string wanted = canonicalModel(model);
+
+    struct Candidate
+    {
+        bool down;
+        bool elsewhere;
+        bool cold;
+        size_t outstanding;
+        size_t index;
+    };
+    std::vector<Candidate> candidates;
+    candidates.reserve(backends_.size());
+    for (size_t i = 0; i < backends_.size(); ++i)
+    {
+        const auto& backend = *backends_[i];
+        bool loaded = false;
+        if (!wanted.empty())
+        {
+            std::lock_guard<std::mutex> lock(backend.models_mutex);
+            loaded = std::find(backend.loaded_models.begin(), backend.loaded_models.end(),
+                               wanted) != backend.loaded_models.end();
+        }
+        candidates.push_back(Candidate{
+            .down = !backend.healthy.load(std::memory_order_relaxed),
+            .elsewhere = !affinity.empty() && backend.host != affinity,
+            .cold = !loaded,
+            .outstanding = backend.outstanding.load(std::memory_order_relaxed),
+            .index = i});
+    }
+
+    // Ties keep configuration order, so the first host is the default
+    std::sort(candidates.begin(), candidates.end(), [](const Candidate& a, const Candidate& b)
+    {
+        return std::tie(a.down, a.elsewhere, a.cold, a.outstanding, a.index) <
+               std::tie(b.down, b.elsewhere, b.cold, b.outstanding, b.index);
+    });
+
+    std::vector<std::string> hosts;
+    hosts.reserve(candidates.size());
+    for (const auto& candidate : candidates)
+    {
+        hosts.push_back(backends_[candidate.index]->host);
+    }
+    return hosts;
+}
+
+std::string BackendPool::primary() const
+{
+    for (const auto& backend : backends_)
+    {
+        if (backend->healthy.load(std::memory_order_relaxed))
+        {
+            return backend->host;
+        }
+    }
+    return backends_.front()->host;
+}
+
+bool BackendPool::isHealthy(const std::string& host) const
+{
+    const Backend* backend = find(host);
+    return backend != nullptr && backend->healthy.load(std::memory_order_relaxed);
+}
+
+BackendPool::Assignment BackendPool::assign(const std::string& host)
+{
+    return Assignment(find(host));
+}
+
+void BackendPool::reportSuccess(const std::string& host, const std::string& model)
+{
+    Backend* backend = find(host);
+    if (!backend)
+    {
+        return;
+    }
+    backend->healthy = true;
+
+    // Ollama loads the model to answer, so route its followers here until the next probe
+    std::string name = canonicalModel(model);
+    if (name.empty())
+    {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(backend->models_mutex);
+    if (std::find(backend->loaded_models.begin(), backend->loaded_models.end(), name) ==
+        backend->loaded_models.end())
+    {
+        backend->loaded_models.push_back(std::move(name));
+    }
+}
+
+void BackendPool::reportFailure(const std::string& host)
+{
+    Backend* backend = find(host);
+    if (backend)
+    {
+        backend->healthy = false;
+        backend->failures.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+std::vector<BackendStatus> BackendPool::status() const
+{
+    std::vector<BackendStatus> result;
+    result.reserve(backends_.size());
+    for (const auto& backend : backends_)
+    {
+        std::lock_guard<std::mutex> lock(backend->models_mutex);
+        result.push_back(BackendStatus{
+            .host = backend->host,
+            .loaded_models = backend->loaded_models,
+            .healthy = backend->healthy.load(std::memory_order_relaxed),
+            .outstanding = backend->outstanding.load(std::memory_order_relaxed),
+            .requests = backend->requests.load(std::memory_order_relaxed),
+            .failures = backend->failures.load(std::memory_order_relaxed)});
+    }
+    return result;
+}
+
+BackendPool::Backend* BackendPool::find(const std::string& host) const
+{
+    // A handful of hosts; a linear scan beats hashing the URL
+    for (const auto& backend : backends_)
+    {
+        if (backend->host == host)
+        {
+            return backend.get();
+        }
+    }
+    return nullptr;
+}
+
+void BackendPool::probe(Backend& backend)
+{
+    auto lease = upstream_pool_.acquire(backend.host, kProbeTimeoutSec);
+    auto res = lease->Get("/api/ps");
+    if (!res || res->status != 200)
+    {
+        if (!res)
+        {
+            lease.invalidate();
+        }
+        backend.healthy = false;
+        return;
+    }
+
+    std::vector<std::string> models;
+    auto json = crow::json::load(res->body);
+    if (json && json.has("models") && json["models"].t() == crow::json::type::List)
+    {
+        for (const auto& entry : json["models"])
+        {
+            if (entry.has("name"))
+            {
+                models.push_back(canonicalModel(std::string(entry["name"].s())));
+            }
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(backend.models_mutex);
+        backend.loaded_models = std::move(models);
+    }
+    backend.healthy = true;
+}
+
+void BackendPool::probeLoop(std::stop_token stop_token)
+{
+    while (!stop_token.stop_requested())
+    {
+        for (const auto& backend : backends_)
+        {
+            if (stop_token.stop_requested())
+            {
+                return;
+            }
+            probe(*backend);
+        }
+
+        std::unique_lock<std::mutex> lock(probe_mutex_);
+        probe_cv_.wait_for(lock, stop_token, std::chrono::seconds(kProbeIntervalSec),
+                           [] { return false; });
+    }
+}
+
+}  // namespace sectorflux
@@ -0,0 +1,168 @@
+/*
+ * SectorFlux - LLM Proxy and Analytics
+ * Copyright (c) 2025 ParticleSector.com
+ *
+ * This software is dual-licensed:
+ * - GPL-3.0 for open source use
+ * - Commercial license for proprietary use
+ *
+ * See LICENSE and LICENSING.md for details.
+ */
+
+#pragma once
+
+#include "upstream_pool.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <stop_token>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace sectorflux
+{
+
+/**
+ * @brief Point-in-time view of one Ollama backend.
+ */
+struct BackendStatus
+{
+    std::string host;
+    std::vector<std::string> loaded_models;
+    bool healthy = true;
+    size_t outstanding = 0;
+    uint64_t requests = 0;
+    uint64_t failures = 0;
+};
+
+/**
+ * @brief The set of Ollama hosts requests are balanced across.
+ *
+ * A background thread polls each host's /api/ps, which doubles as the health
+ * check and tells which models are resident in memory. Requests prefer, in
+ * order: healthy hosts, hosts that already have the model loaded (avoiding a
+ * cold load), and hosts with the fewest outstanding requests. A host that
+ * fails a request is treated as down until it answers a probe again.
+ */
+class BackendPool
+{
+    struct Backend;
+
+public:
+    /**
+     * @brief Counts one request against a backend's outstanding load while alive.
+     */
+    class Assignment
+    {
+    public:
+        Assignment(const Assignment&) = delete;
+        Assignment& operator=(const Assignment&) = delete;
+        ~Assignment();
+
+    private:
+        friend class BackendPool;
+
+        explicit Assignment(Backend* backend);
+
+        Backend* backend_;
+    };
+
+    /**
+     * @brief Construct a pool and start probing.
+     * @param hosts Backend URLs; must not be empty.
+     * @param upstream_pool Connection pool used for the probes.
+     */
+    BackendPool(std::vector<std::string> hosts, UpstreamPool& upstream_pool);
+    ~BackendPool();
+
+    BackendPool(const BackendPool&) = delete;
+    BackendPool& operator=(const BackendPool&) = delete;
+
+    /**
+     * @brief Order the backends by preference for a model.
+     * @param model The requested model (empty for model-independent calls).
+     * @param affinity A host to prefer while it is healthy, e.g. one whose KV
+     *        cache holds the conversation (empty for none).
+     * @return std::vector<std::string> Every backend, most preferred first.
+     */
+    [[nodiscard]] std::vector<std::string> rank(const std::string& model,
+                                                const std::string& affinity = {}) const;
+
+    /**
+     * @brief Get the host for model-independent calls (e.g. /api/tags).
+     * @return std::string The first healthy backend, or the first one if all are down.
+     */
+    [[nodiscard]] std::string primary() const;
+
+    /**
+     * @brief Check whether a backend answered its last probe and request.
+     * @param host A URL returned by rank().
+     */
+    [[nodiscard]] bool isHealthy(const std::string& host) const;
+
+    /**
+     * @brief Start counting a request against a backend.
+     * @param host A URL returned by rank().
+     */
+    [[nodiscard]] Assignment assign(const std::string& host);
+
+    /**
+     * @brief Record a successful response; the model is now resident there.
+     */
+    void reportSuccess(const std::string& host, const std::string& model);
+
+    /**
+     * @brief Record a transport failure; the host is skipped until its next good probe.
+     */
+    void reportFailure(const std::string& host);
+
+    /**
+     * @brief Get health, load and resident models of every backend.
+     */
+    [[nodiscard]] std::vector<BackendStatus> status() const;
+
+    /**
+     * @brief Canonical model name: Ollama reports "llama3" as "llama3:latest".
+     */
+    [[nodiscard]] static std::string canonicalModel(std::string_view model);
+
+private:
+    struct Backend
+    {
+        explicit Backend(std::string host) : host(std::move(host))
+        {
+        }
+
+        const std::string host;
+        std::atomic<bool> healthy{true};
+        std::atomic<size_t> outstanding{0};
+        std::atomic<uint64_t> requests{0};
+        std::atomic<uint64_t> failures{0};
+
+        mutable std::mutex models_mutex;
+        std::vector<std::string> loaded_models;  // Canonical names
+    };
+
+    Backend* find(const std::string& host) const;
+    void probe(Backend& backend);
+    void probeLoop(std::stop_token stop_token);
+
+    UpstreamPool& upstream_pool_;
+    std::vector<std::unique_ptr<Backend>> backends_;
+
+    std::mutex probe_mutex_;
+    std::condition_variable_any probe_cv_;
+    std::jthread probe_worker_;
+
+    // Constants
+    static constexpr int kProbeIntervalSec = 5;
+    static constexpr int kProbeTimeoutSec = 2;
+};
+
+}  // namespace sectorflux
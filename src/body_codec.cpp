@@ -0,0 +1,199 @@
+/*
+ * SectorFlux - LLM Proxy and Analytics
+ * Copyright (c) 2025 ParticleSector.com
+ *
+ * This software is dual-licensed:
+ * - GPL-3.0 for open source use
+ * - Commercial license for proprietary use
+ *
+ * See LICENSE and LICENSING.md for details.
+ */
+
+#include "body_codec.hpp"
+
+#include <zdict.h>
+#include <zstd.h>
+
+#include <algorithm>
+#include <iostream>
+#include <mutex>
+
+namespace sectorflux
+{
+
+/**
+ * @brief A trained dictionary, digested once for compression and decompression.
+ */
+struct BodyCodec::Dictionary
+{
+    Dictionary(int64_t id, std::string bytes, int level)
+        : id(id),
+          bytes(std::move(bytes)),
+          cdict(ZSTD_createCDict(this->bytes.data(), this->bytes.size(), level)),
+          ddict(ZSTD_createDDict(this->bytes.data(), this->bytes.size()))
+    {
+    }
+
+    ~Dictionary()
+    {
+        ZSTD_freeCDict(cdict);
+        ZSTD_freeDDict(ddict);
+    }
+
+    Dictionary(const Dictionary&) = delete;
+    Dictionary& operator=(const Dictionary&) = delete;
+
+    const int64_t id;
+    const std::string bytes;
+    ZSTD_CDict* const cdict;
+    ZSTD_DDict* const ddict;
+};
+
+namespace
+{
+
+// One decompression context per reader thread, reused across bodies
+ZSTD_DCtx* threadDecompressionContext()
+{
+    thread_local std::unique_ptr<ZSTD_DCtx, decltype(&ZSTD_freeDCtx)> dctx(
+        ZSTD_createDCtx(), &ZSTD_freeDCtx);
+    return dctx.get();
+}
+
+}  // namespace
+
+BodyCodec::BodyCodec(int level)
+    : level_(level),
+      cctx_(level > 0 ? ZSTD_createCCtx() : nullptr)
+{
+}
+
+BodyCodec::~BodyCodec()
+{
+    ZSTD_freeCCtx(cctx_);
+}
+
+EncodedBody BodyCodec::encode(std::string_view body)
+{
+    EncodedBody encoded;
+    if (!cctx_ || body.size() < kMinCompressBytes)
+    {
+        encoded.data.assign(body);
+        return encoded;
+    }
+
+    std::string compressed;
+    compressed.resize(ZSTD_compressBound(body.size()));
+    size_t size = active_
+        ? ZSTD_compress_usingCDict(cctx_, compressed.data(), compressed.size(), body.data(),
+                                   body.size(), active_->cdict)
+        : ZSTD_compressCCtx(cctx_, compressed.data(), compressed.size(), body.data(),
+                            body.size(), level_);
+
+    if (ZSTD_isError(size) || size >= body.size())
+    {
+        encoded.data.assign(body);
+        return encoded;
+    }
+
+    compressed.resize(size);
+    encoded.encoding = BodyEncoding::Zstd;
+    encoded.dictionary_id = active_ ? active_->id : 0;
+    encoded.data = std::move(compressed);
+    return encoded;
+}
+
+std::optional<std::string> BodyCodec::decode(BodyEncoding encoding,
+                                             int64_t dictionary_id,
+                                             std::string_view data,
+                                             size_t raw_size) const
+{
+    if (encoding == BodyEncoding::Raw)
+    {
+        return std::string(data);
+    }
+    if (encoding != BodyEncoding::Zstd)
+    {
+        return std::nullopt;
+    }
+
+    std::shared_ptr<const Dictionary> dictionary;
+    if (dictionary_id != 0)
+    {
+        std::shared_lock<std::shared_mutex> lock(dictionaries_mutex_);
+        auto it = dictionaries_.find(dictionary_id);
+        if (it == dictionaries_.end())
+        {
+            return std::nullopt;
+        }
+        dictionary = it->second;
+    }
+
+    ZSTD_DCtx* dctx = threadDecompressionContext();
+    std::string body(raw_size, '\0');
+    size_t size = dictionary
+        ? ZSTD_decompress_usingDDict(dctx, body.data(), body.size(), data.data(), data.size(),
+                                     dictionary->ddict)
+        : ZSTD_decompressDCtx(dctx, body.data(), body.size(), data.data(), data.size());
+    if (ZSTD_isError(size) || size != raw_size)
+    {
+        return std::nullopt;
+    }
+    return body;
+}
+
+void BodyCodec::addDictionary(int64_t id, std::string dictionary)
+{
+    auto digested = std::make_shared<const Dictionary>(id, std::move(dictionary),
+                                                       std::max(level_, 1));
+    if (!digested->cdict || !digested->ddict)
+    {
+        std::cerr << "Warning: Ignoring unusable compression dictionary " << id << std::endl;
+        return;
+    }
+
+    std::unique_lock<std::shared_mutex> lock(dictionaries_mutex_);
+    dictionaries_[id] = digested;
+    if (!active_ || id > active_->id)
+    {
+        active_ = std::move(digested);
+    }
+}
+
+bool BodyCodec::addSample(std::string_view body)
+{
+    if (!cctx_ || active_ || training_done_ || body.size() < kMinCompressBytes)
+    {
+        return false;
+    }
+
+    body = body.substr(0, kMaxSampleBytes);
+    samples_.append(body);
+    sample_sizes_.push_back(body.size());
+    return samples_.size() >= kTrainingBytes && sample_sizes_.size() >= kMinTrainingSamples;
+}
+
+std::optional<std::string> BodyCodec::trainDictionary()
+{
+    training_done_ = true;
+
+    std::string dictionary(kDictionaryBytes, '\0');
+    size_t size = ZDICT_trainFromBuffer(dictionary.data(), dictionary.size(), samples_.data(),
+                                        sample_sizes_.data(),
+                                        static_cast<unsigned>(sample_sizes_.size()));
+    samples_.clear();
+    samples_.shrink_to_fit();
+    sample_sizes_.clear();
+    sample_sizes_.shrink_to_fit();
+
+    if (ZDICT_isError(size))
+    {
+        std::cerr << "Warning: Compression dictionary training failed: "
+                  << ZDICT_getErrorName(size) << std::endl;
+        return std::nullopt;
+    }
+    dictionary.resize(size);
+    return dictionary;
+}
+
+}  // namespace sectorflux
@@ -0,0 +1,134 @@
+/*
+ * SectorFlux - LLM Proxy and Analytics
+ * Copyright (c) 2025 ParticleSector.com
+ *
+ * This software is dual-licensed:
+ * - GPL-3.0 for open source use
+ * - Commercial license for proprietary use
+ *
+ * See LICENSE and LICENSING.md for details.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+struct ZSTD_CCtx_s;
+
+namespace sectorflux
+{
+
+/**
+ * @brief How a stored body's bytes are encoded (the `codec` column of `blobs`).
+ */
+enum class BodyEncoding : int
+{
+    Raw = 0,   // Stored as is (small or incompressible bodies)
+    Zstd = 1,  // A zstd frame, optionally against a trained dictionary
+};
+
+/**
+ * @brief A body ready to be written to the `blobs` table.
+ */
+struct EncodedBody
+{
+    BodyEncoding encoding = BodyEncoding::Raw;
+    int64_t dictionary_id = 0;  // 0 if no dictionary was used
+    std::string data;
+};
+
+/**
+ * @brief zstd compression of logged bodies with a dictionary trained on live traffic.
+ *
+ * NDJSON token streams repeat the same keys and framing on every line, so a
+ * dictionary trained on the first bodies seen compresses later ones far
+ * better than plain zstd. Dictionaries are persisted by the caller and never
+ * change once added, so anything they encoded stays decodable.
+ *
+ * encode() and the training methods belong to the writer thread; decode()
+ * may run on any thread.
+ */
+class BodyCodec
+{
+public:
+    /**
+     * @brief Construct a new Body Codec object.
+     * @param level zstd compression level; 0 stores every body raw.
+     */
+    explicit BodyCodec(int level);
+    ~BodyCodec();
+
+    // Delete copy operations
+    BodyCodec(const BodyCodec&) = delete;
+    BodyCodec& operator=(const BodyCodec&) = delete;
+
+    /**
+     * @brief Compress a body with the newest dictionary, if any.
+     * @param body The raw bytes.
+     * @return EncodedBody Raw when compression would not save space.
+     */
+    [[nodiscard]] EncodedBody encode(std::string_view body);
+
+    /**
+     * @brief Restore a stored body.
+     * @param encoding The stored codec.
+     * @param dictionary_id The stored dictionary id (0 for none).
+     * @param data The stored bytes.
+     * @param raw_size The original size.
+     * @return std::optional<std::string> The body, or nullopt if it cannot be decoded.
+     */
+    [[nodiscard]] std::optional<std::string> decode(BodyEncoding encoding,
+                                                    int64_t dictionary_id,
+                                                    std::string_view data,
+                                                    size_t raw_size) const;
+
+    /**
+     * @brief Register a persisted dictionary; the highest id encodes new bodies.
+     */
+    void addDictionary(int64_t id, std::string dictionary);
+
+    /**
+     * @brief Offer a body as a training sample while no dictionary exists.
+     * @return bool True once enough samples were collected to train.
+     */
+    bool addSample(std::string_view body);
+
+    /**
+     * @brief Train a dictionary from the collected samples and drop them.
+     * @return std::optional<std::string> The dictionary bytes, or nullopt if
+     *         training failed (no further attempts are made).
+     */
+    [[nodiscard]] std::optional<std::string> trainDictionary();
+
+private:
+    struct Dictionary;
+
+    const int level_;
+    ZSTD_CCtx_s* cctx_ = nullptr;
+
+    mutable std::shared_mutex dictionaries_mutex_;
+    std::unordered_map<int64_t, std::shared_ptr<const Dictionary>> dictionaries_;
+    std::shared_ptr<const Dictionary> active_;  // Writer thread only
+
+    // Training state (writer thread only)
+    std::string samples_;
+    std::vector<size_t> sample_sizes_;
+    bool training_done_ = false;
+
+    // Constants
+    static constexpr size_t kMinCompressBytes = 128;
+    static constexpr size_t kMaxSampleBytes = 16 * 1024;
+    static constexpr size_t kTrainingBytes = 1024 * 1024;
+    static constexpr size_t kMinTrainingSamples = 64;
+    static constexpr size_t kDictionaryBytes = 16 * 1024;
+};
+
+}  // namespace sectorflux
@@ -0,0 +1,160 @@
+/*
+ * SectorFlux - LLM Proxy and Analytics
+ * Copyright (c) 2025 ParticleSector.com
+ *
+ * This software is dual-licensed:
+ * - GPL-3.0 for open source use
+ * - Commercial license for proprietary use
+ *
+ * See LICENSE and LICENSING.md for details.
+ */
+
+#include "cache_key.hpp"
+
+#include <cstring>
+
+namespace sectorflux
+{
+
+namespace
+{
+
+constexpr uint64_t kC1 = 0x87c37b91114253d5ULL;
+constexpr uint64_t kC2 = 0x4cf5ad432745937fULL;
+
+inline uint64_t rotl64(uint64_t x, int r)
+{
+    return (x << r) | (x >> (64 - r));
+}
+
+inline uint64_t fmix64(uint64_t k)
+{
+    k ^= k >> 33;
+    k *= 0xff51afd7ed558ccdULL;
+    k ^= k >> 33;
+    k *= 0xc4ceb9fe1a85ec53ULL;
+    k ^= k >> 33;
+    return k;
+}
+
+inline uint64_t loadBlock(const unsigned char* p)
+{
+    uint64_t value;
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+}  // namespace
+
+std::array<unsigned char, 16> CacheKey::toBytes() const
+{
+    std::array<unsigned char, 16> bytes{};
+    for (int i = 0; i < 8; ++i)
+    {
+        bytes[i] = static_cast<unsigned char>(high >> (56 - 8 * i));
+        bytes[8 + i] = static_cast<unsigned char>(low >> (56 - 8 * i));
+    }
+    return bytes;
+}
+
+std::string CacheKey::toHex() const
+{
+    static constexpr char kDigits[] = "0123456789abcdef";
+    std::string hex;
+    hex.reserve(32);
+    for (unsigned char byte : toBytes())
+    {
+        hex.push_back(kDigits[byte >> 4]);
+        hex.push_back(kDigits[byte & 0x0f]);
+    }
+    return hex;
+}
+
+CacheKey hash128(std::string_view data, uint64_t seed)
+{
+    const auto* bytes = reinterpret_cast<const unsigned char*>(data.data());
+    const size_t len = data.size();
+    const size_t nblocks = len / 16;
+
+    uint64_t h1 = seed;
+    uint64_t h2 = seed;
+
+    for (size_t i = 0; i < nblocks; ++i)
+    {
+        uint64_t k1 = loadBlock(bytes + i * 16);
+        uint64_t k2 = loadBlock(bytes + i * 16 + 8);
+
+        k1 *= kC1;
+        k1 = rotl64(k1, 31);
+        k1 *= kC2;
+        h1 ^= k1;
+        h1 = rotl64(h1, 27);
+        h1 += h2;
+        h1 = h1 * 5 + 0x52dce729;
+
+        k2 *= kC2;
+        k2 = rotl64(k2, 33);
+        k2 *= kC1;
+        h2 ^= k2;
+        h2 = rotl64(h2, 31);
+        h2 += h1;
+        h2 = h2 * 5 + 0x38495ab5;
+    }
+
+    const unsigned char* tail = bytes + nblocks * 16;
+    uint64_t k1 = 0;
+    uint64_t k2 = 0;
+
+    switch (len & 15)
+    {
+        case 15: k2 ^= static_cast<uint64_t>(tail[14]) << 48; [[fallthrough]];
+        case 14: k2 ^= static_cast<uint64_t>(tail[13]) << 40; [[fallthrough]];
+        case 13: k2 ^= static_cast<uint64_t>(tail[12]) << 32; [[fallthrough]];
+        case 12: k2 ^= static_cast<uint64_t>(tail[11]) << 24; [[fallthrough]];
+        case 11: k2 ^= static_cast<uint64_t>(tail[10]) << 16; [[fallthrough]];
+        case 10: k2 ^= static_cast<uint64_t>(tail[9]) << 8; [[fallthrough]];
+        case 9:
+            k2 ^= static_cast<uint64_t>(tail[8]);
+            k2 *= kC2;
+            k2 = rotl64(k2, 33);
+            k2 *= kC1;
+            h2 ^= k2;
+            [[fallthrough]];
+        case 8: k1 ^= static_cast<uint64_t>(tail[7]) << 56; [[fallthrough]];
+        case 7: k1 ^= static_cast<uint64_t>(tail[6]) << 48; [[fallthrough]];
+        case 6: k1 ^= static_cast<uint64_t>(tail[5]) << 40; [[fallthrough]];
+        case 5: k1 ^= static_cast<uint64_t>(tail[4]) << 32; [[fallthrough]];
+        case 4: k1 ^= static_cast<uint64_t>(tail[3]) << 24; [[fallthrough]];
+        case 3: k1 ^= static_cast<uint64_t>(tail[2]) << 16; [[fallthrough]];
+        case 2: k1 ^= static_cast<uint64_t>(tail[1]) << 8; [[fallthrough]];
+        case 1:
+            k1 ^= static_cast<uint64_t>(tail[0]);
+            k1 *= kC1;
+            k1 = rotl64(k1, 31);
+            k1 *= kC2;
+            h1 ^= k1;
+            break;
+        default:
+            break;
+    }
+
+    h1 ^= len;
+    h2 ^= len;
+    h1 += h2;
+    h2 += h1;
+    h1 = fmix64(h1);
+    h2 = fmix64(h2);
+    h1 += h2;
+    h2 += h1;
+
+    return {h1, h2};
+}
+
+CacheKey makeCacheKey(std::string_view endpoint, std::string_view request_body)
+{
+    // Seeding with the endpoint digest keeps identical bodies sent to
+    // different endpoints apart without concatenating the strings
+    return hash128(request_body, hash128(endpoint).low);
+}
+
+} // namespace sectorflux
@@ -0,0 +1,76 @@
+/*
+ * SectorFlux - LLM Proxy and Analytics
+ * Copyright (c) 2025 ParticleSector.com
+ *
+ * This software is dual-licensed:
+ * - GPL-3.0 for open source use
+ * - Commercial license for proprietary use
+ *
+ * See LICENSE and LICENSING.md for details.
+ */
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace sectorflux
+{
+
+/**
+ * @brief 128-bit identifier of a cacheable request.
+ *
+ * Fixed-size keys keep cache lookups independent of prompt length, both in
+ * the in-memory tier and in the SQLite index.
+ */
+struct CacheKey
+{
+    uint64_t high = 0;
+    uint64_t low = 0;
+
+    bool operator==(const CacheKey& other) const = default;
+
+    /**
+     * @brief Serialize the key as 16 big-endian bytes (for BLOB storage).
+     * @return std::array<unsigned char, 16> The key bytes.
+     */
+    [[nodiscard]] std::array<unsigned char, 16> toBytes() const;
+
+    /**
+     * @brief Render the key as 32 lowercase hex digits.
+     * @return std::string The hex representation.
+     */
+    [[nodiscard]] std::string toHex() const;
+};
+
+/**
+ * @brief Hash functor so CacheKey can key unordered containers.
+ */
+struct CacheKeyHash
+{
+    size_t operator()(const CacheKey& key) const noexcept
+    {
+        return static_cast<size_t>(key.low ^ (key.high * 0x9e3779b97f4a7c15ULL));
+    }
+};
+
+/**
+ * @brief Compute a 128-bit MurmurHash3 (x64 variant) of a byte string.
+ * @param data The bytes to hash.
+ * @param seed Seed mixed into both hash lanes.
+ * @return CacheKey The 128-bit digest.
+ */
+[[nodiscard]] CacheKey hash128(std::string_view data, uint64_t seed = 0);
+
+/**
+ * @brief Build the cache key for a request.
+ * @param endpoint The Ollama endpoint (e.g. "/api/chat").
+ * @param request_body The request body the key is derived from.
+ * @return CacheKey Key unique to the endpoint/body pair.
+ */
+[[nodiscard]] CacheKey makeCacheKey(std::string_view endpoint, std::string_view request_body);
+
+} // namespace sectorflux
@@ -0,0 +1,265 @@
+/*
+ * SectorFlux - LLM Proxy and Analytics
+ * Copyright (c) 2025 ParticleSector.com
+ *
+ * This software is dual-licensed:
+ * - GPL-3.0 for open source use
+ * - Commercial license for proprietary use
+ *
+ * See LICENSE and LICENSING.md for details.
+ */
+
+#include "capture_policy.hpp"
+
+#include <charconv>
+#include <utility>
+
+namespace sectorflux
+{
+
+namespace
+{
+
+constexpr uint64_t kMaxTruncateKb = 1 << 20;
+constexpr uint64_t kMaxSampleEvery = 1 << 30;
+
+std::string_view trim(std::string_view text)
+{
+    const auto first = text.find_first_not_of(" \t");
+    if (first == std::string_view::npos)
+    {
+        return {};
+    }
+    const auto last = text.find_last_not_of(" \t");
+    return text.substr(first, last - first + 1);
+}
+
+/**
+ * @brief Parse the argument of a `mode:N` rule.
+ * @return std::optional<uint64_t> N if it is a whole number in [1, max_value].
+ */
+std::optional<uint64_t> parseArgument(std::string_view mode, std::string_view prefix,
+                                      uint64_t max_value)
+{
+    const std::string_view digits = mode.substr(prefix.size());
+    uint64_t value = 0;
+    auto [end, ec] = std::from_chars(digits.data(), digits.data() + digits.size(), value);
+    if (ec != std::errc() || end != digits.data() + digits.size() || value == 0 ||
+        value > max_value)
+    {
+        return std::nullopt;
+    }
+    return value;
+}
+
+bool isContinuationByte(char c)
+{
+    return (static_cast<unsigned char>(c) & 0xC0) == 0x80;
+}
+
+/**
+ * @brief Keep the first and last keep_bytes of a body, marking the cut.
+ *
+ * Cuts move to UTF-8 character boundaries so the kept text stays valid.
+ */
+std::string truncateBody(std::string_view body, size_t keep_bytes)
+{
+    if (body.size() <= 2 * keep_bytes)
+    {
+        return std::string(body);
+    }
+
+    size_t head = keep_bytes;
+    while (head > 0 && isContinuationByte(body[head]))
+    {
+        --head;
+    }
+    size_t tail = body.size() - keep_bytes;
+    while (tail < body.size() && isContinuationByte(body[tail]))
+    {
+        ++tail;
+    }
+
+    const std::string marker = "\n[" + std::to_string(tail - head) + " bytes omitted]\n";
+    std::string kept;
+    kept.reserve(head + marker.size() + (body.size() - tail));
+    kept.append(body.substr(0, head));
+    kept.append(marker);
+    kept.append(body.substr(tail));
+    return kept;
+}
+
+}  // namespace
+
+std::string CaptureDecision::request(const std::string& body) const
+{
+    switch (capture)
+    {
+        case LogCapture::Full: return body;
+        case LogCapture::Truncated: return truncateBody(body, keep_bytes);
+        case LogCapture::MetricsOnly: return {};
+    }
+    return body;
+}
+
+SharedBody CaptureDecision::response(const SharedBody& body) const
+{
+    if (!body || capture == LogCapture::Full)
+    {
+        return body;
+    }
+    if (capture == LogCapture::MetricsOnly)
+    {
+        return nullptr;
+    }
+    if (body->size() <= 2 * keep_bytes)
+    {
+        return body;
+    }
+    return std::make_shared<const std::string>(truncateBody(*body, keep_bytes));
+}
+
+std::optional<std::string> CapturePolicy::parse(std::string_view spec)
+{
+    rules_.clear();
+    auto invalid = [](std::string_view item, const char* reason)
+    {
+        return "Invalid capture rule '" + std::string(item) + "': " + reason;
+    };
+
+    std::vector<CaptureRule> rules;
+    while (!spec.empty())
+    {
+        const auto comma = spec.find(',');
+        const std::string_view item = trim(spec.substr(0, comma));
+        spec = comma == std::string_view::npos ? std::string_view() : spec.substr(comma + 1);
+        if (item.empty())
+        {
+            continue;
+        }
+
+        const auto equals = item.find('=');
+        if (equals == std::string_view::npos)
+        {
+            return invalid(item, "expected selector=mode");
+        }
+        const std::string_view selector = trim(item.substr(0, equals));
+        const std::string_view mode = trim(item.substr(equals + 1));
+
+        CaptureRule rule;
+        if (selector.empty())
+        {
+            return invalid(item, "empty selector");
+        }
+        if (selector.front() == '/')
+        {
+            rule.endpoint = selector;
+        }
+        else if (selector != "*")
+        {
+            rule.model = selector;
+        }
+
+        if (mode == "full")
+        {
+            rule.mode = CaptureMode::Full;
+        }
+        else if (mode == "metrics")
+        {
+            rule.mode = CaptureMode::MetricsOnly;
+        }
+        else if (mode.starts_with("truncate:"))
+        {
+            auto kilobytes = parseArgument(mode, "truncate:", kMaxTruncateKb);
+            if (!kilobytes)
+            {
+                return invalid(item, "truncate needs a size in KB");
+            }
+            rule.mode = CaptureMode::Truncate;
+            rule.keep_bytes = static_cast<size_t>(*kilobytes) * kBytesPerKilobyte;
+        }
+        else if (mode.starts_with("sample:"))
+        {
+            auto every = parseArgument(mode, "sample:", kMaxSampleEvery);
+            if (!every)
+            {
+                return invalid(item, "sample needs a positive N");
+            }
+            rule.mode = CaptureMode::Sample;
+            rule.sample_every = *every;
+        }
+        else
+        {
+            return invalid(item, "mode must be full, metrics, truncate:KB or sample:N");
+        }
+        rules.push_back(std::move(rule));
+    }
+
+    // Unmatched requests are captured in full anyway, so trailing full rules
+    // are dropped; a policy of only those keeps the capturesAll() fast path
+    while (!rules.empty() && rules.back().mode == CaptureMode::Full)
+    {
+        rules.pop_back();
+    }
+
+    rules_ = std::move(rules);
+    sampled_ = std::make_unique<std::atomic<uint64_t>[]>(rules_.size());
+    return std::nullopt;
+}
+
+std::optional<std::string> CapturePolicy::validate(const std::string& spec)
+{
+    CapturePolicy policy;
+    return policy.parse(spec);
+}
+
+CaptureDecision CapturePolicy::decide(const std::string& endpoint,
+                                      const std::string& model,
+                                      int status,
+                                      size_t body_bytes,
+                                      const std::function<bool()>& always_capture) const
+{
+    if (rules_.empty() || status != 200)
+    {
+        return CaptureDecision{};
+    }
+
+    for (size_t i = 0; i < rules_.size(); ++i)
+    {
+        const CaptureRule& rule = rules_[i];
+        if ((!rule.endpoint.empty() && rule.endpoint != endpoint) ||
+            (!rule.model.empty() && rule.model != model))
+        {
+            continue;
+        }
+
+        switch (rule.mode)
+        {
+            case CaptureMode::Full:
+                return CaptureDecision{};
+            case CaptureMode::MetricsOnly:
+                break;
+            case CaptureMode::Truncate:
+                if (body_bytes <= 2 * rule.keep_bytes || always_capture())
+                {
+                    return CaptureDecision{};
+                }
+                return CaptureDecision{.capture = LogCapture::Truncated,
+                                       .keep_bytes = rule.keep_bytes};
+            case CaptureMode::Sample:
+                if (sampled_[i].fetch_add(1, std::memory_order_relaxed) % rule.sample_every == 0)
+                {
+                    return CaptureDecision{};
+                }
+                break;
+        }
+        if (always_capture())
+        {
+            return CaptureDecision{};
+        }
+        return CaptureDecision{.capture = LogCapture::MetricsOnly};
+    }
+    return CaptureDecision{};
+}
+
+}  // namespace sectorflux
@@ -0,0 +1,136 @@
+/*
+ * SectorFlux - LLM Proxy and Analytics
+ * Copyright (c) 2025 ParticleSector.com
+ *
+ * This software is dual-licensed:
+ * - GPL-3.0 for open source use
+ * - Commercial license for proprietary use
+ *
+ * See LICENSE and LICENSING.md for details.
+ */
+
+#pragma once
+
+#include "log_queue.hpp"
+#include "response_buffer.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace sectorflux
+{
+
+/**
+ * @brief How a capture rule treats the bodies of matching requests.
+ */
+enum class CaptureMode
+{
+    Full,         // Keep both bodies
+    MetricsOnly,  // Keep neither body
+    Truncate,     // Keep the first and last keep_bytes of each body
+    Sample        // Keep both bodies of one request in sample_every, neither otherwise
+};
+
+/**
+ * @brief One rule of a capture policy; a rule with neither selector matches everything.
+ */
+struct CaptureRule
+{
+    std::string endpoint;  // Matches this endpoint when set
+    std::string model;     // Matches this model when set
+    CaptureMode mode = CaptureMode::Full;
+    size_t keep_bytes = 0;      // Truncate only
+    uint64_t sample_every = 1;  // Sample only
+};
+
+/**
+ * @brief The bodies a log record keeps, decided before they are copied.
+ */
+struct CaptureDecision
+{
+    LogCapture capture = LogCapture::Full;
+    size_t keep_bytes = 0;  // From each end of a body, when truncated
+
+    /**
+     * @brief Copy the kept part of a request body.
+     */
+    [[nodiscard]] std::string request(const std::string& body) const;
+
+    /**
+     * @brief Get the kept part of a response body; shares it when kept whole.
+     */
+    [[nodiscard]] SharedBody response(const SharedBody& body) const;
+};
+
+/**
+ * @brief Per-endpoint and per-model rules for how much of each interaction is logged.
+ *
+ * A policy is written as comma-separated `selector=mode` rules, checked in
+ * order, e.g. `/api/embed=metrics,llama3:70b=sample:10,*=truncate:16`. The
+ * selector is an endpoint (starting with '/'), a model name, or `*`. Modes
+ * are `full`, `metrics`, `truncate:KB` and `sample:N`. Requests no rule
+ * matches are captured in full, as are failed requests whatever the rule;
+ * callers add their own always-capture conditions such as slow requests.
+ */
+class CapturePolicy
+{
+public:
+    CapturePolicy() = default;
+
+    CapturePolicy(const CapturePolicy&) = delete;
+    CapturePolicy& operator=(const CapturePolicy&) = delete;
+
+    /**
+     * @brief Replace the rules with a parsed policy string.
+     * @param spec The policy; empty captures everything in full.
+     * @return std::optional<std::string> Error message naming the bad rule
+     *         (the rules are left empty), nullopt on success.
+     */
+    std::optional<std::string> parse(std::string_view spec);
+
+    /**
+     * @brief Check that a policy string parses.
+     * @param spec The policy.
+     * @return std::optional<std::string> Error message, nullopt if valid.
+     */
+    [[nodiscard]] static std::optional<std::string> validate(const std::string& spec);
+
+    /**
+     * @brief Check whether every request is captured in full.
+     */
+    [[nodiscard]] bool capturesAll() const
+    {
+        return rules_.empty();
+    }
+
+    /**
+     * @brief Decide how much of a finished interaction to log.
+     * @param endpoint The Ollama endpoint.
+     * @param model The model name.
+     * @param status The response status; anything but 200 is captured in full.
+     * @param body_bytes Size of the larger of the two bodies.
+     * @param always_capture Called only when a rule would drop or cut bodies;
+     *        true keeps them whole (e.g. for a slow request).
+     * @return CaptureDecision What the log record keeps.
+     */
+    [[nodiscard]] CaptureDecision decide(const std::string& endpoint,
+                                         const std::string& model,
+                                         int status,
+                                         size_t body_bytes,
+                                         const std::function<bool()>& always_capture) const;
+
+private:
+    std::vector<CaptureRule> rules_;
+    std::unique_ptr<std::atomic<uint64_t>[]> sampled_;  // Requests seen per Sample rule
+
+    static constexpr size_t kBytesPerKilobyte = 1024;
+};
+
+}  // namespace sectorflux
@@ -0,0 +1,142 @@
+/*
+ * SectorFlux - LLM Proxy and Analytics
+ * Copyright (c) 2025 ParticleSector.com
+ *
+ * This software is dual-licensed:
+ * - GPL-3.0 for open source use
+ * - Commercial license for proprietary use
+ *
+ * See LICENSE and LICENSING.md for details.
+ */
+
+#include "chat_executor.hpp"
+
+#include <iostream>
+#include <string>
+
+namespace sectorflux
+{
+
+bool ChatSession::send(const char* data, size_t length)
+{
+    std::lock_guard<std::mutex> lock(send_mutex_);
+    if (!active_)
+    {
+        return false;
+    }
+    conn_->send_text(std::string(data, length));
+    return true;
+}
+
+void ChatSession::close()
+{
+    // Taking the send lock waits out any send in progress
+    std::lock_guard<std::mutex> lock(send_mutex_);
+    active_ = false;
+    conn_ = nullptr;
+}
+
+ChatExecutor::ChatExecutor(size_t workers, size_t max_pending_per_session)
+    : max_pending_per_session_(max_pending_per_session)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    startWorkersLocked(workers);
+}
+
+ChatExecutor::~ChatExecutor()
+{
+    for (auto& worker : workers_)
+    {
+        worker.request_stop();
+    }
+    // jthreads join on destruction
+}
+
+bool ChatExecutor::submit(const std::shared_ptr<ChatSession>& session, std::function<void()> task)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!session->active_ || session->pending_.size() >= max_pending_per_session_)
+        {
+            return false;
+        }
+
+        session->pending_.push_back(std::move(task));
+        if (session->scheduled_)
+        {
+            // Already queued or running; the worker picks this up afterwards
+            return true;
+        }
+        session->scheduled_ = true;
+        ready_.push_back(session);
+    }
+    cv_.notify_one();
+    return true;
+}
+
+void ChatExecutor::resize(size_t workers)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        startWorkersLocked(workers);
+    }
+    cv_.notify_all();
+}
+
+void ChatExecutor::startWorkersLocked(size_t workers)
+{
+    limit_ = workers;
+    while (workers_.size() < workers)
+    {
+        workers_.emplace_back([this](std::stop_token stop_token)
+        {
+            workerLoop(stop_token);
+        });
+    }
+}
+
+void ChatExecutor::workerLoop(std::stop_token stop_token)
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (cv_.wait(lock, stop_token, [this]() { return !ready_.empty() && running_ < limit_; }) &&
+           !stop_token.stop_requested())
+    {
+        auto session = std::move(ready_.front());
+        ready_.pop_front();
+        auto task = std::move(session->pending_.front());
+        session->pending_.pop_front();
+        ++running_;
+
+        if (session->active_)
+        {
+            lock.unlock();
+            try
+            {
+                task();
+            }
+            catch (const std::exception& e)
+            {
+                std::cerr << "Chat task failed: " << e.what() << std::endl;
+            }
+            lock.lock();
+        }
+        --running_;
+
+        // Closed sessions drop their backlog; others rejoin the back of the line
+        if (!session->active_)
+        {
+            session->pending_.clear();
+        }
+        if (session->pending_.empty())
+        {
+            session->scheduled_ = false;
+        }
+        else
+        {
+            ready_.push_back(std::move(session));
+            cv_.notify_one();
+        }
+    }
+}
+
+}  // namespace sectorflux
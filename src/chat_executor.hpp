@@ -0,0 +1,136 @@
+/*
+ * SectorFlux - LLM Proxy and Analytics
+ * Copyright (c) 2025 ParticleSector.com
+ *
+ * This software is dual-licensed:
+ * - GPL-3.0 for open source use
+ * - Commercial license for proprietary use
+ *
+ * See LICENSE and LICENSING.md for details.
+ */
+
+#pragma once
+
+#include <crow.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stop_token>
+#include <thread>
+#include <vector>
+
+namespace sectorflux
+{
+
+class ChatExecutor;
+
+/**
+ * @brief One /ws/chat connection: its send path, cancellation flag and work queue.
+ *
+ * Sends go through send(), which stops touching the connection as soon as
+ * close() returns, so workers never write to a socket Crow has torn down.
+ */
+class ChatSession
+{
+public:
+    explicit ChatSession(crow::websocket::connection& conn) : conn_(&conn)
+    {
+    }
+
+    ChatSession(const ChatSession&) = delete;
+    ChatSession& operator=(const ChatSession&) = delete;
+
+    /**
+     * @brief Send a text frame to the client.
+     * @param data Frame bytes.
+     * @param length Frame length.
+     * @return bool False once the session has been closed.
+     */
+    bool send(const char* data, size_t length);
+
+    /**
+     * @brief Cancel queued and running work and detach from the connection.
+     *
+     * Called from Crow's onclose; after it returns the connection is never used.
+     */
+    void close();
+
+    /**
+     * @brief Cancellation flag, cleared by close().
+     */
+    [[nodiscard]] const std::atomic<bool>& active() const
+    {
+        return active_;
+    }
+
+private:
+    friend class ChatExecutor;
+
+    std::mutex send_mutex_;
+    crow::websocket::connection* conn_;
+    std::atomic<bool> active_{true};
+
+    // Guarded by ChatExecutor::mutex_
+    std::deque<std::function<void()>> pending_;
+    bool scheduled_ = false;
+};
+
+/**
+ * @brief Fixed-size worker pool that runs WebSocket chat generations.
+ *
+ * Messages of one session run one at a time, in order. Sessions with queued
+ * work take turns round-robin, so the number of workers bounds how many
+ * generations stream at once, however many playground tabs are open.
+ */
+class ChatExecutor
+{
+public:
+    /**
+     * @brief Start the worker pool.
+     * @param workers Number of worker threads (global concurrency limit).
+     * @param max_pending_per_session Messages a session may queue behind its running one.
+     */
+    ChatExecutor(size_t workers, size_t max_pending_per_session);
+
+    /**
+     * @brief Stop the workers; running tasks finish, queued ones are dropped.
+     */
+    ~ChatExecutor();
+
+    ChatExecutor(const ChatExecutor&) = delete;
+    ChatExecutor& operator=(const ChatExecutor&) = delete;
+
+    /**
+     * @brief Queue a task on a session.
+     * @param session The session the task belongs to.
+     * @param task The work; skipped if the session closes before it starts.
+     * @return bool False if the session is closed or its queue is full.
+     */
+    bool submit(const std::shared_ptr<ChatSession>& session, std::function<void()> task);
+
+    /**
+     * @brief Change the global concurrency limit.
+     * @param workers Number of tasks that may run at once. Threads are started
+     *        as needed; surplus ones park once their running task finishes.
+     */
+    void resize(size_t workers);
+
+private:
+    void startWorkersLocked(size_t workers);
+    void workerLoop(std::stop_token stop_token);
+
+    std::mutex mutex_;
+    std::condition_variable_any cv_;
+    std::deque<std::shared_ptr<ChatSession>> ready_;
+    const size_t max_pending_per_session_;
+    size_t limit_ = 0;
+    size_t running_ = 0;
+    std::vector<std::jthread> workers_;
+};
+
+}  // namespace sectorflux
@@ -0,0 +1,181 @@
+/*
+ * SectorFlux - LLM Proxy and Analytics
+ * Copyright (c) 2025 ParticleSector.com
+ *
+ * This software is dual-licensed:
+ * - GPL-3.0 for open source use
+ * - Commercial license for proprietary use
+ *
+ * See LICENSE and LICENSING.md for details.
+ */
+
+#include "chunk_index.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <thread>
+
+namespace sectorflux
+{
+
+namespace
+{
+
+constexpr size_t kEncodedMarkBytes = 8;
+
+void putU32(std::string& out, uint32_t value)
+{
+    for (int shift = 0; shift < 32; shift += 8)
+    {
+        out += static_cast<char>((value >> shift) & 0xff);
+    }
+}
+
+uint32_t getU32(const char* data)
+{
+    uint32_t value = 0;
+    for (int i = 0; i < 4; ++i)
+    {
+        value |= static_cast<uint32_t>(static_cast<unsigned char>(data[i])) << (8 * i);
+    }
+    return value;
+}
+
+uint32_t clampU32(long long value)
+{
+    return static_cast<uint32_t>(std::clamp<long long>(
+        value, 0, std::numeric_limits<uint32_t>::max()));
+}
+
+}  // namespace
+
+ReplayPacing parseReplayPacing(std::string_view name)
+{
+    return name == "recorded" ? ReplayPacing::Recorded : ReplayPacing::Immediate;
+}
+
+void ChunkRecorder::append(const char* data, size_t length)
+{
+    auto now = std::chrono::steady_clock::now();
+    if (!started_)
+    {
+        started_ = true;
+        first_chunk_ = now;
+    }
+    const uint32_t at_ms = clampU32(
+        std::chrono::duration_cast<std::chrono::milliseconds>(now - first_chunk_).count());
+    last_at_ms_ = at_ms;
+
+    const char* cursor = data;
+    const char* end = data + length;
+    while (const char* newline = static_cast<const char*>(
+               std::memchr(cursor, '\n', static_cast<size_t>(end - cursor))))
+    {
+        marks_.push_back(ChunkMark{
+            .end = clampU32(static_cast<long long>(offset_ + (newline - data) + 1)),
+            .at_ms = at_ms});
+        cursor = newline + 1;
+    }
+    offset_ += length;
+}
+
+ChunkIndex ChunkRecorder::finish(long long ttft_ms)
+{
+    if (offset_ > 0 && (marks_.empty() || marks_.back().end < offset_))
+    {
+        marks_.push_back(ChunkMark{.end = clampU32(static_cast<long long>(offset_)),
+                                   .at_ms = last_at_ms_});
+    }
+    for (auto& mark : marks_)
+    {
+        mark.at_ms = clampU32(mark.at_ms + ttft_ms);
+    }
+    return std::move(marks_);
+}
+
+ChunkIndex indexLines(std::string_view body)
+{
+    ChunkIndex chunks;
+    size_t start = 0;
+    while (start < body.size())
+    {
+        size_t newline = body.find('\n', start);
+        size_t end = newline == std::string_view::npos ? body.size() : newline + 1;
+        chunks.push_back(ChunkMark{.end = clampU32(static_cast<long long>(end)), .at_ms = 0});
+        start = end;
+    }
+    return chunks;
+}
+
+std::string encodeChunkIndex(const ChunkIndex& chunks)
+{
+    std::string out;
+    out.reserve(chunks.size() * kEncodedMarkBytes);
+    for (const auto& mark : chunks)
+    {
+        putU32(out, mark.end);
+        putU32(out, mark.at_ms);
+    }
+    return out;
+}
+
+ChunkIndex decodeChunkIndex(std::string_view blob, size_t body_size)
+{
+    if (blob.size() % kEncodedMarkBytes != 0)
+    {
+        return {};
+    }
+
+    ChunkIndex chunks;
+    chunks.reserve(blob.size() / kEncodedMarkBytes);
+    uint32_t previous_end = 0;
+    for (size_t pos = 0; pos < blob.size(); pos += kEncodedMarkBytes)
+    {
+        ChunkMark mark{.end = getU32(blob.data() + pos), .at_ms = getU32(blob.data() + pos + 4)};
+
+        // Offsets must grow and stay inside the body, or replay would slice out of bounds
+        if (mark.end <= previous_end || mark.end > body_size)
+        {
+            return {};
+        }
+        previous_end = mark.end;
+        chunks.push_back(mark);
+    }
+    return chunks;
+}
+
+bool replayChunks(std::string_view body,
+                  const ChunkIndex& chunks,
+                  ReplayPacing pacing,
+                  const std::function<bool(const char* data, size_t length)>& sink)
+{
+    if (chunks.empty())
+    {
+        return body.empty() || sink(body.data(), body.size());
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    size_t offset = 0;
+    for (const auto& mark : chunks)
+    {
+        if (pacing == ReplayPacing::Recorded)
+        {
+            std::this_thread::sleep_until(start + std::chrono::milliseconds(mark.at_ms));
+        }
+        if (!sink(body.data() + offset, mark.end - offset))
+        {
+            return false;
+        }
+        offset = mark.end;
+    }
+
+    // Bytes past the last mark (an index recorded against a shorter body)
+    if (offset < body.size())
+    {
+        return sink(body.data() + offset, body.size() - offset);
+    }
+    return true;
+}
+
+}  // namespace sectorflux
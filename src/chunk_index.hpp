@@ -0,0 +1,113 @@
+/*
+ * SectorFlux - LLM Proxy and Analytics
+ * Copyright (c) 2025 ParticleSector.com
+ *
+ * This software is dual-licensed:
+ * - GPL-3.0 for open source use
+ * - Commercial license for proprietary use
+ *
+ * See LICENSE and LICENSING.md for details.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace sectorflux
+{
+
+/**
+ * @brief End of one NDJSON line in a response body and when it arrived.
+ */
+struct ChunkMark
+{
+    uint32_t end = 0;    // Offset one past the line's last byte (its '\n')
+    uint32_t at_ms = 0;  // Arrival time since the request was sent upstream
+};
+
+/**
+ * @brief Line boundaries of a cached response, in body order.
+ */
+using ChunkIndex = std::vector<ChunkMark>;
+
+/**
+ * @brief How a cached response is streamed back to the client.
+ */
+enum class ReplayPacing
+{
+    Immediate,  // Line by line, as fast as the client reads
+    Recorded,   // Line by line, at the pace the original generation arrived
+};
+
+/**
+ * @brief Parse an X-SectorFlux-Replay value.
+ * @param name "recorded" for original pacing; anything else is Immediate.
+ */
+[[nodiscard]] ReplayPacing parseReplayPacing(std::string_view name);
+
+/**
+ * @brief Builds a ChunkIndex while a response streams in.
+ */
+class ChunkRecorder
+{
+public:
+    /**
+     * @brief Account for the next received bytes, marking every completed line.
+     */
+    void append(const char* data, size_t length);
+
+    /**
+     * @brief Close a trailing unterminated line and return the index.
+     * @param ttft_ms Time to the first byte; shifts marks to request-relative time.
+     * @return ChunkIndex The recorded line boundaries.
+     */
+    [[nodiscard]] ChunkIndex finish(long long ttft_ms);
+
+private:
+    ChunkIndex marks_;
+    size_t offset_ = 0;
+    uint32_t last_at_ms_ = 0;
+    bool started_ = false;
+    std::chrono::steady_clock::time_point first_chunk_;
+};
+
+/**
+ * @brief Index the lines of a body that was stored without timing.
+ * @param body NDJSON (or a single JSON document).
+ * @return ChunkIndex One mark per line, all at time 0.
+ */
+[[nodiscard]] ChunkIndex indexLines(std::string_view body);
+
+/**
+ * @brief Serialize an index as little-endian (end, at_ms) pairs for BLOB storage.
+ */
+[[nodiscard]] std::string encodeChunkIndex(const ChunkIndex& chunks);
+
+/**
+ * @brief Parse an index written by encodeChunkIndex().
+ * @param blob The stored bytes.
+ * @param body_size Size of the body the index belongs to.
+ * @return ChunkIndex The index, or an empty one if the blob is malformed.
+ */
+[[nodiscard]] ChunkIndex decodeChunkIndex(std::string_view blob, size_t body_size);
+
+/**
+ * @brief Stream a body chunk by chunk as slices of the stored buffer.
+ * @param body The cached response body.
+ * @param chunks Its line index; an empty index sends the body in one piece.
+ * @param pacing Whether to reproduce the recorded inter-chunk delays.
+ * @param sink Receives each slice (pointing into body); false stops the replay.
+ * @return bool False if the sink stopped the replay early.
+ */
+bool replayChunks(std::string_view body,
+                  const ChunkIndex& chunks,
+                  ReplayPacing pacing,
+                  const std::function<bool(const char* data, size_t length)>& sink);
+
+}  // namespace sectorflux
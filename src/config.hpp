@@ -12,7 +12,9 @@
 #pragma once
 
 #include <cstdlib>
+#include <limits>
 #include <string>
+#include <vector>
 
 namespace sectorflux
 {
@@ -43,6 +45,64 @@ inline std::string safeGetenv(const char* name)
 #endif
 }
 
+/**
+ * @brief Read an integer environment variable within a valid range.
+ * @param name Environment variable name.
+ * @param fallback Value returned when unset, malformed or out of range.
+ * @param min_value Smallest accepted value.
+ * @param max_value Largest accepted value.
+ * @return int The parsed value or the fallback.
+ */
+inline int getenvInt(const char* name, int fallback, int min_value, int max_value)
+{
+    std::string env_value = safeGetenv(name);
+    if (!env_value.empty())
+    {
+        try
+        {
+            int value = std::stoi(env_value);
+            if (value >= min_value && value <= max_value)
+            {
+                return value;
+            }
+        }
+        catch (...)
+        {
+            // Invalid value, use fallback
+        }
+    }
+    return fallback;
+}
+
+/**
+ * @brief Read a floating-point environment variable within a range.
+ * @param name Environment variable name.
+ * @param fallback Value returned when unset, malformed or out of range.
+ * @param min_value Smallest accepted value.
+ * @param max_value Largest accepted value.
+ * @return double The parsed value or the fallback.
+ */
+inline double getenvDouble(const char* name, double fallback, double min_value, double max_value)
+{
+    std::string env_value = safeGetenv(name);
+    if (!env_value.empty())
+    {
+        try
+        {
+            double value = std::stod(env_value);
+            if (value >= min_value && value <= max_value)
+            {
+                return value;
+            }
+        }
+        catch (...)
+        {
+            // Invalid value, use fallback
+        }
+    }
+    return fallback;
+}
+
 }  // namespace detail
 
 /**
@@ -67,6 +127,41 @@ public:
         return "http://localhost:11434";
     }
 
+    /**
+     * @brief Get the Ollama backends to balance requests across.
+     *
+     * OLLAMA_HOSTS takes a comma-separated list of URLs; when it is unset
+     * the single OLLAMA_HOST is the only backend.
+     *
+     * @return std::vector<std::string> Backend URLs, at least one.
+     */
+    static std::vector<std::string> getOllamaHosts()
+    {
+        std::vector<std::string> hosts;
+        std::string list = detail::safeGetenv("OLLAMA_HOSTS");
+        size_t start = 0;
+        while (start <= list.size())
+        {
+            size_t end = list.find(',', start);
+            if (end == std::string::npos)
+            {
+                end = list.size();
+            }
+            size_t first = list.find_first_not_of(" \t", start);
+            size_t last = list.find_last_not_of(" \t", end == 0 ? 0 : end - 1);
+            if (first != std::string::npos && first < end && last >= first)
+            {
+                hosts.push_back(list.substr(first, last - first + 1));
+            }
+            start = end + 1;
+        }
+        if (hosts.empty())
+        {
+            hosts.push_back(getOllamaHost());
+        }
+        return hosts;
+    }
+
     /**
      * @brief Get the database file path.
      * @return std::string The database path (default: "sectorflux.db").
@@ -81,6 +176,25 @@ public:
         return "sectorflux.db";
     }
 
+    /**
+     * @brief Get the path of the runtime configuration file.
+     * @return std::string The JSON file overlaid on these defaults; empty when
+     *         SECTORFLUX_CONFIG is unset (default: none).
+     */
+    static std::string getConfigPath()
+    {
+        return detail::safeGetenv("SECTORFLUX_CONFIG");
+    }
+
+    /**
+     * @brief Get the number of HTTP worker threads of the main listener.
+     * @return int Thread count; 0 uses one per hardware thread (default: 0).
+     */
+    static int getHttpThreads()
+    {
+        return detail::getenvInt("SECTORFLUX_HTTP_THREADS", 0, 0, 1024);
+    }
+
     /**
      * @brief Get the SectorFlux listening port.
      * @return int The port number (default: 8888).
@@ -106,10 +220,315 @@ public:
         return kDefaultPort;
     }
 
+    /**
+     * @brief Get the port of the chunked streaming listener.
+     * @return int The port number (default: 8889), or 0 when disabled.
+     */
+    static int getStreamPort()
+    {
+        return detail::getenvInt("SECTORFLUX_STREAM_PORT", kDefaultStreamPort, 0, 65535);
+    }
+
+    /**
+     * @brief Get the number of warm keep-alive connections kept per upstream host.
+     * @return int The pool size (default: 8).
+     */
+    static int getUpstreamPoolSize()
+    {
+        return detail::getenvInt("SECTORFLUX_UPSTREAM_POOL_SIZE", kDefaultUpstreamPoolSize, 1, 1024);
+    }
+
+    /**
+     * @brief Get the byte budget of the in-memory response cache tier.
+     * @return int The budget in megabytes (default: 64).
+     */
+    static int getCacheMemoryMb()
+    {
+        return detail::getenvInt("SECTORFLUX_CACHE_MEMORY_MB", kDefaultCacheMemoryMb, 0, 1 << 20);
+    }
+
+    /**
+     * @brief Get the byte budget of the persisted response cache.
+     * @return int The budget in megabytes; 0 means unbounded (default: 1024).
+     */
+    static int getCacheDiskMb()
+    {
+        return detail::getenvInt("SECTORFLUX_CACHE_DISK_MB", kDefaultCacheDiskMb, 0, 1 << 24);
+    }
+
+    /**
+     * @brief Get how long cached responses live unless a request sets its own TTL.
+     * @return int Seconds; 0 means entries never expire (default: 0).
+     */
+    static int getCacheTtlSec()
+    {
+        return detail::getenvInt("SECTORFLUX_CACHE_TTL_SEC", 0, 0, 1 << 30);
+    }
+
+    /**
+     * @brief Get the largest response body admitted to the cache.
+     * @return int The limit in kilobytes; 0 means no limit (default: 0).
+     */
+    static int getCacheMaxEntryKb()
+    {
+        return detail::getenvInt("SECTORFLUX_CACHE_MAX_ENTRY_KB", 0, 0, 1 << 22);
+    }
+
+    /**
+     * @brief Check whether only deterministic requests are cached.
+     * @return bool True if SECTORFLUX_CACHE_DETERMINISTIC_ONLY is 1, so only
+     *         requests with temperature 0 or a fixed seed are cached (default: off).
+     */
+    static bool getCacheDeterministicOnly()
+    {
+        return detail::getenvInt("SECTORFLUX_CACHE_DETERMINISTIC_ONLY", 0, 0, 1) == 1;
+    }
+
+    /**
+     * @brief Get the byte budget of the async log write queue.
+     * @return int The budget in megabytes (default: 64).
+     */
+    static int getLogQueueMb()
+    {
+        return detail::getenvInt("SECTORFLUX_LOG_QUEUE_MB", kDefaultLogQueueMb, 1, 1 << 20);
+    }
+
+    /**
+     * @brief Get the log queue overflow policy name.
+     * @return std::string One of "block", "drop_oldest", "drop_bodies" (default), "sample".
+     */
+    static std::string getLogQueuePolicy()
+    {
+        std::string env_policy = detail::safeGetenv("SECTORFLUX_LOG_QUEUE_POLICY");
+        if (!env_policy.empty())
+        {
+            return env_policy;
+        }
+        return "drop_bodies";
+    }
+
+    /**
+     * @brief Get the sampling rate used by the "sample" overflow policy.
+     * @return int Keep 1 in this many writes under pressure (default: 10).
+     */
+    static int getLogQueueSampleEvery()
+    {
+        return detail::getenvInt("SECTORFLUX_LOG_QUEUE_SAMPLE", kDefaultLogQueueSampleEvery,
+                                 1, 1000000);
+    }
+
+    /**
+     * @brief Get the number of workers running WebSocket chat sessions.
+     * @return int Maximum concurrent playground generations (default: 4).
+     */
+    static int getChatWorkers()
+    {
+        return detail::getenvInt("SECTORFLUX_CHAT_WORKERS", kDefaultChatWorkers, 1, 256);
+    }
+
+    /**
+     * @brief Get the connection and read timeout of proxied HTTP requests.
+     * @return int Seconds per upstream attempt (default: 60).
+     */
+    static int getUpstreamTimeoutSec()
+    {
+        return detail::getenvInt("SECTORFLUX_UPSTREAM_TIMEOUT_SEC", kDefaultTimeout, 1, 86400);
+    }
+
+    /**
+     * @brief Get the upstream timeout of playground WebSocket generations.
+     * @return int Seconds per upstream attempt (default: 300).
+     */
+    static int getWebSocketTimeoutSec()
+    {
+        return detail::getenvInt("SECTORFLUX_WEBSOCKET_TIMEOUT_SEC", kDefaultWebSocketTimeoutSec,
+                                 1, 86400);
+    }
+
+    /**
+     * @brief Get the maximum number of in-flight upstream requests per model.
+     * @return int The limit; 0 disables it (default: 4).
+     */
+    static int getMaxInflightPerModel()
+    {
+        return detail::getenvInt("SECTORFLUX_MAX_INFLIGHT_PER_MODEL", kDefaultMaxInflightPerModel,
+                                 0, 4096);
+    }
+
+    /**
+     * @brief Get the maximum number of in-flight upstream requests per backend.
+     * @return int The limit; 0 disables it (default: 8).
+     */
+    static int getMaxInflightPerBackend()
+    {
+        return detail::getenvInt("SECTORFLUX_MAX_INFLIGHT_PER_BACKEND",
+                                 kDefaultMaxInflightPerBackend, 0, 4096);
+    }
+
+    /**
+     * @brief Get how long a request may wait for an upstream slot.
+     * @return int Seconds before the request fails with 503 (default: 120).
+     */
+    static int getQueueTimeoutSec()
+    {
+        return detail::getenvInt("SECTORFLUX_QUEUE_TIMEOUT_SEC", kDefaultQueueTimeoutSec, 1, 86400);
+    }
+
+    /**
+     * @brief Get the number of read-only SQLite connections for request handlers.
+     * @return int Concurrent dashboard/cache reads (default: 4).
+     */
+    static int getDbReaders()
+    {
+        return detail::getenvInt("SECTORFLUX_DB_READERS", kDefaultDbReaders, 1, 64);
+    }
+
+    /**
+     * @brief Get the SQLite page cache size of each connection.
+     * @return int The cache size in megabytes (default: 16).
+     */
+    static int getDbCacheMb()
+    {
+        return detail::getenvInt("SECTORFLUX_DB_CACHE_MB", kDefaultDbCacheMb, 1, 1 << 16);
+    }
+
+    /**
+     * @brief Get the memory-mapped I/O window of each SQLite connection.
+     * @return int The window in megabytes; 0 disables mmap (default: 256).
+     */
+    static int getDbMmapMb()
+    {
+        return detail::getenvInt("SECTORFLUX_DB_MMAP_MB", kDefaultDbMmapMb, 0, 1 << 20);
+    }
+
+    /**
+     * @brief Get the zstd level used to compress logged bodies.
+     * @return int The level; 0 stores bodies uncompressed (default: 3).
+     */
+    static int getCompressionLevel()
+    {
+        return detail::getenvInt("SECTORFLUX_COMPRESSION_LEVEL", kDefaultCompressionLevel, 0, 19);
+    }
+
+    /**
+     * @brief Get the number of most recent log entries retention keeps.
+     * @return int The row limit; 0 disables it (default: 100000).
+     */
+    static int getRetentionRows()
+    {
+        return detail::getenvInt("SECTORFLUX_RETENTION_ROWS", kDefaultRetentionRows, 0,
+                                 std::numeric_limits<int>::max());
+    }
+
+    /**
+     * @brief Get how many days of log history retention keeps.
+     * @return int Age limit in days; 0 disables it (default: 30).
+     */
+    static int getRetentionDays()
+    {
+        return detail::getenvInt("SECTORFLUX_RETENTION_DAYS", kDefaultRetentionDays, 0, 36500);
+    }
+
+    /**
+     * @brief Get the body volume retention keeps, oldest days dropped first.
+     * @return int Budget in megabytes of logged bodies; 0 disables it (default: 1024).
+     */
+    static int getRetentionMb()
+    {
+        return detail::getenvInt("SECTORFLUX_RETENTION_MB", kDefaultRetentionMb, 0, 1 << 24);
+    }
+
+    /**
+     * @brief Get the rules deciding how much of each interaction is logged.
+     * @return std::string Comma-separated selector=mode rules (see
+     *         CapturePolicy); empty logs every body in full (default).
+     */
+    static std::string getCapturePolicy()
+    {
+        return detail::safeGetenv("SECTORFLUX_CAPTURE");
+    }
+
+    /**
+     * @brief Check whether chat conversations are indexed by message prefix.
+     * @return bool True if SECTORFLUX_PREFIX_CACHE is 1 (default: off).
+     */
+    static bool getPrefixCacheEnabled()
+    {
+        return detail::getenvInt("SECTORFLUX_PREFIX_CACHE", 0, 0, 1) == 1;
+    }
+
+    /**
+     * @brief Get the keep_alive sent with chats that continue a known conversation.
+     * @return std::string An Ollama duration such as "30m"; empty leaves requests as sent.
+     */
+    static std::string getPrefixKeepAlive()
+    {
+        return detail::safeGetenv("SECTORFLUX_PREFIX_KEEP_ALIVE");
+    }
+
+    /**
+     * @brief Get the embedding model used for near-duplicate /api/generate lookups.
+     * @return std::string The Ollama model name; empty disables the lookup (default).
+     */
+    static std::string getSemanticModel()
+    {
+        return detail::safeGetenv("SECTORFLUX_SEMANTIC_MODEL");
+    }
+
+    /**
+     * @brief Get the cosine similarity at which a prompt counts as a near duplicate.
+     * @return double The threshold in (0, 1] (default: 0.95).
+     */
+    static double getSemanticThreshold()
+    {
+        return detail::getenvDouble("SECTORFLUX_SEMANTIC_THRESHOLD", kDefaultSemanticThreshold,
+                                    0.01, 1.0);
+    }
+
+    /**
+     * @brief Get how many prompt embeddings the near-duplicate index holds.
+     * @return int The capacity; the oldest embeddings are replaced (default: 10000).
+     */
+    static int getSemanticCapacity()
+    {
+        return detail::getenvInt("SECTORFLUX_SEMANTIC_CAPACITY", kDefaultSemanticCapacity, 1,
+                                 1 << 22);
+    }
+
+    /**
+     * @brief Get the time a near-duplicate lookup may spend embedding a prompt.
+     * @return int Milliseconds before the lookup counts as a miss (default: 500).
+     */
+    static int getSemanticTimeoutMs()
+    {
+        return detail::getenvInt("SECTORFLUX_SEMANTIC_TIMEOUT_MS", kDefaultSemanticTimeoutMs, 1,
+                                 60000);
+    }
+
     // Configuration constants
     static constexpr int kDefaultPort = 8888;
+    static constexpr int kDefaultStreamPort = 8889;
+    static constexpr int kDefaultUpstreamPoolSize = 8;
+    static constexpr int kDefaultCacheMemoryMb = 64;
+    static constexpr int kDefaultCacheDiskMb = 1024;
+    static constexpr int kDefaultLogQueueMb = 64;
+    static constexpr int kDefaultLogQueueSampleEvery = 10;
+    static constexpr int kDefaultChatWorkers = 4;
+    static constexpr int kDefaultMaxInflightPerModel = 4;
+    static constexpr int kDefaultMaxInflightPerBackend = 8;
+    static constexpr int kDefaultQueueTimeoutSec = 120;
+    static constexpr int kDefaultDbReaders = 4;
+    static constexpr int kDefaultDbCacheMb = 16;
+    static constexpr int kDefaultDbMmapMb = 256;
+    static constexpr int kDefaultCompressionLevel = 3;
+    static constexpr int kDefaultRetentionRows = 100000;
+    static constexpr int kDefaultRetentionDays = 30;
+    static constexpr int kDefaultRetentionMb = 1024;
+    static constexpr double kDefaultSemanticThreshold = 0.95;
+    static constexpr int kDefaultSemanticCapacity = 10000;
+    static constexpr int kDefaultSemanticTimeoutMs = 500;
     static constexpr int kDefaultTimeout = 60;
-    static constexpr int kMaxHistoryEntries = 100;
+    static constexpr int kDefaultWebSocketTimeoutSec = 300;
 };
 
 } // namespace sectorflux
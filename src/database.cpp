@@ -11,27 +11,438 @@
 
 #include "database.hpp"
 
+#include "config.hpp"
+#include "search_text.hpp"
+
+#include <algorithm>
 #include <iostream>
+#include <iterator>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <variant>
 
 namespace sectorflux
 {
 
+namespace
+{
+
+/**
+ * @brief Schema migrations; entry i upgrades PRAGMA user_version i to i + 1.
+ */
+constexpr const char* kMigrations[] = {
+    // v1: record cache hits explicitly instead of inferring them from duration_ms = 0
+    "ALTER TABLE requests ADD COLUMN cache_hit INTEGER DEFAULT 0;"
+    "UPDATE requests SET cache_hit = 1 WHERE duration_ms = 0;",
+    // v2: time spent waiting for admission to the upstream
+    "ALTER TABLE requests ADD COLUMN queue_wait_ms INTEGER DEFAULT 0;",
+    // v3: which Ollama backend served the request
+    "ALTER TABLE requests ADD COLUMN backend TEXT DEFAULT '';",
+    // v4: NDJSON line offsets and arrival times, for chunked cache replay
+    "ALTER TABLE response_cache ADD COLUMN chunk_index BLOB;",
+    // v5: bodies move to a compressed, content-addressed blob table shared by
+    // requests and response_cache; rows keep only blob ids and raw sizes.
+    // Older rows keep their inline bodies, which reads fall back to.
+    "CREATE TABLE blobs ("
+    "    id INTEGER PRIMARY KEY,"
+    "    hash BLOB NOT NULL UNIQUE,"
+    "    codec INTEGER NOT NULL,"
+    "    dictionary_id INTEGER,"
+    "    raw_size INTEGER NOT NULL,"
+    "    data BLOB);"
+    "CREATE TABLE blob_dictionaries ("
+    "    id INTEGER PRIMARY KEY,"
+    "    data BLOB NOT NULL,"
+    "    created_at DATETIME DEFAULT CURRENT_TIMESTAMP);"
+    "ALTER TABLE requests ADD COLUMN request_blob INTEGER;"
+    "ALTER TABLE requests ADD COLUMN request_size INTEGER DEFAULT 0;"
+    "ALTER TABLE requests ADD COLUMN response_blob INTEGER;"
+    "ALTER TABLE requests ADD COLUMN response_size INTEGER DEFAULT 0;"
+    "ALTER TABLE response_cache ADD COLUMN body_blob INTEGER;"
+    "UPDATE requests SET request_size = COALESCE(length(CAST(request_body AS BLOB)), 0),"
+    "    response_size = COALESCE(length(CAST(response_body AS BLOB)), 0);"
+    "CREATE INDEX idx_requests_request_blob ON requests(request_blob);"
+    "CREATE INDEX idx_requests_response_blob ON requests(response_blob);"
+    "CREATE INDEX idx_response_cache_body_blob ON response_cache(body_blob);"
+    // A blob is dropped with the last row that references it
+    "CREATE TRIGGER requests_release_blobs AFTER DELETE ON requests BEGIN"
+    "    DELETE FROM blobs WHERE id IN (OLD.request_blob, OLD.response_blob)"
+    "        AND NOT EXISTS (SELECT 1 FROM requests WHERE request_blob = blobs.id)"
+    "        AND NOT EXISTS (SELECT 1 FROM requests WHERE response_blob = blobs.id)"
+    "        AND NOT EXISTS (SELECT 1 FROM response_cache WHERE body_blob = blobs.id);"
+    "END;"
+    "CREATE TRIGGER response_cache_release_blob AFTER UPDATE OF body_blob ON response_cache"
+    "    WHEN OLD.body_blob IS NOT NEW.body_blob BEGIN"
+    "    DELETE FROM blobs WHERE id = OLD.body_blob"
+    "        AND NOT EXISTS (SELECT 1 FROM requests WHERE request_blob = blobs.id)"
+    "        AND NOT EXISTS (SELECT 1 FROM requests WHERE response_blob = blobs.id)"
+    "        AND NOT EXISTS (SELECT 1 FROM response_cache WHERE body_blob = blobs.id);"
+    "END;"
+    "CREATE TRIGGER response_cache_delete_blob AFTER DELETE ON response_cache BEGIN"
+    "    DELETE FROM blobs WHERE id = OLD.body_blob"
+    "        AND NOT EXISTS (SELECT 1 FROM requests WHERE request_blob = blobs.id)"
+    "        AND NOT EXISTS (SELECT 1 FROM requests WHERE response_blob = blobs.id)"
+    "        AND NOT EXISTS (SELECT 1 FROM response_cache WHERE body_blob = blobs.id);"
+    "END;",
+    // v6: per-day partitions of the requests rowid range, so retention can
+    // drop a whole day as one contiguous range; counts exclude starred rows,
+    // which setStarred() moves in and out
+    "CREATE TABLE log_partitions ("
+    "    day TEXT PRIMARY KEY,"
+    "    first_id INTEGER NOT NULL,"
+    "    last_id INTEGER NOT NULL,"
+    "    rows INTEGER NOT NULL,"
+    "    bytes INTEGER NOT NULL);"
+    "INSERT INTO log_partitions "
+    "    SELECT date(timestamp), MIN(id), MAX(id), SUM(is_starred = 0),"
+    "        SUM(CASE WHEN is_starred = 0 THEN request_size + response_size ELSE 0 END)"
+    "    FROM requests GROUP BY date(timestamp);",
+    // v7: indexes behind the log filters, and full-text search over prompts
+    // and generated text (earlier entries are indexed by v13's back-fill)
+    "CREATE INDEX idx_requests_model ON requests(model, id);"
+    "CREATE INDEX idx_requests_endpoint ON requests(endpoint, id);"
+    "CREATE INDEX idx_requests_status ON requests(response_status, id);"
+    "CREATE INDEX idx_requests_timestamp ON requests(timestamp);"
+    "CREATE INDEX idx_requests_starred ON requests(id) WHERE is_starred = 1;"
+    "CREATE VIRTUAL TABLE requests_fts USING fts5(prompt, response);"
+    "CREATE TRIGGER requests_release_search AFTER DELETE ON requests BEGIN"
+    "    DELETE FROM requests_fts WHERE rowid = OLD.id;"
+    "END;",
+    // v8: per-model metric rollups at minute and hour resolution, kept
+    // independently of the raw rows
+    "CREATE TABLE metric_rollups ("
+    "    resolution INTEGER NOT NULL,"
+    "    bucket INTEGER NOT NULL,"
+    "    model TEXT NOT NULL,"
+    "    requests INTEGER NOT NULL,"
+    "    cache_hits INTEGER NOT NULL,"
+    "    errors INTEGER NOT NULL,"
+    "    prompt_tokens INTEGER NOT NULL,"
+    "    completion_tokens INTEGER NOT NULL,"
+    "    duration_ms INTEGER NOT NULL,"
+    "    eval_duration_ms INTEGER NOT NULL,"
+    "    ttft_histogram BLOB,"
+    "    PRIMARY KEY (resolution, bucket, model)) WITHOUT ROWID;",
+    // v9: per-phase timing spans of each request
+    "ALTER TABLE requests ADD COLUMN trace BLOB;",
+    // v10: cache entry size, expiry and last use (Unix seconds), for TTLs and
+    // the LRU byte budget; existing entries never expire
+    "ALTER TABLE response_cache ADD COLUMN body_size INTEGER DEFAULT 0;"
+    "ALTER TABLE response_cache ADD COLUMN expires_at INTEGER DEFAULT 0;"
+    "ALTER TABLE response_cache ADD COLUMN last_used_at INTEGER DEFAULT 0;"
+    "UPDATE response_cache SET "
+    "    body_size = COALESCE((SELECT raw_size FROM blobs WHERE blobs.id = body_blob),"
+    "        length(CAST(response_body AS BLOB)), 0),"
+    "    last_used_at = COALESCE(CAST(strftime('%s', created_at) AS INTEGER), 0);"
+    "CREATE INDEX idx_response_cache_last_used ON response_cache(last_used_at);"
+    "CREATE INDEX idx_response_cache_expires ON response_cache(expires_at) WHERE expires_at > 0;",
+    // v11: how much of each body the capture policy kept (LogCapture)
+    "ALTER TABLE requests ADD COLUMN capture INTEGER DEFAULT 0;",
+    // v12: the search index keeps only its inverted index; the text it was
+    // built from is already in blobs, compressed and deduplicated
+    "DROP TRIGGER requests_release_search;"
+    "ALTER TABLE requests_fts RENAME TO requests_fts_v7;"
+    "CREATE VIRTUAL TABLE requests_fts USING fts5("
+    "    prompt, response, content='', contentless_delete=1);"
+    "INSERT INTO requests_fts (rowid, prompt, response) "
+    "    SELECT rowid, prompt, response FROM requests_fts_v7;"
+    "DROP TABLE requests_fts_v7;"
+    "CREATE TRIGGER requests_release_search AFTER DELETE ON requests BEGIN"
+    "    DELETE FROM requests_fts WHERE rowid = OLD.id;"
+    "END;",
+    // v13: cursor of the search back-fill, which indexes the entries logged
+    // before v7 newest first; it starts below the oldest indexed entry and
+    // reaches 0 when done
+    "CREATE TABLE search_backfill (next_id INTEGER NOT NULL);"
+    "INSERT INTO search_backfill SELECT COALESCE("
+    "    (SELECT rowid FROM requests_fts ORDER BY rowid LIMIT 1) - 1,"
+    "    (SELECT MAX(id) FROM requests), 0);",
+    // v14: the pre-hash response cache, keyed by raw request bodies; its
+    // entries cannot be re-keyed without normalizing each request, so they go
+    "DROP TABLE IF EXISTS cache;",
+    // v15: lifetime request totals, advanced with each batch so they keep
+    // counting entries that retention has since deleted
+    "CREATE TABLE log_totals ("
+    "    id INTEGER PRIMARY KEY CHECK (id = 0),"
+    "    requests INTEGER NOT NULL,"
+    "    duration_ms INTEGER NOT NULL,"
+    "    cache_hits INTEGER NOT NULL);"
+    "INSERT INTO log_totals "
+    "    SELECT 0, COUNT(*), COALESCE(SUM(duration_ms), 0), COALESCE(SUM(cache_hit), 0) "
+    "    FROM requests;",
+    // v16: recount the day partitions, restoring those dropped while all of
+    // their entries were starred
+    "DELETE FROM log_partitions;"
+    "INSERT INTO log_partitions "
+    "    SELECT date(timestamp), MIN(id), MAX(id), SUM(is_starred = 0),"
+    "        SUM(CASE WHEN is_starred = 0 THEN request_size + response_size ELSE 0 END)"
+    "    FROM requests GROUP BY date(timestamp);",
+};
+
+constexpr const char* kInsertLogSql =
+    "INSERT INTO requests (method, endpoint, model, request_blob, request_size, "
+    "response_status, response_blob, response_size, duration_ms, prompt_tokens, "
+    "completion_tokens, prompt_eval_duration_ms, eval_duration_ms, ttft_ms, "
+    "cache_hit, queue_wait_ms, backend, trace, capture) "
+    "VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)";
+// An upsert rather than INSERT OR REPLACE, so the blob triggers see the update
+constexpr const char* kInsertCacheSql =
+    "INSERT INTO response_cache (cache_key, response_status, body_blob, chunk_index, "
+    "body_size, expires_at, last_used_at) "
+    "VALUES (?, ?, ?, ?, ?, ?, ?) ON CONFLICT(cache_key) DO UPDATE SET "
+    "response_status = excluded.response_status, response_body = NULL, "
+    "body_blob = excluded.body_blob, chunk_index = excluded.chunk_index, "
+    "body_size = excluded.body_size, expires_at = excluded.expires_at, "
+    "last_used_at = excluded.last_used_at, created_at = CURRENT_TIMESTAMP";
+constexpr const char* kTouchCacheSql =
+    "UPDATE response_cache SET last_used_at = ? WHERE cache_key = ?";
+constexpr const char* kFlushCacheSql = "DELETE FROM response_cache";
+constexpr const char* kExpireCacheSql =
+    "DELETE FROM response_cache WHERE cache_key IN (SELECT cache_key FROM response_cache "
+    "WHERE expires_at > 0 AND expires_at <= ? LIMIT ?)";
+constexpr const char* kCacheTotalsSql =
+    "SELECT COUNT(*), COALESCE(SUM(body_size), 0) FROM response_cache";
+constexpr const char* kSelectEvictionSql =
+    "SELECT cache_key, body_size FROM response_cache ORDER BY last_used_at LIMIT ?";
+constexpr const char* kDeleteCacheEntrySql = "DELETE FROM response_cache WHERE cache_key = ?";
+constexpr const char* kInsertSearchSql =
+    "INSERT INTO requests_fts (rowid, prompt, response) VALUES (?, ?, ?)";
+constexpr const char* kSelectBackfillCursorSql = "SELECT next_id FROM search_backfill";
+constexpr const char* kUpdateBackfillCursorSql = "UPDATE search_backfill SET next_id = ?";
+// Both bodies with the (codec, dictionary_id, data) of their blobs
+constexpr const char* kSelectBackfillSql =
+    "SELECT r.id, r.request_body, r.response_body, r.request_size, r.response_size, "
+    "q.codec, q.dictionary_id, q.data, p.codec, p.dictionary_id, p.data FROM requests r "
+    "LEFT JOIN blobs q ON q.id = r.request_blob LEFT JOIN blobs p ON p.id = r.response_blob "
+    "WHERE r.id <= ? ORDER BY r.id DESC LIMIT ?";
+constexpr const char* kFindBlobSql = "SELECT id FROM blobs WHERE hash = ?";
+constexpr const char* kInsertBlobSql =
+    "INSERT INTO blobs (hash, codec, dictionary_id, raw_size, data) VALUES (?, ?, ?, ?, ?)";
+constexpr const char* kInsertDictionarySql = "INSERT INTO blob_dictionaries (data) VALUES (?)";
+constexpr const char* kRecordPartitionSql =
+    "INSERT INTO log_partitions (day, first_id, last_id, rows, bytes) "
+    "VALUES (date('now'), ?, ?, ?, ?) ON CONFLICT(day) DO UPDATE SET "
+    "first_id = MIN(first_id, excluded.first_id), last_id = MAX(last_id, excluded.last_id), "
+    "rows = rows + excluded.rows, bytes = bytes + excluded.bytes";
+constexpr const char* kAddLogTotalsSql =
+    "UPDATE log_totals SET requests = requests + ?, duration_ms = duration_ms + ?, "
+    "cache_hits = cache_hits + ? WHERE id = 0";
+constexpr const char* kSelectPartitionsSql =
+    "SELECT first_id, last_id, bytes, day < date('now', ?) FROM log_partitions ORDER BY day";
+constexpr const char* kSelectByteCutoffSql =
+    "SELECT id FROM (SELECT id, SUM(request_size + response_size) OVER (ORDER BY id) AS running "
+    "    FROM requests WHERE id >= ? AND is_starred = 0) "
+    "WHERE running >= ? LIMIT 1";
+constexpr const char* kDropRangeSql =
+    "DELETE FROM requests WHERE id IN (SELECT id FROM requests "
+    "WHERE id BETWEEN ? AND ? AND is_starred = 0 LIMIT ?)";
+constexpr const char* kRefreshPartitionsSql =
+    "UPDATE log_partitions SET "
+    "rows = (SELECT COUNT(*) FROM requests "
+    "    WHERE id BETWEEN first_id AND last_id AND is_starred = 0), "
+    "bytes = (SELECT COALESCE(SUM(request_size + response_size), 0) FROM requests "
+    "    WHERE id BETWEEN first_id AND last_id AND is_starred = 0) "
+    "WHERE first_id <= ?2 AND last_id >= ?1";
+// Starred entries keep their day's partition, so it covers them once unstarred
+constexpr const char* kDropEmptyPartitionsSql =
+    "DELETE FROM log_partitions WHERE rows = 0 AND NOT EXISTS "
+    "(SELECT 1 FROM requests WHERE id BETWEEN first_id AND last_id)";
+// ?1 is +1 when an entry is unstarred and -1 when it is starred
+constexpr const char* kCreditPartitionSql =
+    "UPDATE log_partitions SET rows = rows + ?1, "
+    "bytes = bytes + ?1 * (SELECT request_size + response_size FROM requests WHERE id = ?2) "
+    "WHERE ?2 BETWEEN first_id AND last_id";
+constexpr const char* kSelectRollupHistogramSql =
+    "SELECT ttft_histogram FROM metric_rollups "
+    "WHERE resolution = ? AND bucket = ? AND model = ?";
+constexpr const char* kUpsertRollupSql =
+    "INSERT INTO metric_rollups (resolution, bucket, model, requests, cache_hits, errors, "
+    "prompt_tokens, completion_tokens, duration_ms, eval_duration_ms, ttft_histogram) "
+    "VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?) "
+    "ON CONFLICT(resolution, bucket, model) DO UPDATE SET "
+    "requests = requests + excluded.requests, cache_hits = cache_hits + excluded.cache_hits, "
+    "errors = errors + excluded.errors, prompt_tokens = prompt_tokens + excluded.prompt_tokens, "
+    "completion_tokens = completion_tokens + excluded.completion_tokens, "
+    "duration_ms = duration_ms + excluded.duration_ms, "
+    "eval_duration_ms = eval_duration_ms + excluded.eval_duration_ms, "
+    "ttft_histogram = excluded.ttft_histogram";
+constexpr const char* kPruneRollupsSql =
+    "DELETE FROM metric_rollups WHERE resolution = ? AND bucket < ?";
+constexpr const char* kSetStarredSql =
+    "UPDATE requests SET is_starred = ?1 WHERE id = ?2 AND is_starred IS NOT ?1";
+
+// Selects list the columns in the order readLogEntry() expects; full entries
+// append the (codec, dictionary_id, data) of both body blobs
+constexpr const char* kSelectLogsSql =
+    "SELECT r.id, r.timestamp, r.method, r.endpoint, r.model, r.request_body, "
+    "r.response_status, r.response_body, r.duration_ms, r.prompt_tokens, "
+    "r.completion_tokens, r.prompt_eval_duration_ms, r.eval_duration_ms, "
+    "r.ttft_ms, r.is_starred, r.cache_hit, r.queue_wait_ms, r.backend, "
+    "r.request_size, r.response_size, r.capture, "
+    "q.codec, q.dictionary_id, q.data, p.codec, p.dictionary_id, p.data FROM requests r "
+    "LEFT JOIN blobs q ON q.id = r.request_blob LEFT JOIN blobs p ON p.id = r.response_blob "
+    "ORDER BY r.id DESC LIMIT ?";
+// Bodies are selected as empty literals so readLogEntry's column order holds
+constexpr const char* kSelectLogSummariesSql =
+    "SELECT id, timestamp, method, endpoint, model, '', "
+    "response_status, '', duration_ms, prompt_tokens, "
+    "completion_tokens, prompt_eval_duration_ms, eval_duration_ms, "
+    "ttft_ms, is_starred, cache_hit, queue_wait_ms, backend, "
+    "request_size, response_size, capture FROM requests WHERE id > ? "
+    "ORDER BY id DESC LIMIT ?";
+// queryLogs() appends its filters to this; columns as in kSelectLogSummariesSql
+constexpr std::string_view kQueryLogsSql =
+    "SELECT id, timestamp, method, endpoint, model, '', "
+    "response_status, '', duration_ms, prompt_tokens, "
+    "completion_tokens, prompt_eval_duration_ms, eval_duration_ms, "
+    "ttft_ms, is_starred, cache_hit, queue_wait_ms, backend, "
+    "request_size, response_size, capture FROM requests WHERE 1";
+constexpr const char* kSelectLogSql =
+    "SELECT r.id, r.timestamp, r.method, r.endpoint, r.model, r.request_body, "
+    "r.response_status, r.response_body, r.duration_ms, r.prompt_tokens, "
+    "r.completion_tokens, r.prompt_eval_duration_ms, r.eval_duration_ms, "
+    "r.ttft_ms, r.is_starred, r.cache_hit, r.queue_wait_ms, r.backend, "
+    "r.request_size, r.response_size, r.capture, "
+    "q.codec, q.dictionary_id, q.data, p.codec, p.dictionary_id, p.data FROM requests r "
+    "LEFT JOIN blobs q ON q.id = r.request_blob LEFT JOIN blobs p ON p.id = r.response_blob "
+    "WHERE r.id = ?";
+constexpr const char* kSelectTraceSql = "SELECT trace FROM requests WHERE id = ?";
+constexpr const char* kSelectCachedSql =
+    "SELECT c.response_status, c.response_body, c.chunk_index, "
+    "b.codec, b.dictionary_id, b.data, b.raw_size, c.expires_at FROM response_cache c "
+    "LEFT JOIN blobs b ON b.id = c.body_blob "
+    "WHERE c.cache_key = ?1 AND (c.expires_at = 0 OR c.expires_at > ?2)";
+constexpr const char* kSelectRollupsSql =
+    "SELECT bucket, model, requests, cache_hits, errors, prompt_tokens, completion_tokens, "
+    "duration_ms, eval_duration_ms, ttft_histogram FROM metric_rollups "
+    "WHERE resolution = ?1 AND bucket BETWEEN ?2 AND ?3 AND (?4 = '' OR model = ?4) "
+    "ORDER BY model, bucket";
+constexpr const char* kSelectDictionariesSql =
+    "SELECT id, data FROM blob_dictionaries ORDER BY id";
+
+constexpr int kBusyTimeoutMs = 5000;
+constexpr int kKibPerMegabyte = 1024;
+constexpr long long kBytesPerMegabyteLL = 1024 * 1024;
+
+ConnectionTuning connectionTuning()
+{
+    return ConnectionTuning{
+        .cache_size_kb = Config::getDbCacheMb() * kKibPerMegabyte,
+        .mmap_bytes = static_cast<long long>(Config::getDbMmapMb()) * kBytesPerMegabyteLL,
+        .busy_timeout_ms = kBusyTimeoutMs};
+}
+
+int64_t unixNow()
+{
+    return std::chrono::duration_cast<std::chrono::seconds>(
+               std::chrono::system_clock::now().time_since_epoch())
+        .count();
+}
+
+std::string columnText(sqlite3_stmt* stmt, int column)
+{
+    const unsigned char* text = sqlite3_column_text(stmt, column);
+    return text ? reinterpret_cast<const char*>(text) : "";
+}
+
+std::string_view columnBlob(sqlite3_stmt* stmt, int column)
+{
+    const void* blob = sqlite3_column_blob(stmt, column);
+    return blob ? std::string_view(static_cast<const char*>(blob),
+                                   static_cast<size_t>(sqlite3_column_bytes(stmt, column)))
+                : std::string_view();
+}
+
+/**
+ * @brief Read a body stored as a blob at blob_column, or inline at inline_column.
+ * @param blob_column First of the blob's (codec, dictionary_id, data) columns.
+ */
+std::string readBody(sqlite3_stmt* stmt, int inline_column, int blob_column, size_t raw_size,
+                     const BodyCodec& codec)
+{
+    if (sqlite3_column_type(stmt, blob_column) == SQLITE_NULL)
+    {
+        return columnText(stmt, inline_column);  // Rows logged before blob storage
+    }
+    auto body = codec.decode(static_cast<BodyEncoding>(sqlite3_column_int(stmt, blob_column)),
+                             sqlite3_column_int64(stmt, blob_column + 1),
+                             columnBlob(stmt, blob_column + 2), raw_size);
+    return body.value_or("");
+}
+
+/**
+ * @brief Read a LogEntry from a row selected in the canonical column order.
+ * @param codec Decodes the body blobs; nullptr for summaries without bodies.
+ */
+LogEntry readLogEntry(sqlite3_stmt* stmt, const BodyCodec* codec)
+{
+    LogEntry entry;
+    entry.id = sqlite3_column_int(stmt, 0);
+    entry.timestamp = columnText(stmt, 1);
+    entry.method = columnText(stmt, 2);
+    entry.endpoint = columnText(stmt, 3);
+    entry.model = columnText(stmt, 4);
+    entry.response_status = sqlite3_column_int(stmt, 6);
+    entry.duration_ms = sqlite3_column_int64(stmt, 8);
+    entry.prompt_tokens = sqlite3_column_int(stmt, 9);
+    entry.completion_tokens = sqlite3_column_int(stmt, 10);
+    entry.prompt_eval_duration_ms = sqlite3_column_int64(stmt, 11);
+    entry.eval_duration_ms = sqlite3_column_int64(stmt, 12);
+    entry.ttft_ms = sqlite3_column_int64(stmt, 13);
+    entry.is_starred = sqlite3_column_int(stmt, 14) != 0;
+    entry.cache_hit = sqlite3_column_int(stmt, 15) != 0;
+    entry.queue_wait_ms = sqlite3_column_int64(stmt, 16);
+    entry.backend = columnText(stmt, 17);
+    entry.request_size = sqlite3_column_int64(stmt, 18);
+    entry.response_size = sqlite3_column_int64(stmt, 19);
+    entry.capture = static_cast<LogCapture>(sqlite3_column_int(stmt, 20));
+    if (codec)
+    {
+        entry.request_body = readBody(stmt, 5, 21, static_cast<size_t>(entry.request_size),
+                                      *codec);
+        entry.response_body = readBody(stmt, 7, 24, static_cast<size_t>(entry.response_size),
+                                       *codec);
+    }
+    return entry;
+}
+
+}  // namespace
+
 Database::Database()
+    : codec_(Config::getCompressionLevel()),
+      write_queue_(static_cast<size_t>(Config::getLogQueueMb()) * kBytesPerMegabyte,
+                   parseOverflowPolicy(Config::getLogQueuePolicy())
+                       .value_or(OverflowPolicy::DropBodies),
+                   static_cast<unsigned>(Config::getLogQueueSampleEvery())),
+      retention_{.max_rows = Config::getRetentionRows(),
+                 .max_days = Config::getRetentionDays(),
+                 .max_bytes = static_cast<long long>(Config::getRetentionMb()) *
+                              static_cast<long long>(kBytesPerMegabyte)},
+      cache_max_bytes_(static_cast<long long>(Config::getCacheDiskMb()) *
+                       static_cast<long long>(kBytesPerMegabyte))
 {
 }
 
 Database::~Database()
 {
-    // Signal shutdown and wait for worker to finish
+    // Compaction shares the writer connection, so it stops first
+    if (retention_worker_.joinable())
     {
-        std::lock_guard<std::mutex> lock(queue_mutex_);
-        shutdown_requested_ = true;
+        retention_worker_.request_stop();
+        retention_worker_.join();
     }
-    queue_cv_.notify_one();
 
-    // jthread automatically joins on destruction, but we need to ensure
-    // the worker exits its wait loop first
+    // Stop accepting writes and let the worker drain what is queued before
+    // the connection is closed
+    write_queue_.close();
+    if (write_worker_.joinable())
+    {
+        write_worker_.join();
+    }
 
+    // Statements must be finalized before their connection closes
+    writer_statements_.reset();
     if (db_)
     {
         sqlite3_close(db_);
@@ -47,9 +458,15 @@ std::optional<std::string> Database::init(const std::string& db_path)
         return err;
     }
 
-    // Enable WAL mode for concurrent write support
+    // Enable WAL mode for concurrent write support. Readers then never block
+    // the writer, and synchronous=NORMAL only syncs the WAL at checkpoints.
+    // Incremental auto-vacuum (effective on new databases) lets retention
+    // return freed pages to the file system.
     char* wal_err = nullptr;
-    rc = sqlite3_exec(db_, "PRAGMA journal_mode=WAL;", nullptr, nullptr, &wal_err);
+    rc = sqlite3_exec(db_,
+                      "PRAGMA auto_vacuum=INCREMENTAL;"
+                      "PRAGMA journal_mode=WAL;PRAGMA synchronous=NORMAL;",
+                      nullptr, nullptr, &wal_err);
     if (rc != SQLITE_OK)
     {
         std::cerr << "Warning: Failed to enable WAL mode: "
@@ -59,6 +476,10 @@ std::optional<std::string> Database::init(const std::string& db_path)
             sqlite3_free(wal_err);
         }
     }
+    if (auto err = applyTuning(db_, connectionTuning()))
+    {
+        std::cerr << "Warning: " << *err << std::endl;
+    }
 
     const char* sql = R"(
         CREATE TABLE IF NOT EXISTS requests (
@@ -79,10 +500,11 @@ std::optional<std::string> Database::init(const std::string& db_path)
             is_starred INTEGER DEFAULT 0
         );
 
-        CREATE TABLE IF NOT EXISTS cache (
-            request_body TEXT PRIMARY KEY,
+        CREATE TABLE IF NOT EXISTS response_cache (
+            cache_key BLOB PRIMARY KEY,
             response_status INTEGER,
-            response_body TEXT
+            response_body TEXT,
+            created_at DATETIME DEFAULT CURRENT_TIMESTAMP
         );
     )";
 
@@ -95,417 +517,1219 @@ std::optional<std::string> Database::init(const std::string& db_path)
         return err;
     }
 
+    if (auto err = migrate())
+    {
+        return err;
+    }
+
+    // Seed the in-memory aggregates once; the writer keeps them current
+    loadMetrics();
+
+    // Writer statements are prepared once and reused for every batch;
+    // preparing them here surfaces schema problems at startup
+    writer_statements_ = std::make_unique<StatementCache>(db_);
+    if (!writer_statements_->prepare(kInsertLogSql) ||
+        !writer_statements_->prepare(kInsertCacheSql) ||
+        !writer_statements_->prepare(kRecordPartitionSql) ||
+        !writer_statements_->prepare(kAddLogTotalsSql) ||
+        !writer_statements_->prepare(kSetStarredSql) ||
+        !writer_statements_->prepare(kFindBlobSql) ||
+        !writer_statements_->prepare(kInsertBlobSql) ||
+        !writer_statements_->prepare(kInsertSearchSql) ||
+        !writer_statements_->prepare(kUpsertRollupSql))
+    {
+        return "Failed to prepare writer statements: " + std::string(sqlite3_errmsg(db_));
+    }
+
+    // Request handlers read through their own connections, never the writer's
+    if (auto err = read_pool_.open(db_path, static_cast<size_t>(Config::getDbReaders()),
+                                   connectionTuning()))
+    {
+        return err;
+    }
+
+    loadDictionaries();
+
+    // The row limit counts back from the newest entry
+    sqlite3_stmt* range_stmt;
+    if (sqlite3_prepare_v2(db_, "SELECT COALESCE(MAX(id), 0) FROM requests", -1, &range_stmt,
+                           nullptr) == SQLITE_OK)
+    {
+        if (sqlite3_step(range_stmt) == SQLITE_ROW)
+        {
+            last_log_id_ = sqlite3_column_int64(range_stmt, 0);
+        }
+        sqlite3_finalize(range_stmt);
+    }
+
     // Start the async write worker thread
-    write_worker_ = std::jthread([this](std::stop_token stop_token)
+    write_worker_ = std::jthread([this](std::stop_token /*stop_token*/)
     {
-        while (!stop_token.stop_requested())
+        // Runs until the queue is closed and drained
+        std::vector<QueuedWrite> batch;
+        while (write_queue_.popBatch(batch, kMaxBatchSize, kMaxBatchDelay))
         {
-            processWriteQueue();
+            commitBatch(batch);
+            batch.clear();
         }
-        // Process any remaining items before exiting
-        processWriteQueue();
+    });
+
+    // Start the background compaction thread
+    retention_worker_ = std::jthread([this](std::stop_token stop_token)
+    {
+        retentionLoop(stop_token);
     });
 
     return std::nullopt;
 }
 
-void Database::processWriteQueue()
+std::optional<std::string> Database::migrate()
 {
-    std::function<void()> task;
-
+    int version = 0;
+    sqlite3_stmt* stmt;
+    if (sqlite3_prepare_v2(db_, "PRAGMA user_version;", -1, &stmt, nullptr) == SQLITE_OK)
     {
-        std::unique_lock<std::mutex> lock(queue_mutex_);
-        queue_cv_.wait(lock, [this]
+        if (sqlite3_step(stmt) == SQLITE_ROW)
         {
-            return !write_queue_.empty() || shutdown_requested_;
-        });
+            version = sqlite3_column_int(stmt, 0);
+        }
+        sqlite3_finalize(stmt);
+    }
+
+    const int target = static_cast<int>(std::size(kMigrations));
+    for (; version < target; ++version)
+    {
+        std::string sql = "BEGIN;" + std::string(kMigrations[version]) +
+                          "PRAGMA user_version = " + std::to_string(version + 1) + ";COMMIT;";
 
-        if (write_queue_.empty())
+        char* err_msg = nullptr;
+        if (sqlite3_exec(db_, sql.c_str(), nullptr, nullptr, &err_msg) != SQLITE_OK)
         {
-            return;
+            std::string err = "Migration to schema v" + std::to_string(version + 1) +
+                              " failed: " + (err_msg ? err_msg : "unknown error");
+            sqlite3_free(err_msg);
+            sqlite3_exec(db_, "ROLLBACK;", nullptr, nullptr, nullptr);
+            return err;
         }
+    }
 
-        task = std::move(write_queue_.front());
-        write_queue_.pop();
+    return std::nullopt;
+}
+
+void Database::loadMetrics()
+{
+    const char* sql = "SELECT requests, duration_ms, cache_hits FROM log_totals";
+
+    sqlite3_stmt* stmt;
+    if (sqlite3_prepare_v2(db_, sql, -1, &stmt, nullptr) != SQLITE_OK)
+    {
+        return;
     }
 
-    // Execute the task outside the lock
-    if (task)
+    if (sqlite3_step(stmt) == SQLITE_ROW)
     {
-        task();
+        total_requests_ = sqlite3_column_int64(stmt, 0);
+        total_duration_ms_ = sqlite3_column_int64(stmt, 1);
+        cache_hits_ = sqlite3_column_int64(stmt, 2);
     }
+    sqlite3_finalize(stmt);
 }
 
-void Database::logInteractionAsync(
-    const std::string& method,
-    const std::string& endpoint,
-    const std::string& model,
-    const std::string& request_body,
-    int response_status,
-    const std::string& response_body,
-    long long duration_ms,
-    int prompt_tokens,
-    int completion_tokens,
-    long long prompt_eval_duration_ms,
-    long long eval_duration_ms,
-    long long ttft_ms)
-{
-    // Capture all parameters by value for the async task
-    auto task = [this,
-                 method,
-                 endpoint,
-                 model,
-                 request_body,
-                 response_status,
-                 response_body,
-                 duration_ms,
-                 prompt_tokens,
-                 completion_tokens,
-                 prompt_eval_duration_ms,
-                 eval_duration_ms,
-                 ttft_ms]()
-    {
-        auto result = logInteractionSync(
-            method,
-            endpoint,
-            model,
-            request_body,
-            response_status,
-            response_body,
-            duration_ms,
-            prompt_tokens,
-            completion_tokens,
-            prompt_eval_duration_ms,
-            eval_duration_ms,
-            ttft_ms);
+void Database::commitBatch(const std::vector<QueuedWrite>& batch)
+{
+    ++batches_waiting_;
+    std::lock_guard<std::mutex> writer_lock(writer_mutex_);
+    --batches_waiting_;
+
+    // One transaction (and one fsync) for the whole batch
+    bool in_transaction =
+        sqlite3_exec(db_, "BEGIN IMMEDIATE;", nullptr, nullptr, nullptr) == SQLITE_OK;
+
+    // Aggregates only advance for rows that were actually committed
+    long long logged = 0;
+    long long logged_duration_ms = 0;
+    long long logged_hits = 0;
+    long long logged_bytes = 0;
+    long long first_logged_id = 0;
+
+    // Rollup buckets are keyed on commit time, like the rows' timestamps
+    const int64_t now = unixNow();
+    std::map<RollupKey, RollupTotals> rollups;
+
+    for (const auto& write : batch)
+    {
+        std::optional<std::string> result;
+        if (const auto* log = std::get_if<LogRecord>(&write))
+        {
+            result = logInteractionSync(*log);
+            if (!result)
+            {
+                if (logged == 0)
+                {
+                    first_logged_id = last_log_id_;
+                }
+                ++logged;
+                logged_duration_ms += log->duration_ms;
+                logged_hits += log->cache_hit ? 1 : 0;
+                logged_bytes += static_cast<long long>(
+                    log->request_body.size() +
+                    (log->response_body ? log->response_body->size() : 0));
+                for (auto resolution : {RollupResolution::Minute, RollupResolution::Hour})
+                {
+                    const int64_t width = static_cast<int64_t>(resolution);
+                    rollups[RollupKey{.resolution = resolution,
+                                      .bucket_start = now - now % width,
+                                      .model = log->model}]
+                        .add(*log);
+                }
+            }
+        }
+        else if (const auto* cache = std::get_if<CacheRecord>(&write))
+        {
+            result = cacheResponseSync(*cache, now);
+        }
+        else
+        {
+            result = touchCachedResponseSync(std::get<CacheTouch>(write), now);
+        }
 
         if (result)
         {
-            std::cerr << "Async log failed: " << *result << std::endl;
+            std::cerr << "Async write failed: " << *result << std::endl;
         }
-    };
+    }
 
+    writeRollups(rollups);
+
+    // The batch's entries join today's partition
+    if (logged > 0)
     {
-        std::lock_guard<std::mutex> lock(queue_mutex_);
-        write_queue_.push(std::move(task));
+        Statement partition = writer_statements_->prepare(kRecordPartitionSql);
+        sqlite3_bind_int64(partition.get(), 1, first_logged_id);
+        sqlite3_bind_int64(partition.get(), 2, last_log_id_);
+        sqlite3_bind_int64(partition.get(), 3, logged);
+        sqlite3_bind_int64(partition.get(), 4, logged_bytes);
+        if (sqlite3_step(partition.get()) != SQLITE_DONE)
+        {
+            std::cerr << "Failed to record log partition: " << sqlite3_errmsg(db_) << std::endl;
+        }
+
+        Statement totals = writer_statements_->prepare(kAddLogTotalsSql);
+        sqlite3_bind_int64(totals.get(), 1, logged);
+        sqlite3_bind_int64(totals.get(), 2, logged_duration_ms);
+        sqlite3_bind_int64(totals.get(), 3, logged_hits);
+        if (sqlite3_step(totals.get()) != SQLITE_DONE)
+        {
+            std::cerr << "Failed to update log totals: " << sqlite3_errmsg(db_) << std::endl;
+        }
     }
-    queue_cv_.notify_one();
-}
 
-std::optional<std::string> Database::logInteractionSync(
-    const std::string& method,
-    const std::string& endpoint,
-    const std::string& model,
-    const std::string& request_body,
-    int response_status,
-    const std::string& response_body,
-    long long duration_ms,
-    int prompt_tokens,
-    int completion_tokens,
-    long long prompt_eval_duration_ms,
-    long long eval_duration_ms,
-    long long ttft_ms)
-{
-    if (!db_)
+    if (in_transaction &&
+        sqlite3_exec(db_, "COMMIT;", nullptr, nullptr, nullptr) != SQLITE_OK)
     {
-        return "Database not initialized";
+        std::cerr << "Failed to commit write batch: " << sqlite3_errmsg(db_) << std::endl;
+        sqlite3_exec(db_, "ROLLBACK;", nullptr, nullptr, nullptr);
+        return;
     }
 
-    const char* sql =
-        "INSERT INTO requests (method, endpoint, model, request_body, "
-        "response_status, response_body, duration_ms, prompt_tokens, "
-        "completion_tokens, prompt_eval_duration_ms, eval_duration_ms, ttft_ms) VALUES "
-        "(?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)";
+    total_requests_ += logged;
+    total_duration_ms_ += logged_duration_ms;
+    cache_hits_ += logged_hits;
 
-    sqlite3_stmt* stmt;
-    int rc = sqlite3_prepare_v2(db_, sql, -1, &stmt, nullptr);
-    if (rc != SQLITE_OK)
+    if (dictionary_pending_)
     {
-        return "Failed to prepare statement: " + std::string(sqlite3_errmsg(db_));
+        trainDictionary();
     }
 
-    sqlite3_bind_text(stmt, 1, method.c_str(), -1, SQLITE_STATIC);
-    sqlite3_bind_text(stmt, 2, endpoint.c_str(), -1, SQLITE_STATIC);
-    sqlite3_bind_text(stmt, 3, model.c_str(), -1, SQLITE_STATIC);
-    sqlite3_bind_text(stmt, 4, request_body.c_str(), -1, SQLITE_STATIC);
-    sqlite3_bind_int(stmt, 5, response_status);
-    sqlite3_bind_text(stmt, 6, response_body.c_str(), -1, SQLITE_STATIC);
-    sqlite3_bind_int64(stmt, 7, duration_ms);
-    sqlite3_bind_int(stmt, 8, prompt_tokens);
-    sqlite3_bind_int(stmt, 9, completion_tokens);
-    sqlite3_bind_int64(stmt, 10, prompt_eval_duration_ms);
-    sqlite3_bind_int64(stmt, 11, eval_duration_ms);
-    sqlite3_bind_int64(stmt, 12, ttft_ms);
-
-    rc = sqlite3_step(stmt);
-    if (rc != SQLITE_DONE)
+    if (logged > 0)
     {
-        std::string err = "Execution failed: " + std::string(sqlite3_errmsg(db_));
-        sqlite3_finalize(stmt);
-        return err;
+        std::lock_guard<std::mutex> lock(listener_mutex_);
+        if (commit_listener_)
+        {
+            commit_listener_();
+        }
     }
-    sqlite3_finalize(stmt);
+}
 
-    // Enforce History Limit (Keep last kMaxHistoryEntries)
-    const char* delete_sql =
-        "DELETE FROM requests WHERE id NOT IN ("
-        "SELECT id FROM requests ORDER BY id DESC LIMIT ?)";
+void Database::setCommitListener(std::function<void()> listener)
+{
+    std::lock_guard<std::mutex> lock(listener_mutex_);
+    commit_listener_ = std::move(listener);
+}
 
-    sqlite3_stmt* delete_stmt;
-    rc = sqlite3_prepare_v2(db_, delete_sql, -1, &delete_stmt, nullptr);
-    if (rc == SQLITE_OK)
+void Database::writeRollups(const std::map<RollupKey, RollupTotals>& rollups)
+{
+    for (const auto& [key, totals] : rollups)
     {
-        sqlite3_bind_int(delete_stmt, 1, kMaxHistoryEntries);
-        rc = sqlite3_step(delete_stmt);
-        if (rc != SQLITE_DONE)
+        // Counters add up in SQL; the histogram is merged with the stored one here
+        RollupHistogram ttft_ms = totals.ttft_ms;
         {
-            std::cerr << "Failed to enforce history limit: "
-                      << sqlite3_errmsg(db_) << std::endl;
+            Statement select = writer_statements_->prepare(kSelectRollupHistogramSql);
+            sqlite3_bind_int(select.get(), 1, static_cast<int>(key.resolution));
+            sqlite3_bind_int64(select.get(), 2, key.bucket_start);
+            sqlite3_bind_text(select.get(), 3, key.model.c_str(), -1, SQLITE_STATIC);
+            if (sqlite3_step(select.get()) == SQLITE_ROW)
+            {
+                ttft_ms.merge(RollupHistogram::decode(columnBlob(select.get(), 0)));
+            }
+        }
+        const std::string histogram = ttft_ms.encode();
+
+        Statement upsert = writer_statements_->prepare(kUpsertRollupSql);
+        sqlite3_stmt* stmt = upsert.get();
+        sqlite3_bind_int(stmt, 1, static_cast<int>(key.resolution));
+        sqlite3_bind_int64(stmt, 2, key.bucket_start);
+        sqlite3_bind_text(stmt, 3, key.model.c_str(), -1, SQLITE_STATIC);
+        sqlite3_bind_int64(stmt, 4, totals.requests);
+        sqlite3_bind_int64(stmt, 5, totals.cache_hits);
+        sqlite3_bind_int64(stmt, 6, totals.errors);
+        sqlite3_bind_int64(stmt, 7, totals.prompt_tokens);
+        sqlite3_bind_int64(stmt, 8, totals.completion_tokens);
+        sqlite3_bind_int64(stmt, 9, totals.duration_ms);
+        sqlite3_bind_int64(stmt, 10, totals.eval_duration_ms);
+        sqlite3_bind_blob(stmt, 11, histogram.data(), static_cast<int>(histogram.size()),
+                          SQLITE_STATIC);
+        if (sqlite3_step(stmt) != SQLITE_DONE)
+        {
+            std::cerr << "Failed to update metric rollup: " << sqlite3_errmsg(db_) << std::endl;
         }
-        sqlite3_finalize(delete_stmt);
     }
+}
 
-    return std::nullopt;
+void Database::retentionLoop(std::stop_token stop_token)
+{
+    while (!stop_token.stop_requested())
+    {
+        enforceRetention(stop_token);
+        backfillSearch(stop_token);
+
+        std::unique_lock<std::mutex> lock(retention_mutex_);
+        retention_cv_.wait_for(lock, stop_token, kRetentionInterval,
+                               [this]() { return std::exchange(retention_due_, false); });
+    }
 }
 
-std::optional<std::vector<LogEntry>> Database::getLogs(int limit)
+void Database::enforceRetention(const std::stop_token& stop_token)
 {
-    if (!db_)
+    struct Partition
     {
-        return std::nullopt;
+        long long first_id;
+        long long last_id;
+        long long bytes;
+        bool expired;
+    };
+
+    RetentionPolicy policy;
+    {
+        std::lock_guard<std::mutex> lock(retention_mutex_);
+        policy = retention_;
     }
 
-    std::vector<LogEntry> logs;
-    const char* sql =
-        "SELECT id, timestamp, method, endpoint, model, request_body, "
-        "response_status, response_body, duration_ms, prompt_tokens, "
-        "completion_tokens, prompt_eval_duration_ms, eval_duration_ms, "
-        "ttft_ms, is_starred FROM requests ORDER BY id DESC LIMIT ?";
+    // Age and volume limits drop whole days, oldest first
+    std::vector<Partition> partitions;
+    long long total_bytes = 0;
+    {
+        std::lock_guard<std::mutex> writer_lock(writer_mutex_);
+        Statement select = writer_statements_->prepare(kSelectPartitionsSql);
+        const std::string age = "-" + std::to_string(policy.max_days) + " days";
+        sqlite3_bind_text(select.get(), 1, age.c_str(), -1, SQLITE_TRANSIENT);
+        while (sqlite3_step(select.get()) == SQLITE_ROW)
+        {
+            partitions.push_back(Partition{
+                .first_id = sqlite3_column_int64(select.get(), 0),
+                .last_id = sqlite3_column_int64(select.get(), 1),
+                .bytes = sqlite3_column_int64(select.get(), 2),
+                .expired = policy.max_days > 0 && sqlite3_column_int(select.get(), 3) != 0});
+            total_bytes += partitions.back().bytes;
+        }
+    }
 
-    sqlite3_stmt* stmt;
-    if (sqlite3_prepare_v2(db_, sql, -1, &stmt, nullptr) != SQLITE_OK)
+    // The newest partition is still being written and is never dropped whole
+    long long dropped = 0;
+    for (size_t i = 0; i + 1 < partitions.size() && !stop_token.stop_requested(); ++i)
     {
-        return std::nullopt;
+        const Partition& partition = partitions[i];
+        bool over_budget = policy.max_bytes > 0 && total_bytes > policy.max_bytes;
+        if (!partition.expired && !over_budget)
+        {
+            break;
+        }
+        dropped += dropRange(partition.first_id, partition.last_id, stop_token);
+        refreshPartitions(partition.first_id, partition.last_id);
+        total_bytes -= partition.bytes;
     }
 
-    sqlite3_bind_int(stmt, 1, limit);
+    // Still over the volume limit means the newest day alone exceeds it, so
+    // its oldest entries are trimmed until the rest fits
+    if (policy.max_bytes > 0 && total_bytes > policy.max_bytes && !partitions.empty() &&
+        !stop_token.stop_requested())
+    {
+        const Partition& newest = partitions.back();
+        long long cutoff_id = newest.last_id;
+        {
+            std::lock_guard<std::mutex> writer_lock(writer_mutex_);
+            Statement select = writer_statements_->prepare(kSelectByteCutoffSql);
+            sqlite3_bind_int64(select.get(), 1, newest.first_id);
+            sqlite3_bind_int64(select.get(), 2, total_bytes - policy.max_bytes);
+            if (sqlite3_step(select.get()) == SQLITE_ROW)
+            {
+                cutoff_id = sqlite3_column_int64(select.get(), 0);
+            }
+        }
+        long long trimmed = dropRange(newest.first_id, cutoff_id, stop_token);
+        if (trimmed > 0)
+        {
+            refreshPartitions(newest.first_id, cutoff_id);
+        }
+        dropped += trimmed;
+    }
 
-    while (sqlite3_step(stmt) == SQLITE_ROW)
+    // The row limit trims within a day
+    if (policy.max_rows > 0 && !stop_token.stop_requested())
     {
-        LogEntry entry;
-        entry.id = sqlite3_column_int(stmt, 0);
+        long long cutoff_id = 0;
+        {
+            std::lock_guard<std::mutex> writer_lock(writer_mutex_);
+            cutoff_id = last_log_id_ - policy.max_rows;
+        }
+        if (cutoff_id > 0)
+        {
+            long long trimmed = dropRange(0, cutoff_id, stop_token);
+            if (trimmed > 0)
+            {
+                refreshPartitions(0, cutoff_id);
+            }
+            dropped += trimmed;
+        }
+    }
 
-        const unsigned char* ts = sqlite3_column_text(stmt, 1);
-        entry.timestamp = ts ? reinterpret_cast<const char*>(ts) : "";
+    // Minute rollups age out; hour rollups are small enough to keep
+    {
+        const int64_t cutoff =
+            std::chrono::duration_cast<std::chrono::seconds>(
+                (std::chrono::system_clock::now() - kMinuteRollupRetention).time_since_epoch())
+                .count();
+        std::lock_guard<std::mutex> writer_lock(writer_mutex_);
+        Statement prune = writer_statements_->prepare(kPruneRollupsSql);
+        sqlite3_bind_int(prune.get(), 1, static_cast<int>(RollupResolution::Minute));
+        sqlite3_bind_int64(prune.get(), 2, cutoff);
+        if (sqlite3_step(prune.get()) != SQLITE_DONE)
+        {
+            std::cerr << "Failed to prune metric rollups: " << sqlite3_errmsg(db_) << std::endl;
+        }
+    }
 
-        const unsigned char* m = sqlite3_column_text(stmt, 2);
-        entry.method = m ? reinterpret_cast<const char*>(m) : "";
+    dropped += enforceCacheBudget(stop_token);
 
-        const unsigned char* ep = sqlite3_column_text(stmt, 3);
-        entry.endpoint = ep ? reinterpret_cast<const char*>(ep) : "";
+    if (dropped > 0)
+    {
+        std::lock_guard<std::mutex> writer_lock(writer_mutex_);
+        const std::string vacuum =
+            "PRAGMA incremental_vacuum(" + std::to_string(kVacuumPagesPerPass) + ");";
+        sqlite3_exec(db_, vacuum.c_str(), nullptr, nullptr, nullptr);
+    }
+}
 
-        const unsigned char* model = sqlite3_column_text(stmt, 4);
-        entry.model = model ? reinterpret_cast<const char*>(model) : "";
+void Database::backfillSearch(const std::stop_token& stop_token)
+{
+    long long next_id = 0;
+    {
+        std::lock_guard<std::mutex> writer_lock(writer_mutex_);
+        Statement select = writer_statements_->prepare(kSelectBackfillCursorSql);
+        if (sqlite3_step(select.get()) == SQLITE_ROW)
+        {
+            next_id = sqlite3_column_int64(select.get(), 0);
+        }
+    }
 
-        const unsigned char* req = sqlite3_column_text(stmt, 5);
-        entry.request_body = req ? reinterpret_cast<const char*>(req) : "";
+    struct Unindexed
+    {
+        long long id;
+        std::string prompt;
+        std::string response;
+    };
 
-        entry.response_status = sqlite3_column_int(stmt, 6);
+    // Bodies are decoded on a reader so the writer is held only for the inserts;
+    // entries are deleted on this thread alone, so none vanish in between
+    while (next_id > 0 && !stop_token.stop_requested())
+    {
+        std::vector<Unindexed> chunk;
+        long long scanned = 0;
+        long long oldest_id = next_id;
+        {
+            auto reader = read_pool_.acquire();
+            Statement select = reader.prepare(kSelectBackfillSql);
+            if (!select)
+            {
+                return;
+            }
+            sqlite3_stmt* stmt = select.get();
+            sqlite3_bind_int64(stmt, 1, next_id);
+            sqlite3_bind_int(stmt, 2, kSearchBackfillChunkRows);
+            while (sqlite3_step(stmt) == SQLITE_ROW)
+            {
+                ++scanned;
+                oldest_id = sqlite3_column_int64(stmt, 0);
+                std::string prompt = SearchText::fromRequest(readBody(
+                    stmt, 1, 5, static_cast<size_t>(sqlite3_column_int64(stmt, 3)), codec_));
+                std::string response = SearchText::fromResponse(readBody(
+                    stmt, 2, 8, static_cast<size_t>(sqlite3_column_int64(stmt, 4)), codec_));
+                if (!prompt.empty() || !response.empty())
+                {
+                    chunk.push_back(Unindexed{.id = oldest_id,
+                                              .prompt = std::move(prompt),
+                                              .response = std::move(response)});
+                }
+            }
+        }
+        const long long cursor = scanned < kSearchBackfillChunkRows ? 0 : oldest_id - 1;
 
-        const unsigned char* res = sqlite3_column_text(stmt, 7);
-        entry.response_body = res ? reinterpret_cast<const char*>(res) : "";
+        std::lock_guard<std::mutex> writer_lock(writer_mutex_);
+        if (sqlite3_exec(db_, "BEGIN IMMEDIATE;", nullptr, nullptr, nullptr) != SQLITE_OK)
+        {
+            std::cerr << "Failed to back-fill the search index: " << sqlite3_errmsg(db_)
+                      << std::endl;
+            return;
+        }
+        for (const Unindexed& entry : chunk)
+        {
+            indexSearchText(entry.id, entry.prompt, entry.response);
+        }
+        Statement update = writer_statements_->prepare(kUpdateBackfillCursorSql);
+        sqlite3_bind_int64(update.get(), 1, cursor);
+        if (sqlite3_step(update.get()) != SQLITE_DONE ||
+            sqlite3_exec(db_, "COMMIT;", nullptr, nullptr, nullptr) != SQLITE_OK)
+        {
+            std::cerr << "Failed to back-fill the search index: " << sqlite3_errmsg(db_)
+                      << std::endl;
+            sqlite3_exec(db_, "ROLLBACK;", nullptr, nullptr, nullptr);
+            return;
+        }
+        next_id = cursor;
+    }
+}
 
-        entry.duration_ms = sqlite3_column_int64(stmt, 8);
-        entry.prompt_tokens = sqlite3_column_int(stmt, 9);
-        entry.completion_tokens = sqlite3_column_int(stmt, 10);
-        entry.prompt_eval_duration_ms = sqlite3_column_int64(stmt, 11);
-        entry.eval_duration_ms = sqlite3_column_int64(stmt, 12);
-        entry.ttft_ms = sqlite3_column_int64(stmt, 13);
-        entry.is_starred = sqlite3_column_int(stmt, 14) != 0;
+long long Database::dropRange(long long first_id, long long last_id,
+                              const std::stop_token& stop_token)
+{
+    long long dropped = 0;
+    while (!stop_token.stop_requested())
+    {
+        // Logging goes between chunks; a large day is many of them
+        if (dropped > 0)
+        {
+            yieldToWriter(stop_token);
+        }
+        std::lock_guard<std::mutex> writer_lock(writer_mutex_);
+        Statement drop = writer_statements_->prepare(kDropRangeSql);
+        sqlite3_bind_int64(drop.get(), 1, first_id);
+        sqlite3_bind_int64(drop.get(), 2, last_id);
+        sqlite3_bind_int(drop.get(), 3, kRetentionChunkRows);
+        if (sqlite3_step(drop.get()) != SQLITE_DONE)
+        {
+            std::cerr << "Failed to enforce retention: " << sqlite3_errmsg(db_) << std::endl;
+            break;
+        }
 
-        logs.push_back(entry);
+        int deleted = sqlite3_changes(db_);
+        dropped += deleted;
+        if (deleted < kRetentionChunkRows)
+        {
+            break;
+        }
     }
+    return dropped;
+}
 
-    sqlite3_finalize(stmt);
-    return logs;
+void Database::yieldToWriter(const std::stop_token& stop_token)
+{
+    // std::mutex is not fair: without this, the retention thread could retake
+    // the connection for its next chunk ahead of a waiting batch
+    const auto deadline = std::chrono::steady_clock::now() + kRetentionMaxYield;
+    while (!stop_token.stop_requested() && std::chrono::steady_clock::now() < deadline &&
+           (batches_waiting_ > 0 || write_queue_.stats().depth > 0))
+    {
+        std::this_thread::sleep_for(kRetentionYieldPoll);
+    }
 }
 
-std::optional<std::pair<int, std::string>>
-Database::getCachedResponse(const std::string& request_body)
+long long Database::enforceCacheBudget(const std::stop_token& stop_token)
 {
-    if (!db_)
+    // Expired entries go first, whatever the budget
+    long long expired = 0;
+    const int64_t now = unixNow();
+    while (!stop_token.stop_requested())
     {
-        return std::nullopt;
+        if (expired > 0)
+        {
+            yieldToWriter(stop_token);
+        }
+        std::lock_guard<std::mutex> writer_lock(writer_mutex_);
+        Statement expire = writer_statements_->prepare(kExpireCacheSql);
+        sqlite3_bind_int64(expire.get(), 1, now);
+        sqlite3_bind_int(expire.get(), 2, kRetentionChunkRows);
+        if (sqlite3_step(expire.get()) != SQLITE_DONE)
+        {
+            std::cerr << "Failed to expire cache entries: " << sqlite3_errmsg(db_) << std::endl;
+            break;
+        }
+        int deleted = sqlite3_changes(db_);
+        expired += deleted;
+        if (deleted < kRetentionChunkRows)
+        {
+            break;
+        }
     }
+    cache_expired_ += expired;
 
-    const char* sql =
-        "SELECT response_status, response_body FROM cache WHERE request_body = ?";
+    long long entries = 0;
+    long long bytes = 0;
+    {
+        std::lock_guard<std::mutex> writer_lock(writer_mutex_);
+        Statement totals = writer_statements_->prepare(kCacheTotalsSql);
+        if (sqlite3_step(totals.get()) == SQLITE_ROW)
+        {
+            entries = sqlite3_column_int64(totals.get(), 0);
+            bytes = sqlite3_column_int64(totals.get(), 1);
+        }
+    }
 
-    sqlite3_stmt* stmt;
-    if (sqlite3_prepare_v2(db_, sql, -1, &stmt, nullptr) != SQLITE_OK)
+    // Then least recently used entries, a bounded batch per transaction,
+    // until the bodies fit the budget
+    long long evicted = 0;
+    const long long max_bytes = cache_max_bytes_.load();
+    while (max_bytes > 0 && bytes > max_bytes && !stop_token.stop_requested())
     {
-        return std::nullopt;
+        std::lock_guard<std::mutex> writer_lock(writer_mutex_);
+        std::vector<std::pair<std::string, long long>> victims;
+        {
+            Statement select = writer_statements_->prepare(kSelectEvictionSql);
+            sqlite3_bind_int(select.get(), 1, kCacheEvictionChunk);
+            long long freed = 0;
+            while (bytes - freed > max_bytes && sqlite3_step(select.get()) == SQLITE_ROW)
+            {
+                victims.emplace_back(std::string(columnBlob(select.get(), 0)),
+                                     sqlite3_column_int64(select.get(), 1));
+                freed += victims.back().second;
+            }
+        }
+        if (victims.empty())
+        {
+            break;
+        }
+
+        if (sqlite3_exec(db_, "BEGIN IMMEDIATE;", nullptr, nullptr, nullptr) != SQLITE_OK)
+        {
+            std::cerr << "Failed to evict cache entries: " << sqlite3_errmsg(db_) << std::endl;
+            break;
+        }
+        const long long evicted_before = evicted;
+        for (const auto& [key, size] : victims)
+        {
+            Statement remove = writer_statements_->prepare(kDeleteCacheEntrySql);
+            sqlite3_bind_blob(remove.get(), 1, key.data(), static_cast<int>(key.size()),
+                              SQLITE_STATIC);
+            if (sqlite3_step(remove.get()) == SQLITE_DONE && sqlite3_changes(db_) > 0)
+            {
+                bytes -= size;
+                --entries;
+                ++evicted;
+            }
+        }
+        if (sqlite3_exec(db_, "COMMIT;", nullptr, nullptr, nullptr) != SQLITE_OK ||
+            evicted == evicted_before)
+        {
+            std::cerr << "Failed to evict cache entries: " << sqlite3_errmsg(db_) << std::endl;
+            sqlite3_exec(db_, "ROLLBACK;", nullptr, nullptr, nullptr);
+            break;
+        }
     }
+    cache_evicted_ += evicted;
 
-    sqlite3_bind_text(stmt, 1, request_body.c_str(), -1, SQLITE_STATIC);
+    cache_entries_ = entries;
+    cache_bytes_ = bytes;
+    return expired + evicted;
+}
 
-    std::optional<std::pair<int, std::string>> result = std::nullopt;
-    if (sqlite3_step(stmt) == SQLITE_ROW)
+void Database::refreshPartitions(long long first_id, long long last_id)
+{
+    std::lock_guard<std::mutex> writer_lock(writer_mutex_);
+    Statement refresh = writer_statements_->prepare(kRefreshPartitionsSql);
+    sqlite3_bind_int64(refresh.get(), 1, first_id);
+    sqlite3_bind_int64(refresh.get(), 2, last_id);
+    if (sqlite3_step(refresh.get()) != SQLITE_DONE)
     {
-        int status = sqlite3_column_int(stmt, 0);
-        const unsigned char* body = sqlite3_column_text(stmt, 1);
-        result = {status, body ? reinterpret_cast<const char*>(body) : ""};
+        std::cerr << "Failed to refresh log partitions: " << sqlite3_errmsg(db_) << std::endl;
+        return;
     }
 
-    sqlite3_finalize(stmt);
-    return result;
+    Statement drop_empty = writer_statements_->prepare(kDropEmptyPartitionsSql);
+    sqlite3_step(drop_empty.get());
 }
 
-std::optional<std::string> Database::cacheResponse(
-    const std::string& request_body,
-    int response_status,
-    const std::string& response_body)
+void Database::logInteractionAsync(LogRecord record)
+{
+    write_queue_.push(std::move(record));
+}
+
+std::optional<std::string> Database::logInteractionSync(const LogRecord& record)
 {
     if (!db_)
     {
         return "Database not initialized";
     }
 
-    const char* sql =
-        "INSERT OR REPLACE INTO cache (request_body, response_status, response_body) "
-        "VALUES (?, ?, ?)";
+    const std::string_view response_body =
+        record.response_body ? std::string_view(*record.response_body) : std::string_view();
+    const auto request_blob = storeBlob(record.request_body);
+    const auto response_blob = storeBlob(response_body);
+
+    Statement insert = writer_statements_->prepare(kInsertLogSql);
+    sqlite3_stmt* stmt = insert.get();
+    sqlite3_bind_text(stmt, 1, record.method.c_str(), -1, SQLITE_STATIC);
+    sqlite3_bind_text(stmt, 2, record.endpoint.c_str(), -1, SQLITE_STATIC);
+    sqlite3_bind_text(stmt, 3, record.model.c_str(), -1, SQLITE_STATIC);
+    bindBlobId(stmt, 4, request_blob);
+    sqlite3_bind_int64(stmt, 5, static_cast<sqlite3_int64>(record.request_body.size()));
+    sqlite3_bind_int(stmt, 6, record.response_status);
+    bindBlobId(stmt, 7, response_blob);
+    sqlite3_bind_int64(stmt, 8, static_cast<sqlite3_int64>(response_body.size()));
+    sqlite3_bind_int64(stmt, 9, record.duration_ms);
+    sqlite3_bind_int(stmt, 10, record.prompt_tokens);
+    sqlite3_bind_int(stmt, 11, record.completion_tokens);
+    sqlite3_bind_int64(stmt, 12, record.prompt_eval_duration_ms);
+    sqlite3_bind_int64(stmt, 13, record.eval_duration_ms);
+    sqlite3_bind_int64(stmt, 14, record.ttft_ms);
+    sqlite3_bind_int(stmt, 15, record.cache_hit ? 1 : 0);
+    sqlite3_bind_int64(stmt, 16, record.queue_wait_ms);
+    sqlite3_bind_text(stmt, 17, record.backend.c_str(), -1, SQLITE_STATIC);
+    const std::string trace = encodeTrace(record.trace);
+    if (trace.empty())
+    {
+        sqlite3_bind_null(stmt, 18);
+    }
+    else
+    {
+        sqlite3_bind_blob(stmt, 18, trace.data(), static_cast<int>(trace.size()),
+                          SQLITE_STATIC);
+    }
+    sqlite3_bind_int(stmt, 19, static_cast<int>(record.capture));
 
-    sqlite3_stmt* stmt;
-    if (sqlite3_prepare_v2(db_, sql, -1, &stmt, nullptr) != SQLITE_OK)
+    std::optional<std::string> result = std::nullopt;
+    if (sqlite3_step(stmt) != SQLITE_DONE)
     {
-        return std::string(sqlite3_errmsg(db_));
+        result = "Execution failed: " + std::string(sqlite3_errmsg(db_));
+    }
+    else
+    {
+        last_log_id_ = sqlite3_last_insert_rowid(db_);
+        indexSearchText(last_log_id_, SearchText::fromRequest(record.request_body),
+                        SearchText::fromResponse(response_body));
+    }
+    return result;
+}
+
+void Database::indexSearchText(long long id, const std::string& prompt,
+                               const std::string& response)
+{
+    if (prompt.empty() && response.empty())
+    {
+        return;
+    }
+
+    Statement insert = writer_statements_->prepare(kInsertSearchSql);
+    sqlite3_bind_int64(insert.get(), 1, id);
+    sqlite3_bind_text(insert.get(), 2, prompt.data(), static_cast<int>(prompt.size()),
+                      SQLITE_STATIC);
+    sqlite3_bind_text(insert.get(), 3, response.data(), static_cast<int>(response.size()),
+                      SQLITE_STATIC);
+    if (sqlite3_step(insert.get()) != SQLITE_DONE)
+    {
+        std::cerr << "Failed to index log entry " << id << ": " << sqlite3_errmsg(db_)
+                  << std::endl;
+    }
+}
+
+std::optional<int64_t> Database::storeBlob(std::string_view body)
+{
+    if (body.empty())
+    {
+        return std::nullopt;
     }
 
-    sqlite3_bind_text(stmt, 1, request_body.c_str(), -1, SQLITE_STATIC);
-    sqlite3_bind_int(stmt, 2, response_status);
-    sqlite3_bind_text(stmt, 3, response_body.c_str(), -1, SQLITE_STATIC);
+    // Content-addressed: identical bodies (a cached response and the request
+    // that produced it, repeated prompts) are stored once
+    const auto hash = hash128(body).toBytes();
+    {
+        Statement find = writer_statements_->prepare(kFindBlobSql);
+        sqlite3_bind_blob(find.get(), 1, hash.data(), static_cast<int>(hash.size()),
+                          SQLITE_STATIC);
+        if (sqlite3_step(find.get()) == SQLITE_ROW)
+        {
+            return sqlite3_column_int64(find.get(), 0);
+        }
+    }
+
+    if (codec_.addSample(body))
+    {
+        dictionary_pending_ = true;
+    }
+    const auto encoded = codec_.encode(body);
 
+    Statement insert = writer_statements_->prepare(kInsertBlobSql);
+    sqlite3_stmt* stmt = insert.get();
+    sqlite3_bind_blob(stmt, 1, hash.data(), static_cast<int>(hash.size()), SQLITE_STATIC);
+    sqlite3_bind_int(stmt, 2, static_cast<int>(encoded.encoding));
+    if (encoded.dictionary_id != 0)
+    {
+        sqlite3_bind_int64(stmt, 3, encoded.dictionary_id);
+    }
+    else
+    {
+        sqlite3_bind_null(stmt, 3);
+    }
+    sqlite3_bind_int64(stmt, 4, static_cast<sqlite3_int64>(body.size()));
+    sqlite3_bind_blob(stmt, 5, encoded.data.data(), static_cast<int>(encoded.data.size()),
+                      SQLITE_STATIC);
     if (sqlite3_step(stmt) != SQLITE_DONE)
     {
-        std::string err = sqlite3_errmsg(db_);
-        sqlite3_finalize(stmt);
-        return err;
+        std::cerr << "Failed to store body: " << sqlite3_errmsg(db_) << std::endl;
+        return std::nullopt;
+    }
+    return sqlite3_last_insert_rowid(db_);
+}
+
+void Database::bindBlobId(sqlite3_stmt* stmt, int index, const std::optional<int64_t>& id)
+{
+    if (id)
+    {
+        sqlite3_bind_int64(stmt, index, *id);
+    }
+    else
+    {
+        sqlite3_bind_null(stmt, index);
     }
+}
 
+void Database::loadDictionaries()
+{
+    sqlite3_stmt* stmt;
+    if (sqlite3_prepare_v2(db_, kSelectDictionariesSql, -1, &stmt, nullptr) != SQLITE_OK)
+    {
+        return;
+    }
+    while (sqlite3_step(stmt) == SQLITE_ROW)
+    {
+        codec_.addDictionary(sqlite3_column_int64(stmt, 0), std::string(columnBlob(stmt, 1)));
+    }
     sqlite3_finalize(stmt);
-    return std::nullopt;
 }
 
-Metrics Database::getMetrics()
+void Database::trainDictionary()
 {
-    Metrics m = {0, 0.0, 0.0};
-    if (!db_)
+    dictionary_pending_ = false;
+    auto dictionary = codec_.trainDictionary();
+    if (!dictionary)
     {
-        return m;
+        return;
     }
 
-    // Total Requests
-    const char* sql_total = "SELECT COUNT(*) FROM requests";
+    // Persisted in its own transaction before any body is encoded with it,
+    // so a stored blob never references a dictionary that was rolled back
     sqlite3_stmt* stmt;
-    if (sqlite3_prepare_v2(db_, sql_total, -1, &stmt, nullptr) == SQLITE_OK)
+    if (sqlite3_prepare_v2(db_, kInsertDictionarySql, -1, &stmt, nullptr) != SQLITE_OK)
     {
-        if (sqlite3_step(stmt) == SQLITE_ROW)
+        return;
+    }
+    sqlite3_bind_blob(stmt, 1, dictionary->data(), static_cast<int>(dictionary->size()),
+                      SQLITE_STATIC);
+    if (sqlite3_step(stmt) == SQLITE_DONE)
+    {
+        const int64_t id = sqlite3_last_insert_rowid(db_);
+        codec_.addDictionary(id, std::move(*dictionary));
+        std::cout << "Trained body compression dictionary " << id << std::endl;
+    }
+    else
+    {
+        std::cerr << "Failed to store compression dictionary: " << sqlite3_errmsg(db_)
+                  << std::endl;
+    }
+    sqlite3_finalize(stmt);
+}
+
+std::optional<std::vector<LogEntry>> Database::getLogs(int limit)
+{
+    auto reader = read_pool_.acquire();
+    Statement select = reader.prepare(kSelectLogsSql);
+    if (!select)
+    {
+        return std::nullopt;
+    }
+
+    std::vector<LogEntry> logs;
+    sqlite3_bind_int(select.get(), 1, limit);
+    while (sqlite3_step(select.get()) == SQLITE_ROW)
+    {
+        logs.push_back(readLogEntry(select.get(), &codec_));
+    }
+    return logs;
+}
+
+std::optional<LogPage> Database::queryLogs(const LogQuery& query)
+{
+    // Each filter adds a fixed clause, so the statement cache holds one
+    // statement per combination of filters in use rather than per value
+    std::string sql(kQueryLogsSql);
+    std::vector<std::variant<long long, std::string>> params;
+    auto filter = [&](const char* clause, std::variant<long long, std::string> value)
+    {
+        sql += clause;
+        params.push_back(std::move(value));
+    };
+
+    if (query.before_id > 0)
+    {
+        filter(" AND id < ?", query.before_id);
+    }
+    if (!query.model.empty())
+    {
+        filter(" AND model = ?", query.model);
+    }
+    if (!query.endpoint.empty())
+    {
+        filter(" AND endpoint = ?", query.endpoint);
+    }
+    if (query.status)
+    {
+        filter(" AND response_status = ?", static_cast<long long>(*query.status));
+    }
+    if (!query.since.empty())
+    {
+        filter(" AND timestamp >= ?", query.since);
+    }
+    if (!query.until.empty())
+    {
+        filter(" AND timestamp <= ?", query.until);
+    }
+    if (query.starred)
+    {
+        sql += *query.starred ? " AND is_starred = 1" : " AND is_starred = 0";
+    }
+    if (query.min_duration_ms > 0)
+    {
+        filter(" AND duration_ms >= ?", query.min_duration_ms);
+    }
+    if (query.max_duration_ms > 0)
+    {
+        filter(" AND duration_ms <= ?", query.max_duration_ms);
+    }
+    if (!query.text.empty())
+    {
+        filter(" AND id IN (SELECT rowid FROM requests_fts WHERE requests_fts MATCH ?)",
+               query.text);
+    }
+
+    // One row beyond the page tells whether another page follows
+    const int limit = std::clamp(query.limit, 1, kMaxPageSize);
+    sql += " ORDER BY id DESC LIMIT ?";
+    params.push_back(static_cast<long long>(limit) + 1);
+
+    auto reader = read_pool_.acquire();
+    Statement select = reader.prepare(sql);
+    if (!select)
+    {
+        return std::nullopt;
+    }
+
+    for (size_t i = 0; i < params.size(); ++i)
+    {
+        const int index = static_cast<int>(i) + 1;
+        if (const auto* number = std::get_if<long long>(&params[i]))
         {
-            m.total_requests = sqlite3_column_int(stmt, 0);
+            sqlite3_bind_int64(select.get(), index, *number);
+        }
+        else
+        {
+            const auto& text = std::get<std::string>(params[i]);
+            sqlite3_bind_text(select.get(), index, text.data(), static_cast<int>(text.size()),
+                              SQLITE_STATIC);
         }
-        sqlite3_finalize(stmt);
     }
 
-    // Avg Latency
-    const char* sql_latency = "SELECT AVG(duration_ms) FROM requests";
-    if (sqlite3_prepare_v2(db_, sql_latency, -1, &stmt, nullptr) == SQLITE_OK)
+    LogPage page;
+    int rc;
+    while ((rc = sqlite3_step(select.get())) == SQLITE_ROW)
     {
-        if (sqlite3_step(stmt) == SQLITE_ROW)
+        if (page.entries.size() == static_cast<size_t>(limit))
         {
-            m.avg_latency_ms = sqlite3_column_double(stmt, 0);
+            page.next_cursor = page.entries.back().id;
+            break;
         }
-        sqlite3_finalize(stmt);
+        page.entries.push_back(readLogEntry(select.get(), nullptr));
     }
+    if (rc != SQLITE_ROW && rc != SQLITE_DONE)
+    {
+        return std::nullopt;
+    }
+    return page;
+}
 
-    // Cache Hit Rate (cache hits are marked with duration_ms = 0)
-    const char* hit_sql = "SELECT COUNT(*) FROM requests WHERE duration_ms = 0";
-    sqlite3_stmt* hit_stmt;
-    if (sqlite3_prepare_v2(db_, hit_sql, -1, &hit_stmt, nullptr) == SQLITE_OK)
+std::optional<std::vector<LogEntry>> Database::getLogSummaries(long long after_id, int limit)
+{
+    auto reader = read_pool_.acquire();
+    Statement select = reader.prepare(kSelectLogSummariesSql);
+    if (!select)
     {
-        if (sqlite3_step(hit_stmt) == SQLITE_ROW)
+        return std::nullopt;
+    }
+
+    std::vector<LogEntry> logs;
+    sqlite3_bind_int64(select.get(), 1, after_id);
+    sqlite3_bind_int(select.get(), 2, limit);
+    while (sqlite3_step(select.get()) == SQLITE_ROW)
+    {
+        logs.push_back(readLogEntry(select.get(), nullptr));
+    }
+    return logs;
+}
+
+std::optional<StoredResponse> Database::getCachedResponse(const CacheKey& key)
+{
+    auto reader = read_pool_.acquire();
+    Statement select = reader.prepare(kSelectCachedSql);
+    if (!select)
+    {
+        return std::nullopt;
+    }
+    sqlite3_stmt* stmt = select.get();
+
+    auto key_bytes = key.toBytes();
+    sqlite3_bind_blob(stmt, 1, key_bytes.data(), static_cast<int>(key_bytes.size()),
+                      SQLITE_STATIC);
+    sqlite3_bind_int64(stmt, 2, unixNow());
+
+    std::optional<StoredResponse> result = std::nullopt;
+    if (sqlite3_step(stmt) == SQLITE_ROW)
+    {
+        StoredResponse stored;
+        stored.status = sqlite3_column_int(stmt, 0);
+        stored.expires_at = sqlite3_column_int64(stmt, 7);
+        stored.body = readBody(stmt, 1, 3, static_cast<size_t>(sqlite3_column_int64(stmt, 6)),
+                               codec_);
+        if (sqlite3_column_type(stmt, 2) != SQLITE_NULL)
         {
-            int hits = sqlite3_column_int(hit_stmt, 0);
-            if (m.total_requests > 0)
-            {
-                m.cache_hit_rate = static_cast<double>(hits) / m.total_requests;
-            }
+            stored.chunks = decodeChunkIndex(columnBlob(stmt, 2), stored.body.size());
         }
-        sqlite3_finalize(hit_stmt);
+        result = std::move(stored);
     }
+    return result;
+}
 
-    return m;
+void Database::cacheResponseAsync(
+    const CacheKey& key,
+    int response_status,
+    std::shared_ptr<const std::string> response_body,
+    std::shared_ptr<const ChunkIndex> chunks,
+    int64_t expires_at)
+{
+    write_queue_.push(CacheRecord{.key = key,
+                                  .response_status = response_status,
+                                  .response_body = std::move(response_body),
+                                  .chunks = std::move(chunks),
+                                  .expires_at = expires_at,
+                                  .generation = cache_generation_.load()});
 }
 
-std::optional<LogEntry> Database::getLog(int id)
+void Database::touchCachedResponseAsync(const CacheKey& key)
+{
+    write_queue_.push(CacheTouch{key});
+}
+
+std::optional<long long> Database::flushCachedResponses()
 {
     if (!db_)
     {
         return std::nullopt;
     }
 
-    const char* sql =
-        "SELECT id, timestamp, method, endpoint, model, request_body, "
-        "response_status, response_body, duration_ms, prompt_tokens, "
-        "completion_tokens, prompt_eval_duration_ms, eval_duration_ms, "
-        "ttft_ms, is_starred FROM requests WHERE id = ?";
+    // Entries still queued were cached before the flush and are dropped by
+    // the writer instead of resurrecting them
+    cache_generation_.fetch_add(1);
 
-    sqlite3_stmt* stmt;
-    if (sqlite3_prepare_v2(db_, sql, -1, &stmt, nullptr) != SQLITE_OK)
+    std::lock_guard<std::mutex> writer_lock(writer_mutex_);
+    Statement flush = writer_statements_->prepare(kFlushCacheSql);
+    if (!flush || sqlite3_step(flush.get()) != SQLITE_DONE)
     {
+        std::cerr << "Failed to flush the response cache: " << sqlite3_errmsg(db_) << std::endl;
         return std::nullopt;
     }
+    const long long flushed = sqlite3_changes(db_);
+    cache_flushed_ += flushed;
+    cache_entries_ = 0;
+    cache_bytes_ = 0;
+    return flushed;
+}
+
+void Database::setRetention(const RetentionPolicy& policy, long long cache_max_bytes)
+{
+    const bool cache_changed = cache_max_bytes_.exchange(cache_max_bytes) != cache_max_bytes;
+    {
+        std::lock_guard<std::mutex> lock(retention_mutex_);
+        const bool changed = policy.max_rows != retention_.max_rows ||
+                             policy.max_days != retention_.max_days ||
+                             policy.max_bytes != retention_.max_bytes;
+        if (!changed && !cache_changed)
+        {
+            return;
+        }
+        retention_ = policy;
+        retention_due_ = true;
+    }
+    retention_cv_.notify_one();
+}
 
-    sqlite3_bind_int(stmt, 1, id);
+CacheDiskStats Database::getCacheDiskStats() const
+{
+    return CacheDiskStats{.entries = cache_entries_.load(),
+                          .bytes = cache_bytes_.load(),
+                          .max_bytes = cache_max_bytes_.load(),
+                          .evicted = cache_evicted_.load(),
+                          .expired = cache_expired_.load(),
+                          .flushed = cache_flushed_.load()};
+}
 
-    std::optional<LogEntry> result = std::nullopt;
-    if (sqlite3_step(stmt) == SQLITE_ROW)
+std::optional<std::string> Database::touchCachedResponseSync(const CacheTouch& touch,
+                                                             int64_t now)
+{
+    Statement update = writer_statements_->prepare(kTouchCacheSql);
+    auto key_bytes = touch.key.toBytes();
+    sqlite3_bind_int64(update.get(), 1, now);
+    sqlite3_bind_blob(update.get(), 2, key_bytes.data(), static_cast<int>(key_bytes.size()),
+                      SQLITE_STATIC);
+    if (sqlite3_step(update.get()) != SQLITE_DONE)
     {
-        LogEntry entry;
-        entry.id = sqlite3_column_int(stmt, 0);
+        return std::string(sqlite3_errmsg(db_));
+    }
+    return std::nullopt;
+}
 
-        const unsigned char* ts = sqlite3_column_text(stmt, 1);
-        entry.timestamp = ts ? reinterpret_cast<const char*>(ts) : "";
+std::optional<std::string> Database::cacheResponseSync(const CacheRecord& record, int64_t now)
+{
+    if (!db_)
+    {
+        return "Database not initialized";
+    }
+    if (record.generation != cache_generation_.load())
+    {
+        return std::nullopt;  // Queued before a flush
+    }
 
-        const unsigned char* m = sqlite3_column_text(stmt, 2);
-        entry.method = m ? reinterpret_cast<const char*>(m) : "";
+    // A body that was also logged is already stored and only referenced
+    const auto body_blob = storeBlob(*record.response_body);
+
+    Statement insert = writer_statements_->prepare(kInsertCacheSql);
+    sqlite3_stmt* stmt = insert.get();
+    const std::string chunk_blob = record.chunks ? encodeChunkIndex(*record.chunks) : "";
+    auto key_bytes = record.key.toBytes();
+    sqlite3_bind_blob(stmt, 1, key_bytes.data(), static_cast<int>(key_bytes.size()),
+                      SQLITE_STATIC);
+    sqlite3_bind_int(stmt, 2, record.response_status);
+    bindBlobId(stmt, 3, body_blob);
+    sqlite3_bind_blob(stmt, 4, chunk_blob.data(), static_cast<int>(chunk_blob.size()),
+                      SQLITE_STATIC);
+    sqlite3_bind_int64(stmt, 5, static_cast<sqlite3_int64>(record.response_body->size()));
+    sqlite3_bind_int64(stmt, 6, record.expires_at);
+    sqlite3_bind_int64(stmt, 7, now);
+
+    std::optional<std::string> result = std::nullopt;
+    if (sqlite3_step(stmt) != SQLITE_DONE)
+    {
+        result = std::string(sqlite3_errmsg(db_));
+    }
+    return result;
+}
 
-        const unsigned char* ep = sqlite3_column_text(stmt, 3);
-        entry.endpoint = ep ? reinterpret_cast<const char*>(ep) : "";
+Metrics Database::getMetrics()
+{
+    // O(1): maintained by the writer, never recomputed from the table
+    Metrics m;
+    m.total_requests = total_requests_;
+    m.cache_hits = cache_hits_;
+    if (m.total_requests > 0)
+    {
+        m.avg_latency_ms = static_cast<double>(total_duration_ms_) / m.total_requests;
+        m.cache_hit_rate = static_cast<double>(m.cache_hits) / m.total_requests;
+    }
+    return m;
+}
 
-        const unsigned char* model = sqlite3_column_text(stmt, 4);
-        entry.model = model ? reinterpret_cast<const char*>(model) : "";
+std::optional<std::vector<RollupPoint>> Database::getRollups(
+    RollupResolution resolution, int64_t since, int64_t until, const std::string& model)
+{
+    auto reader = read_pool_.acquire();
+    Statement select = reader.prepare(kSelectRollupsSql);
+    if (!select)
+    {
+        return std::nullopt;
+    }
 
-        const unsigned char* req = sqlite3_column_text(stmt, 5);
-        entry.request_body = req ? reinterpret_cast<const char*>(req) : "";
+    sqlite3_stmt* stmt = select.get();
+    sqlite3_bind_int(stmt, 1, static_cast<int>(resolution));
+    sqlite3_bind_int64(stmt, 2, since);
+    sqlite3_bind_int64(stmt, 3, until);
+    sqlite3_bind_text(stmt, 4, model.c_str(), -1, SQLITE_STATIC);
 
-        entry.response_status = sqlite3_column_int(stmt, 6);
+    std::vector<RollupPoint> points;
+    while (sqlite3_step(stmt) == SQLITE_ROW)
+    {
+        RollupPoint point;
+        point.bucket_start = sqlite3_column_int64(stmt, 0);
+        point.model = columnText(stmt, 1);
+        point.totals.requests = sqlite3_column_int64(stmt, 2);
+        point.totals.cache_hits = sqlite3_column_int64(stmt, 3);
+        point.totals.errors = sqlite3_column_int64(stmt, 4);
+        point.totals.prompt_tokens = sqlite3_column_int64(stmt, 5);
+        point.totals.completion_tokens = sqlite3_column_int64(stmt, 6);
+        point.totals.duration_ms = sqlite3_column_int64(stmt, 7);
+        point.totals.eval_duration_ms = sqlite3_column_int64(stmt, 8);
+        point.totals.ttft_ms = RollupHistogram::decode(columnBlob(stmt, 9));
+        points.push_back(std::move(point));
+    }
+    return points;
+}
 
-        const unsigned char* res = sqlite3_column_text(stmt, 7);
-        entry.response_body = res ? reinterpret_cast<const char*>(res) : "";
+std::optional<std::vector<TraceSpan>> Database::getTrace(int id)
+{
+    auto reader = read_pool_.acquire();
+    Statement select = reader.prepare(kSelectTraceSql);
+    if (!select)
+    {
+        return std::nullopt;
+    }
 
-        entry.duration_ms = sqlite3_column_int64(stmt, 8);
-        entry.prompt_tokens = sqlite3_column_int(stmt, 9);
-        entry.completion_tokens = sqlite3_column_int(stmt, 10);
-        entry.prompt_eval_duration_ms = sqlite3_column_int64(stmt, 11);
-        entry.eval_duration_ms = sqlite3_column_int64(stmt, 12);
-        entry.ttft_ms = sqlite3_column_int64(stmt, 13);
-        entry.is_starred = sqlite3_column_int(stmt, 14) != 0;
+    sqlite3_bind_int(select.get(), 1, id);
+    if (sqlite3_step(select.get()) != SQLITE_ROW)
+    {
+        return std::nullopt;
+    }
+    return decodeTrace(columnBlob(select.get(), 0));
+}
 
-        result = entry;
+std::optional<LogEntry> Database::getLog(int id)
+{
+    auto reader = read_pool_.acquire();
+    Statement select = reader.prepare(kSelectLogSql);
+    if (!select)
+    {
+        return std::nullopt;
     }
 
-    sqlite3_finalize(stmt);
-    return result;
+    sqlite3_bind_int(select.get(), 1, id);
+    if (sqlite3_step(select.get()) == SQLITE_ROW)
+    {
+        return readLogEntry(select.get(), &codec_);
+    }
+    return std::nullopt;
 }
 
 std::optional<std::string> Database::setStarred(int id, bool is_starred)
@@ -515,27 +1739,36 @@ std::optional<std::string> Database::setStarred(int id, bool is_starred)
         return "Database not initialized";
     }
 
-    const char* sql = "UPDATE requests SET is_starred = ? WHERE id = ?";
-
-    sqlite3_stmt* stmt;
-    int rc = sqlite3_prepare_v2(db_, sql, -1, &stmt, nullptr);
-    if (rc != SQLITE_OK)
+    // The writer connection is shared with the batch thread
+    std::lock_guard<std::mutex> writer_lock(writer_mutex_);
+    Statement update = writer_statements_->prepare(kSetStarredSql);
+    Statement credit = writer_statements_->prepare(kCreditPartitionSql);
+    if (!update || !credit)
     {
         return "Failed to prepare statement: " + std::string(sqlite3_errmsg(db_));
     }
 
-    sqlite3_bind_int(stmt, 1, is_starred ? 1 : 0);
-    sqlite3_bind_int(stmt, 2, id);
-
-    rc = sqlite3_step(stmt);
-    if (rc != SQLITE_DONE)
+    // Starred entries are exempt from retention, so they leave their day's
+    // counts and rejoin them when unstarred
+    if (sqlite3_exec(db_, "BEGIN IMMEDIATE;", nullptr, nullptr, nullptr) != SQLITE_OK)
+    {
+        return "Execution failed: " + std::string(sqlite3_errmsg(db_));
+    }
+    sqlite3_bind_int(update.get(), 1, is_starred ? 1 : 0);
+    sqlite3_bind_int(update.get(), 2, id);
+    bool ok = sqlite3_step(update.get()) == SQLITE_DONE;
+    if (ok && sqlite3_changes(db_) > 0)
+    {
+        sqlite3_bind_int(credit.get(), 1, is_starred ? -1 : 1);
+        sqlite3_bind_int(credit.get(), 2, id);
+        ok = sqlite3_step(credit.get()) == SQLITE_DONE;
+    }
+    if (!ok || sqlite3_exec(db_, "COMMIT;", nullptr, nullptr, nullptr) != SQLITE_OK)
     {
         std::string err = "Execution failed: " + std::string(sqlite3_errmsg(db_));
-        sqlite3_finalize(stmt);
+        sqlite3_exec(db_, "ROLLBACK;", nullptr, nullptr, nullptr);
         return err;
     }
-
-    sqlite3_finalize(stmt);
     return std::nullopt;
 }
 
@@ -11,13 +11,23 @@
 
 #pragma once
 
+#include "body_codec.hpp"
+#include "cache_key.hpp"
+#include "log_queue.hpp"
+#include "metric_rollups.hpp"
+#include "sqlite_pool.hpp"
+
+#include <atomic>
+#include <chrono>
 #include <condition_variable>
 #include <functional>
+#include <map>
+#include <memory>
 #include <mutex>
 #include <optional>
-#include <queue>
 #include <sqlite3.h>
 #include <string>
+#include <string_view>
 #include <thread>
 #include <vector>
 
@@ -43,17 +53,94 @@ struct LogEntry
     long long prompt_eval_duration_ms;
     long long eval_duration_ms;
     long long ttft_ms;
+    long long queue_wait_ms;
     bool is_starred;
+    bool cache_hit;
+    std::string backend;
+    long long request_size;   // Body sizes in bytes, also set on summaries
+    long long response_size;
+    LogCapture capture;       // Only fully captured entries can be replayed
+};
+
+/**
+ * @brief A cached response as persisted in SQLite.
+ */
+struct StoredResponse
+{
+    int status = 0;
+    std::string body;
+    ChunkIndex chunks;       // Empty for entries stored before chunk indexing
+    int64_t expires_at = 0;  // Unix seconds; 0 never expires
+};
+
+/**
+ * @brief Filters and position of a page of log summaries.
+ *
+ * Empty or unset fields do not filter. Pages are newest first and keyed on
+ * id, so a page costs the same however deep into history it is.
+ */
+struct LogQuery
+{
+    long long before_id = 0;             // Cursor: only entries older than this (0 = newest)
+    int limit = 50;
+    std::string model;
+    std::string endpoint;
+    std::optional<int> status;
+    std::string since;                   // Inclusive UTC bounds, "YYYY-MM-DD[ HH:MM:SS]"
+    std::string until;
+    std::optional<bool> starred;
+    long long min_duration_ms = 0;
+    long long max_duration_ms = 0;
+    std::string text;                    // FTS5 query over prompts and generated text
+};
+
+/**
+ * @brief One page of log summaries.
+ */
+struct LogPage
+{
+    std::vector<LogEntry> entries;  // Without bodies
+    long long next_cursor = 0;      // before_id of the next page; 0 if this is the last
+};
+
+/**
+ * @brief How much log history is kept; a limit of 0 disables that rule.
+ *
+ * Starred entries are exempt from every rule.
+ */
+struct RetentionPolicy
+{
+    long long max_rows = 0;   // Most recent entries kept
+    int max_days = 0;         // Whole days of history kept, by UTC date
+    long long max_bytes = 0;  // Logged body bytes kept, oldest days then entries dropped first
+};
+
+/**
+ * @brief Size and eviction counters of the persisted response cache.
+ *
+ * entries and bytes are as of the last compaction pass; counters are since startup.
+ */
+struct CacheDiskStats
+{
+    long long entries = 0;
+    long long bytes = 0;      // Raw body bytes (stored compressed and deduplicated)
+    long long max_bytes = 0;  // Budget; 0 means unbounded
+    long long evicted = 0;    // Least recently used entries dropped for the budget
+    long long expired = 0;    // Entries dropped past their TTL
+    long long flushed = 0;    // Entries dropped by flushCachedResponses()
 };
 
 /**
  * @brief Aggregated metrics for the dashboard.
+ *
+ * Totals cover every request ever logged, including entries retention has deleted.
  */
 struct Metrics
 {
-    int total_requests;
-    double avg_latency_ms;
-    double cache_hit_rate;
+    long long total_requests = 0;
+    long long cache_hits = 0;
+    double avg_latency_ms = 0.0;
+    double cache_hit_rate = 0.0;
 };
 
 /**
@@ -61,7 +148,9 @@ struct Metrics
  *
  * Handles all database operations including logging, caching, and metrics.
  * Uses WAL mode for concurrent write support and async writes to avoid
- * blocking the HTTP response stream.
+ * blocking the HTTP response stream. One writer connection with cached
+ * statements applies those writes; reads go through a pool of read-only
+ * connections, so they never wait on the writer.
  */
 class Database
 {
@@ -84,34 +173,22 @@ public:
      * @brief Log a request/response interaction asynchronously.
      *
      * This method queues the log entry for async write to avoid blocking
-     * the HTTP response stream.
-     *
-     * @param method HTTP method (GET, POST, etc.).
-     * @param endpoint API endpoint.
-     * @param model The LLM model used (e.g., "llama3:latest").
-     * @param request_body Body of the request.
-     * @param response_status HTTP status code of the response.
-     * @param response_body Body of the response.
-     * @param duration_ms Duration of the request in milliseconds.
-     * @param prompt_tokens Number of prompt tokens.
-     * @param completion_tokens Number of completion tokens.
-     * @param prompt_eval_duration_ms Prompt evaluation duration in ms.
-     * @param eval_duration_ms Evaluation duration in ms.
-     * @param ttft_ms Time to first token in ms.
-     */
-    void logInteractionAsync(
-        const std::string& method,
-        const std::string& endpoint,
-        const std::string& model,
-        const std::string& request_body,
-        int response_status,
-        const std::string& response_body,
-        long long duration_ms,
-        int prompt_tokens,
-        int completion_tokens,
-        long long prompt_eval_duration_ms,
-        long long eval_duration_ms,
-        long long ttft_ms);
+     * the HTTP response stream. The queue is bounded; when it is full the
+     * configured OverflowPolicy decides whether this call waits, evicts
+     * older entries, drops the bodies or samples.
+     *
+     * @param record The interaction to log (moved into the queue).
+     */
+    void logInteractionAsync(LogRecord record);
+
+    /**
+     * @brief Get occupancy and drop counters of the async write queue.
+     * @return LogQueueStats The current queue statistics.
+     */
+    [[nodiscard]] LogQueueStats getQueueStats()
+    {
+        return write_queue_.stats();
+    }
 
     /**
      * @brief Retrieve recent logs.
@@ -122,32 +199,119 @@ public:
     [[nodiscard]] std::optional<std::vector<LogEntry>> getLogs(int limit = 50);
 
     /**
-     * @brief Get a cached response for a given request body.
-     * @param request_body The request body to look up.
-     * @return std::optional<std::pair<int, std::string>> Status code and response
-     *         body if found, nullopt otherwise.
+     * @brief Retrieve recent logs without their request/response bodies.
+     * @param after_id Only return entries with an id greater than this (0 for all).
+     * @param limit Maximum number of entries, newest first.
+     * @return std::optional<std::vector<LogEntry>> Entries with empty bodies on
+     *         success, std::nullopt on failure.
+     */
+    [[nodiscard]] std::optional<std::vector<LogEntry>> getLogSummaries(
+        long long after_id = 0, int limit = 50);
+
+    /**
+     * @brief Retrieve a filtered page of log summaries.
+     * @param query Filters, cursor and page size (clamped to kMaxPageSize).
+     * @return std::optional<LogPage> The page on success, std::nullopt on
+     *         failure (including a malformed full-text query).
+     */
+    [[nodiscard]] std::optional<LogPage> queryLogs(const LogQuery& query);
+
+    /**
+     * @brief Register a callback run on the writer thread after each commit
+     *        that added log entries.
+     *
+     * The callback should only signal another thread; it runs while the
+     * writer is blocked.
+     *
+     * @param listener The callback (empty to unregister).
+     */
+    void setCommitListener(std::function<void()> listener);
+
+    /**
+     * @brief Get a persisted cached response by key.
+     * @param key The hashed cache key of the request.
+     * @return std::optional<StoredResponse> Status, body and chunk index if
+     *         found, nullopt otherwise.
      */
-    [[nodiscard]] std::optional<std::pair<int, std::string>>
-    getCachedResponse(const std::string& request_body);
+    [[nodiscard]] std::optional<StoredResponse> getCachedResponse(const CacheKey& key);
 
     /**
-     * @brief Cache a response for a given request body.
-     * @param request_body The request body to cache.
+     * @brief Persist a cached response asynchronously on the writer thread.
+     * @param key The hashed cache key of the request.
      * @param response_status The status code to cache.
-     * @param response_body The response body to cache.
-     * @return std::optional<std::string> Error message on failure, nullopt on success.
+     * @param response_body The response body to cache (shared, not copied).
+     * @param chunks Line boundaries and timing of the body (shared, not copied).
+     * @param expires_at Unix seconds after which the entry is dropped; 0 never expires.
      */
-    std::optional<std::string> cacheResponse(
-        const std::string& request_body,
+    void cacheResponseAsync(
+        const CacheKey& key,
         int response_status,
-        const std::string& response_body);
+        std::shared_ptr<const std::string> response_body,
+        std::shared_ptr<const ChunkIndex> chunks,
+        int64_t expires_at = 0);
+
+    /**
+     * @brief Mark a cached response as used, asynchronously on the writer thread.
+     *
+     * The compaction pass evicts the least recently used entries once the
+     * bodies exceed SECTORFLUX_CACHE_DISK_MB.
+     *
+     * @param key The hashed cache key of the entry.
+     */
+    void touchCachedResponseAsync(const CacheKey& key);
+
+    /**
+     * @brief Delete every persisted cached response.
+     *
+     * Cache writes still queued at the time of the call are discarded too.
+     *
+     * @return std::optional<long long> Number of entries deleted, nullopt on failure.
+     */
+    std::optional<long long> flushCachedResponses();
+
+    /**
+     * @brief Replace the log retention policy and the persisted cache budget.
+     *
+     * A change wakes the retention thread, so tighter limits apply right away
+     * rather than at the next scheduled pass.
+     *
+     * @param policy The new retention rules.
+     * @param cache_max_bytes Byte budget of cached bodies; 0 for no limit.
+     */
+    void setRetention(const RetentionPolicy& policy, long long cache_max_bytes);
+
+    /**
+     * @brief Get size and eviction counters of the persisted response cache.
+     */
+    [[nodiscard]] CacheDiskStats getCacheDiskStats() const;
 
     /**
      * @brief Get current metrics.
+     *
+     * Served from in-memory aggregates that the writer advances as it commits
+     * entries; SQL is only used to seed them in init().
+     *
      * @return Metrics struct containing total requests, avg latency, and cache hit rate.
      */
     [[nodiscard]] Metrics getMetrics();
 
+    /**
+     * @brief Read the metric rollups of a time range.
+     *
+     * Rollups are maintained by the writer as entries commit and outlive the
+     * raw rows: minute buckets are kept for kMinuteRollupRetention, hour
+     * buckets indefinitely.
+     *
+     * @param resolution Bucket width to read.
+     * @param since First bucket start (Unix seconds), inclusive.
+     * @param until Last bucket start (Unix seconds), inclusive.
+     * @param model Only this model's buckets; empty for all models.
+     * @return std::optional<std::vector<RollupPoint>> Buckets ordered by
+     *         (model, time) on success, std::nullopt on failure.
+     */
+    [[nodiscard]] std::optional<std::vector<RollupPoint>> getRollups(
+        RollupResolution resolution, int64_t since, int64_t until, const std::string& model);
+
     /**
      * @brief Get a specific log entry by ID (for replay).
      * @param id The ID of the log entry.
@@ -155,6 +319,14 @@ public:
      */
     [[nodiscard]] std::optional<LogEntry> getLog(int id);
 
+    /**
+     * @brief Get the phase timings recorded for a log entry.
+     * @param id The ID of the log entry.
+     * @return std::optional<std::vector<TraceSpan>> The spans (empty for an
+     *         untraced entry), or nullopt if the entry does not exist.
+     */
+    [[nodiscard]] std::optional<std::vector<TraceSpan>> getTrace(int id);
+
     /**
      * @brief Set the starred status of a log entry.
      * @param id The ID of the log entry.
@@ -167,36 +339,172 @@ private:
     /**
      * @brief Internal synchronous log interaction (called by worker thread).
      */
-    std::optional<std::string> logInteractionSync(
-        const std::string& method,
-        const std::string& endpoint,
-        const std::string& model,
-        const std::string& request_body,
-        int response_status,
-        const std::string& response_body,
-        long long duration_ms,
-        int prompt_tokens,
-        int completion_tokens,
-        long long prompt_eval_duration_ms,
-        long long eval_duration_ms,
-        long long ttft_ms);
+    std::optional<std::string> logInteractionSync(const LogRecord& record);
+
+    /**
+     * @brief Internal synchronous cache write (called by worker thread).
+     * @param now The batch's commit time (Unix seconds), recorded as the last use.
+     */
+    std::optional<std::string> cacheResponseSync(const CacheRecord& record, int64_t now);
+
+    /**
+     * @brief Internal synchronous cache use update (called by worker thread).
+     */
+    std::optional<std::string> touchCachedResponseSync(const CacheTouch& touch, int64_t now);
+
+    /**
+     * @brief Add an entry's prompt and generated text (from SearchText) to the search index.
+     *
+     * Entries with neither are skipped. Writer connection, under writer_mutex_.
+     */
+    void indexSearchText(long long id, const std::string& prompt, const std::string& response);
+
+    /**
+     * @brief Store a body in the blob table, or find the identical one already there.
+     * @param body The raw bytes (writer thread only).
+     * @return std::optional<int64_t> The blob id; nullopt for an empty body or on failure.
+     */
+    std::optional<int64_t> storeBlob(std::string_view body);
+
+    /**
+     * @brief Bind a blob id, or NULL when there is none.
+     */
+    static void bindBlobId(sqlite3_stmt* stmt, int index, const std::optional<int64_t>& id);
+
+    /**
+     * @brief Register the persisted compression dictionaries with the codec.
+     */
+    void loadDictionaries();
+
+    /**
+     * @brief Train a dictionary from the sampled bodies, persist it and start using it.
+     */
+    void trainDictionary();
+
+    /**
+     * @brief Apply pending schema migrations (tracked in PRAGMA user_version).
+     * @return std::optional<std::string> Error message on failure, nullopt on success.
+     */
+    std::optional<std::string> migrate();
+
+    /**
+     * @brief Seed the in-memory metric aggregates from the persisted lifetime totals.
+     */
+    void loadMetrics();
+
+    /**
+     * @brief Apply a batch of queued writes in a single transaction.
+     * @param batch The writes drained from the queue.
+     */
+    void commitBatch(const std::vector<QueuedWrite>& batch);
+
+    /**
+     * @brief Fold a batch's per-bucket totals into the rollup tables (writer thread).
+     */
+    void writeRollups(const std::map<RollupKey, RollupTotals>& rollups);
 
     /**
-     * @brief Worker thread function for async database writes.
+     * @brief Background compaction: enforce the retention policy periodically.
      */
-    void processWriteQueue();
+    void retentionLoop(std::stop_token stop_token);
 
+    /**
+     * @brief Drop expired day partitions, trim to the volume and row limits,
+     *        then bound the cache.
+     */
+    void enforceRetention(const std::stop_token& stop_token);
+
+    /**
+     * @brief Index the entries logged before full-text search existed, newest
+     *        first, in bounded transactions that resume from a persisted cursor.
+     */
+    void backfillSearch(const std::stop_token& stop_token);
+
+    /**
+     * @brief Drop expired cache entries, then the least recently used ones
+     *        until the bodies fit the cache budget.
+     * @return long long Number of entries deleted.
+     */
+    long long enforceCacheBudget(const std::stop_token& stop_token);
+
+    /**
+     * @brief Delete the unstarred entries with ids in [first_id, last_id].
+     *
+     * A day is not removed in one statement: the blob and search triggers fire
+     * for every row, so the range is deleted kRetentionChunkRows at a time,
+     * yielding the writer connection to pending log writes between chunks.
+     *
+     * @return long long Number of entries deleted.
+     */
+    long long dropRange(long long first_id, long long last_id, const std::stop_token& stop_token);
+
+    /**
+     * @brief Between retention chunks, wait (up to kRetentionMaxYield) while
+     *        writes are queued or a batch is waiting for the writer connection.
+     */
+    void yieldToWriter(const std::stop_token& stop_token);
+
+    /**
+     * @brief Recount the day partitions overlapping [first_id, last_id] after a drop.
+     */
+    void refreshPartitions(long long first_id, long long last_id);
+
+    // Writer connection, used by the writer thread and setStarred() under
+    // writer_mutex_; request handlers read through read_pool_ instead
     sqlite3* db_ = nullptr;
+    std::mutex writer_mutex_;
+    std::unique_ptr<StatementCache> writer_statements_;
+    ReadPool read_pool_;
+
+    // Body compression; encoding and dictionary training run on the writer
+    BodyCodec codec_;
+    bool dictionary_pending_ = false;
+    long long last_log_id_ = 0;  // Id of the most recently logged request (writer_mutex_)
+    std::atomic<int> batches_waiting_{0};  // Batches blocked on writer_mutex_
 
-    // Async write queue
-    std::queue<std::function<void()>> write_queue_;
-    std::mutex queue_mutex_;
-    std::condition_variable queue_cv_;
+    // Lifetime totals (log_totals), written by the writer thread and read
+    // lock-free; retention never lowers them
+    std::atomic<long long> total_requests_{0};
+    std::atomic<long long> total_duration_ms_{0};
+    std::atomic<long long> cache_hits_{0};
+
+    // Notified by the writer after commits that added log entries
+    std::mutex listener_mutex_;
+    std::function<void()> commit_listener_;
+
+    // Async write queue, drained by the writer thread in batches
+    LogQueue write_queue_;
     std::jthread write_worker_;
-    std::atomic<bool> shutdown_requested_{false};
+
+    // Retention runs on its own thread, sharing the writer connection
+    std::mutex retention_mutex_;
+    std::condition_variable_any retention_cv_;
+    RetentionPolicy retention_;   // Guarded by retention_mutex_
+    bool retention_due_ = false;  // A changed policy awaits a pass
+    std::jthread retention_worker_;
+
+    // Response cache bounds, enforced by the retention thread
+    std::atomic<long long> cache_max_bytes_;
+    std::atomic<uint64_t> cache_generation_{0};  // Bumped by each flush
+    std::atomic<long long> cache_entries_{0};
+    std::atomic<long long> cache_bytes_{0};
+    std::atomic<long long> cache_evicted_{0};
+    std::atomic<long long> cache_expired_{0};
+    std::atomic<long long> cache_flushed_{0};
 
     // Constants
-    static constexpr int kMaxHistoryEntries = 100;
+    static constexpr size_t kMaxBatchSize = 256;
+    static constexpr std::chrono::milliseconds kMaxBatchDelay{5};
+    static constexpr size_t kBytesPerMegabyte = 1024 * 1024;
+    static constexpr std::chrono::seconds kRetentionInterval{60};
+    static constexpr int kRetentionChunkRows = 1000;
+    static constexpr std::chrono::milliseconds kRetentionMaxYield{100};
+    static constexpr std::chrono::milliseconds kRetentionYieldPoll{1};
+    static constexpr int kSearchBackfillChunkRows = 500;
+    static constexpr int kCacheEvictionChunk = 500;
+    static constexpr int kVacuumPagesPerPass = 4096;
+    static constexpr int kMaxPageSize = 500;
+    static constexpr std::chrono::seconds kMinuteRollupRetention{7 * 24 * 3600};
 };
 
 } // namespace sectorflux
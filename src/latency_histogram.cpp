@@ -0,0 +1,206 @@
+/*
+ * SectorFlux - LLM Proxy and Analytics
+ * Copyright (c) 2025 ParticleSector.com
+ *
+ * This software is dual-licensed:
+ * - GPL-3.0 for open source use
+ * - Commercial license for proprietary use
+ *
+ * See LICENSE and LICENSING.md for details.
+ */
+
+#include "latency_histogram.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <mutex>
+
+namespace sectorflux
+{
+
+namespace
+{
+
+constexpr uint64_t kMaxRecordable = (uint64_t{1} << (LogHistogram::kMaxExponent + 1)) - 1;
+
+uint64_t toSample(long long value)
+{
+    return value > 0 ? static_cast<uint64_t>(value) : 0;
+}
+
+}  // namespace
+
+size_t LogHistogram::bucketIndex(uint64_t value)
+{
+    value = std::min(value, kMaxRecordable);
+    if (value < kSubBuckets)
+    {
+        return static_cast<size_t>(value);
+    }
+
+    // Top kSubBucketBits + 1 bits: the leading one selects the octave, the
+    // rest select the linear sub-bucket within it
+    const int exponent = std::bit_width(value) - 1;
+    const int shift = exponent - kSubBucketBits;
+    const uint64_t sub = (value >> shift) & (kSubBuckets - 1);
+    return static_cast<size_t>(kSubBuckets + static_cast<uint64_t>(shift) * kSubBuckets + sub);
+}
+
+uint64_t LogHistogram::bucketUpperBound(size_t index)
+{
+    if (index < kSubBuckets)
+    {
+        return index;
+    }
+
+    const uint64_t shift = (index - kSubBuckets) / kSubBuckets;
+    const uint64_t sub = (index - kSubBuckets) % kSubBuckets;
+    const uint64_t lower = (kSubBuckets + sub) << shift;
+    return lower + (uint64_t{1} << shift) - 1;
+}
+
+void LogHistogram::record(uint64_t value)
+{
+    buckets_[bucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+    sum_.fetch_add(value, std::memory_order_relaxed);
+
+    uint64_t current = max_.load(std::memory_order_relaxed);
+    while (value > current &&
+           !max_.compare_exchange_weak(current, value, std::memory_order_relaxed))
+    {
+    }
+}
+
+HistogramSnapshot LogHistogram::snapshot() const
+{
+    HistogramSnapshot snap;
+    snap.sum = sum_.load(std::memory_order_relaxed);
+    snap.max = max_.load(std::memory_order_relaxed);
+
+    // Count from the buckets themselves so percentiles stay consistent even
+    // while writers are racing with us
+    std::array<uint64_t, kBucketCount> counts;
+    for (size_t i = 0; i < kBucketCount; ++i)
+    {
+        counts[i] = buckets_[i].load(std::memory_order_relaxed);
+        snap.count += counts[i];
+    }
+    if (snap.count == 0)
+    {
+        return snap;
+    }
+
+    for (size_t i = 0; i < kBucketCount; ++i)
+    {
+        if (counts[i] == 0)
+        {
+            continue;
+        }
+        const auto width = static_cast<size_t>(std::bit_width(bucketUpperBound(i)));
+        for (size_t n = width; n < kHistogramPow2Bounds; ++n)
+        {
+            snap.below_pow2[n] += counts[i];
+        }
+    }
+
+    auto percentile = [&](double q)
+    {
+        const auto rank = static_cast<uint64_t>(q * static_cast<double>(snap.count - 1)) + 1;
+        uint64_t seen = 0;
+        for (size_t i = 0; i < kBucketCount; ++i)
+        {
+            seen += counts[i];
+            if (seen >= rank)
+            {
+                return std::min(bucketUpperBound(i), snap.max);
+            }
+        }
+        return snap.max;
+    };
+
+    snap.p50 = percentile(0.50);
+    snap.p95 = percentile(0.95);
+    snap.p99 = percentile(0.99);
+    return snap;
+}
+
+void LatencyStats::record(
+    const std::string& model,
+    const std::string& endpoint,
+    const LatencySample& sample)
+{
+    auto& hist = series(model, endpoint);
+    hist.queue_wait_ms.record(toSample(sample.queue_wait_ms));
+    hist.duration_ms.record(toSample(sample.duration_ms));
+    if (sample.ttft_ms > 0)
+    {
+        hist.ttft_ms.record(toSample(sample.ttft_ms));
+    }
+    if (sample.prompt_eval_duration_ms > 0)
+    {
+        hist.prompt_eval_ms.record(toSample(sample.prompt_eval_duration_ms));
+    }
+    if (sample.eval_duration_ms > 0 && sample.completion_tokens > 0)
+    {
+        hist.tokens_per_sec.record(toSample(
+            static_cast<long long>(sample.completion_tokens) * 1000 / sample.eval_duration_ms));
+    }
+}
+
+SeriesHistograms& LatencyStats::series(const std::string& model, const std::string& endpoint)
+{
+    SeriesKey key{model, endpoint};
+    {
+        std::shared_lock lock(mutex_);
+        auto it = series_.find(key);
+        if (it != series_.end())
+        {
+            return *it->second;
+        }
+    }
+
+    std::unique_lock lock(mutex_);
+    if (series_.size() >= kMaxSeries && !series_.contains(key))
+    {
+        key.first = kOverflowModel;
+    }
+    auto& slot = series_[key];
+    if (!slot)
+    {
+        slot = std::make_unique<SeriesHistograms>();
+    }
+    return *slot;
+}
+
+std::vector<SeriesSnapshot> LatencyStats::snapshot() const
+{
+    std::shared_lock lock(mutex_);
+    std::vector<SeriesSnapshot> result;
+    result.reserve(series_.size());
+    for (const auto& [key, hist] : series_)
+    {
+        result.push_back(SeriesSnapshot{
+            .model = key.first,
+            .endpoint = key.second,
+            .queue_wait_ms = hist->queue_wait_ms.snapshot(),
+            .duration_ms = hist->duration_ms.snapshot(),
+            .ttft_ms = hist->ttft_ms.snapshot(),
+            .prompt_eval_ms = hist->prompt_eval_ms.snapshot(),
+            .tokens_per_sec = hist->tokens_per_sec.snapshot()});
+    }
+    return result;
+}
+
+std::optional<HistogramSnapshot> LatencyStats::duration(const std::string& model,
+                                                        const std::string& endpoint) const
+{
+    std::shared_lock lock(mutex_);
+    auto it = series_.find(SeriesKey{model, endpoint});
+    if (it == series_.end())
+    {
+        return std::nullopt;
+    }
+    return it->second->duration_ms.snapshot();
+}
+
+}  // namespace sectorflux
@@ -0,0 +1,182 @@
+/*
+ * SectorFlux - LLM Proxy and Analytics
+ * Copyright (c) 2025 ParticleSector.com
+ *
+ * This software is dual-licensed:
+ * - GPL-3.0 for open source use
+ * - Commercial license for proprietary use
+ *
+ * See LICENSE and LICENSING.md for details.
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <optional>
+#include <shared_mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace sectorflux
+{
+
+/**
+ * @brief Number of power-of-two bounds reported in HistogramSnapshot::below_pow2.
+ */
+inline constexpr size_t kHistogramPow2Bounds = 25;
+
+/**
+ * @brief Point-in-time summary of a LogHistogram.
+ */
+struct HistogramSnapshot
+{
+    uint64_t count = 0;
+    uint64_t sum = 0;
+    uint64_t max = 0;
+    uint64_t p50 = 0;
+    uint64_t p95 = 0;
+    uint64_t p99 = 0;
+
+    // below_pow2[n] counts observations < 2^n. Buckets never straddle a power
+    // of two, so these cumulative counts are exact (used for Prometheus buckets).
+    std::array<uint64_t, kHistogramPow2Bounds> below_pow2{};
+};
+
+/**
+ * @brief Fixed-size, log-bucketed histogram of non-negative integers.
+ *
+ * Each power of two is split into kSubBuckets linear buckets, giving a
+ * relative error of at most 1 / kSubBuckets on reported percentiles. All
+ * counters are relaxed atomics, so record() is lock-free and safe to call
+ * concurrently with snapshot().
+ */
+class LogHistogram
+{
+public:
+    static constexpr int kSubBucketBits = 3;
+    static constexpr uint64_t kSubBuckets = uint64_t{1} << kSubBucketBits;
+    static constexpr int kMaxExponent = 40;  // ~12 days in ms; larger values are clamped
+    static constexpr size_t kBucketCount =
+        kSubBuckets + (kMaxExponent - kSubBucketBits + 1) * kSubBuckets;
+
+    /**
+     * @brief Record one observation.
+     * @param value The observed value (clamped to the histogram range).
+     */
+    void record(uint64_t value);
+
+    /**
+     * @brief Summarize the recorded observations.
+     * @return HistogramSnapshot Count, sum, max and p50/p95/p99.
+     */
+    [[nodiscard]] HistogramSnapshot snapshot() const;
+
+    /**
+     * @brief Index of the bucket holding a value.
+     */
+    [[nodiscard]] static size_t bucketIndex(uint64_t value);
+
+    /**
+     * @brief Largest value that maps into a bucket.
+     */
+    [[nodiscard]] static uint64_t bucketUpperBound(size_t index);
+
+private:
+    std::array<std::atomic<uint64_t>, kBucketCount> buckets_{};
+    std::atomic<uint64_t> sum_{0};
+    std::atomic<uint64_t> max_{0};
+};
+
+/**
+ * @brief Latency and throughput histograms for one (model, endpoint) pair.
+ */
+struct SeriesHistograms
+{
+    LogHistogram queue_wait_ms;
+    LogHistogram duration_ms;
+    LogHistogram ttft_ms;
+    LogHistogram prompt_eval_ms;
+    LogHistogram tokens_per_sec;
+};
+
+/**
+ * @brief Snapshot of one series, as reported over the metrics APIs.
+ */
+struct SeriesSnapshot
+{
+    std::string model;
+    std::string endpoint;
+    HistogramSnapshot queue_wait_ms;
+    HistogramSnapshot duration_ms;
+    HistogramSnapshot ttft_ms;
+    HistogramSnapshot prompt_eval_ms;
+    HistogramSnapshot tokens_per_sec;
+};
+
+/**
+ * @brief Upstream timing observation for one completed request.
+ */
+struct LatencySample
+{
+    long long queue_wait_ms = 0;
+    long long duration_ms = 0;
+    long long ttft_ms = 0;
+    long long prompt_eval_duration_ms = 0;
+    long long eval_duration_ms = 0;
+    int completion_tokens = 0;
+};
+
+/**
+ * @brief Registry of per-model, per-endpoint histograms.
+ *
+ * Series are created on first use and never removed, so the hot path only
+ * takes a shared lock to find its series before recording lock-free. The
+ * number of series is capped; once full, new models are folded into
+ * kOverflowModel so client-chosen names cannot grow memory without bound.
+ */
+class LatencyStats
+{
+public:
+    static constexpr size_t kMaxSeries = 256;
+    static constexpr const char* kOverflowModel = "other";
+
+    /**
+     * @brief Record a completed upstream request.
+     * @param model The model name from the request.
+     * @param endpoint The Ollama endpoint that served it.
+     * @param sample Timings and token counts of the response.
+     */
+    void record(const std::string& model, const std::string& endpoint, const LatencySample& sample);
+
+    /**
+     * @brief Snapshot every series, ordered by (model, endpoint).
+     * @return std::vector<SeriesSnapshot> One entry per series.
+     */
+    [[nodiscard]] std::vector<SeriesSnapshot> snapshot() const;
+
+    /**
+     * @brief Summarize the request durations of one series.
+     * @param model The model name.
+     * @param endpoint The Ollama endpoint.
+     * @return std::optional<HistogramSnapshot> The summary, or nullopt if the
+     *         series has not recorded anything yet.
+     */
+    [[nodiscard]] std::optional<HistogramSnapshot> duration(const std::string& model,
+                                                            const std::string& endpoint) const;
+
+private:
+    SeriesHistograms& series(const std::string& model, const std::string& endpoint);
+
+    using SeriesKey = std::pair<std::string, std::string>;
+
+    mutable std::shared_mutex mutex_;
+    std::map<SeriesKey, std::unique_ptr<SeriesHistograms>> series_;
+};
+
+}  // namespace sectorflux
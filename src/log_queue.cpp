@@ -0,0 +1,270 @@
+/*
+ * SectorFlux - LLM Proxy and Analytics
+ * Copyright (c) 2025 ParticleSector.com
+ *
+ * This software is dual-licensed:
+ * - GPL-3.0 for open source use
+ * - Commercial license for proprietary use
+ *
+ * See LICENSE and LICENSING.md for details.
+ */
+
+#include "log_queue.hpp"
+
+#include <algorithm>
+
+namespace sectorflux
+{
+
+namespace
+{
+
+// Bookkeeping overhead charged per write on top of its string payloads
+constexpr size_t kRecordOverheadBytes = sizeof(QueuedWrite);
+
+size_t writeBytes(const QueuedWrite& write)
+{
+    if (const auto* log = std::get_if<LogRecord>(&write))
+    {
+        return kRecordOverheadBytes + log->method.size() + log->endpoint.size() +
+               log->model.size() + log->request_body.size() +
+               (log->response_body ? log->response_body->size() : 0);
+    }
+    if (const auto* cache = std::get_if<CacheRecord>(&write))
+    {
+        return kRecordOverheadBytes + (cache->response_body ? cache->response_body->size() : 0) +
+               (cache->chunks ? cache->chunks->size() * sizeof(ChunkMark) : 0);
+    }
+    return kRecordOverheadBytes;
+}
+
+/**
+ * @brief Discard the bodies of a log record, keeping its metrics.
+ * @return bool False if the write has no bodies it can live without.
+ */
+bool stripBodies(QueuedWrite& write)
+{
+    auto* log = std::get_if<LogRecord>(&write);
+    if (!log)
+    {
+        return false;  // A cache entry is nothing but its body; a touch has none
+    }
+    log->request_body.clear();
+    log->request_body.shrink_to_fit();
+    log->response_body.reset();
+    log->capture = LogCapture::MetricsOnly;
+    return true;
+}
+
+}  // namespace
+
+const char* logCaptureName(LogCapture capture)
+{
+    switch (capture)
+    {
+        case LogCapture::Full: return "full";
+        case LogCapture::Truncated: return "truncated";
+        case LogCapture::MetricsOnly: return "metrics";
+    }
+    return "unknown";
+}
+
+std::optional<OverflowPolicy> parseOverflowPolicy(std::string_view name)
+{
+    if (name == "block")
+    {
+        return OverflowPolicy::Block;
+    }
+    if (name == "drop_oldest")
+    {
+        return OverflowPolicy::DropOldest;
+    }
+    if (name == "drop_bodies")
+    {
+        return OverflowPolicy::DropBodies;
+    }
+    if (name == "sample")
+    {
+        return OverflowPolicy::Sample;
+    }
+    return std::nullopt;
+}
+
+const char* overflowPolicyName(OverflowPolicy policy)
+{
+    switch (policy)
+    {
+        case OverflowPolicy::Block: return "block";
+        case OverflowPolicy::DropOldest: return "drop_oldest";
+        case OverflowPolicy::DropBodies: return "drop_bodies";
+        case OverflowPolicy::Sample: return "sample";
+    }
+    return "unknown";
+}
+
+LogQueue::LogQueue(size_t max_bytes, OverflowPolicy policy, unsigned sample_every)
+    : slots_(kCapacity),
+      max_bytes_(max_bytes),
+      policy_(policy),
+      sample_every_(sample_every > 0 ? sample_every : 1)
+{
+}
+
+bool LogQueue::fitsLocked(size_t bytes) const
+{
+    // An empty queue always accepts one write so oversized records still land
+    return size_ == 0 || (size_ < kCapacity && bytes_ + bytes <= max_bytes_);
+}
+
+void LogQueue::pushLocked(QueuedWrite write, size_t bytes)
+{
+    if (auto* log = std::get_if<LogRecord>(&write))
+    {
+        log->trace.markEnqueued();
+    }
+    slots_[(head_ + size_) % kCapacity] = std::move(write);
+    ++size_;
+    bytes_ += bytes;
+}
+
+QueuedWrite LogQueue::popLocked()
+{
+    QueuedWrite write = std::move(slots_[head_]);
+    slots_[head_] = LogRecord{};  // Release the moved-from payload
+    head_ = (head_ + 1) % kCapacity;
+    --size_;
+    bytes_ -= writeBytes(write);
+    return write;
+}
+
+void LogQueue::push(QueuedWrite write)
+{
+    size_t bytes = writeBytes(write);
+
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (closed_)
+        {
+            ++dropped_;
+            return;
+        }
+
+        // Sampling starts once the queue is half full, before anything is lost
+        if (policy_ == OverflowPolicy::Sample &&
+            (size_ * 2 >= kCapacity || bytes_ * 2 >= max_bytes_))
+        {
+            if (++sample_counter_ % sample_every_ != 0)
+            {
+                ++sampled_out_;
+                return;
+            }
+        }
+
+        if (!fitsLocked(bytes))
+        {
+            switch (policy_)
+            {
+                case OverflowPolicy::Block:
+                    ++blocked_;
+                    not_full_.wait(lock, [this, bytes]
+                    {
+                        return closed_ || fitsLocked(bytes);
+                    });
+                    if (closed_)
+                    {
+                        ++dropped_;
+                        return;
+                    }
+                    break;
+
+                case OverflowPolicy::DropOldest:
+                    while (!fitsLocked(bytes))
+                    {
+                        popLocked();
+                        ++dropped_;
+                    }
+                    break;
+
+                case OverflowPolicy::DropBodies:
+                    if (stripBodies(write))
+                    {
+                        bytes = writeBytes(write);
+                        ++bodies_dropped_;
+                    }
+                    if (!fitsLocked(bytes))
+                    {
+                        ++dropped_;
+                        return;
+                    }
+                    break;
+
+                case OverflowPolicy::Sample:
+                    ++dropped_;
+                    return;
+            }
+        }
+
+        pushLocked(std::move(write), bytes);
+    }
+    not_empty_.notify_one();
+}
+
+bool LogQueue::popBatch(std::vector<QueuedWrite>& out,
+                        size_t max_items,
+                        std::chrono::milliseconds linger)
+{
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        not_empty_.wait(lock, [this] { return size_ > 0 || closed_; });
+
+        if (size_ == 0)
+        {
+            return false;  // Closed and drained
+        }
+
+        // Give a burst a short window to accumulate so it shares one commit
+        if (!closed_ && size_ < max_items)
+        {
+            not_empty_.wait_for(lock, linger, [this, max_items]
+            {
+                return size_ >= max_items || closed_;
+            });
+        }
+
+        size_t count = std::min(size_, max_items);
+        out.reserve(out.size() + count);
+        for (size_t i = 0; i < count; ++i)
+        {
+            out.push_back(popLocked());
+        }
+    }
+    not_full_.notify_all();
+    return true;
+}
+
+void LogQueue::close()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        closed_ = true;
+    }
+    not_empty_.notify_all();
+    not_full_.notify_all();
+}
+
+LogQueueStats LogQueue::stats()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    LogQueueStats stats;
+    stats.depth = size_;
+    stats.bytes = bytes_;
+    stats.max_bytes = max_bytes_;
+    stats.policy = policy_;
+    stats.dropped = dropped_;
+    stats.bodies_dropped = bodies_dropped_;
+    stats.sampled_out = sampled_out_;
+    stats.blocked = blocked_;
+    return stats;
+}
+
+} // namespace sectorflux
@@ -0,0 +1,231 @@
+/*
+ * SectorFlux - LLM Proxy and Analytics
+ * Copyright (c) 2025 ParticleSector.com
+ *
+ * This software is dual-licensed:
+ * - GPL-3.0 for open source use
+ * - Commercial license for proprietary use
+ *
+ * See LICENSE and LICENSING.md for details.
+ */
+
+#pragma once
+
+#include "cache_key.hpp"
+#include "chunk_index.hpp"
+#include "response_buffer.hpp"
+#include "trace.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <variant>
+#include <vector>
+
+namespace sectorflux
+{
+
+/**
+ * @brief How much of an interaction's bodies a log entry holds.
+ *
+ * Stored as an integer; values must not be renumbered.
+ */
+enum class LogCapture
+{
+    Full = 0,         // Both bodies complete, so the entry can be replayed
+    Truncated = 1,    // Bodies cut down to their first and last bytes
+    MetricsOnly = 2,  // Bodies discarded by the capture policy or an overflowing queue
+};
+
+/**
+ * @brief Get the name of a capture level as reported by the log APIs.
+ * @param capture The capture level.
+ * @return const char* "full", "truncated" or "metrics".
+ */
+[[nodiscard]] const char* logCaptureName(LogCapture capture);
+
+/**
+ * @brief A request/response interaction waiting to be persisted.
+ */
+struct LogRecord
+{
+    std::string method;
+    std::string endpoint;
+    std::string model;
+    std::string backend{};  // Ollama host that served it; empty for cache hits
+    std::string request_body;
+    int response_status = 0;
+    SharedBody response_body;  // Shared with the client writer and the cache; may be null
+    long long duration_ms = 0;
+    int prompt_tokens = 0;
+    int completion_tokens = 0;
+    long long prompt_eval_duration_ms = 0;
+    long long eval_duration_ms = 0;
+    long long ttft_ms = 0;
+    long long queue_wait_ms = 0;
+    bool cache_hit = false;
+    LogCapture capture = LogCapture::Full;
+    RequestTrace trace{};  // Phase timings; the queue ends the LogEnqueue phase
+};
+
+/**
+ * @brief A cache entry waiting to be persisted (write-behind).
+ */
+struct CacheRecord
+{
+    CacheKey key;
+    int response_status = 0;
+    SharedBody response_body;
+    std::shared_ptr<const ChunkIndex> chunks;
+    int64_t expires_at = 0;   // Unix seconds; 0 never expires
+    uint64_t generation = 0;  // Cache flushes since startup when queued; stale records are skipped
+};
+
+/**
+ * @brief A cache hit, refreshing the entry's place in the eviction order.
+ */
+struct CacheTouch
+{
+    CacheKey key;
+};
+
+/**
+ * @brief Any write the database writer thread can apply.
+ */
+using QueuedWrite = std::variant<LogRecord, CacheRecord, CacheTouch>;
+
+/**
+ * @brief What LogQueue does when a push would exceed its bounds.
+ */
+enum class OverflowPolicy
+{
+    Block,       // Producer waits for the writer to make room
+    DropOldest,  // Evict the oldest queued writes
+    DropBodies,  // Keep the metrics, discard request/response bodies
+    Sample       // Under pressure keep only 1 in N writes
+};
+
+/**
+ * @brief Parse a policy name ("block", "drop_oldest", "drop_bodies", "sample").
+ * @param name The policy name.
+ * @return std::optional<OverflowPolicy> The policy, or nullopt if unknown.
+ */
+[[nodiscard]] std::optional<OverflowPolicy> parseOverflowPolicy(std::string_view name);
+
+/**
+ * @brief Get the canonical name of a policy.
+ * @param policy The policy.
+ * @return const char* The policy name.
+ */
+[[nodiscard]] const char* overflowPolicyName(OverflowPolicy policy);
+
+/**
+ * @brief Counters describing LogQueue occupancy and losses.
+ */
+struct LogQueueStats
+{
+    size_t depth = 0;
+    size_t bytes = 0;
+    size_t max_bytes = 0;
+    OverflowPolicy policy = OverflowPolicy::Block;
+    uint64_t dropped = 0;         // Writes discarded entirely
+    uint64_t bodies_dropped = 0;  // Log records persisted without bodies
+    uint64_t sampled_out = 0;     // Writes skipped by sampling
+    uint64_t blocked = 0;         // Pushes that had to wait for room
+};
+
+/**
+ * @brief Bounded multi-producer, single-consumer ring of pending writes.
+ *
+ * Bounded both by slot count and by an approximate byte budget, so a stalled
+ * disk cannot grow the process without limit. What happens on overflow is
+ * decided by the configured OverflowPolicy.
+ */
+class LogQueue
+{
+public:
+    /**
+     * @brief Construct a new Log Queue object.
+     * @param max_bytes Approximate byte budget of queued writes.
+     * @param policy Behaviour when a push would exceed the bounds.
+     * @param sample_every Keep 1 in this many writes under Sample pressure.
+     */
+    LogQueue(size_t max_bytes, OverflowPolicy policy, unsigned sample_every);
+
+    // Delete copy operations
+    LogQueue(const LogQueue&) = delete;
+    LogQueue& operator=(const LogQueue&) = delete;
+
+    /**
+     * @brief Enqueue a write, applying the overflow policy if needed.
+     * @param write The write to enqueue (moved).
+     */
+    void push(QueuedWrite write);
+
+    /**
+     * @brief Wait for writes and move up to max_items of them into out.
+     *
+     * Once the first write is available, waits up to linger for a burst to
+     * fill the batch.
+     *
+     * @param out Receives the writes (appended).
+     * @param max_items Maximum writes to take.
+     * @param linger Maximum time to wait for more writes after the first.
+     * @return bool False once the queue is closed and fully drained.
+     */
+    bool popBatch(std::vector<QueuedWrite>& out,
+                  size_t max_items,
+                  std::chrono::milliseconds linger);
+
+    /**
+     * @brief Stop accepting writes and wake the consumer to drain the rest.
+     */
+    void close();
+
+    /**
+     * @brief Snapshot occupancy and loss counters.
+     * @return LogQueueStats The current statistics.
+     */
+    [[nodiscard]] LogQueueStats stats();
+
+private:
+    /**
+     * @brief Check whether a write of the given size fits right now.
+     * @note Caller must hold mutex_.
+     */
+    [[nodiscard]] bool fitsLocked(size_t bytes) const;
+
+    void pushLocked(QueuedWrite write, size_t bytes);
+    QueuedWrite popLocked();
+
+    std::vector<QueuedWrite> slots_;
+    size_t head_ = 0;
+    size_t size_ = 0;
+    size_t bytes_ = 0;
+
+    const size_t max_bytes_;
+    const OverflowPolicy policy_;
+    const unsigned sample_every_;
+    unsigned sample_counter_ = 0;
+    bool closed_ = false;
+
+    std::mutex mutex_;
+    std::condition_variable not_empty_;
+    std::condition_variable not_full_;
+
+    uint64_t dropped_ = 0;
+    uint64_t bodies_dropped_ = 0;
+    uint64_t sampled_out_ = 0;
+    uint64_t blocked_ = 0;
+
+    // Constants
+    static constexpr size_t kCapacity = 4096;
+};
+
+} // namespace sectorflux
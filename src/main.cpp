@@ -9,50 +9,141 @@
  * See LICENSE and LICENSING.md for details.
  */
 
+#include "api_json.hpp"
+#include "chat_executor.hpp"
 #include "config.hpp"
 #include "database.hpp"
-#include "embedded_ui.hpp"
+#include "metrics_exporter.hpp"
 #include "proxy.hpp"
+#include "runtime_config.hpp"
+#include "static_assets.hpp"
+#include "stream_server.hpp"
 #include "version.hpp"
 
 #include <crow.h>
 #include <httplib.h>
 
+#include <algorithm>
 #include <atomic>
+#include <charconv>
 #include <chrono>
+#include <condition_variable>
 #include <iostream>
 #include <mutex>
 #include <thread>
 #include <unordered_map>
 #include <unordered_set>
+#include <utility>
+#include <vector>
 
 namespace
 {
 
+// Map to store chat sessions: connection* -> shared_ptr<ChatSession>
+std::mutex g_connection_mutex;
+std::unordered_map<void*, std::shared_ptr<sectorflux::ChatSession>> g_connections;
+
+// Constants
+constexpr int kProxyTimeoutSec = 5;
+constexpr size_t kMaxPendingChatMessages = 4;
+constexpr long long kBytesPerMegabyte = 1024 * 1024;
+
+// Default /api/metrics/timeseries window (in buckets) and the widest allowed
+constexpr int64_t kDefaultMinuteBuckets = 60;
+constexpr int64_t kDefaultHourBuckets = 7 * 24;
+constexpr int64_t kMaxTimeseriesBuckets = 7 * 24 * 60;
+
 /**
- * @brief State for managing WebSocket connections.
+ * @brief Read an integer query parameter; false if present but malformed.
  */
-struct ConnectionState
+template <typename Integer>
+bool integerParam(const crow::query_string& params, const char* name, Integer& value)
 {
-    std::atomic<bool> active{true};
-    std::jthread worker;
-};
+    const char* text = params.get(name);
+    if (!text)
+    {
+        return true;
+    }
+    std::string_view digits(text);
+    auto [end, ec] = std::from_chars(digits.data(), digits.data() + digits.size(), value);
+    return ec == std::errc() && end == digits.data() + digits.size();
+}
 
-// Map to store connection state: connection* -> shared_ptr<ConnectionState>
-std::mutex g_connection_mutex;
-std::unordered_map<void*, std::shared_ptr<ConnectionState>> g_connections;
+/**
+ * @brief Build a log query from /api/logs parameters.
+ * @return std::optional<sectorflux::LogQuery> nullopt if a parameter is malformed.
+ */
+std::optional<sectorflux::LogQuery> parseLogQuery(const crow::query_string& params)
+{
+    sectorflux::LogQuery query;
+    auto text = [&params](const char* name, std::string& value)
+    {
+        if (const char* param = params.get(name))
+        {
+            value = param;
+        }
+    };
+    text("model", query.model);
+    text("endpoint", query.endpoint);
+    text("since", query.since);
+    text("until", query.until);
+    text("q", query.text);
+
+    if (!integerParam(params, "cursor", query.before_id) ||
+        !integerParam(params, "limit", query.limit) ||
+        !integerParam(params, "min_duration_ms", query.min_duration_ms) ||
+        !integerParam(params, "max_duration_ms", query.max_duration_ms))
+    {
+        return std::nullopt;
+    }
 
-// Constants
-constexpr int kProxyTimeoutSec = 5;
+    int status = 0;
+    if (params.get("status"))
+    {
+        if (!integerParam(params, "status", status))
+        {
+            return std::nullopt;
+        }
+        query.status = status;
+    }
+
+    if (const char* starred = params.get("starred"))
+    {
+        std::string_view value(starred);
+        if (value != "true" && value != "false")
+        {
+            return std::nullopt;
+        }
+        query.starred = value == "true";
+    }
+    return query;
+}
 
 /**
  * @brief Broadcaster for real-time dashboard updates via WebSocket.
+ *
+ * Event-driven: each new connection gets one full snapshot, after which only
+ * deltas are pushed. A delta holds the rows committed since the previous one
+ * plus current metrics, or a change of the running model. Deltas are triggered
+ * by the database writer's commit listener and coalesced to at most one per
+ * kMinDeltaInterval. An idle proxy therefore sends nothing but an occasional
+ * /api/ps probe.
  */
 class DashboardBroadcaster
 {
 public:
-    explicit DashboardBroadcaster(sectorflux::Database& db) : db_(db)
+    DashboardBroadcaster(sectorflux::Database& db, sectorflux::ProxyHandler& proxy)
+        : db_(db), proxy_(proxy)
     {
+        db_.setCommitListener([this]()
+        {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                dirty_ = true;
+            }
+            cv_.notify_one();
+        });
+
         worker_ = std::jthread([this](std::stop_token stop_token)
         {
             broadcastLoop(stop_token);
@@ -61,108 +152,201 @@ public:
 
     ~DashboardBroadcaster()
     {
-        // jthread automatically requests stop and joins
+        // Unregister first so the writer cannot call into a dead broadcaster;
+        // jthread then requests stop and joins
+        db_.setCommitListener({});
     }
 
     void addConnection(crow::websocket::connection* conn)
     {
-        std::lock_guard<std::mutex> lock(mutex_);
-        connections_.insert(conn);
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            connections_.insert(conn);
+            pending_snapshots_.push_back(conn);
+        }
+        cv_.notify_one();
     }
 
     void removeConnection(crow::websocket::connection* conn)
     {
         std::lock_guard<std::mutex> lock(mutex_);
         connections_.erase(conn);
+        std::erase(pending_snapshots_, conn);
     }
 
 private:
     void broadcastLoop(std::stop_token stop_token)
     {
+        std::unique_lock<std::mutex> lock(mutex_);
         while (!stop_token.stop_requested())
         {
-            std::this_thread::sleep_for(std::chrono::seconds(kBroadcastIntervalSec));
-            if (!stop_token.stop_requested())
+            // Wake for new connections, for a commit (re-evaluating the
+            // deadline), or when the next delta / status probe is due
+            auto deadline = next_status_poll_;
+            if (dirty_)
             {
-                broadcast();
+                deadline = std::min(deadline, last_delta_ + kMinDeltaInterval);
+            }
+            const bool was_dirty = dirty_;
+            cv_.wait_until(lock, stop_token, deadline, [&]()
+            {
+                return !pending_snapshots_.empty() || dirty_ != was_dirty;
+            });
+            if (stop_token.stop_requested())
+            {
+                break;
+            }
+
+            const auto now = std::chrono::steady_clock::now();
+            const bool send_logs = dirty_ && now >= last_delta_ + kMinDeltaInterval;
+            const bool poll_status = now >= next_status_poll_;
+            auto snapshots = std::exchange(pending_snapshots_, {});
+            if (!send_logs && !poll_status && snapshots.empty())
+            {
+                continue;
+            }
+            if (send_logs)
+            {
+                dirty_ = false;
+                last_delta_ = now;
+            }
+            if (poll_status)
+            {
+                next_status_poll_ = now + kStatusPollInterval;
+            }
+            if (connections_.empty())
+            {
+                continue;
+            }
+
+            // Query and serialize without holding the lock
+            lock.unlock();
+            std::string delta;
+            std::string snapshot;
+            buildMessages(send_logs, poll_status, !snapshots.empty(), delta, snapshot);
+            lock.lock();
+
+            for (auto* conn : snapshots)
+            {
+                if (!snapshot.empty() && connections_.contains(conn))
+                {
+                    conn->send_text(snapshot);
+                }
+            }
+            if (!delta.empty())
+            {
+                for (auto* conn : connections_)
+                {
+                    conn->send_text(delta);
+                }
             }
         }
     }
 
-    void broadcast()
+    void buildMessages(bool send_logs, bool poll_status, bool want_snapshot,
+                       std::string& delta, std::string& snapshot)
     {
-        // 1. Fetch Logs
-        auto logs_opt = db_.getLogs();
-        if (!logs_opt)
+        crow::json::wvalue delta_json;
+        bool has_delta = false;
+
+        if (send_logs)
         {
-            return;
+            auto logs = db_.getLogSummaries(last_sent_id_, kDashboardLogLimit);
+            if (logs && !logs->empty())
+            {
+                last_sent_id_ = std::max(last_sent_id_, static_cast<long long>(logs->front().id));
+                delta_json["logs"] = sectorflux::logListToJson(*logs);
+                has_delta = true;
+            }
+            delta_json["metrics"] = metricsToJson();
+            has_delta = true;
         }
 
-        crow::json::wvalue data;
-        const auto& logs = *logs_opt;
-
-        for (size_t i = 0; i < logs.size(); ++i)
-        {
-            auto idx = static_cast<unsigned int>(i);
-            data["logs"][idx]["id"] = logs[i].id;
-            data["logs"][idx]["timestamp"] = logs[i].timestamp;
-            data["logs"][idx]["method"] = logs[i].method;
-            data["logs"][idx]["endpoint"] = logs[i].endpoint;
-            data["logs"][idx]["model"] = logs[i].model;
-            data["logs"][idx]["response_status"] = logs[i].response_status;
-            data["logs"][idx]["duration_ms"] = logs[i].duration_ms;
-            data["logs"][idx]["prompt_tokens"] = logs[i].prompt_tokens;
-            data["logs"][idx]["completion_tokens"] = logs[i].completion_tokens;
-            data["logs"][idx]["prompt_eval_duration_ms"] = logs[i].prompt_eval_duration_ms;
-            data["logs"][idx]["eval_duration_ms"] = logs[i].eval_duration_ms;
-            data["logs"][idx]["is_starred"] = logs[i].is_starred;
+        // A snapshot needs a known running model even between probes
+        if (poll_status || (want_snapshot && running_model_.empty()))
+        {
+            std::string running_model = fetchRunningModel();
+            if (running_model != running_model_)
+            {
+                running_model_ = std::move(running_model);
+                delta_json["running_model"] = running_model_;
+                has_delta = true;
+            }
         }
 
-        // 2. Fetch Metrics
-        auto metrics = db_.getMetrics();
-        data["metrics"]["total_requests"] = metrics.total_requests;
-        data["metrics"]["avg_latency_ms"] = metrics.avg_latency_ms;
-        data["metrics"]["cache_hit_rate"] = metrics.cache_hit_rate;
-
-        // 3. Fetch Running Model (Ollama)
-        httplib::Client cli(sectorflux::Config::getOllamaHost());
-        cli.set_connection_timeout(kOllamaTimeoutSec, 0);
-        cli.set_read_timeout(kOllamaTimeoutSec, 0);
+        if (has_delta)
+        {
+            delta_json["type"] = "delta";
+            delta = delta_json.dump();
+        }
 
-        auto res = cli.Get("/api/ps");
-        if (res && res->status == 200)
+        if (want_snapshot)
         {
-            auto json = crow::json::load(res->body);
-            if (json && json.has("models") && json["models"].size() > 0)
-            {
-                data["running_model"] = json["models"][0]["name"];
-            }
-            else
+            auto logs = db_.getLogSummaries(0, kDashboardLogLimit);
+            if (logs)
             {
-                data["running_model"] = "None";
+                crow::json::wvalue snapshot_json;
+                snapshot_json["type"] = "snapshot";
+                snapshot_json["logs"] = sectorflux::logListToJson(*logs);
+                snapshot_json["metrics"] = metricsToJson();
+                snapshot_json["running_model"] = running_model_;
+                snapshot = snapshot_json.dump();
             }
         }
-        else
-        {
-            data["running_model"] = "Ollama Offline";
-        }
+    }
 
-        std::string message = data.dump();
+    crow::json::wvalue metricsToJson()
+    {
+        auto metrics = db_.getMetrics();
+        crow::json::wvalue json;
+        json["total_requests"] = metrics.total_requests;
+        json["cache_hits"] = metrics.cache_hits;
+        json["avg_latency_ms"] = metrics.avg_latency_ms;
+        json["cache_hit_rate"] = metrics.cache_hit_rate;
+        json["latency"] = sectorflux::latencyToJson(proxy_.latencyStats());
+        return json;
+    }
 
-        std::lock_guard<std::mutex> lock(mutex_);
-        for (auto* conn : connections_)
+    std::string fetchRunningModel()
+    {
+        // The backend pool already polls /api/ps on every host
+        bool any_healthy = false;
+        for (const auto& backend : proxy_.backends().status())
         {
-            conn->send_text(message);
+            if (!backend.healthy)
+            {
+                continue;
+            }
+            any_healthy = true;
+            if (!backend.loaded_models.empty())
+            {
+                return backend.loaded_models.front();
+            }
         }
+        return any_healthy ? "None" : "Ollama Offline";
     }
 
     sectorflux::Database& db_;
-    std::jthread worker_;
+    sectorflux::ProxyHandler& proxy_;
+
+    // Guarded by mutex_
     std::mutex mutex_;
+    std::condition_variable_any cv_;
     std::unordered_set<crow::websocket::connection*> connections_;
+    std::vector<crow::websocket::connection*> pending_snapshots_;
+    bool dirty_ = false;
+    std::chrono::steady_clock::time_point last_delta_{};
+    std::chrono::steady_clock::time_point next_status_poll_{};
+
+    // Owned by the worker thread
+    long long last_sent_id_ = 0;
+    std::string running_model_;
 
-    static constexpr int kBroadcastIntervalSec = 1;
-    static constexpr int kOllamaTimeoutSec = 1;
+    std::jthread worker_;
+
+    static constexpr int kDashboardLogLimit = 50;
+    static constexpr std::chrono::milliseconds kMinDeltaInterval{250};
+    static constexpr std::chrono::seconds kStatusPollInterval{2};
 };
 
 /**
@@ -183,16 +367,20 @@ void openBrowser(const std::string& url)
 
 /**
  * @brief Create a lambda for proxying GET requests to Ollama.
+ * @param proxy The proxy handler whose upstream pool serves the request.
  * @param endpoint The Ollama endpoint to proxy.
  * @return crow::response The proxied response.
  */
-crow::response proxyGetRequest(const std::string& endpoint)
+crow::response proxyGetRequest(sectorflux::ProxyHandler& proxy, const std::string& endpoint)
 {
-    httplib::Client cli(sectorflux::Config::getOllamaHost());
-    cli.set_connection_timeout(kProxyTimeoutSec, 0);
-    cli.set_read_timeout(kProxyTimeoutSec, 0);
+    auto upstream = proxy.upstreamPool().acquire(proxy.ollamaHost(), kProxyTimeoutSec);
+
+    auto res = upstream->Get(endpoint);
+    if (!res)
+    {
+        upstream.invalidate();
+    }
 
-    auto res = cli.Get(endpoint.c_str());
     if (res && res->status == 200)
     {
         crow::response c_res(200, res->body);
@@ -208,15 +396,37 @@ int main()
 {
     crow::SimpleApp app;
 
+    // Tunables live in one snapshot; each component resizes itself on change
+    sectorflux::RuntimeConfig runtime_config(sectorflux::Config::getConfigPath());
+
     sectorflux::Database db;
+    runtime_config.addListener([&db](const sectorflux::RuntimeSettings& settings)
+    {
+        db.setRetention(
+            sectorflux::RetentionPolicy{
+                .max_rows = settings.retention_rows,
+                .max_days = settings.retention_days,
+                .max_bytes = static_cast<long long>(settings.retention_mb) * kBytesPerMegabyte},
+            static_cast<long long>(settings.cache_disk_mb) * kBytesPerMegabyte);
+    });
     if (auto err = db.init(sectorflux::Config::getDatabasePath()))
     {
         std::cerr << "Failed to init DB: " << *err << std::endl;
         return 1;
     }
 
-    sectorflux::ProxyHandler proxy_handler(db);
-    DashboardBroadcaster dashboard_broadcaster(db);
+    sectorflux::ProxyHandler proxy_handler(db, runtime_config);
+    runtime_config.addListener([&proxy_handler](const sectorflux::RuntimeSettings& settings)
+    {
+        proxy_handler.applySettings(settings);
+    });
+    DashboardBroadcaster dashboard_broadcaster(db, proxy_handler);
+    sectorflux::ChatExecutor chat_executor(
+        static_cast<size_t>(runtime_config.current()->chat_workers), kMaxPendingChatMessages);
+    runtime_config.addListener([&chat_executor](const sectorflux::RuntimeSettings& settings)
+    {
+        chat_executor.resize(static_cast<size_t>(settings.chat_workers));
+    });
 
     // API Routes - Proxy to Ollama
     CROW_ROUTE(app, "/api/generate")
@@ -238,28 +448,28 @@ int main()
         .onopen([&](crow::websocket::connection& conn)
         {
             std::lock_guard<std::mutex> lock(g_connection_mutex);
-            g_connections[&conn] = std::make_shared<ConnectionState>();
+            g_connections[&conn] = std::make_shared<sectorflux::ChatSession>(conn);
         })
         .onclose([&](crow::websocket::connection& conn,
                      const std::string& /*reason*/,
                      uint16_t /*code*/)
         {
-            std::shared_ptr<ConnectionState> state;
+            std::shared_ptr<sectorflux::ChatSession> session;
             {
                 std::lock_guard<std::mutex> lock(g_connection_mutex);
                 auto it = g_connections.find(&conn);
                 if (it != g_connections.end())
                 {
-                    state = it->second;
+                    session = it->second;
                     g_connections.erase(it);
                 }
             }
 
-            if (state)
+            if (session)
             {
-                // Signal worker to stop
-                state->active = false;
-                // jthread will automatically join when state is destroyed
+                // Cancels the running generation at its next chunk and drops
+                // queued ones, without blocking the I/O thread on them
+                session->close();
             }
         })
         .onmessage([&](crow::websocket::connection& conn,
@@ -268,27 +478,33 @@ int main()
         {
             if (!is_binary)
             {
-                std::shared_ptr<ConnectionState> state;
+                std::shared_ptr<sectorflux::ChatSession> session;
                 {
                     std::lock_guard<std::mutex> lock(g_connection_mutex);
                     auto it = g_connections.find(&conn);
                     if (it != g_connections.end())
                     {
-                        state = it->second;
+                        session = it->second;
                     }
                 }
 
-                if (state)
+                if (session)
                 {
-                    // Reset active flag for new request
-                    state->active = true;
-
-                    // Start new worker using jthread
-                    state->worker = std::jthread(
-                        [&proxy_handler, &conn, data, state](std::stop_token /*stop_token*/)
-                        {
-                            proxy_handler.handleWebSocketRequest(conn, data, state->active);
-                        });
+                    bool queued = chat_executor.submit(session, [&proxy_handler, session, data]()
+                    {
+                        proxy_handler.handleWebSocketRequest(
+                            data,
+                            [&session](const char* chunk, size_t length)
+                            {
+                                return session->send(chunk, length);
+                            },
+                            session->active());
+                    });
+
+                    if (!queued)
+                    {
+                        conn.send_text("{\"error\": \"Too many pending requests\"}");
+                    }
                 }
             }
         });
@@ -316,49 +532,37 @@ int main()
         });
 
     // API Routes - Proxy Ollama info endpoints
-    CROW_ROUTE(app, "/api/tags")([]()
+    CROW_ROUTE(app, "/api/tags")([&proxy_handler]()
     {
-        return proxyGetRequest("/api/tags");
+        return proxyGetRequest(proxy_handler, "/api/tags");
     });
 
-    CROW_ROUTE(app, "/api/ps")([]()
+    CROW_ROUTE(app, "/api/ps")([&proxy_handler]()
     {
-        return proxyGetRequest("/api/ps");
+        return proxyGetRequest(proxy_handler, "/api/ps");
     });
 
     // API Routes - Logs
-    CROW_ROUTE(app, "/api/logs")([&db]()
+    // Summaries only; bodies are fetched per entry from /api/logs/<id>
+    CROW_ROUTE(app, "/api/logs")([&db](const crow::request& req)
     {
-        auto logs_opt = db.getLogs();
-        if (!logs_opt)
+        auto query = parseLogQuery(req.url_params);
+        if (!query)
         {
-            return crow::response(500);
+            return crow::response(400, "Invalid query parameter");
         }
 
-        std::vector<crow::json::wvalue> log_list;
-        const auto& logs = *logs_opt;
-
-        for (const auto& log : logs)
-        {
-            crow::json::wvalue entry;
-            entry["id"] = log.id;
-            entry["timestamp"] = log.timestamp;
-            entry["method"] = log.method;
-            entry["endpoint"] = log.endpoint;
-            entry["model"] = log.model;
-            entry["response_status"] = log.response_status;
-            entry["duration_ms"] = log.duration_ms;
-            entry["prompt_tokens"] = log.prompt_tokens;
-            entry["completion_tokens"] = log.completion_tokens;
-            entry["prompt_eval_duration_ms"] = log.prompt_eval_duration_ms;
-            entry["eval_duration_ms"] = log.eval_duration_ms;
-            entry["request_body"] = log.request_body;
-            entry["response_body"] = log.response_body;
-            entry["is_starred"] = log.is_starred;
-            log_list.push_back(std::move(entry));
+        auto page = db.queryLogs(*query);
+        if (!page)
+        {
+            // A malformed full-text query is the client's error
+            return query->text.empty() ? crow::response(500)
+                                       : crow::response(400, "Invalid search query");
         }
 
-        crow::json::wvalue json_response = std::move(log_list);
+        crow::json::wvalue json_response;
+        json_response["logs"] = sectorflux::logListToJson(page->entries);
+        json_response["next_cursor"] = page->next_cursor;
         return crow::response(json_response);
     });
 
@@ -370,25 +574,20 @@ int main()
             return crow::response(404, "Log not found");
         }
 
-        const auto& log = *log_opt;
-        crow::json::wvalue json_response;
-        json_response["id"] = log.id;
-        json_response["timestamp"] = log.timestamp;
-        json_response["method"] = log.method;
-        json_response["endpoint"] = log.endpoint;
-        json_response["model"] = log.model;
-        json_response["response_status"] = log.response_status;
-        json_response["duration_ms"] = log.duration_ms;
-        json_response["prompt_tokens"] = log.prompt_tokens;
-        json_response["completion_tokens"] = log.completion_tokens;
-        json_response["prompt_eval_duration_ms"] = log.prompt_eval_duration_ms;
-        json_response["eval_duration_ms"] = log.eval_duration_ms;
-        json_response["request_body"] = log.request_body;
-        json_response["response_body"] = log.response_body;
-        json_response["is_starred"] = log.is_starred;
+        crow::json::wvalue json_response = sectorflux::logToJson(*log_opt, true);
         return crow::response(json_response);
     });
 
+    CROW_ROUTE(app, "/api/logs/<int>/trace")([&db](int id)
+    {
+        auto spans = db.getTrace(id);
+        if (!spans)
+        {
+            return crow::response(404, "Log not found");
+        }
+        return crow::response(sectorflux::traceToJson(id, *spans));
+    });
+
     // API Route - Set Starred Status
     CROW_ROUTE(app, "/api/logs/<int>/starred")
         .methods(crow::HTTPMethod::PUT)([&db](const crow::request& req, int id)
@@ -419,16 +618,129 @@ int main()
         });
 
     // API Routes - Metrics
-    CROW_ROUTE(app, "/api/metrics")([&db]()
+    CROW_ROUTE(app, "/api/metrics")([&db, &proxy_handler]()
     {
         auto metrics = db.getMetrics();
         crow::json::wvalue json_response;
         json_response["total_requests"] = metrics.total_requests;
+        json_response["cache_hits"] = metrics.cache_hits;
         json_response["avg_latency_ms"] = metrics.avg_latency_ms;
         json_response["cache_hit_rate"] = metrics.cache_hit_rate;
+        json_response["latency"] = sectorflux::latencyToJson(proxy_handler.latencyStats());
+        json_response["live_tokens_per_sec"] = proxy_handler.stats().live_tokens_per_sec;
+
+        auto queue = db.getQueueStats();
+        json_response["log_queue"]["depth"] = queue.depth;
+        json_response["log_queue"]["bytes"] = queue.bytes;
+        json_response["log_queue"]["max_bytes"] = queue.max_bytes;
+        json_response["log_queue"]["policy"] = sectorflux::overflowPolicyName(queue.policy);
+        json_response["log_queue"]["dropped"] = queue.dropped;
+        json_response["log_queue"]["bodies_dropped"] = queue.bodies_dropped;
+        json_response["log_queue"]["sampled_out"] = queue.sampled_out;
+        json_response["log_queue"]["blocked"] = queue.blocked;
+
+        auto traffic = proxy_handler.stats();
+        json_response["log_capture"]["truncated"] = traffic.logs_truncated;
+        json_response["log_capture"]["metrics_only"] = traffic.logs_metrics_only;
+
+        auto memory_cache = proxy_handler.cacheStats();
+        auto disk_cache = db.getCacheDiskStats();
+        json_response["cache"]["bypassed"] = traffic.cache_bypassed;
+        json_response["cache"]["memory"]["entries"] = memory_cache.entries;
+        json_response["cache"]["memory"]["bytes"] = memory_cache.memory_bytes;
+        json_response["cache"]["memory"]["evictions"] = memory_cache.evictions;
+        json_response["cache"]["memory"]["expirations"] = memory_cache.expirations;
+        json_response["cache"]["memory"]["rejected"] = memory_cache.rejected;
+        json_response["cache"]["disk"]["entries"] = disk_cache.entries;
+        json_response["cache"]["disk"]["bytes"] = disk_cache.bytes;
+        json_response["cache"]["disk"]["max_bytes"] = disk_cache.max_bytes;
+        json_response["cache"]["disk"]["evicted"] = disk_cache.evicted;
+        json_response["cache"]["disk"]["expired"] = disk_cache.expired;
+        json_response["cache"]["disk"]["flushed"] = disk_cache.flushed;
+
+        auto scheduler = proxy_handler.schedulerStats();
+        for (size_t p = 0; p < sectorflux::kPriorityCount; ++p)
+        {
+            auto priority = static_cast<sectorflux::Priority>(p);
+            json_response["scheduler"]["queued"][sectorflux::priorityName(priority)] =
+                scheduler.queued[p];
+        }
+        json_response["scheduler"]["in_flight"] = scheduler.in_flight;
+        json_response["scheduler"]["admitted"] = scheduler.admitted;
+        json_response["scheduler"]["timeouts"] = scheduler.timeouts;
+
+        std::vector<crow::json::wvalue> backends;
+        for (const auto& status : proxy_handler.backends().status())
+        {
+            crow::json::wvalue backend;
+            backend["host"] = status.host;
+            backend["healthy"] = status.healthy;
+            backend["outstanding"] = status.outstanding;
+            backend["requests"] = status.requests;
+            backend["failures"] = status.failures;
+            std::vector<crow::json::wvalue> models(status.loaded_models.begin(),
+                                                   status.loaded_models.end());
+            backend["loaded_models"] = std::move(models);
+            backends.push_back(std::move(backend));
+        }
+        json_response["backends"] = std::move(backends);
+        return crow::response(json_response);
+    });
+
+    // Historical charts, read from the rollup tables only
+    CROW_ROUTE(app, "/api/metrics/timeseries")([&db](const crow::request& req)
+    {
+        const char* resolution_name = req.url_params.get("resolution");
+        auto resolution = resolution_name ? sectorflux::parseRollupResolution(resolution_name)
+                                          : sectorflux::RollupResolution::Minute;
+        if (!resolution)
+        {
+            return crow::response(400, "resolution must be 'minute' or 'hour'");
+        }
+
+        const int64_t width = static_cast<int64_t>(*resolution);
+        int64_t until = std::chrono::duration_cast<std::chrono::seconds>(
+                            std::chrono::system_clock::now().time_since_epoch())
+                            .count();
+        int64_t since = 0;
+        if (!integerParam(req.url_params, "until", until) ||
+            !integerParam(req.url_params, "since", since))
+        {
+            return crow::response(400, "Invalid query parameter");
+        }
+        if (!req.url_params.get("since"))
+        {
+            const int64_t buckets = *resolution == sectorflux::RollupResolution::Minute
+                                        ? kDefaultMinuteBuckets
+                                        : kDefaultHourBuckets;
+            since = until - buckets * width;
+        }
+        since = std::max(since, until - kMaxTimeseriesBuckets * width);
+
+        const char* model = req.url_params.get("model");
+        auto points = db.getRollups(*resolution, since - since % width, until,
+                                    model ? model : "");
+        if (!points)
+        {
+            return crow::response(500);
+        }
+
+        crow::json::wvalue json_response;
+        json_response["resolution_sec"] = width;
+        json_response["since"] = since;
+        json_response["until"] = until;
+        json_response["series"] = sectorflux::timeseriesToJson(*points, *resolution);
         return crow::response(json_response);
     });
 
+    // Prometheus / OpenMetrics scrape endpoint (in-memory counters only, no SQL)
+    CROW_ROUTE(app, "/metrics")([&db, &proxy_handler]()
+    {
+        crow::response res(sectorflux::renderOpenMetrics(db, proxy_handler));
+        res.set_header("Content-Type", sectorflux::kOpenMetricsContentType);
+        return res;
+    });
+
     // API Routes - Version
     CROW_ROUTE(app, "/api/version")([]()
     {
@@ -442,10 +754,26 @@ int main()
 
     // API Routes - Cache Configuration
     CROW_ROUTE(app, "/api/config/cache")
-        .methods(crow::HTTPMethod::GET)([&proxy_handler]()
+        .methods(crow::HTTPMethod::GET)([&proxy_handler, &runtime_config]()
         {
             crow::json::wvalue json_response;
             json_response["enabled"] = proxy_handler.isCacheEnabled();
+
+            // Report how cache keys are derived so misses can be diagnosed
+            std::vector<crow::json::wvalue> ignored_fields;
+            for (auto field : sectorflux::RequestNormalizer::kIgnoredFields)
+            {
+                ignored_fields.emplace_back(std::string(field));
+            }
+            json_response["key"]["ignored_fields"] = std::move(ignored_fields);
+            json_response["key"]["stream_default"] = true;
+
+            // Bounds and admission rules, changed through /api/config
+            auto settings = runtime_config.current();
+            json_response["ttl_sec"] = settings->cache_ttl_sec;
+            json_response["disk_budget_mb"] = settings->cache_disk_mb;
+            json_response["max_entry_kb"] = settings->cache_max_entry_kb;
+            json_response["deterministic_only"] = settings->cache_deterministic_only;
             return crow::response(json_response);
         });
 
@@ -466,6 +794,47 @@ int main()
             return crow::response(400, "Missing 'enabled' field");
         });
 
+    // Runtime settings: partial updates are validated whole, then swapped in
+    CROW_ROUTE(app, "/api/config")
+        .methods(crow::HTTPMethod::GET)([&runtime_config]()
+        {
+            return crow::response(sectorflux::runtimeConfigToJson(runtime_config));
+        });
+
+    CROW_ROUTE(app, "/api/config")
+        .methods(crow::HTTPMethod::PUT)([&runtime_config](const crow::request& req)
+        {
+            if (auto err = runtime_config.update(req.body))
+            {
+                return crow::response(400, *err);
+            }
+            return crow::response(sectorflux::runtimeConfigToJson(runtime_config));
+        });
+
+    CROW_ROUTE(app, "/api/config/reload")
+        .methods(crow::HTTPMethod::POST)([&runtime_config]()
+        {
+            if (auto err = runtime_config.reload())
+            {
+                return crow::response(400, *err);
+            }
+            return crow::response(sectorflux::runtimeConfigToJson(runtime_config));
+        });
+
+    // Drops every cached response; in-flight generations still complete and are cached
+    CROW_ROUTE(app, "/api/cache/flush")
+        .methods(crow::HTTPMethod::POST)([&proxy_handler]()
+        {
+            auto flushed = proxy_handler.flushCache();
+            if (!flushed)
+            {
+                return crow::response(500, "Failed to flush the cache");
+            }
+            crow::json::wvalue json_response;
+            json_response["flushed"] = *flushed;
+            return crow::response(json_response);
+        });
+
     // API Routes - Replay
     CROW_ROUTE(app, "/api/replay/<int>")
         .methods(crow::HTTPMethod::POST)(
@@ -483,6 +852,14 @@ int main()
                 }
 
                 const auto& log = *log_opt;
+                if (log.capture != sectorflux::LogCapture::Full)
+                {
+                    // A truncated or metrics-only entry has no request left to send
+                    res.code = 409;
+                    res.body = "Log entry was not captured in full and cannot be replayed";
+                    res.end();
+                    return;
+                }
 
                 // Construct a request to replay
                 crow::request replay_req;
@@ -495,40 +872,40 @@ int main()
                 proxy_handler.handleRequest(replay_req, res, log.endpoint);
             });
 
-    // Static File Helper
-    auto serve_embedded_file = [](crow::response& res,
-                                  const unsigned char* data,
-                                  size_t len,
-                                  const std::string& content_type)
+    // Static Files - Embedded UI, precompressed at build time
+    auto serve_embedded_file = [](const crow::request& req, crow::response& res, const char* path)
     {
-        res.body = std::string(reinterpret_cast<const char*>(data), len);
-        res.set_header("Content-Type", content_type);
+        if (const auto* asset = sectorflux::findEmbeddedAsset(path))
+        {
+            sectorflux::serveEmbeddedAsset(req, res, *asset);
+            return;
+        }
+        res.code = 404;
         res.end();
     };
 
-    // Static Files - Embedded UI
     CROW_ROUTE(app, "/")(
-        [serve_embedded_file](const crow::request& /*req*/, crow::response& res)
+        [serve_embedded_file](const crow::request& req, crow::response& res)
         {
-            serve_embedded_file(res, index_html, index_html_len, "text/html");
+            serve_embedded_file(req, res, "/");
         });
 
     CROW_ROUTE(app, "/style.css")(
-        [serve_embedded_file](const crow::request& /*req*/, crow::response& res)
+        [serve_embedded_file](const crow::request& req, crow::response& res)
         {
-            serve_embedded_file(res, style_css, style_css_len, "text/css");
+            serve_embedded_file(req, res, "/style.css");
         });
 
     CROW_ROUTE(app, "/app.js")(
-        [serve_embedded_file](const crow::request& /*req*/, crow::response& res)
+        [serve_embedded_file](const crow::request& req, crow::response& res)
         {
-            serve_embedded_file(res, app_js, app_js_len, "application/javascript");
+            serve_embedded_file(req, res, "/app.js");
         });
 
     CROW_ROUTE(app, "/api.js")(
-        [serve_embedded_file](const crow::request& /*req*/, crow::response& res)
+        [serve_embedded_file](const crow::request& req, crow::response& res)
         {
-            serve_embedded_file(res, api_js, api_js_len, "application/javascript");
+            serve_embedded_file(req, res, "/api.js");
         });
 
     CROW_ROUTE(app, "/favicon.ico")([]()
@@ -549,6 +926,21 @@ int main()
     std::cout << "SectorFlux v" << sectorflux::Version::kString
               << " starting on port " << port << "..." << std::endl;
 
+    // Chunked pass-through listener for clients that need live token streaming
+    sectorflux::StreamServer stream_server(proxy_handler);
+    int stream_port = sectorflux::Config::getStreamPort();
+    if (stream_port > 0)
+    {
+        if (auto err = stream_server.start(stream_port))
+        {
+            std::cerr << "Warning: " << *err << std::endl;
+        }
+        else
+        {
+            std::cout << "Streaming proxy listening on port " << stream_port << std::endl;
+        }
+    }
+
     // Run browser opener in a separate thread
     std::jthread browser_thread([port](std::stop_token /*stop_token*/)
     {
@@ -557,6 +949,17 @@ int main()
     });
     browser_thread.detach();
 
-    app.port(static_cast<uint16_t>(port)).multithreaded().run();
+    // The worker count is fixed once the listener runs; changes wait for a restart
+    const int http_threads = runtime_config.current()->http_threads;
+    app.port(static_cast<uint16_t>(port));
+    if (http_threads > 0)
+    {
+        app.concurrency(static_cast<uint16_t>(http_threads));
+    }
+    else
+    {
+        app.multithreaded();
+    }
+    app.run();
     return 0;
 }
@@ -0,0 +1,159 @@
+/*
+ * SectorFlux - LLM Proxy and Analytics
+ * Copyright (c) 2025 ParticleSector.com
+ *
+ * This software is dual-licensed:
+ * - GPL-3.0 for open source use
+ * - Commercial license for proprietary use
+ *
+ * See LICENSE and LICENSING.md for details.
+ */
+
+#include "metric_rollups.hpp"
+
+#include "latency_histogram.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace sectorflux
+{
+
+namespace
+{
+
+constexpr size_t kEncodedBucketBytes = 6;
+
+void putLittleEndian(std::string& out, uint32_t value, int bytes)
+{
+    for (int i = 0; i < bytes; ++i)
+    {
+        out += static_cast<char>((value >> (8 * i)) & 0xff);
+    }
+}
+
+uint32_t getLittleEndian(const char* data, int bytes)
+{
+    uint32_t value = 0;
+    for (int i = 0; i < bytes; ++i)
+    {
+        value |= static_cast<uint32_t>(static_cast<unsigned char>(data[i])) << (8 * i);
+    }
+    return value;
+}
+
+uint32_t saturatingAdd(uint32_t a, uint32_t b)
+{
+    return a > std::numeric_limits<uint32_t>::max() - b ? std::numeric_limits<uint32_t>::max()
+                                                        : a + b;
+}
+
+}  // namespace
+
+std::optional<RollupResolution> parseRollupResolution(std::string_view name)
+{
+    if (name == "minute")
+    {
+        return RollupResolution::Minute;
+    }
+    if (name == "hour")
+    {
+        return RollupResolution::Hour;
+    }
+    return std::nullopt;
+}
+
+void RollupHistogram::record(long long value)
+{
+    auto bucket = static_cast<uint16_t>(
+        LogHistogram::bucketIndex(value > 0 ? static_cast<uint64_t>(value) : 0));
+    uint32_t& count = counts_[bucket];
+    count = saturatingAdd(count, 1);
+}
+
+void RollupHistogram::merge(const RollupHistogram& other)
+{
+    for (const auto& [bucket, count] : other.counts_)
+    {
+        uint32_t& merged = counts_[bucket];
+        merged = saturatingAdd(merged, count);
+    }
+}
+
+uint64_t RollupHistogram::percentile(double quantile) const
+{
+    uint64_t total = 0;
+    for (const auto& [bucket, count] : counts_)
+    {
+        total += count;
+    }
+    if (total == 0)
+    {
+        return 0;
+    }
+
+    // Rank of the observation at the quantile, 1-based
+    const auto rank = std::max<uint64_t>(
+        1, static_cast<uint64_t>(std::ceil(quantile * static_cast<double>(total))));
+    uint64_t seen = 0;
+    for (const auto& [bucket, count] : counts_)
+    {
+        seen += count;
+        if (seen >= rank)
+        {
+            return LogHistogram::bucketUpperBound(bucket);
+        }
+    }
+    return LogHistogram::bucketUpperBound(counts_.rbegin()->first);
+}
+
+std::string RollupHistogram::encode() const
+{
+    std::string out;
+    out.reserve(counts_.size() * kEncodedBucketBytes);
+    for (const auto& [bucket, count] : counts_)
+    {
+        putLittleEndian(out, bucket, 2);
+        putLittleEndian(out, count, 4);
+    }
+    return out;
+}
+
+RollupHistogram RollupHistogram::decode(std::string_view blob)
+{
+    RollupHistogram histogram;
+    if (blob.size() % kEncodedBucketBytes != 0)
+    {
+        return histogram;
+    }
+
+    for (size_t pos = 0; pos < blob.size(); pos += kEncodedBucketBytes)
+    {
+        const uint32_t bucket = getLittleEndian(blob.data() + pos, 2);
+        if (bucket >= LogHistogram::kBucketCount)
+        {
+            return RollupHistogram();
+        }
+        histogram.counts_[static_cast<uint16_t>(bucket)] =
+            getLittleEndian(blob.data() + pos + 2, 4);
+    }
+    return histogram;
+}
+
+void RollupTotals::add(const LogRecord& record)
+{
+    ++requests;
+    cache_hits += record.cache_hit ? 1 : 0;
+    errors += (record.response_status == 0 || record.response_status >= 400) ? 1 : 0;
+    prompt_tokens += record.prompt_tokens;
+    completion_tokens += record.completion_tokens;
+    duration_ms += record.duration_ms;
+    eval_duration_ms += record.eval_duration_ms;
+    if (!record.cache_hit && record.ttft_ms > 0)
+    {
+        ttft_ms.record(record.ttft_ms);
+    }
+}
+
+}  // namespace sectorflux
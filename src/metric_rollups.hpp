@@ -0,0 +1,127 @@
+/*
+ * SectorFlux - LLM Proxy and Analytics
+ * Copyright (c) 2025 ParticleSector.com
+ *
+ * This software is dual-licensed:
+ * - GPL-3.0 for open source use
+ * - Commercial license for proprietary use
+ *
+ * See LICENSE and LICENSING.md for details.
+ */
+
+#pragma once
+
+#include "log_queue.hpp"
+
+#include <compare>
+#include <cstdint>
+#include <map>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace sectorflux
+{
+
+/**
+ * @brief Width of a rollup bucket, in seconds.
+ */
+enum class RollupResolution : int
+{
+    Minute = 60,
+    Hour = 3600,
+};
+
+/**
+ * @brief Parse a resolution name ("minute" or "hour").
+ * @return std::optional<RollupResolution> nullopt for an unknown name.
+ */
+[[nodiscard]] std::optional<RollupResolution> parseRollupResolution(std::string_view name);
+
+/**
+ * @brief Sparse, mergeable histogram stored with each rollup bucket.
+ *
+ * Uses LogHistogram's bucket layout, so percentiles carry the same bounded
+ * relative error, but only keeps the buckets that were hit: a minute of
+ * traffic typically touches a handful of them.
+ */
+class RollupHistogram
+{
+public:
+    /**
+     * @brief Record one observation.
+     */
+    void record(long long value);
+
+    /**
+     * @brief Add another histogram's observations to this one.
+     */
+    void merge(const RollupHistogram& other);
+
+    /**
+     * @brief Upper bound of the bucket holding the given quantile (0 if empty).
+     */
+    [[nodiscard]] uint64_t percentile(double quantile) const;
+
+    [[nodiscard]] bool empty() const
+    {
+        return counts_.empty();
+    }
+
+    /**
+     * @brief Serialize as little-endian (bucket, count) pairs for BLOB storage.
+     */
+    [[nodiscard]] std::string encode() const;
+
+    /**
+     * @brief Parse a histogram written by encode(); malformed data yields an empty one.
+     */
+    [[nodiscard]] static RollupHistogram decode(std::string_view blob);
+
+private:
+    std::map<uint16_t, uint32_t> counts_;  // LogHistogram bucket index -> observations
+};
+
+/**
+ * @brief Aggregates of the entries logged for one model in one bucket.
+ */
+struct RollupTotals
+{
+    long long requests = 0;
+    long long cache_hits = 0;
+    long long errors = 0;  // Status 0 (upstream unreachable) or >= 400
+    long long prompt_tokens = 0;
+    long long completion_tokens = 0;
+    long long duration_ms = 0;
+    long long eval_duration_ms = 0;
+    RollupHistogram ttft_ms;  // Upstream responses only; cache hits replay instantly
+
+    /**
+     * @brief Account for one logged entry.
+     */
+    void add(const LogRecord& record);
+};
+
+/**
+ * @brief Identifies one rollup row.
+ */
+struct RollupKey
+{
+    RollupResolution resolution = RollupResolution::Minute;
+    int64_t bucket_start = 0;  // Unix seconds, a multiple of the resolution
+    std::string model;
+
+    auto operator<=>(const RollupKey&) const = default;
+};
+
+/**
+ * @brief One rollup row as read back for the timeseries API.
+ */
+struct RollupPoint
+{
+    int64_t bucket_start = 0;
+    std::string model;
+    RollupTotals totals;
+};
+
+}  // namespace sectorflux
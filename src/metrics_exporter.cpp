@@ -0,0 +1,312 @@
+/*
+ * SectorFlux - LLM Proxy and Analytics
+ * Copyright (c) 2025 ParticleSector.com
+ *
+ * This software is dual-licensed:
+ * - GPL-3.0 for open source use
+ * - Commercial license for proprietary use
+ *
+ * See LICENSE and LICENSING.md for details.
+ */
+
+#include "metrics_exporter.hpp"
+
+#include <charconv>
+#include <cstdint>
+#include <string_view>
+
+namespace sectorflux
+{
+
+namespace
+{
+
+constexpr double kMillisecondsPerSecond = 1000.0;
+
+std::string formatDouble(double value)
+{
+    char buf[32];
+    auto [end, ec] = std::to_chars(buf, buf + sizeof(buf), value);
+    return ec == std::errc() ? std::string(buf, end) : "0";
+}
+
+/**
+ * @brief Escape a label value (backslash, double quote and newline).
+ */
+std::string escapeLabel(std::string_view value)
+{
+    std::string out;
+    out.reserve(value.size());
+    for (char c : value)
+    {
+        switch (c)
+        {
+            case '\\': out += "\\\\"; break;
+            case '"': out += "\\\""; break;
+            case '\n': out += "\\n"; break;
+            default: out += c; break;
+        }
+    }
+    return out;
+}
+
+/**
+ * @brief Incrementally builds an OpenMetrics exposition.
+ */
+class Writer
+{
+public:
+    void family(std::string_view name, std::string_view type, std::string_view help,
+                std::string_view unit = {})
+    {
+        out_ += "# TYPE ";
+        out_ += name;
+        out_ += ' ';
+        out_ += type;
+        out_ += '\n';
+        if (!unit.empty())
+        {
+            out_ += "# UNIT ";
+            out_ += name;
+            out_ += ' ';
+            out_ += unit;
+            out_ += '\n';
+        }
+        out_ += "# HELP ";
+        out_ += name;
+        out_ += ' ';
+        out_ += help;
+        out_ += '\n';
+    }
+
+    void sample(std::string_view name, std::string_view labels, std::string_view value)
+    {
+        out_ += name;
+        if (!labels.empty())
+        {
+            out_ += '{';
+            out_ += labels;
+            out_ += '}';
+        }
+        out_ += ' ';
+        out_ += value;
+        out_ += '\n';
+    }
+
+    void counter(std::string_view name, std::string_view help, uint64_t value)
+    {
+        family(name, "counter", help);
+        sample(std::string(name) + "_total", {}, std::to_string(value));
+    }
+
+    void gauge(std::string_view name, std::string_view help, long long value)
+    {
+        family(name, "gauge", help);
+        sample(name, {}, std::to_string(value));
+    }
+
+    /**
+     * @brief Emit one histogram series; `scale` converts recorded units to exported ones.
+     */
+    void histogram(std::string_view name, const std::string& labels,
+                   const HistogramSnapshot& hist, double scale)
+    {
+        const std::string bucket = std::string(name) + "_bucket";
+        const std::string prefix = labels.empty() ? "" : labels + ",";
+        for (size_t n = 0; n < kHistogramPow2Bounds; ++n)
+        {
+            const double bound = static_cast<double>(uint64_t{1} << n) / scale;
+            sample(bucket, prefix + "le=\"" + formatDouble(bound) + "\"",
+                   std::to_string(hist.below_pow2[n]));
+        }
+        sample(bucket, prefix + "le=\"+Inf\"", std::to_string(hist.count));
+        sample(std::string(name) + "_count", labels, std::to_string(hist.count));
+        sample(std::string(name) + "_sum", labels,
+               formatDouble(static_cast<double>(hist.sum) / scale));
+    }
+
+    std::string finish()
+    {
+        out_ += "# EOF\n";
+        return std::move(out_);
+    }
+
+private:
+    std::string out_;
+};
+
+}  // namespace
+
+std::string renderOpenMetrics(Database& db, ProxyHandler& proxy)
+{
+    Writer w;
+
+    const auto metrics = db.getMetrics();
+    const auto traffic = proxy.stats();
+    const auto queue = db.getQueueStats();
+
+    w.counter("sectorflux_requests",
+              "Proxied requests (cache hits, shared generations and upstream requests).",
+              traffic.cache_hits + traffic.coalesced + traffic.upstream_requests);
+    w.counter("sectorflux_cache_hits", "Requests served from the response cache.",
+              traffic.cache_hits);
+    w.counter("sectorflux_coalesced_requests",
+              "Duplicate requests that shared an identical in-flight generation.",
+              traffic.coalesced);
+    w.counter("sectorflux_cache_misses", "Cache lookups that missed.", traffic.cache_misses);
+    w.counter("sectorflux_cache_bypassed",
+              "Requests kept out of the cache by the admission policy.",
+              traffic.cache_bypassed);
+    w.counter("sectorflux_semantic_cache_hits",
+              "Cache hits served for a near-duplicate /api/generate prompt.",
+              traffic.semantic_hits);
+    w.counter("sectorflux_prefix_matches",
+              "Chat requests continuing a conversation seen recently.",
+              traffic.prefix_matches);
+    w.counter("sectorflux_prefix_messages",
+              "Leading chat messages shared with a recent request.",
+              traffic.prefix_messages);
+    w.counter("sectorflux_upstream_requests", "Requests forwarded to Ollama.",
+              traffic.upstream_requests);
+    w.counter("sectorflux_upstream_errors",
+              "Upstream requests that failed to connect or returned 5xx.",
+              traffic.upstream_errors);
+    w.gauge("sectorflux_inflight_streams", "Upstream requests currently streaming.",
+            traffic.in_flight);
+    w.counter("sectorflux_streamed_tokens", "Token chunks relayed from upstream streams.",
+              traffic.streamed_tokens);
+    w.family("sectorflux_live_tokens_per_second", "gauge",
+             "Tokens streamed per second over the last few seconds.");
+    w.sample("sectorflux_live_tokens_per_second", {},
+             formatDouble(traffic.live_tokens_per_sec));
+
+    const auto backends = proxy.backends().status();
+    auto per_backend = [&](std::string_view name, std::string_view type, std::string_view help,
+                          auto value)
+    {
+        w.family(name, type, help);
+        const std::string sample_name =
+            type == "counter" ? std::string(name) + "_total" : std::string(name);
+        for (const auto& backend : backends)
+        {
+            w.sample(sample_name, "backend=\"" + escapeLabel(backend.host) + "\"",
+                     std::to_string(value(backend)));
+        }
+    };
+    per_backend("sectorflux_upstream_up", "gauge",
+               "Whether the Ollama backend answered its last probe.",
+               [](const BackendStatus& b) { return b.healthy ? 1 : 0; });
+    per_backend("sectorflux_backend_outstanding", "gauge",
+               "Requests currently running on the backend.",
+               [](const BackendStatus& b) { return b.outstanding; });
+    per_backend("sectorflux_backend_requests", "counter", "Requests sent to the backend.",
+               [](const BackendStatus& b) { return b.requests; });
+    per_backend("sectorflux_backend_failures", "counter",
+               "Requests to the backend that failed to connect.",
+               [](const BackendStatus& b) { return b.failures; });
+    per_backend("sectorflux_backend_loaded_models", "gauge",
+               "Models resident in the backend's memory.",
+               [](const BackendStatus& b) { return b.loaded_models.size(); });
+
+    w.counter("sectorflux_logged_requests", "Interactions committed to the history database.",
+              static_cast<uint64_t>(metrics.total_requests));
+    w.gauge("sectorflux_log_queue_depth", "Writes waiting for the database writer.",
+            static_cast<long long>(queue.depth));
+    w.gauge("sectorflux_log_queue_bytes", "Bytes held by pending database writes.",
+            static_cast<long long>(queue.bytes));
+    w.gauge("sectorflux_log_queue_max_bytes", "Byte budget of the database write queue.",
+            static_cast<long long>(queue.max_bytes));
+    w.counter("sectorflux_log_queue_dropped", "Queued writes discarded on overflow.",
+              queue.dropped);
+    w.counter("sectorflux_log_queue_bodies_dropped",
+              "Log entries whose bodies were stripped on overflow.", queue.bodies_dropped);
+    w.counter("sectorflux_log_queue_sampled_out", "Log entries skipped by overflow sampling.",
+              queue.sampled_out);
+    w.counter("sectorflux_log_queue_blocked", "Enqueues that had to wait for space.",
+              queue.blocked);
+    w.counter("sectorflux_log_capture_truncated",
+              "Log entries whose bodies the capture policy truncated.", traffic.logs_truncated);
+    w.counter("sectorflux_log_capture_metrics_only",
+              "Log entries the capture policy kept without bodies.", traffic.logs_metrics_only);
+
+    const auto memory_cache = proxy.cacheStats();
+    const auto disk_cache = db.getCacheDiskStats();
+    w.gauge("sectorflux_cache_memory_entries", "Responses held by the in-memory cache tier.",
+            static_cast<long long>(memory_cache.entries));
+    w.gauge("sectorflux_cache_memory_bytes", "Bytes held by the in-memory cache tier.",
+            static_cast<long long>(memory_cache.memory_bytes));
+    w.counter("sectorflux_cache_memory_evictions",
+              "Entries evicted from the in-memory tier to make room.", memory_cache.evictions);
+    w.counter("sectorflux_cache_expirations", "Lookups that found their entry past its TTL.",
+              memory_cache.expirations);
+    w.counter("sectorflux_cache_rejected", "Responses too large to be cached.",
+              memory_cache.rejected);
+    w.gauge("sectorflux_cache_disk_entries", "Responses persisted in SQLite (last compaction).",
+            disk_cache.entries);
+    w.gauge("sectorflux_cache_disk_bytes",
+            "Raw body bytes of the persisted responses (last compaction).", disk_cache.bytes);
+    w.gauge("sectorflux_cache_disk_max_bytes",
+            "Byte budget of the persisted responses (0 = unbounded).", disk_cache.max_bytes);
+    w.counter("sectorflux_cache_disk_evictions",
+              "Least recently used persisted responses dropped for the budget.",
+              static_cast<uint64_t>(disk_cache.evicted));
+    w.counter("sectorflux_cache_disk_expirations", "Persisted responses dropped past their TTL.",
+              static_cast<uint64_t>(disk_cache.expired));
+    w.counter("sectorflux_cache_flushed", "Persisted responses dropped by cache flushes.",
+              static_cast<uint64_t>(disk_cache.flushed));
+
+    const auto scheduler = proxy.schedulerStats();
+    w.family("sectorflux_scheduler_queued", "gauge",
+             "Requests waiting for an upstream slot, by priority class.");
+    for (size_t p = 0; p < kPriorityCount; ++p)
+    {
+        w.sample("sectorflux_scheduler_queued",
+                 std::string("priority=\"") + priorityName(static_cast<Priority>(p)) + "\"",
+                 std::to_string(scheduler.queued[p]));
+    }
+    w.gauge("sectorflux_scheduler_inflight", "Requests holding an upstream slot.",
+            static_cast<long long>(scheduler.in_flight));
+    w.counter("sectorflux_scheduler_admitted", "Requests admitted to the upstream.",
+              scheduler.admitted);
+    w.counter("sectorflux_scheduler_timeouts", "Requests that gave up waiting for a slot.",
+              scheduler.timeouts);
+
+    // Histogram families: each needs its TYPE line once, then every series
+    const auto series = proxy.latencyStats().snapshot();
+    struct Family
+    {
+        const char* name;
+        const char* unit;
+        const char* help;
+        HistogramSnapshot SeriesSnapshot::*field;
+        double scale;
+    };
+    const Family families[] = {
+        {"sectorflux_queue_wait_seconds", "seconds", "Time spent waiting for an upstream slot.",
+         &SeriesSnapshot::queue_wait_ms, kMillisecondsPerSecond},
+        {"sectorflux_request_duration_seconds", "seconds",
+         "End-to-end upstream request duration.", &SeriesSnapshot::duration_ms,
+         kMillisecondsPerSecond},
+        {"sectorflux_ttft_seconds", "seconds", "Time to the first upstream response byte.",
+         &SeriesSnapshot::ttft_ms, kMillisecondsPerSecond},
+        {"sectorflux_prompt_eval_seconds", "seconds", "Ollama prompt evaluation time.",
+         &SeriesSnapshot::prompt_eval_ms, kMillisecondsPerSecond},
+        {"sectorflux_tokens_per_second", "", "Generation throughput in tokens per second.",
+         &SeriesSnapshot::tokens_per_sec, 1.0},
+    };
+
+    for (const auto& family : families)
+    {
+        w.family(family.name, "histogram", family.help, family.unit);
+        for (const auto& s : series)
+        {
+            const std::string labels = "model=\"" + escapeLabel(s.model) + "\",endpoint=\"" +
+                                       escapeLabel(s.endpoint) + "\"";
+            w.histogram(family.name, labels, s.*family.field, family.scale);
+        }
+    }
+
+    return w.finish();
+}
+
+}  // namespace sectorflux
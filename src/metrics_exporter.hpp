@@ -0,0 +1,40 @@
+/*
+ * SectorFlux - LLM Proxy and Analytics
+ * Copyright (c) 2025 ParticleSector.com
+ *
+ * This software is dual-licensed:
+ * - GPL-3.0 for open source use
+ * - Commercial license for proprietary use
+ *
+ * See LICENSE and LICENSING.md for details.
+ */
+
+#pragma once
+
+#include "database.hpp"
+#include "proxy.hpp"
+
+#include <string>
+
+namespace sectorflux
+{
+
+/**
+ * @brief Content type of the text produced by renderOpenMetrics().
+ */
+inline constexpr const char* kOpenMetricsContentType =
+    "application/openmetrics-text; version=1.0.0; charset=utf-8";
+
+/**
+ * @brief Render all proxy, log-queue and latency metrics in OpenMetrics text format.
+ *
+ * Everything is read from in-memory counters and histograms, so a scrape
+ * never touches SQLite.
+ *
+ * @param db The database (request aggregates and write-queue stats).
+ * @param proxy The proxy handler (traffic counters, histograms, upstream health).
+ * @return std::string The exposition, terminated by "# EOF".
+ */
+[[nodiscard]] std::string renderOpenMetrics(Database& db, ProxyHandler& proxy);
+
+}  // namespace sectorflux
@@ -0,0 +1,69 @@
+/*
+ * SectorFlux - LLM Proxy and Analytics
+ * Copyright (c) 2025 ParticleSector.com
+ *
+ * This software is dual-licensed:
+ * - GPL-3.0 for open source use
+ * - Commercial license for proprietary use
+ *
+ * See LICENSE and LICENSING.md for details.
+ */
+
+#include "prefix_index.hpp"
+
+namespace sectorflux
+{
+
+PrefixIndex::PrefixIndex(size_t capacity) : capacity_(capacity)
+{
+}
+
+PrefixMatch PrefixIndex::longestMatch(const std::vector<CacheKey>& prefixes)
+{
+    PrefixMatch match;
+    match.total = prefixes.size();
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (size_t length = prefixes.size(); length > 0; --length)
+    {
+        auto it = index_.find(prefixes[length - 1]);
+        if (it != index_.end())
+        {
+            lru_.splice(lru_.begin(), lru_, it->second);
+            match.matched = length;
+            match.backend = it->second->backend;
+            break;
+        }
+    }
+    return match;
+}
+
+void PrefixIndex::record(const std::vector<CacheKey>& prefixes, const std::string& backend)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const auto& key : prefixes)
+    {
+        auto it = index_.find(key);
+        if (it != index_.end())
+        {
+            it->second->backend = backend;
+            lru_.splice(lru_.begin(), lru_, it->second);
+            continue;
+        }
+        lru_.push_front(Entry{key, backend});
+        index_.emplace(key, lru_.begin());
+        while (lru_.size() > capacity_)
+        {
+            index_.erase(lru_.back().key);
+            lru_.pop_back();
+        }
+    }
+}
+
+size_t PrefixIndex::size()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return lru_.size();
+}
+
+} // namespace sectorflux
@@ -0,0 +1,88 @@
+/*
+ * SectorFlux - LLM Proxy and Analytics
+ * Copyright (c) 2025 ParticleSector.com
+ *
+ * This software is dual-licensed:
+ * - GPL-3.0 for open source use
+ * - Commercial license for proprietary use
+ *
+ * See LICENSE and LICENSING.md for details.
+ */
+
+#pragma once
+
+#include "cache_key.hpp"
+
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace sectorflux
+{
+
+/**
+ * @brief How much of a chat request a recent conversation already covered.
+ */
+struct PrefixMatch
+{
+    size_t matched = 0;   // Leading messages seen in an earlier request
+    size_t total = 0;     // Messages in this request
+    std::string backend;  // Host that served the longest match; its KV cache is warm
+};
+
+/**
+ * @brief Recently seen chat conversations, keyed by message-prefix hash.
+ *
+ * Each turn of a conversation resends every earlier message, so the request
+ * for turn n extends the one for turn n-1. Indexing every prefix of every
+ * request answers "how many leading messages did we just see, and where"
+ * with one hash lookup per message. Bounded LRU; nothing is persisted.
+ */
+class PrefixIndex
+{
+public:
+    /**
+     * @brief Construct a new Prefix Index object.
+     * @param capacity Maximum number of prefixes remembered.
+     */
+    explicit PrefixIndex(size_t capacity);
+
+    // Delete copy operations
+    PrefixIndex(const PrefixIndex&) = delete;
+    PrefixIndex& operator=(const PrefixIndex&) = delete;
+
+    /**
+     * @brief Find the longest known prefix of a request's messages.
+     * @param prefixes NormalizedRequest::message_prefixes of the request.
+     * @return PrefixMatch matched is 0 if no prefix is known.
+     */
+    [[nodiscard]] PrefixMatch longestMatch(const std::vector<CacheKey>& prefixes);
+
+    /**
+     * @brief Remember every prefix of a served request.
+     * @param prefixes NormalizedRequest::message_prefixes of the request.
+     * @param backend The host that served it.
+     */
+    void record(const std::vector<CacheKey>& prefixes, const std::string& backend);
+
+    /**
+     * @brief Get the number of prefixes currently remembered.
+     */
+    [[nodiscard]] size_t size();
+
+private:
+    struct Entry
+    {
+        CacheKey key;
+        std::string backend;
+    };
+
+    std::mutex mutex_;
+    const size_t capacity_;
+    std::list<Entry> lru_;  // Most recently used first
+    std::unordered_map<CacheKey, std::list<Entry>::iterator, CacheKeyHash> index_;
+};
+
+} // namespace sectorflux
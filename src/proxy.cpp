@@ -13,257 +13,819 @@
 
 #include <httplib.h>
 
+#include <algorithm>
 #include <chrono>
 #include <iostream>
+#include <string_view>
 
 namespace sectorflux
 {
 
-ProxyHandler::ProxyHandler(Database& db) : db_(db)
+namespace
 {
+
+/**
+ * @brief Counts a request as in flight for the lifetime of the guard.
+ */
+class InFlightGuard
+{
+public:
+    explicit InFlightGuard(std::atomic<int64_t>& counter) : counter_(counter)
+    {
+        counter_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    ~InFlightGuard()
+    {
+        counter_.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    InFlightGuard(const InFlightGuard&) = delete;
+    InFlightGuard& operator=(const InFlightGuard&) = delete;
+
+private:
+    std::atomic<int64_t>& counter_;
+};
+
+/**
+ * @brief Add a keep_alive member to a JSON object body that has none.
+ *
+ * The check is textual, so a body that merely mentions keep_alive is left
+ * as sent, which is always safe.
+ *
+ * @param body The request body.
+ * @param keep_alive An Ollama duration such as "30m".
+ * @return std::string The body to send upstream.
+ */
+std::string withKeepAlive(const std::string& body, const std::string& keep_alive)
+{
+    const size_t open = body.find('{');
+    if (open == std::string::npos || body.find("\"keep_alive\"") != std::string::npos)
+    {
+        return body;
+    }
+    crow::json::wvalue value = keep_alive;
+    std::string member = "\"keep_alive\":" + value.dump();
+    const bool empty_object = body.find_first_not_of(" \t\r\n", open + 1) == body.find('}', open);
+    if (!empty_object)
+    {
+        member.push_back(',');
+    }
+    std::string spliced = body;
+    spliced.insert(open + 1, member);
+    return spliced;
 }
 
-std::string ProxyHandler::extractModelFromRequest(const std::string& request_body)
+}  // namespace
+
+ProxyHandler::ProxyHandler(Database& db, const RuntimeConfig& runtime)
+    : db_(db), runtime_(runtime)
 {
-    try
+}
+
+void ProxyHandler::applySettings(const RuntimeSettings& settings)
+{
+    upstream_pool_.setMaxIdlePerHost(static_cast<size_t>(settings.upstream_pool_size));
+    scheduler_.setLimits(static_cast<size_t>(settings.max_inflight_per_model),
+                         static_cast<size_t>(settings.max_inflight_per_backend));
+    response_cache_.setLimits(
+        static_cast<size_t>(settings.cache_memory_mb) * kBytesPerMegabyte,
+        static_cast<size_t>(settings.cache_max_entry_kb) * kBytesPerKilobyte);
+
+    if (settings.capture != capture_spec_)
     {
-        auto json = crow::json::load(request_body);
-        if (json && json.has("model"))
+        auto policy = std::make_shared<CapturePolicy>();
+        if (auto err = policy->parse(settings.capture))
         {
-            return json["model"].s();
+            // Validated on every path in, so only a bad environment gets here
+            std::cerr << "Warning: capturing every interaction in full: " << *err << std::endl;
         }
+        capture_policy_.store(std::move(policy), std::memory_order_release);
+        capture_spec_ = settings.capture;
     }
-    catch (...)
+}
+
+ProxyStats ProxyHandler::stats() const
+{
+    return ProxyStats{
+        .cache_hits = cache_hits_.load(std::memory_order_relaxed),
+        .cache_misses = cache_misses_.load(std::memory_order_relaxed),
+        .upstream_requests = upstream_requests_.load(std::memory_order_relaxed),
+        .upstream_errors = upstream_errors_.load(std::memory_order_relaxed),
+        .coalesced = coalesced_.load(std::memory_order_relaxed),
+        .cache_bypassed = cache_bypassed_.load(std::memory_order_relaxed),
+        .semantic_hits = semantic_hits_.load(std::memory_order_relaxed),
+        .prefix_matches = prefix_matches_.load(std::memory_order_relaxed),
+        .prefix_messages = prefix_messages_.load(std::memory_order_relaxed),
+        .streamed_tokens = streamed_tokens_.load(std::memory_order_relaxed),
+        .logs_truncated = logs_truncated_.load(std::memory_order_relaxed),
+        .logs_metrics_only = logs_metrics_only_.load(std::memory_order_relaxed),
+        .in_flight = in_flight_.load(std::memory_order_relaxed),
+        .live_tokens_per_sec = live_tokens_.perSecond()};
+}
+
+CaptureDecision ProxyHandler::captureFor(const std::string& endpoint,
+                                         const std::string& model,
+                                         int status,
+                                         size_t body_bytes,
+                                         long long duration_ms)
+{
+    auto policy = capture_policy_.load(std::memory_order_acquire);
+    if (policy->capturesAll())
+    {
+        return CaptureDecision{};
+    }
+
+    auto is_slow = [&]
+    {
+        auto series = latency_stats_.duration(model, endpoint);
+        return series && series->count >= kSlowCaptureMinSamples &&
+               duration_ms > static_cast<long long>(series->p99);
+    };
+    CaptureDecision decision = policy->decide(endpoint, model, status, body_bytes, is_slow);
+    if (decision.capture == LogCapture::Truncated)
+    {
+        logs_truncated_.fetch_add(1, std::memory_order_relaxed);
+    }
+    else if (decision.capture == LogCapture::MetricsOnly)
     {
-        // Ignore parsing errors
+        logs_metrics_only_.fetch_add(1, std::memory_order_relaxed);
     }
-    return "unknown";
+    return decision;
 }
 
-ProxyHandler::ResponseMetrics ProxyHandler::extractMetrics(const std::string& response)
+void ProxyHandler::countStreamedTokens(size_t token_lines)
 {
-    ResponseMetrics metrics;
+    if (token_lines > 0)
+    {
+        streamed_tokens_.fetch_add(token_lines, std::memory_order_relaxed);
+        live_tokens_.add(token_lines);
+    }
+}
 
-    try
+std::vector<float> ProxyHandler::embed(const std::string& text)
+{
+    crow::json::wvalue request;
+    request["model"] = semantic_model_;
+    request["input"] = text;
+    const std::string body = request.dump();
+
+    // A down or slow backend must not hold up the request it is a lookup for,
+    // so only healthy hosts are tried, within one budget for all attempts
+    ScopedSpan span(TracePhase::SemanticEmbed);
+    const auto deadline = std::chrono::steady_clock::now() + semantic_timeout_;
+    std::optional<std::string> response_body;
+    for (const auto& host : backends_.rank(semantic_model_))
     {
-        // For NDJSON streaming responses, split by newlines and parse each line
-        // The metrics are in the last JSON object with "done": true
-        size_t pos = response.length();
+        const auto remaining = std::chrono::duration_cast<std::chrono::microseconds>(
+            deadline - std::chrono::steady_clock::now());
+        if (remaining.count() <= 0)
+        {
+            break;
+        }
+        if (!backends_.isHealthy(host))
+        {
+            continue;
+        }
 
-        // Search backwards through the response for complete JSON objects
-        while (pos > 0)
+        // The pool's timeouts are whole seconds; this budget is finer
+        const auto sec = remaining.count() / 1000000;
+        const auto usec = remaining.count() % 1000000;
+        auto assignment = backends_.assign(host);
+        auto upstream = upstream_pool_.acquire(host, 0);
+        upstream->set_connection_timeout(sec, usec);
+        upstream->set_read_timeout(sec, usec);
+        auto result = upstream->Post("/api/embed", body, "application/json");
+        if (!result)
         {
-            // Find the end of a potential JSON line (look for newline or end)
-            size_t line_end = pos;
-            size_t line_start = response.rfind('\n', pos - 1);
-            if (line_start == std::string::npos)
+            upstream.invalidate();
+            if (result.error() == httplib::Error::Connection)
             {
-                line_start = 0;
+                backends_.reportFailure(host);
+                continue;
             }
-            else
+            break;  // Timed out; the budget is spent
+        }
+        if (result->status == 200)
+        {
+            backends_.reportSuccess(host, semantic_model_);
+            response_body = std::move(result->body);
+        }
+        break;
+    }
+    span.end();
+    if (!response_body)
+    {
+        return {};
+    }
+
+    auto response = crow::json::load(*response_body);
+    if (!response || !response.has("embeddings") ||
+        response["embeddings"].t() != crow::json::type::List ||
+        response["embeddings"].size() == 0)
+    {
+        return {};
+    }
+    const auto& first = response["embeddings"][0];
+    if (first.t() != crow::json::type::List)
+    {
+        return {};
+    }
+    std::vector<float> embedding;
+    embedding.reserve(first.size());
+    for (size_t i = 0; i < first.size(); ++i)
+    {
+        embedding.push_back(static_cast<float>(first[i].d()));
+    }
+    return embedding;
+}
+
+std::optional<CacheHit> ProxyHandler::findSimilar(NormalizedRequest& normalized)
+{
+    auto embedding = embed(normalized.prompt);
+    if (embedding.empty())
+    {
+        return std::nullopt;
+    }
+
+    ScopedSpan lookup(TracePhase::CacheLookup);
+    auto match = semantic_index_.nearest(normalized.context_key, embedding);
+    if (match && match->similarity >= semantic_threshold_)
+    {
+        // The indexed request may not have been cached (it failed, or was
+        // evicted since); that is simply a miss
+        if (auto cached = response_cache_.get(match->key))
+        {
+            return CacheHit{std::move(*cached), match->similarity};
+        }
+    }
+    normalized.prompt_embedding = std::move(embedding);
+    return std::nullopt;
+}
+
+PrefixMatch ProxyHandler::matchPrefix(const NormalizedRequest& normalized)
+{
+    if (!prefix_enabled_ || normalized.message_prefixes.empty())
+    {
+        return PrefixMatch{};
+    }
+    auto match = prefix_index_.longestMatch(normalized.message_prefixes);
+    if (match.matched > 0)
+    {
+        prefix_matches_.fetch_add(1, std::memory_order_relaxed);
+        prefix_messages_.fetch_add(match.matched, std::memory_order_relaxed);
+    }
+    return match;
+}
+
+std::optional<CacheHit> ProxyHandler::serveFromCache(
+    const std::string& request_body,
+    NormalizedRequest& normalized,
+    const std::string& target_endpoint)
+{
+    if (!cache_enabled_)
+    {
+        return std::nullopt;
+    }
+    if (!isCacheable(normalized))
+    {
+        cache_bypassed_.fetch_add(1, std::memory_order_relaxed);
+        return std::nullopt;
+    }
+
+    ScopedSpan lookup(TracePhase::CacheLookup);
+    std::optional<CacheHit> cached;
+    if (auto exact = response_cache_.get(normalized.key))
+    {
+        cached = CacheHit{std::move(*exact)};
+    }
+    lookup.end();
+    if (!cached && !semantic_model_.empty() && target_endpoint == "/api/generate" &&
+        !normalized.prompt.empty())
+    {
+        // Traced as its own embed phase plus a second, index-only lookup span
+        cached = findSimilar(normalized);
+        if (cached)
+        {
+            semantic_hits_.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+    if (!cached)
+    {
+        cache_misses_.fetch_add(1, std::memory_order_relaxed);
+        return std::nullopt;
+    }
+    cache_hits_.fetch_add(1, std::memory_order_relaxed);
+
+    std::cout << (cached->similarity < 1.0f ? "Similar-prompt cache hit for: "
+                                            : "Cache Hit for: ")
+              << target_endpoint << std::endl;
+
+    // Metrics were parsed when the response was cached
+    const auto& metrics = cached->metrics;
+
+    // Log the interaction asynchronously, flagged as a cache hit
+    const auto capture = captureFor(target_endpoint, normalized.model, cached->status,
+                                    std::max(request_body.size(), cached->body->size()), 0);
+    db_.logInteractionAsync(LogRecord{
+        .method = "POST",
+        .endpoint = target_endpoint,
+        .model = normalized.model,
+        .request_body = capture.request(request_body),
+        .response_status = cached->status,
+        .response_body = capture.response(cached->body),
+        .prompt_tokens = metrics.prompt_tokens,
+        .completion_tokens = metrics.completion_tokens,
+        .cache_hit = true,
+        .capture = capture.capture,
+        .trace = RequestTrace::forLog()});
+    return cached;
+}
+
+CacheOptions ProxyHandler::cacheOptions(const std::string& no_cache_header,
+                                        const std::string& ttl_header) const
+{
+    CacheOptions options{.lookup = no_cache_header != "true",
+                         .ttl = std::chrono::seconds(runtime_.current()->cache_ttl_sec)};
+    if (!ttl_header.empty())
+    {
+        try
+        {
+            size_t parsed = 0;
+            long long ttl = std::stoll(ttl_header, &parsed);
+            if (parsed == ttl_header.size() && ttl >= 0)
             {
-                line_start++;  // Move past the newline
+                options.ttl = std::chrono::seconds(ttl);
             }
+        }
+        catch (const std::exception&)
+        {
+            // Keep the default TTL
+        }
+    }
+    return options;
+}
+
+SchedulingHints ProxyHandler::schedulingHints(
+    const std::string& priority_header,
+    const std::string& client)
+{
+    return SchedulingHints{.priority = parsePriority(priority_header), .client = client};
+}
+
+ProxyHandler::UpstreamExchange ProxyHandler::exchangeUpstream(
+    const std::string& model,
+    const std::string& path,
+    const std::string& body,
+    const SchedulingHints& hints,
+    int timeout_sec,
+    const ChunkSink& on_chunk,
+    const StatusSink& on_status)
+{
+    UpstreamExchange exchange;
+    auto candidates = backends_.rank(model, hints.affinity);
+
+    while (!candidates.empty())
+    {
+        // Wait for a slot on the model and backend before touching the upstream
+        ScopedSpan scheduler_wait(TracePhase::SchedulerWait);
+        const std::chrono::seconds queue_timeout(runtime_.current()->queue_timeout_sec);
+        auto ticket = scheduler_.admit(model, candidates, hints, queue_timeout);
+        scheduler_wait.end();
+        if (!ticket)
+        {
+            return exchange;
+        }
+        exchange.admitted = true;
+        exchange.backend = ticket.backend();
+        exchange.queue_wait_ms += ticket.queueWaitMs();
 
-            // Extract the line and trim whitespace
-            std::string line = response.substr(line_start, line_end - line_start);
+        auto start_time = std::chrono::steady_clock::now();
+        auto assignment = backends_.assign(exchange.backend);
+        InFlightGuard in_flight(in_flight_);
+        upstream_requests_.fetch_add(1, std::memory_order_relaxed);
+
+        // Log the request
+        std::cout << "Forwarding request to: " << exchange.backend << path << std::endl;
+
+        ScopedSpan connect(TracePhase::UpstreamConnect);
+        auto upstream = upstream_pool_.acquire(exchange.backend, timeout_sec);
+        connect.end();
 
-            // Trim whitespace
-            size_t first = line.find_first_not_of(" \t\r\n");
-            if (first != std::string::npos)
+        // Construct httplib Request manually to support content receiver
+        httplib::Request req_http;
+        req_http.method = "POST";
+        req_http.path = path;
+        req_http.body = body;
+        req_http.set_header("Content-Type", "application/json");
+
+        // Chunk handling is only timed when the request is traced
+        RequestTrace* trace = RequestTrace::current();
+        RequestTrace::Clock::time_point first_byte_time;
+        RequestTrace::Clock::duration chunk_handling{};
+
+        bool answered = false;
+        bool received = false;
+        exchange.ttft_ms = 0;
+        req_http.response_handler = [&](const httplib::Response& response)
+        {
+            answered = true;
+            if (on_status)
+            {
+                on_status(response.status);
+            }
+            return true;
+        };
+        req_http.content_receiver = [&](const char* data,
+                                        size_t data_length,
+                                        uint64_t /*offset*/,
+                                        uint64_t /*total_length*/)
+        {
+            if (!received)
+            {
+                received = true;
+                first_byte_time = std::chrono::steady_clock::now();
+                exchange.ttft_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                    first_byte_time - start_time).count();
+            }
+            if (!trace)
             {
-                size_t last = line.find_last_not_of(" \t\r\n");
-                line = line.substr(first, last - first + 1);
+                return on_chunk(data, data_length);
             }
+            auto chunk_start = std::chrono::steady_clock::now();
+            bool keep_reading = on_chunk(data, data_length);
+            chunk_handling += std::chrono::steady_clock::now() - chunk_start;
+            return keep_reading;
+        };
+
+        auto send_time = std::chrono::steady_clock::now();
+        auto result = upstream->send(req_http);
+        auto end_time = std::chrono::steady_clock::now();
+        exchange.duration_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+            end_time - start_time).count();
 
-            if (!line.empty() && line.front() == '{')
+        if (trace)
+        {
+            if (received)
             {
-                auto json = crow::json::load(line);
-                if (json)
-                {
-                    bool found_metrics = false;
-
-                    if (json.has("prompt_eval_count"))
-                    {
-                        metrics.prompt_tokens = static_cast<int>(json["prompt_eval_count"].i());
-                        found_metrics = true;
-                    }
-                    if (json.has("eval_count"))
-                    {
-                        metrics.completion_tokens = static_cast<int>(json["eval_count"].i());
-                        found_metrics = true;
-                    }
-                    if (json.has("prompt_eval_duration"))
-                    {
-                        metrics.prompt_eval_duration_ms =
-                            json["prompt_eval_duration"].i() / kNanosecondsPerMillisecond;
-                        found_metrics = true;
-                    }
-                    if (json.has("eval_duration"))
-                    {
-                        metrics.eval_duration_ms =
-                            json["eval_duration"].i() / kNanosecondsPerMillisecond;
-                        found_metrics = true;
-                    }
-
-                    // Found the summary object with metrics or done flag
-                    if (found_metrics || (json.has("done") && json["done"].b()))
-                    {
-                        break;
-                    }
-                }
+                trace->add(TracePhase::FirstByte, send_time, first_byte_time);
+                trace->add(TracePhase::StreamForward, first_byte_time, end_time);
+                trace->add(TracePhase::ChunkHandling, first_byte_time,
+                           first_byte_time + chunk_handling);
             }
+            else
+            {
+                trace->add(TracePhase::FirstByte, send_time, end_time);
+            }
+        }
 
-            // Move to previous line
-            if (line_start == 0)
+        if (result)
+        {
+            exchange.status = result->status;
+            exchange.error.clear();
+            if (result->status >= 500)
+            {
+                upstream_errors_.fetch_add(1, std::memory_order_relaxed);
+            }
+            else if (result->status == 200)
             {
-                break;
+                backends_.reportSuccess(exchange.backend, model);
             }
-            pos = line_start - 1;
+            return exchange;
         }
-    }
-    catch (...)
-    {
-        // Ignore parsing errors
+
+        upstream.invalidate();
+        upstream_errors_.fetch_add(1, std::memory_order_relaxed);
+        exchange.error = to_string(result.error());
+        if (result.error() == httplib::Error::Canceled)
+        {
+            // The client went away; the backend is fine
+            return exchange;
+        }
+        backends_.reportFailure(exchange.backend);
+
+        // The status or bytes already reached the client, so the response
+        // cannot be restarted
+        if (answered || received)
+        {
+            return exchange;
+        }
+        std::cerr << "Backend " << exchange.backend << " failed (" << exchange.error
+                  << "), trying the next one" << std::endl;
+        std::erase(candidates, exchange.backend);
     }
 
-    return metrics;
+    return exchange;
 }
 
-void ProxyHandler::handleRequest(
-    const crow::request& req,
-    crow::response& res,
-    const std::string& target_endpoint)
+Flight::Outcome ProxyHandler::followFlight(
+    SingleFlight::Participation& participation,
+    const std::string& request_body,
+    const std::string& model,
+    const std::string& endpoint,
+    const ChunkSink& sink,
+    const StatusSink& on_status)
 {
-    auto start_time = std::chrono::steady_clock::now();
+    coalesced_.fetch_add(1, std::memory_order_relaxed);
+    std::cout << "Sharing in-flight generation for: " << endpoint << std::endl;
 
-    // Capture request body early (before res.end() which may invalidate req)
-    std::string request_body_copy = req.body;
-
-    // Extract model from request for logging
-    std::string model = extractModelFromRequest(request_body_copy);
+    ScopedSpan forward(TracePhase::StreamForward);
+    auto start_time = std::chrono::steady_clock::now();
+    auto outcome = participation.flight().follow(sink, on_status);
+    auto duration_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - start_time).count();
+    forward.end();
 
-    // 1. Check Cache (Smart Caching)
-    // Skip cache if X-SectorFlux-No-Cache header is present OR cache is globally disabled
-    bool skip_cache = !cache_enabled_ ||
-                      req.get_header_value("X-SectorFlux-No-Cache") == "true";
+    // The leader logs the generation itself; this row records the duplicate,
+    // which cost no upstream work, so it counts as a cache hit
+    if (outcome.status == 200)
+    {
+        auto body = participation.flight().body();
+        auto metrics = extractMetrics(*body);
+        const auto capture = captureFor(endpoint, model, outcome.status,
+                                        std::max(request_body.size(), body->size()), duration_ms);
+        db_.logInteractionAsync(LogRecord{
+            .method = "POST",
+            .endpoint = endpoint,
+            .model = model,
+            .request_body = capture.request(request_body),
+            .response_status = outcome.status,
+            .response_body = capture.response(body),
+            .duration_ms = duration_ms,
+            .prompt_tokens = metrics.prompt_tokens,
+            .completion_tokens = metrics.completion_tokens,
+            .cache_hit = true,
+            .capture = capture.capture,
+            .trace = RequestTrace::forLog()});
+    }
+    return outcome;
+}
 
-    if (!skip_cache)
+ProxyHandler::ForwardResult ProxyHandler::forwardUpstream(
+    const std::string& request_body,
+    const NormalizedRequest& normalized,
+    const std::string& target_endpoint,
+    const SchedulingHints& hints,
+    const PrefixMatch& prefix,
+    const CacheOptions& cache,
+    const ChunkSink& sink,
+    const StatusSink& on_status)
+{
+    // Identical requests already in flight share one generation
+    const bool cacheable = isCacheable(normalized);
+    SingleFlight::Participation flight;
+    if (cache.lookup && cache_enabled_ && cacheable)
     {
-        auto cached = db_.getCachedResponse(request_body_copy);
-        if (cached)
+        flight = single_flight_.join(normalized.key);
+        if (!flight.leader())
         {
-            std::cout << "Cache Hit for: " << target_endpoint << std::endl;
-            res.code = cached->first;
-            res.body = cached->second;
-            res.add_header("X-SectorFlux-Cache", "HIT");
-            res.end();
+            auto outcome = followFlight(flight, request_body, normalized.model,
+                                        target_endpoint, sink, on_status);
+            return ForwardResult{.status = outcome.status,
+                                 .error = std::move(outcome.error),
+                                 .body = flight.flight().body(),
+                                 .coalesced = true};
+        }
+    }
 
-            // Extract metrics from cached response for logging
-            auto metrics = extractMetrics(cached->second);
+    // Capture the full response for logging, its line timing for replay and
+    // its metrics, all in the one pass over each chunk. A flight's buffer
+    // doubles as the request's own, so shared generations are not held twice.
+    ResponseBuffer solo_response;
+    ChunkRecorder recorder;
+    StreamMetricsParser parser;
+    bool client_open = true;
 
-            // Log the interaction asynchronously (duration 0 indicates cache hit)
-            db_.logInteractionAsync(
-                "POST", target_endpoint, model, request_body_copy,
-                res.code, res.body, 0, metrics.prompt_tokens, metrics.completion_tokens,
-                0, 0, 0);
-            return;
+    // A continued conversation goes where its KV cache is warm; the log keeps
+    // the body as the client sent it
+    SchedulingHints placement = hints;
+    std::string keep_alive_body;
+    if (prefix.matched > 0)
+    {
+        placement.affinity = prefix.backend;
+        if (!prefix_keep_alive_.empty())
+        {
+            keep_alive_body = withKeepAlive(request_body, prefix_keep_alive_);
         }
     }
 
-    // Log the request
-    std::cout << "Forwarding request to: " << ollama_host_ << target_endpoint << std::endl;
-
-    httplib::Client cli(ollama_host_);
-    cli.set_connection_timeout(kConnectionTimeoutSec, 0);
-    cli.set_read_timeout(kConnectionTimeoutSec, 0);
+    auto exchange = exchangeUpstream(
+        normalized.model, target_endpoint,
+        keep_alive_body.empty() ? request_body : keep_alive_body, placement,
+        runtime_.current()->upstream_timeout_sec,
+        [&](const char* data, size_t length)
+        {
+            // Accumulate for DB
+            if (flight)
+            {
+                flight.flight().publish(data, length);
+            }
+            else
+            {
+                solo_response.append(data, length);
+            }
+            recorder.append(data, length);
+            countStreamedTokens(parser.feed(data, length));
 
-    // Capture the full response for logging
-    std::string accumulated_response;
-    long long ttft_ms = 0;
+            // Forward to client; stop reading upstream once nobody is listening
+            if (client_open)
+            {
+                client_open = sink(data, length);
+            }
+            return client_open || (flight && flight.flight().hasFollowers());
+        },
+        [&](int status)
+        {
+            if (flight)
+            {
+                flight.flight().begin(status);
+            }
+            if (on_status)
+            {
+                on_status(status);
+            }
+        });
 
-    // Prepare response headers for streaming
-    res.add_header("Content-Type", "application/json");
-    res.add_header("X-SectorFlux-Cache", "MISS");
+    if (!exchange.admitted)
+    {
+        ForwardResult timeout{503, "Timed out waiting for an upstream slot"};
+        flight.complete(timeout.status, timeout.error);
+        return timeout;
+    }
 
-    auto* res_ptr = &res;
+    // Upstream is done writing, so the client, the log and the cache can all
+    // hold the one buffer
+    ScopedSpan extraction(TracePhase::MetricsExtraction);
+    const auto metrics = parser.finish();
+    ForwardResult forward_result;
+    forward_result.body = flight ? flight.flight().body() : solo_response.share();
+    if (exchange.status)
+    {
+        forward_result.status = *exchange.status;
 
-    // Construct httplib Request manually to support content receiver
-    httplib::Request req_http;
-    req_http.method = "POST";
-    req_http.path = target_endpoint;
-    req_http.body = request_body_copy;
-    req_http.set_header("Content-Type", "application/json");
+        // Cache the response if successful, not empty and admitted by the policy
+        if (forward_result.status == 200 && cacheable && !forward_result.body->empty())
+        {
+            bool stored = response_cache_.put(normalized.key, forward_result.status,
+                                              forward_result.body,
+                                              recorder.finish(exchange.ttft_ms), metrics,
+                                              cache.ttl);
 
-    // Set content receiver to handle streaming response
-    req_http.content_receiver = [&](const char* data,
-                                    size_t data_length,
-                                    uint64_t /*offset*/,
-                                    uint64_t /*total_length*/)
-    {
-        if (ttft_ms == 0)
+            // Only a prompt whose response can actually be served is worth finding
+            if (stored && !normalized.prompt_embedding.empty())
+            {
+                semantic_index_.insert(normalized.context_key, normalized.key,
+                                       normalized.prompt_embedding);
+            }
+        }
+        if (forward_result.status == 200 && prefix_enabled_)
         {
-            auto now = std::chrono::steady_clock::now();
-            ttft_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
-                now - start_time).count();
+            prefix_index_.record(normalized.message_prefixes, exchange.backend);
         }
+    }
+    else
+    {
+        forward_result.status = 500;
+        forward_result.error = "Error forwarding request to Ollama: " + exchange.error;
+        forward_result.body = std::make_shared<const std::string>(*forward_result.error);
+    }
+    flight.complete(forward_result.status, forward_result.error);
 
-        // Receive chunk
-        std::string chunk(data, data_length);
+    if (forward_result.status == 200)
+    {
+        latency_stats_.record(normalized.model, target_endpoint, LatencySample{
+            .queue_wait_ms = exchange.queue_wait_ms,
+            .duration_ms = exchange.duration_ms,
+            .ttft_ms = exchange.ttft_ms,
+            .prompt_eval_duration_ms = metrics.prompt_eval_duration_ms,
+            .eval_duration_ms = metrics.eval_duration_ms,
+            .completion_tokens = metrics.completion_tokens});
+    }
+    extraction.end();
 
-        // Accumulate for DB
-        accumulated_response += chunk;
+    // Log to DB asynchronously
+    const auto capture = captureFor(
+        target_endpoint, normalized.model, forward_result.status,
+        std::max(request_body.size(), forward_result.body->size()), exchange.duration_ms);
+    db_.logInteractionAsync(LogRecord{
+        .method = "POST",
+        .endpoint = target_endpoint,
+        .model = normalized.model,
+        .backend = std::move(exchange.backend),
+        .request_body = capture.request(request_body),
+        .response_status = forward_result.status,
+        .response_body = capture.response(forward_result.body),
+        .duration_ms = exchange.duration_ms,
+        .prompt_tokens = metrics.prompt_tokens,
+        .completion_tokens = metrics.completion_tokens,
+        .prompt_eval_duration_ms = metrics.prompt_eval_duration_ms,
+        .eval_duration_ms = metrics.eval_duration_ms,
+        .ttft_ms = exchange.ttft_ms,
+        .queue_wait_ms = exchange.queue_wait_ms,
+        .capture = capture.capture,
+        .trace = RequestTrace::forLog()});
 
-        // Forward to client
-        res_ptr->body += chunk;
+    return forward_result;
+}
 
-        return true;  // Continue processing
-    };
+void ProxyHandler::handleRequest(
+    const crow::request& req,
+    crow::response& res,
+    const std::string& target_endpoint)
+{
+    RequestTrace trace;
+    TraceScope trace_scope(trace);
 
-    auto result = cli.send(req_http);
+    // Capture request body early (before res.end() which may invalidate req)
+    ScopedSpan parse(TracePhase::RequestParse);
+    std::string request_body_copy = req.body;
 
-    if (result)
-    {
-        res.code = result->status;
+    // Parse once; the normalized form supplies both the cache key and the model
+    auto normalized = RequestNormalizer::normalize(target_endpoint, request_body_copy);
+    parse.end();
+
+    // 1. Check Cache (Smart Caching)
+    // Skip cache if X-SectorFlux-No-Cache header is present
+    auto cache = cacheOptions(req.get_header_value("X-SectorFlux-No-Cache"),
+                              req.get_header_value("X-SectorFlux-Cache-TTL"));
 
-        // 2. Cache the response if successful and not empty
-        if (res.code == 200 && !accumulated_response.empty())
+    if (cache.lookup)
+    {
+        auto cached = serveFromCache(request_body_copy, normalized, target_endpoint);
+        if (cached)
         {
-            db_.cacheResponse(request_body_copy, res.code, accumulated_response);
+            res.code = cached->status;
+            res.body = *cached->body;
+            if (cached->similarity < 1.0f)
+            {
+                res.add_header("X-SectorFlux-Cache", "SIMILAR");
+                res.add_header("X-SectorFlux-Similarity", std::to_string(cached->similarity));
+            }
+            else
+            {
+                res.add_header("X-SectorFlux-Cache", "HIT");
+            }
+            res.add_header("X-SectorFlux-Cache-Key", normalized.key.toHex());
+            res.end();
+            return;
         }
     }
-    else
+
+    // 2. Forward upstream. Crow responses are sent in one piece, so the body
+    // is taken from the shared response buffer once it is complete instead of
+    // being appended chunk by chunk; StreamServer offers true chunked pass-through.
+    res.add_header("Content-Type", "application/json");
+    res.add_header("X-SectorFlux-Cache-Key", normalized.key.toHex());
+    auto prefix = matchPrefix(normalized);
+    if (prefix.matched > 0)
     {
-        res.code = 500;
-        res.body = "Error forwarding request to Ollama: " + to_string(result.error());
-        accumulated_response = res.body;
+        res.add_header("X-SectorFlux-Prefix-Match",
+                       std::to_string(prefix.matched) + "/" + std::to_string(prefix.total));
     }
-    res.end();
 
-    auto end_time = std::chrono::steady_clock::now();
-    auto duration_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
-        end_time - start_time).count();
+    auto hints = schedulingHints(req.get_header_value("X-SectorFlux-Priority"),
+                                 req.remote_ip_address);
+    auto result = forwardUpstream(request_body_copy, normalized, target_endpoint, hints,
+                                  prefix, cache,
+                                  [](const char*, size_t)
+                                  {
+                                      return true;
+                                  });
 
-    // Extract metrics from response
-    auto metrics = extractMetrics(accumulated_response);
-
-    // Log to DB asynchronously
-    db_.logInteractionAsync(
-        "POST", target_endpoint, model, request_body_copy, res.code, accumulated_response,
-        duration_ms, metrics.prompt_tokens, metrics.completion_tokens,
-        metrics.prompt_eval_duration_ms, metrics.eval_duration_ms, ttft_ms);
+    res.add_header("X-SectorFlux-Cache", result.coalesced           ? "SHARED"
+                                         : isCacheable(normalized) ? "MISS"
+                                                                   : "BYPASS");
+    res.code = result.status;
+    if (result.error)
+    {
+        res.body = *result.error;
+    }
+    else if (result.body)
+    {
+        res.body = *result.body;  // Crow owns its body, so this is the one copy
+    }
+    res.end();
 }
 
 void ProxyHandler::handleWebSocketRequest(
-    crow::websocket::connection& conn,
     const std::string& message,
-    std::atomic<bool>& is_active)
+    const ChunkSink& sink,
+    const std::atomic<bool>& is_active)
 {
+    auto send_text = [&sink](const std::string& text)
+    {
+        sink(text.data(), text.size());
+    };
+
+    RequestTrace trace;
+    TraceScope trace_scope(trace);
+
     // Parse incoming message to get model and prompt
+    ScopedSpan parse(TracePhase::RequestParse);
     auto json_req = crow::json::load(message);
     if (!json_req)
     {
-        conn.send_text("{\"error\": \"Invalid JSON\"}");
+        send_text("{\"error\": \"Invalid JSON\"}");
         return;
     }
 
@@ -274,107 +836,223 @@ void ProxyHandler::handleWebSocketRequest(
         model = json_req["model"].s();
     }
 
+    if (!json_req.has("messages"))
+    {
+        send_text("{\"error\": \"Missing 'messages' field\"}");
+        return;
+    }
+
+    // Force stream: true. The key is derived from this rebuilt body, which is
+    // what Ollama actually receives, so it matches equivalent HTTP requests.
+    crow::json::wvalue body;
+    body["model"] = model;
+    body["messages"] = json_req["messages"];
+    body["stream"] = true;
+    std::string upstream_body = body.dump();
+    const auto normalized = RequestNormalizer::normalize("/api/chat", upstream_body);
+    const CacheKey& cache_key = normalized.key;
+    parse.end();
+
     // 1. Check Cache (Smart Caching)
-    if (cache_enabled_)
+    const bool cacheable = cache_enabled_ && isCacheable(normalized);
+    if (cache_enabled_ && !cacheable)
     {
-        auto cached = db_.getCachedResponse(message);
-        if (cached)
+        cache_bypassed_.fetch_add(1, std::memory_order_relaxed);
+    }
+    if (cacheable)
+    {
+        ScopedSpan lookup(TracePhase::CacheLookup);
+        auto cached = response_cache_.get(cache_key);
+        lookup.end();
+        if (!cached)
         {
+            cache_misses_.fetch_add(1, std::memory_order_relaxed);
+        }
+        else
+        {
+            cache_hits_.fetch_add(1, std::memory_order_relaxed);
             std::cout << "Cache Hit for WebSocket Chat" << std::endl;
-            conn.send_text(cached->second);
 
-            // Extract metrics from cached response for logging
-            auto metrics = extractMetrics(cached->second);
+            // Stream the hit line by line, like a live generation
+            auto pacing = json_req.has("replay")
+                              ? parseReplayPacing(std::string(json_req["replay"].s()))
+                              : ReplayPacing::Immediate;
+            ScopedSpan replay(TracePhase::StreamForward);
+            replayChunks(*cached->body, *cached->chunks, pacing,
+                         [&](const char* data, size_t length)
+                         {
+                             return is_active && sink(data, length);
+                         });
+            replay.end();
+
+            // Metrics were parsed when the response was cached
+            const auto& metrics = cached->metrics;
 
-            // Log the interaction asynchronously (duration 0 indicates cache hit)
-            db_.logInteractionAsync(
-                "POST", "/api/chat", model, message,
-                cached->first, cached->second, 0, metrics.prompt_tokens, metrics.completion_tokens,
-                0, 0, 0);
+            // Log the interaction asynchronously, flagged as a cache hit
+            const auto capture = captureFor("/api/chat", model, cached->status,
+                                            std::max(message.size(), cached->body->size()), 0);
+            db_.logInteractionAsync(LogRecord{
+                .method = "POST",
+                .endpoint = "/api/chat",
+                .model = model,
+                .request_body = capture.request(message),
+                .response_status = cached->status,
+                .response_body = capture.response(cached->body),
+                .prompt_tokens = metrics.prompt_tokens,
+                .completion_tokens = metrics.completion_tokens,
+                .cache_hit = true,
+                .capture = capture.capture,
+                .trace = RequestTrace::forLog()});
+            return;
+        }
+    }
+
+    // A duplicate of a chat already streaming shares it instead of generating again
+    SingleFlight::Participation flight;
+    if (cacheable)
+    {
+        flight = single_flight_.join(cache_key);
+        if (!flight.leader())
+        {
+            auto outcome = followFlight(flight, message, model, "/api/chat",
+                                        [&](const char* data, size_t length)
+                                        {
+                                            return is_active && sink(data, length);
+                                        },
+                                        {});
+            if (is_active && outcome.status != 200)
+            {
+                send_text("{\"error\": \"Failed to connect to Ollama\"}");
+            }
             return;
         }
     }
 
-    // Run synchronously in the worker thread managed by main.cpp
+    // The playground is a person waiting on tokens, so it jumps batch traffic.
+    // A continued conversation goes where its KV cache is warm; keep_alive is
+    // not part of the key, so adding it leaves cache_key as it is.
+    SchedulingHints hints{.priority = Priority::Interactive, .client = kPlaygroundClient};
+    auto prefix = matchPrefix(normalized);
+    if (prefix.matched > 0)
+    {
+        hints.affinity = prefix.backend;
+        if (!prefix_keep_alive_.empty())
+        {
+            body["keep_alive"] = prefix_keep_alive_;
+            upstream_body = body.dump();
+        }
+    }
+
+    // Runs synchronously on a ChatExecutor worker
     try
     {
-        auto start_time = std::chrono::steady_clock::now();
+        ResponseBuffer solo_response;
+        ChunkRecorder recorder;
+        StreamMetricsParser parser;
+        bool client_open = true;
 
-        // Construct request to Ollama
-        httplib::Client cli(ollama_host_);
-        cli.set_connection_timeout(kWebSocketTimeoutSec, 0);
-        cli.set_read_timeout(kWebSocketTimeoutSec, 0);
+        auto exchange = exchangeUpstream(
+            model, "/api/chat", upstream_body, hints, runtime_.current()->websocket_timeout_sec,
+            [&](const char* data, size_t length)
+            {
+                if (flight)
+                {
+                    flight.flight().publish(data, length);
+                }
+                else
+                {
+                    solo_response.append(data, length);
+                }
+                recorder.append(data, length);
+                countStreamedTokens(parser.feed(data, length));
 
-        httplib::Request req_http;
-        req_http.method = "POST";
-        req_http.path = "/api/chat";
-        req_http.set_header("Content-Type", "application/json");
+                // Check if connection is still active
+                if (client_open)
+                {
+                    client_open = is_active && sink(data, length);
+                }
 
-        // Force stream: true
-        crow::json::wvalue body;
-        body["model"] = json_req["model"].s();
-        body["messages"] = json_req["messages"];
-        body["stream"] = true;
-        req_http.body = body.dump();
+                // Stop httplib request unless another request shares it
+                return client_open || (flight && flight.flight().hasFollowers());
+            },
+            [&](int status)
+            {
+                if (flight)
+                {
+                    flight.flight().begin(status);
+                }
+            });
 
-        std::string full_response;
-        long long ttft_ms = 0;
+        if (!exchange.admitted)
+        {
+            flight.complete(503, "Timed out waiting for an upstream slot");
+            send_text("{\"error\": \"Timed out waiting for an upstream slot\"}");
+            return;
+        }
 
-        // Stream response back to client
-        req_http.content_receiver = [&](const char* data,
-                                        size_t data_length,
-                                        uint64_t /*offset*/,
-                                        uint64_t /*total_length*/)
+        ScopedSpan extraction(TracePhase::MetricsExtraction);
+        const auto metrics = parser.finish();
+        const SharedBody full_response =
+            flight ? flight.flight().body() : solo_response.share();
+        if (exchange.status)
         {
-            if (ttft_ms == 0)
+            // Cache the response if enabled and valid
+            if (*exchange.status == 200 && cacheable && !full_response->empty())
             {
-                auto now = std::chrono::steady_clock::now();
-                ttft_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
-                    now - start_time).count();
+                response_cache_.put(cache_key, 200, full_response,
+                                    recorder.finish(exchange.ttft_ms), metrics,
+                                    std::chrono::seconds(runtime_.current()->cache_ttl_sec));
             }
-
-            // Check if connection is still active
-            if (!is_active)
+            if (*exchange.status == 200 && prefix_enabled_)
             {
-                return false;  // Stop httplib request
+                prefix_index_.record(normalized.message_prefixes, exchange.backend);
             }
+            flight.complete(*exchange.status, std::nullopt);
+        }
+        else
+        {
+            flight.complete(500, "Error forwarding request to Ollama: " + exchange.error);
+        }
 
-            std::string chunk(data, data_length);
-            full_response += chunk;
-            conn.send_text(chunk);
-            return true;
-        };
-
-        auto result = cli.send(req_http);
+        extraction.end();
 
         // Only log if we finished successfully and weren't aborted
         if (is_active)
         {
-            if (!result || result->status != 200)
+            if (exchange.status != 200)
             {
-                conn.send_text("{\"error\": \"Failed to connect to Ollama\"}");
+                send_text("{\"error\": \"Failed to connect to Ollama\"}");
             }
             else
             {
-                // Log the interaction
-                auto end_time = std::chrono::steady_clock::now();
-                long long duration_ms =
-                    std::chrono::duration_cast<std::chrono::milliseconds>(
-                        end_time - start_time).count();
-
-                // Extract metrics from response
-                auto metrics = extractMetrics(full_response);
-
-                db_.logInteractionAsync(
-                    "POST", "/api/chat", model, message, 200, full_response,
-                    duration_ms, metrics.prompt_tokens, metrics.completion_tokens,
-                    metrics.prompt_eval_duration_ms, metrics.eval_duration_ms, ttft_ms);
-
-                // Cache the response if enabled and valid
-                if (cache_enabled_ && !full_response.empty())
-                {
-                    db_.cacheResponse(message, 200, full_response);
-                }
+                latency_stats_.record(model, "/api/chat", LatencySample{
+                    .queue_wait_ms = exchange.queue_wait_ms,
+                    .duration_ms = exchange.duration_ms,
+                    .ttft_ms = exchange.ttft_ms,
+                    .prompt_eval_duration_ms = metrics.prompt_eval_duration_ms,
+                    .eval_duration_ms = metrics.eval_duration_ms,
+                    .completion_tokens = metrics.completion_tokens});
+
+                const auto capture = captureFor(
+                    "/api/chat", model, 200, std::max(message.size(), full_response->size()),
+                    exchange.duration_ms);
+                db_.logInteractionAsync(LogRecord{
+                    .method = "POST",
+                    .endpoint = "/api/chat",
+                    .model = model,
+                    .backend = std::move(exchange.backend),
+                    .request_body = capture.request(message),
+                    .response_status = 200,
+                    .response_body = capture.response(full_response),
+                    .duration_ms = exchange.duration_ms,
+                    .prompt_tokens = metrics.prompt_tokens,
+                    .completion_tokens = metrics.completion_tokens,
+                    .prompt_eval_duration_ms = metrics.prompt_eval_duration_ms,
+                    .eval_duration_ms = metrics.eval_duration_ms,
+                    .ttft_ms = exchange.ttft_ms,
+                    .queue_wait_ms = exchange.queue_wait_ms,
+                    .capture = capture.capture,
+                    .trace = RequestTrace::forLog()});
             }
         }
     }
@@ -383,7 +1061,7 @@ void ProxyHandler::handleWebSocketRequest(
         std::cerr << "Exception in handleWebSocketRequest: " << e.what() << std::endl;
         if (is_active)
         {
-            conn.send_text("{\"error\": \"Internal Server Error\"}");
+            send_text("{\"error\": \"Internal Server Error\"}");
         }
     }
     catch (...)
@@ -11,17 +11,87 @@
 
 #pragma once
 
+#include "admission_scheduler.hpp"
+#include "backend_pool.hpp"
+#include "capture_policy.hpp"
 #include "config.hpp"
 #include "database.hpp"
+#include "latency_histogram.hpp"
+#include "prefix_index.hpp"
+#include "request_normalizer.hpp"
+#include "response_buffer.hpp"
+#include "response_cache.hpp"
+#include "runtime_config.hpp"
+#include "single_flight.hpp"
+#include "stream_metrics.hpp"
+#include "trace.hpp"
+#include "upstream_pool.hpp"
+#include "vector_index.hpp"
 
 #include <crow.h>
 
 #include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
 #include <string>
+#include <utility>
+#include <vector>
 
 namespace sectorflux
 {
 
+/**
+ * @brief Callback receiving each response chunk as it arrives from Ollama.
+ * @return bool False to abort the upstream request (e.g. client disconnected).
+ */
+using ChunkSink = std::function<bool(const char* data, size_t length)>;
+
+/**
+ * @brief Callback receiving the upstream status line, before any chunk of its body.
+ */
+using StatusSink = std::function<void(int status)>;
+
+/**
+ * @brief How a request may use the response cache, from its headers.
+ */
+struct CacheOptions
+{
+    bool lookup = true;            // False for X-SectorFlux-No-Cache
+    std::chrono::seconds ttl{0};   // Lifetime of the stored response; 0 never expires
+};
+
+/**
+ * @brief Point-in-time copy of the proxy's traffic counters.
+ */
+struct ProxyStats
+{
+    uint64_t cache_hits = 0;
+    uint64_t cache_misses = 0;
+    uint64_t upstream_requests = 0;
+    uint64_t upstream_errors = 0;
+    uint64_t coalesced = 0;
+    uint64_t cache_bypassed = 0;   // Requests the admission policy kept out of the cache
+    uint64_t semantic_hits = 0;    // Cache hits on a near-duplicate prompt (in cache_hits)
+    uint64_t prefix_matches = 0;   // Chats continuing a conversation seen before
+    uint64_t prefix_messages = 0;  // Leading messages those chats shared with it
+    uint64_t streamed_tokens = 0;  // Token lines relayed from upstream streams
+    uint64_t logs_truncated = 0;     // Log records whose bodies the capture policy cut
+    uint64_t logs_metrics_only = 0;  // Log records it kept no bodies for
+    int64_t in_flight = 0;
+    double live_tokens_per_sec = 0;
+};
+
+/**
+ * @brief A response served from the cache.
+ */
+struct CacheHit : CachedResponse
+{
+    float similarity = 1.0f;  // Below 1 when the prompt only nearly matched
+};
+
 /**
  * @brief Handles proxying requests to Ollama and streaming responses.
  *
@@ -37,8 +107,9 @@ public:
     /**
      * @brief Construct a new Proxy Handler object.
      * @param db Reference to the Database object for logging.
+     * @param runtime Source of timeouts, pool sizes and cache budgets.
      */
-    explicit ProxyHandler(Database& db);
+    ProxyHandler(Database& db, const RuntimeConfig& runtime);
     ~ProxyHandler() = default;
 
     // Delete copy operations
@@ -56,16 +127,130 @@ public:
         crow::response& res,
         const std::string& target_endpoint);
 
+    /**
+     * @brief Serve a request from the response cache, if possible.
+     *
+     * On a hit the interaction is logged as a cache hit before returning.
+     * With SECTORFLUX_SEMANTIC_MODEL set, an /api/generate miss falls back to
+     * the stored response of the most similar earlier prompt whose other
+     * fields match exactly, if it is at least SECTORFLUX_SEMANTIC_THRESHOLD
+     * similar. On such a miss the prompt's embedding is kept in normalized,
+     * so forwardUpstream() can index it once the response is cached.
+     *
+     * @param request_body The raw JSON request body.
+     * @param normalized The normalized form of request_body (cache key, model).
+     * @param target_endpoint The Ollama endpoint the request targets.
+     * @return std::optional<CacheHit> The cached response on a hit,
+     *         nullopt on a miss or when caching is disabled.
+     */
+    [[nodiscard]] std::optional<CacheHit> serveFromCache(
+        const std::string& request_body,
+        NormalizedRequest& normalized,
+        const std::string& target_endpoint);
+
+    /**
+     * @brief Look up how much of a chat the conversation index has already seen.
+     * @param normalized The normalized request (message prefixes).
+     * @return PrefixMatch matched is 0 for a new conversation, a non-chat
+     *         request, or when SECTORFLUX_PREFIX_CACHE is off.
+     */
+    [[nodiscard]] PrefixMatch matchPrefix(const NormalizedRequest& normalized);
+
+    /**
+     * @brief Result of forwarding a request upstream.
+     */
+    struct ForwardResult
+    {
+        int status = 500;
+        std::optional<std::string> error;
+        SharedBody body{};       // The full response, shared with the log and the cache
+        bool coalesced = false;  // Served by an identical request already in flight
+    };
+
+    /**
+     * @brief Forward a request to Ollama, passing each chunk to a sink as it arrives.
+     *
+     * The full response is still accumulated, once, into a buffer that the
+     * result, the log and the cache share, so the sink only decides how the
+     * client receives the bytes. With coalescing,
+     * a request identical to one already in flight shares its stream instead
+     * of starting another generation. A chat continuing a known conversation
+     * is sent to the backend that served it, whose KV cache still holds the
+     * shared messages, with SECTORFLUX_PREFIX_KEEP_ALIVE if one is set.
+     *
+     * @param request_body The raw JSON request body.
+     * @param normalized The normalized form of request_body (cache key, model).
+     * @param target_endpoint The Ollama endpoint to forward to.
+     * @param hints Priority class and fairness key for the admission scheduler.
+     * @param prefix The request's matchPrefix() result.
+     * @param cache Whether in-flight generations are shared, and the stored
+     *        response's TTL. Responses of requests the admission policy
+     *        rejects are neither shared nor stored.
+     * @param sink Receives each chunk; returning false aborts the upstream request
+     *        unless other requests are sharing it.
+     * @param on_status Called with the upstream status as soon as its status
+     *        line arrives; not called if the request was never answered.
+     * @return ForwardResult The upstream status, or an error message on failure
+     *         (503 if no upstream slot freed up within the queue timeout).
+     */
+    ForwardResult forwardUpstream(
+        const std::string& request_body,
+        const NormalizedRequest& normalized,
+        const std::string& target_endpoint,
+        const SchedulingHints& hints,
+        const PrefixMatch& prefix,
+        const CacheOptions& cache,
+        const ChunkSink& sink,
+        const StatusSink& on_status = {});
+
+    /**
+     * @brief Read a request's cache headers.
+     * @param no_cache_header Value of X-SectorFlux-No-Cache (may be empty).
+     * @param ttl_header Value of X-SectorFlux-Cache-TTL in seconds; empty or
+     *        invalid falls back to the cache_ttl_sec setting.
+     * @return CacheOptions The options to pass to forwardUpstream().
+     */
+    [[nodiscard]] CacheOptions cacheOptions(const std::string& no_cache_header,
+                                            const std::string& ttl_header) const;
+
+    /**
+     * @brief Check whether the cache admission policy lets a request use the cache.
+     * @param normalized The normalized request.
+     * @return bool False for a sampled request under cache_deterministic_only.
+     */
+    [[nodiscard]] bool isCacheable(const NormalizedRequest& normalized) const
+    {
+        return !runtime_.current()->cache_deterministic_only || normalized.deterministic;
+    }
+
+    /**
+     * @brief Build scheduling hints from a request's priority header and client address.
+     * @param priority_header Value of X-SectorFlux-Priority (may be empty).
+     * @param client The client's remote address.
+     * @return SchedulingHints The hints to pass to forwardUpstream().
+     */
+    [[nodiscard]] static SchedulingHints schedulingHints(
+        const std::string& priority_header,
+        const std::string& client);
+
     /**
      * @brief Handle a WebSocket chat request and stream the response from Ollama.
-     * @param conn The WebSocket connection.
      * @param message The incoming JSON message string.
+     * @param sink Delivers each text frame to the client; false once it is gone.
      * @param is_active Atomic flag to check if the connection is still active.
      */
     void handleWebSocketRequest(
-        crow::websocket::connection& conn,
         const std::string& message,
-        std::atomic<bool>& is_active);
+        const ChunkSink& sink,
+        const std::atomic<bool>& is_active);
+
+    /**
+     * @brief Resize the upstream pool, admission limits and memory cache budget,
+     *        and swap in a changed capture policy.
+     * @param settings The snapshot just published; timeouts and cache policy
+     *        are read from the RuntimeConfig per request instead.
+     */
+    void applySettings(const RuntimeSettings& settings);
 
     /**
      * @brief Enable or disable response caching.
@@ -86,39 +271,249 @@ public:
     }
 
     /**
-     * @brief Metrics extracted from Ollama response.
+     * @brief Drop every cached response, in memory and in SQLite.
+     * @return std::optional<long long> Number of persisted entries deleted,
+     *         nullopt on failure.
      */
-    struct ResponseMetrics
+    std::optional<long long> flushCache()
     {
-        int prompt_tokens = 0;
-        int completion_tokens = 0;
-        long long prompt_eval_duration_ms = 0;
-        long long eval_duration_ms = 0;
-    };
+        return response_cache_.clear();
+    }
+
+    /**
+     * @brief Get occupancy and eviction counters of the in-memory cache tier.
+     */
+    [[nodiscard]] ResponseCacheStats cacheStats()
+    {
+        return response_cache_.stats();
+    }
+
+    /**
+     * @brief Get the Ollama host for model-independent calls (e.g. /api/tags).
+     * @return std::string The first healthy backend's base URL.
+     */
+    [[nodiscard]] std::string ollamaHost() const
+    {
+        return backends_.primary();
+    }
+
+    /**
+     * @brief Get the Ollama backends generation requests are balanced across.
+     */
+    [[nodiscard]] const BackendPool& backends() const
+    {
+        return backends_;
+    }
+
+    /**
+     * @brief Get the per-model, per-endpoint latency histograms.
+     * @return const LatencyStats& Histograms of successful upstream requests.
+     */
+    [[nodiscard]] const LatencyStats& latencyStats() const
+    {
+        return latency_stats_;
+    }
+
+    /**
+     * @brief Get the proxy's traffic counters.
+     * @return ProxyStats Cache lookups, upstream requests/errors and in-flight streams.
+     */
+    [[nodiscard]] ProxyStats stats() const;
+
+    /**
+     * @brief Get queue depths and counters of the admission scheduler.
+     */
+    [[nodiscard]] SchedulerStats schedulerStats() const
+    {
+        return scheduler_.stats();
+    }
+
+    /**
+     * @brief Get the shared keep-alive connection pool to Ollama.
+     * @return UpstreamPool& The pool, shared by all proxy paths.
+     */
+    [[nodiscard]] UpstreamPool& upstreamPool()
+    {
+        return upstream_pool_;
+    }
+
+    /**
+     * @brief Metrics extracted from Ollama response.
+     */
+    using ResponseMetrics = sectorflux::ResponseMetrics;
 
     /**
      * @brief Extract metrics from Ollama response (handles both single JSON and NDJSON).
+     *
+     * Live streams are scanned incrementally instead; this is for bodies that
+     * are already complete.
+     *
      * @param response The response body string.
      * @return ResponseMetrics The extracted metrics.
      */
-    [[nodiscard]] ResponseMetrics extractMetrics(const std::string& response);
+    [[nodiscard]] static ResponseMetrics extractMetrics(const std::string& response)
+    {
+        return StreamMetricsParser::parse(response);
+    }
 
 private:
     /**
-     * @brief Extract model name from request JSON.
-     * @param request_body The raw JSON request body.
-     * @return std::string The model name, or "unknown" if not found.
+     * @brief Outcome of sending one request through the scheduler and backend pool.
      */
-    [[nodiscard]] std::string extractModelFromRequest(const std::string& request_body);
+    struct UpstreamExchange
+    {
+        bool admitted = false;            // False if the queue wait timed out
+        std::optional<int> status;        // Nullopt if no backend answered
+        std::string error;                // Transport error of the last attempt
+        std::string backend;              // Host of the last attempt
+        long long queue_wait_ms = 0;
+        long long ttft_ms = 0;
+        long long duration_ms = 0;        // From admission to the end of the response
+    };
+
+    /**
+     * @brief Replay an in-flight generation to a duplicate request and log it.
+     * @param participation The follower's handle on the flight.
+     * @param request_body The follower's own request body (for the log).
+     * @param model The requested model.
+     * @param endpoint The Ollama endpoint.
+     * @param sink Receives the shared chunks.
+     * @param on_status Receives the leader's upstream status line.
+     * @return Flight::Outcome The leader's final status.
+     */
+    Flight::Outcome followFlight(
+        SingleFlight::Participation& participation,
+        const std::string& request_body,
+        const std::string& model,
+        const std::string& endpoint,
+        const ChunkSink& sink,
+        const StatusSink& on_status);
+
+    /**
+     * @brief Find a cached response to a prompt similar to this one.
+     *
+     * Embeds the prompt with the configured model; on a miss the embedding
+     * is kept in normalized.prompt_embedding, to be indexed under the
+     * request's key once its response is cached.
+     *
+     * @param normalized The normalized /api/generate request.
+     * @return std::optional<CacheHit> The similar response, nullopt if none is
+     *         close enough or the embedding failed.
+     */
+    std::optional<CacheHit> findSimilar(NormalizedRequest& normalized);
+
+    /**
+     * @brief Embed a prompt through Ollama's /api/embed.
+     *
+     * Goes to the healthy backends in rank() order, within a budget of
+     * SECTORFLUX_SEMANTIC_TIMEOUT_MS in all; a slow or missing embedding only
+     * costs the near-duplicate lookup, never the request.
+     *
+     * @param text The text to embed.
+     * @return std::vector<float> The embedding; empty on failure or timeout.
+     */
+    std::vector<float> embed(const std::string& text);
+
+    /**
+     * @brief Decide how much of a finished interaction to log.
+     *
+     * Failed requests are always captured in full, and so are requests slower
+     * than the p99 of their model and endpoint once that has enough samples.
+     *
+     * @param endpoint The Ollama endpoint.
+     * @param model The model name.
+     * @param status The response status.
+     * @param body_bytes Size of the larger of the two bodies.
+     * @param duration_ms How long the request took.
+     * @return CaptureDecision What the log record keeps; counted in the stats.
+     */
+    CaptureDecision captureFor(const std::string& endpoint,
+                               const std::string& model,
+                               int status,
+                               size_t body_bytes,
+                               long long duration_ms);
+
+    /**
+     * @brief Account token lines relayed from a live stream (counter and live rate).
+     */
+    void countStreamedTokens(size_t token_lines);
+
+    /**
+     * @brief Admit a request, send it to the best backend and stream the response.
+     *
+     * If a backend cannot be reached before any byte has arrived, the request
+     * is re-admitted on the remaining backends, so a dead node costs a retry
+     * instead of a failed request. Once a status line has arrived the
+     * response is committed and is not retried.
+     *
+     * @param model The model the request targets (drives placement).
+     * @param path The Ollama endpoint.
+     * @param body The JSON body to send.
+     * @param hints Priority class, fairness key and preferred backend.
+     * @param timeout_sec Connection and read timeout per attempt.
+     * @param on_chunk Receives each response chunk; false aborts the request.
+     * @param on_status Receives the status line; may be empty.
+     * @return UpstreamExchange Status, timings and the serving backend.
+     */
+    UpstreamExchange exchangeUpstream(
+        const std::string& model,
+        const std::string& path,
+        const std::string& body,
+        const SchedulingHints& hints,
+        int timeout_sec,
+        const ChunkSink& on_chunk,
+        const StatusSink& on_status);
 
-    const std::string ollama_host_ = Config::getOllamaHost();
     Database& db_;
+    const RuntimeConfig& runtime_;
+    UpstreamPool upstream_pool_{static_cast<size_t>(runtime_.current()->upstream_pool_size)};
+    BackendPool backends_{Config::getOllamaHosts(), upstream_pool_};
+    ResponseCache response_cache_{
+        db_, static_cast<size_t>(runtime_.current()->cache_memory_mb) * kBytesPerMegabyte,
+        static_cast<size_t>(runtime_.current()->cache_max_entry_kb) * kBytesPerKilobyte};
+    LatencyStats latency_stats_;
+    SingleFlight single_flight_;
+    AdmissionScheduler scheduler_{
+        static_cast<size_t>(runtime_.current()->max_inflight_per_model),
+        static_cast<size_t>(runtime_.current()->max_inflight_per_backend)};
     bool cache_enabled_ = true;
 
+    // Conversation and near-duplicate indexes (in memory only)
+    const bool prefix_enabled_ = Config::getPrefixCacheEnabled();
+    const std::string prefix_keep_alive_ = Config::getPrefixKeepAlive();
+    PrefixIndex prefix_index_{kPrefixIndexCapacity};
+    const std::string semantic_model_ = Config::getSemanticModel();
+    const float semantic_threshold_ = static_cast<float>(Config::getSemanticThreshold());
+    VectorIndex semantic_index_{static_cast<size_t>(Config::getSemanticCapacity())};
+    const std::chrono::milliseconds semantic_timeout_{Config::getSemanticTimeoutMs()};
+
+    // Log capture policy, replaced whole when the capture setting changes
+    std::atomic<std::shared_ptr<const CapturePolicy>> capture_policy_{
+        std::make_shared<const CapturePolicy>()};
+    std::string capture_spec_;  // Source of capture_policy_; only applySettings touches it
+
+    // Traffic counters, read by the metrics endpoints
+    std::atomic<uint64_t> cache_hits_{0};
+    std::atomic<uint64_t> cache_misses_{0};
+    std::atomic<uint64_t> upstream_requests_{0};
+    std::atomic<uint64_t> upstream_errors_{0};
+    std::atomic<uint64_t> coalesced_{0};
+    std::atomic<uint64_t> cache_bypassed_{0};
+    std::atomic<uint64_t> semantic_hits_{0};
+    std::atomic<uint64_t> prefix_matches_{0};
+    std::atomic<uint64_t> prefix_messages_{0};
+    std::atomic<uint64_t> streamed_tokens_{0};
+    std::atomic<uint64_t> logs_truncated_{0};
+    std::atomic<uint64_t> logs_metrics_only_{0};
+    std::atomic<int64_t> in_flight_{0};
+    RateMeter live_tokens_;
+
     // Constants
-    static constexpr int kConnectionTimeoutSec = 60;
-    static constexpr int kWebSocketTimeoutSec = 300;
-    static constexpr long long kNanosecondsPerMillisecond = 1000000;
+    static constexpr size_t kPrefixIndexCapacity = 65536;
+    static constexpr uint64_t kSlowCaptureMinSamples = 100;  // Before p99 marks a request slow
+    static constexpr const char* kPlaygroundClient = "playground";
+    static constexpr size_t kBytesPerMegabyte = 1024 * 1024;
+    static constexpr size_t kBytesPerKilobyte = 1024;
 };
 
 } // namespace sectorflux
@@ -0,0 +1,297 @@
+/*
+ * SectorFlux - LLM Proxy and Analytics
+ * Copyright (c) 2025 ParticleSector.com
+ *
+ * This software is dual-licensed:
+ * - GPL-3.0 for open source use
+ * - Commercial license for proprietary use
+ *
+ * See LICENSE and LICENSING.md for details.
+ */
+
+#include "request_normalizer.hpp"
+
+#include <crow.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <string_view>
+#include <utility>
+
+namespace sectorflux
+{
+
+namespace
+{
+
+void appendEscaped(std::string& out, const std::string& text)
+{
+    out.push_back('"');
+    for (char c : text)
+    {
+        switch (c)
+        {
+            case '"': out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20)
+                {
+                    char buffer[8];
+                    std::snprintf(buffer, sizeof(buffer), "\\u%04x", c);
+                    out += buffer;
+                }
+                else
+                {
+                    out.push_back(c);
+                }
+        }
+    }
+    out.push_back('"');
+}
+
+void appendNumber(std::string& out, const crow::json::rvalue& value)
+{
+    switch (value.nt())
+    {
+        case crow::json::num_type::Signed_integer:
+            out += std::to_string(value.i());
+            return;
+        case crow::json::num_type::Unsigned_integer:
+            out += std::to_string(value.u());
+            return;
+        default:
+            break;
+    }
+
+    // 0 and 0.0 mean the same temperature; print integral floats as integers
+    double number = value.d();
+    if (std::trunc(number) == number && std::fabs(number) < 1e15)
+    {
+        out += std::to_string(static_cast<long long>(number));
+        return;
+    }
+
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), "%.17g", number);
+    out += buffer;
+}
+
+std::vector<const crow::json::rvalue*> sortedMembers(const crow::json::rvalue& object)
+{
+    std::vector<const crow::json::rvalue*> members;
+    members.reserve(object.size());
+    for (const auto& member : object)
+    {
+        members.push_back(&member);
+    }
+    std::sort(members.begin(), members.end(),
+              [](const crow::json::rvalue* a, const crow::json::rvalue* b)
+              {
+                  return a->key() < b->key();
+              });
+    return members;
+}
+
+void appendCanonical(std::string& out, const crow::json::rvalue& value)
+{
+    switch (value.t())
+    {
+        case crow::json::type::Object:
+        {
+            out.push_back('{');
+            bool first = true;
+            for (const auto* member : sortedMembers(value))
+            {
+                if (!first)
+                {
+                    out.push_back(',');
+                }
+                first = false;
+                appendEscaped(out, member->key());
+                out.push_back(':');
+                appendCanonical(out, *member);
+            }
+            out.push_back('}');
+            break;
+        }
+        case crow::json::type::List:
+        {
+            out.push_back('[');
+            for (size_t i = 0; i < value.size(); ++i)
+            {
+                if (i > 0)
+                {
+                    out.push_back(',');
+                }
+                appendCanonical(out, value[i]);
+            }
+            out.push_back(']');
+            break;
+        }
+        case crow::json::type::String:
+            appendEscaped(out, value.s());
+            break;
+        case crow::json::type::Number:
+            appendNumber(out, value);
+            break;
+        case crow::json::type::True:
+            out += "true";
+            break;
+        case crow::json::type::False:
+            out += "false";
+            break;
+        default:
+            out += "null";
+            break;
+    }
+}
+
+/**
+ * @brief Check whether a sampling member pins the output.
+ * @param name The member's name.
+ * @param value The member's value.
+ * @return bool True for a zero temperature or a non-null seed.
+ */
+bool pinsSampling(const std::string& name, const crow::json::rvalue& value)
+{
+    if (name == "temperature")
+    {
+        return value.t() == crow::json::type::Number && value.d() == 0.0;
+    }
+    if (name == "seed")
+    {
+        return value.t() == crow::json::type::Number;
+    }
+    return false;
+}
+
+bool isIgnoredField(const std::string& name)
+{
+    return std::find(RequestNormalizer::kIgnoredFields.begin(),
+                     RequestNormalizer::kIgnoredFields.end(),
+                     name) != RequestNormalizer::kIgnoredFields.end();
+}
+
+}  // namespace
+
+NormalizedRequest RequestNormalizer::normalize(
+    std::string_view endpoint,
+    const std::string& request_body)
+{
+    NormalizedRequest normalized;
+
+    crow::json::rvalue json;
+    try
+    {
+        json = crow::json::load(request_body);
+    }
+    catch (...)
+    {
+        // Treated as invalid below
+    }
+
+    if (!json || json.t() != crow::json::type::Object)
+    {
+        normalized.key = makeCacheKey(endpoint, request_body);
+        return normalized;
+    }
+
+    normalized.valid_json = true;
+    normalized.canonical.reserve(request_body.size());
+    normalized.canonical.push_back('{');
+
+    // Byte ranges of each message, and of the prompt member, within canonical
+    std::vector<std::pair<size_t, size_t>> message_spans;
+    std::pair<size_t, size_t> prompt_span{0, 0};
+
+    bool first = true;
+    for (const auto* member : sortedMembers(json))
+    {
+        std::string name = member->key();
+        if (isIgnoredField(name))
+        {
+            continue;
+        }
+        if (name == "stream" && member->t() != crow::json::type::False)
+        {
+            continue;  // Streaming is the default, so true and absent are equal
+        }
+        if (name == "model" && member->t() == crow::json::type::String)
+        {
+            normalized.model = member->s();
+        }
+
+        const size_t member_start = normalized.canonical.size();
+        if (!first)
+        {
+            normalized.canonical.push_back(',');
+        }
+        first = false;
+        appendEscaped(normalized.canonical, name);
+        normalized.canonical.push_back(':');
+        if (name == "messages" && member->t() == crow::json::type::List)
+        {
+            normalized.canonical.push_back('[');
+            for (size_t i = 0; i < member->size(); ++i)
+            {
+                if (i > 0)
+                {
+                    normalized.canonical.push_back(',');
+                }
+                const size_t start = normalized.canonical.size();
+                appendCanonical(normalized.canonical, (*member)[i]);
+                message_spans.emplace_back(start, normalized.canonical.size());
+            }
+            normalized.canonical.push_back(']');
+        }
+        else
+        {
+            appendCanonical(normalized.canonical, *member);
+        }
+        if (pinsSampling(name, *member))
+        {
+            normalized.deterministic = true;
+        }
+        else if (name == "options" && member->t() == crow::json::type::Object)
+        {
+            for (const auto& option : *member)
+            {
+                normalized.deterministic =
+                    normalized.deterministic || pinsSampling(option.key(), option);
+            }
+        }
+        if (name == "prompt" && member->t() == crow::json::type::String)
+        {
+            normalized.prompt = member->s();
+            prompt_span = {member_start, normalized.canonical.size()};
+        }
+        normalized.key_fields.push_back(std::move(name));
+    }
+
+    normalized.canonical.push_back('}');
+    normalized.key = makeCacheKey(endpoint, normalized.canonical);
+
+    // Chained, so each prefix key costs one hash of its last message
+    std::string_view canonical(normalized.canonical);
+    CacheKey prefix = makeCacheKey(endpoint, normalized.model);
+    normalized.message_prefixes.reserve(message_spans.size());
+    for (const auto& [start, end] : message_spans)
+    {
+        prefix = hash128(canonical.substr(start, end - start), prefix.high ^ prefix.low);
+        normalized.message_prefixes.push_back(prefix);
+    }
+
+    if (prompt_span.second > 0)
+    {
+        std::string context(canonical.substr(0, prompt_span.first));
+        context += canonical.substr(prompt_span.second);
+        normalized.context_key = makeCacheKey(endpoint, context);
+    }
+    return normalized;
+}
+
+} // namespace sectorflux
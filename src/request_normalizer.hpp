@@ -0,0 +1,78 @@
+/*
+ * SectorFlux - LLM Proxy and Analytics
+ * Copyright (c) 2025 ParticleSector.com
+ *
+ * This software is dual-licensed:
+ * - GPL-3.0 for open source use
+ * - Commercial license for proprietary use
+ *
+ * See LICENSE and LICENSING.md for details.
+ */
+
+#pragma once
+
+#include "cache_key.hpp"
+
+#include <array>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace sectorflux
+{
+
+/**
+ * @brief A request reduced to the fields that determine its response.
+ */
+struct NormalizedRequest
+{
+    std::string model = "unknown";
+    std::string canonical;                // Canonical JSON of the key fields
+    std::vector<std::string> key_fields;  // Top-level fields in the key, sorted
+    CacheKey key;
+    bool valid_json = false;
+
+    // Chat requests: message_prefixes[i] identifies the model plus messages
+    // 0..i, so a turn that extends a conversation shares its earlier keys
+    std::vector<CacheKey> message_prefixes{};
+
+    // Generate requests: the prompt, and the key of every other field, which
+    // must match exactly for two prompts to count as near duplicates
+    std::string prompt{};
+    CacheKey context_key{};
+    std::vector<float> prompt_embedding{};  // Set by a semantic cache miss, indexed once cached
+
+    // Sampling is pinned (temperature 0 or a seed, in options or at the top
+    // level as in OpenAI-style bodies), so a replay is a faithful answer
+    bool deterministic = false;
+};
+
+/**
+ * @brief Canonicalizes Ollama requests so equivalent requests share a cache key.
+ *
+ * The body is parsed once, object keys are sorted recursively, numbers are
+ * printed in a single canonical form and fields that do not affect the
+ * generated output are dropped. `stream` defaults to true in Ollama, so only
+ * an explicit `"stream": false` (which changes the response framing) is kept.
+ * Bodies that are not valid JSON fall back to hashing the raw bytes.
+ */
+class RequestNormalizer
+{
+public:
+    /**
+     * @brief Normalize a request body and compute its cache key.
+     * @param endpoint The Ollama endpoint the request targets.
+     * @param request_body The raw JSON request body.
+     * @return NormalizedRequest The canonical form, key and extracted model.
+     */
+    [[nodiscard]] static NormalizedRequest normalize(
+        std::string_view endpoint,
+        const std::string& request_body);
+
+    /**
+     * @brief Top-level fields that never take part in the cache key.
+     */
+    static constexpr std::array<std::string_view, 1> kIgnoredFields = {"keep_alive"};
+};
+
+} // namespace sectorflux
@@ -0,0 +1,41 @@
+/*
+ * SectorFlux - LLM Proxy and Analytics
+ * Copyright (c) 2025 ParticleSector.com
+ *
+ * This software is dual-licensed:
+ * - GPL-3.0 for open source use
+ * - Commercial license for proprietary use
+ *
+ * See LICENSE and LICENSING.md for details.
+ */
+
+#include "response_buffer.hpp"
+
+namespace sectorflux
+{
+
+void ResponseBuffer::append(const char* data, size_t length)
+{
+    if (!data_)
+    {
+        data_ = std::make_shared<std::string>();
+        data_->reserve(kInitialReserveBytes);
+    }
+    data_->append(data, length);
+}
+
+void ResponseBuffer::assign(std::string text)
+{
+    data_ = std::make_shared<std::string>(std::move(text));
+}
+
+SharedBody ResponseBuffer::share() const
+{
+    if (!data_)
+    {
+        return std::make_shared<const std::string>();
+    }
+    return data_;
+}
+
+}  // namespace sectorflux
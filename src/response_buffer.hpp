@@ -0,0 +1,75 @@
+/*
+ * SectorFlux - LLM Proxy and Analytics
+ * Copyright (c) 2025 ParticleSector.com
+ *
+ * This software is dual-licensed:
+ * - GPL-3.0 for open source use
+ * - Commercial license for proprietary use
+ *
+ * See LICENSE and LICENSING.md for details.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <string_view>
+
+namespace sectorflux
+{
+
+/**
+ * @brief An immutable response body shared by the client writer, the log and the cache.
+ */
+using SharedBody = std::shared_ptr<const std::string>;
+
+/**
+ * @brief Per-request response buffer, written by the upstream reader and then shared.
+ *
+ * Chunks are appended into one reserved allocation that grows geometrically,
+ * so a streamed completion costs a few allocations instead of one per chunk.
+ * share() hands out the same bytes by reference; the log queue, the cache
+ * and SQLite binding all read that one buffer.
+ */
+class ResponseBuffer
+{
+public:
+    /**
+     * @brief Append received bytes; the first append reserves the initial capacity.
+     */
+    void append(const char* data, size_t length);
+
+    /**
+     * @brief Replace the contents (e.g. with an error message).
+     */
+    void assign(std::string text);
+
+    [[nodiscard]] bool empty() const
+    {
+        return !data_ || data_->empty();
+    }
+
+    [[nodiscard]] size_t size() const
+    {
+        return data_ ? data_->size() : 0;
+    }
+
+    [[nodiscard]] std::string_view view() const
+    {
+        return data_ ? std::string_view(*data_) : std::string_view();
+    }
+
+    /**
+     * @brief Share the bytes appended so far; the buffer must not be appended to afterwards.
+     * @return SharedBody The body (never null; empty if nothing was appended).
+     */
+    [[nodiscard]] SharedBody share() const;
+
+private:
+    static constexpr size_t kInitialReserveBytes = 16 * 1024;
+
+    std::shared_ptr<std::string> data_;
+};
+
+}  // namespace sectorflux
@@ -0,0 +1,201 @@
+/*
+ * SectorFlux - LLM Proxy and Analytics
+ * Copyright (c) 2025 ParticleSector.com
+ *
+ * This software is dual-licensed:
+ * - GPL-3.0 for open source use
+ * - Commercial license for proprietary use
+ *
+ * See LICENSE and LICENSING.md for details.
+ */
+
+#include "response_cache.hpp"
+
+namespace sectorflux
+{
+
+namespace
+{
+
+int64_t unixNow()
+{
+    return std::chrono::duration_cast<std::chrono::seconds>(
+               std::chrono::system_clock::now().time_since_epoch())
+        .count();
+}
+
+}  // namespace
+
+ResponseCache::ResponseCache(Database& db, size_t max_memory_bytes, size_t max_entry_bytes)
+    : db_(db), max_entry_bytes_(max_entry_bytes), max_memory_bytes_(max_memory_bytes)
+{
+}
+
+std::optional<CachedResponse> ResponseCache::get(const CacheKey& key)
+{
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        auto it = index_.find(key);
+        if (it != index_.end())
+        {
+            Entry& entry = *it->second;
+            const int64_t expires_at = entry.response.expires_at;
+            if (expires_at != 0 && expires_at <= unixNow())
+            {
+                // The persisted copy expired at the same moment, so this is a miss
+                ++expirations_;
+                memory_bytes_ -= entry.bytes;
+                lru_.erase(it->second);
+                index_.erase(it);
+                return std::nullopt;
+            }
+
+            lru_.splice(lru_.begin(), lru_, it->second);
+            CachedResponse response = entry.response;
+            const auto now = std::chrono::steady_clock::now();
+            const bool touch = now - entry.touched >= kTouchInterval;
+            if (touch)
+            {
+                entry.touched = now;
+            }
+            lock.unlock();
+
+            if (touch)
+            {
+                db_.touchCachedResponseAsync(key);
+            }
+            return response;
+        }
+    }
+
+    // Miss in memory: consult the persistence tier outside the lock
+    auto stored = db_.getCachedResponse(key);
+    if (!stored)
+    {
+        return std::nullopt;
+    }
+
+    // Rows written before chunk indexing are indexed once, on promotion
+    if (stored->chunks.empty())
+    {
+        stored->chunks = indexLines(stored->body);
+    }
+    auto metrics = StreamMetricsParser::parse(stored->body);
+    CachedResponse response{
+        stored->status,
+        std::make_shared<const std::string>(std::move(stored->body)),
+        std::make_shared<const ChunkIndex>(std::move(stored->chunks)),
+        metrics,
+        stored->expires_at};
+
+    // A promotion is a use of the persisted entry
+    db_.touchCachedResponseAsync(key);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    insertLocked(key, response);
+    return response;
+}
+
+bool ResponseCache::put(const CacheKey& key, int status, SharedBody body, ChunkIndex chunks,
+                        std::optional<ResponseMetrics> metrics, std::chrono::seconds ttl)
+{
+    const size_t max_entry_bytes = max_entry_bytes_.load(std::memory_order_relaxed);
+    if (max_entry_bytes > 0 && body->size() > max_entry_bytes)
+    {
+        rejected_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    if (chunks.empty())
+    {
+        chunks = indexLines(*body);
+    }
+    if (!metrics)
+    {
+        metrics = StreamMetricsParser::parse(*body);
+    }
+    CachedResponse response{status,
+                            std::move(body),
+                            std::make_shared<const ChunkIndex>(std::move(chunks)),
+                            *metrics,
+                            ttl.count() > 0 ? unixNow() + ttl.count() : 0};
+
+    // Persistence shares the same buffers, so write-behind costs no copy
+    db_.cacheResponseAsync(key, status, response.body, response.chunks, response.expires_at);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    insertLocked(key, std::move(response));
+    return true;
+}
+
+std::optional<long long> ResponseCache::clear()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        lru_.clear();
+        index_.clear();
+        memory_bytes_ = 0;
+    }
+    return db_.flushCachedResponses();
+}
+
+void ResponseCache::setLimits(size_t max_memory_bytes, size_t max_entry_bytes)
+{
+    max_entry_bytes_.store(max_entry_bytes, std::memory_order_relaxed);
+    std::lock_guard<std::mutex> lock(mutex_);
+    max_memory_bytes_ = max_memory_bytes;
+    evictLocked();
+}
+
+size_t ResponseCache::memoryBytes()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return memory_bytes_;
+}
+
+ResponseCacheStats ResponseCache::stats()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return ResponseCacheStats{.entries = index_.size(),
+                              .memory_bytes = memory_bytes_,
+                              .evictions = evictions_,
+                              .expirations = expirations_,
+                              .rejected = rejected_.load(std::memory_order_relaxed)};
+}
+
+void ResponseCache::insertLocked(const CacheKey& key, CachedResponse response)
+{
+    size_t bytes = response.body->size() + response.chunks->size() * sizeof(ChunkMark) +
+                   kEntryOverheadBytes;
+    if (bytes > max_memory_bytes_)
+    {
+        return;  // Larger than the whole budget; leave it to SQLite
+    }
+
+    auto it = index_.find(key);
+    if (it != index_.end())
+    {
+        memory_bytes_ -= it->second->bytes;
+        lru_.erase(it->second);
+        index_.erase(it);
+    }
+
+    lru_.push_front(Entry{key, std::move(response), bytes, std::chrono::steady_clock::now()});
+    index_[key] = lru_.begin();
+    memory_bytes_ += bytes;
+    evictLocked();
+}
+
+void ResponseCache::evictLocked()
+{
+    while (memory_bytes_ > max_memory_bytes_ && !lru_.empty())
+    {
+        const Entry& victim = lru_.back();
+        memory_bytes_ -= victim.bytes;
+        index_.erase(victim.key);
+        lru_.pop_back();
+        ++evictions_;
+    }
+}
+
+} // namespace sectorflux
@@ -0,0 +1,176 @@
+/*
+ * SectorFlux - LLM Proxy and Analytics
+ * Copyright (c) 2025 ParticleSector.com
+ *
+ * This software is dual-licensed:
+ * - GPL-3.0 for open source use
+ * - Commercial license for proprietary use
+ *
+ * See LICENSE and LICENSING.md for details.
+ */
+
+#pragma once
+
+#include "cache_key.hpp"
+#include "chunk_index.hpp"
+#include "database.hpp"
+#include "stream_metrics.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+
+namespace sectorflux
+{
+
+/**
+ * @brief A cached upstream response.
+ *
+ * The body is shared and immutable, so a hit hands out a reference instead
+ * of copying the stored NDJSON. The chunk index lets a hit be streamed line
+ * by line as slices of that body; the metrics are parsed once on insert,
+ * not on every hit.
+ */
+struct CachedResponse
+{
+    int status = 0;
+    SharedBody body;
+    std::shared_ptr<const ChunkIndex> chunks;  // Never null
+    ResponseMetrics metrics;
+    int64_t expires_at = 0;                    // Unix seconds; 0 never expires
+};
+
+/**
+ * @brief Occupancy and counters of the in-memory tier (since startup).
+ */
+struct ResponseCacheStats
+{
+    size_t entries = 0;
+    size_t memory_bytes = 0;
+    uint64_t evictions = 0;    // Entries pushed out of memory by newer ones
+    uint64_t expirations = 0;  // Lookups that found their entry past its TTL
+    uint64_t rejected = 0;     // Responses over SECTORFLUX_CACHE_MAX_ENTRY_KB, not cached
+};
+
+/**
+ * @brief Two-tier response cache: bounded in-memory LRU over SQLite.
+ *
+ * Lookups are served from memory when hot and fall back to the SQLite
+ * `response_cache` table, promoting the entry on the way out. Writes land in
+ * memory immediately and are persisted write-behind on the database writer
+ * thread, so neither path blocks on disk. The SQLite tier has its own byte
+ * budget and TTL sweep (see Database::getCacheDiskStats()); hits served from
+ * memory refresh the persisted entry's last use now and then, so its LRU
+ * order follows real traffic.
+ */
+class ResponseCache
+{
+public:
+    /**
+     * @brief Construct a new Response Cache object.
+     * @param db Database used as the persistence tier.
+     * @param max_memory_bytes Byte budget of the in-memory tier.
+     * @param max_entry_bytes Largest body admitted to either tier; 0 for no limit.
+     */
+    ResponseCache(Database& db, size_t max_memory_bytes, size_t max_entry_bytes = 0);
+
+    // Delete copy operations
+    ResponseCache(const ResponseCache&) = delete;
+    ResponseCache& operator=(const ResponseCache&) = delete;
+
+    /**
+     * @brief Look up a cached response.
+     * @param key The request's cache key.
+     * @return std::optional<CachedResponse> The response if cached and not
+     *         expired, nullopt otherwise.
+     */
+    [[nodiscard]] std::optional<CachedResponse> get(const CacheKey& key);
+
+    /**
+     * @brief Store a response in memory and schedule its persistence.
+     * @param key The request's cache key.
+     * @param status The response status code.
+     * @param body The response body; held by reference, not copied.
+     * @param chunks Line boundaries recorded while streaming; indexed from the
+     *        body when empty.
+     * @param metrics Metrics already parsed from the stream; parsed from the
+     *        body when absent.
+     * @param ttl How long the entry stays valid; zero never expires.
+     * @return bool False if the body is over the entry limit and was not cached.
+     */
+    bool put(const CacheKey& key, int status, SharedBody body, ChunkIndex chunks = {},
+             std::optional<ResponseMetrics> metrics = std::nullopt,
+             std::chrono::seconds ttl = std::chrono::seconds::zero());
+
+    /**
+     * @brief Drop every entry from both tiers.
+     * @return std::optional<long long> Number of persisted entries deleted,
+     *         nullopt if the SQLite tier could not be cleared.
+     */
+    std::optional<long long> clear();
+
+    /**
+     * @brief Change the budgets; a smaller memory budget evicts right away.
+     * @param max_memory_bytes Byte budget of the in-memory tier.
+     * @param max_entry_bytes Largest body admitted from now on; 0 for no limit.
+     */
+    void setLimits(size_t max_memory_bytes, size_t max_entry_bytes);
+
+    /**
+     * @brief Get occupancy and counters of the in-memory tier.
+     */
+    [[nodiscard]] ResponseCacheStats stats();
+
+    /**
+     * @brief Get the bytes currently held by the in-memory tier.
+     * @return size_t Approximate memory footprint of cached entries.
+     */
+    [[nodiscard]] size_t memoryBytes();
+
+private:
+    struct Entry
+    {
+        CacheKey key;
+        CachedResponse response;
+        size_t bytes = 0;
+        std::chrono::steady_clock::time_point touched{};  // Last use sent to SQLite
+    };
+
+    /**
+     * @brief Insert or refresh an entry at the LRU head, evicting as needed.
+     * @note Caller must hold mutex_.
+     */
+    void insertLocked(const CacheKey& key, CachedResponse response);
+
+    /**
+     * @brief Evict from the LRU tail until the memory budget is met.
+     * @note Caller must hold mutex_.
+     */
+    void evictLocked();
+
+    Database& db_;
+    std::atomic<size_t> max_entry_bytes_;
+
+    std::mutex mutex_;
+    size_t max_memory_bytes_;
+    std::list<Entry> lru_;  // Most recently used first
+    std::unordered_map<CacheKey, std::list<Entry>::iterator, CacheKeyHash> index_;
+    size_t memory_bytes_ = 0;
+    uint64_t evictions_ = 0;
+    uint64_t expirations_ = 0;
+    std::atomic<uint64_t> rejected_{0};
+
+    // Bookkeeping overhead charged per entry on top of the body size
+    static constexpr size_t kEntryOverheadBytes = 128;
+
+    // A hot entry's last use is persisted at most this often
+    static constexpr std::chrono::seconds kTouchInterval{60};
+};
+
+} // namespace sectorflux
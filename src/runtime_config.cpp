@@ -0,0 +1,358 @@
+/*
+ * SectorFlux - LLM Proxy and Analytics
+ * Copyright (c) 2025 ParticleSector.com
+ *
+ * This software is dual-licensed:
+ * - GPL-3.0 for open source use
+ * - Commercial license for proprietary use
+ *
+ * See LICENSE and LICENSING.md for details.
+ */
+
+#include "runtime_config.hpp"
+
+#include "capture_policy.hpp"
+#include "config.hpp"
+
+#include <crow.h>
+
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <limits>
+#include <sstream>
+#include <string_view>
+#include <utility>
+
+namespace sectorflux
+{
+
+namespace
+{
+
+// Ranges match the Config getters of the same settings
+constexpr RuntimeField kFields[] = {
+    {.name = "http_threads", .number = &RuntimeSettings::http_threads,
+     .min_value = 0, .max_value = 1024, .restart = true},
+    {.name = "chat_workers", .number = &RuntimeSettings::chat_workers,
+     .min_value = 1, .max_value = 256},
+    {.name = "upstream_pool_size", .number = &RuntimeSettings::upstream_pool_size,
+     .min_value = 1, .max_value = 1024},
+    {.name = "max_inflight_per_model", .number = &RuntimeSettings::max_inflight_per_model,
+     .min_value = 0, .max_value = 4096},
+    {.name = "max_inflight_per_backend", .number = &RuntimeSettings::max_inflight_per_backend,
+     .min_value = 0, .max_value = 4096},
+    {.name = "queue_timeout_sec", .number = &RuntimeSettings::queue_timeout_sec,
+     .min_value = 1, .max_value = 86400},
+    {.name = "upstream_timeout_sec", .number = &RuntimeSettings::upstream_timeout_sec,
+     .min_value = 1, .max_value = 86400},
+    {.name = "websocket_timeout_sec", .number = &RuntimeSettings::websocket_timeout_sec,
+     .min_value = 1, .max_value = 86400},
+    {.name = "cache_memory_mb", .number = &RuntimeSettings::cache_memory_mb,
+     .min_value = 0, .max_value = 1 << 20},
+    {.name = "cache_disk_mb", .number = &RuntimeSettings::cache_disk_mb,
+     .min_value = 0, .max_value = 1 << 24},
+    {.name = "cache_ttl_sec", .number = &RuntimeSettings::cache_ttl_sec,
+     .min_value = 0, .max_value = 1 << 30},
+    {.name = "cache_max_entry_kb", .number = &RuntimeSettings::cache_max_entry_kb,
+     .min_value = 0, .max_value = 1 << 22},
+    {.name = "cache_deterministic_only", .flag = &RuntimeSettings::cache_deterministic_only},
+    {.name = "retention_rows", .number = &RuntimeSettings::retention_rows,
+     .min_value = 0, .max_value = std::numeric_limits<int>::max()},
+    {.name = "retention_days", .number = &RuntimeSettings::retention_days,
+     .min_value = 0, .max_value = 36500},
+    {.name = "retention_mb", .number = &RuntimeSettings::retention_mb,
+     .min_value = 0, .max_value = 1 << 24},
+    {.name = "capture", .text = &RuntimeSettings::capture,
+     .validate = &CapturePolicy::validate},
+};
+
+const RuntimeField* findField(std::string_view name)
+{
+    for (const auto& field : kFields)
+    {
+        if (name == field.name)
+        {
+            return &field;
+        }
+    }
+    return nullptr;
+}
+
+/**
+ * @brief Overlay a JSON object on a settings snapshot.
+ * @return std::optional<std::string> Error message naming the first bad field;
+ *         settings may be partially modified on error.
+ */
+std::optional<std::string> applyJson(const std::string& text, RuntimeSettings& settings)
+{
+    auto json = crow::json::load(text);
+    if (!json || json.t() != crow::json::type::Object)
+    {
+        return "Expected a JSON object";
+    }
+
+    for (const auto& key : json.keys())
+    {
+        const RuntimeField* field = findField(key);
+        if (field == nullptr)
+        {
+            return "Unknown setting '" + key + "'";
+        }
+        const auto& value = json[key];
+
+        if (field->text != nullptr)
+        {
+            if (value.t() != crow::json::type::String)
+            {
+                return "'" + key + "' must be a string";
+            }
+            std::string text = value.s();
+            if (auto err = field->validate ? field->validate(text) : std::nullopt)
+            {
+                return "'" + key + "': " + *err;
+            }
+            settings.*field->text = std::move(text);
+            continue;
+        }
+
+        if (field->flag != nullptr)
+        {
+            if (value.t() != crow::json::type::True && value.t() != crow::json::type::False)
+            {
+                return "'" + key + "' must be true or false";
+            }
+            settings.*field->flag = value.b();
+            continue;
+        }
+
+        if (value.t() != crow::json::type::Number ||
+            value.nt() == crow::json::num_type::Floating_point ||
+            value.nt() == crow::json::num_type::Double_precision_floating_point)
+        {
+            return "'" + key + "' must be an integer";
+        }
+        const int64_t number = value.i();
+        if (number < field->min_value || number > field->max_value)
+        {
+            return "'" + key + "' must be between " + std::to_string(field->min_value) +
+                   " and " + std::to_string(field->max_value);
+        }
+        settings.*field->number = static_cast<int>(number);
+    }
+    return std::nullopt;
+}
+
+bool sameValue(const RuntimeField& field, const RuntimeSettings& a, const RuntimeSettings& b)
+{
+    if (field.text != nullptr)
+    {
+        return a.*field.text == b.*field.text;
+    }
+    if (field.flag != nullptr)
+    {
+        return a.*field.flag == b.*field.flag;
+    }
+    return a.*field.number == b.*field.number;
+}
+
+void appendJsonString(std::string& out, std::string_view text)
+{
+    out += '"';
+    for (char c : text)
+    {
+        switch (c)
+        {
+            case '"': out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            case '\t': out += "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20)
+                {
+                    char escaped[8];
+                    std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+                    out += escaped;
+                }
+                else
+                {
+                    out += c;
+                }
+        }
+    }
+    out += '"';
+}
+
+}  // namespace
+
+RuntimeSettings RuntimeSettings::fromEnvironment()
+{
+    return RuntimeSettings{
+        .http_threads = Config::getHttpThreads(),
+        .chat_workers = Config::getChatWorkers(),
+        .upstream_pool_size = Config::getUpstreamPoolSize(),
+        .max_inflight_per_model = Config::getMaxInflightPerModel(),
+        .max_inflight_per_backend = Config::getMaxInflightPerBackend(),
+        .queue_timeout_sec = Config::getQueueTimeoutSec(),
+        .upstream_timeout_sec = Config::getUpstreamTimeoutSec(),
+        .websocket_timeout_sec = Config::getWebSocketTimeoutSec(),
+        .cache_memory_mb = Config::getCacheMemoryMb(),
+        .cache_disk_mb = Config::getCacheDiskMb(),
+        .cache_ttl_sec = Config::getCacheTtlSec(),
+        .cache_max_entry_kb = Config::getCacheMaxEntryKb(),
+        .cache_deterministic_only = Config::getCacheDeterministicOnly(),
+        .retention_rows = Config::getRetentionRows(),
+        .retention_days = Config::getRetentionDays(),
+        .retention_mb = Config::getRetentionMb(),
+        .capture = Config::getCapturePolicy(),
+    };
+}
+
+RuntimeConfig::RuntimeConfig(std::string path) : path_(std::move(path))
+{
+    RuntimeSettings settings = RuntimeSettings::fromEnvironment();
+    if (auto err = readFile(settings))
+    {
+        // An unusable file must not keep the proxy from starting
+        std::cerr << "Warning: ignoring " << path_ << ": " << *err << std::endl;
+        settings = RuntimeSettings::fromEnvironment();
+    }
+    startup_ = std::make_shared<const RuntimeSettings>(settings);
+    settings_.store(startup_, std::memory_order_release);
+}
+
+std::optional<std::string> RuntimeConfig::update(const std::string& body)
+{
+    std::lock_guard<std::mutex> lock(update_mutex_);
+    RuntimeSettings settings = *current();
+    if (auto err = applyJson(body, settings))
+    {
+        return err;
+    }
+    if (auto err = writeFile(settings))
+    {
+        return err;
+    }
+    publishLocked(settings);
+    return std::nullopt;
+}
+
+std::optional<std::string> RuntimeConfig::reload()
+{
+    std::lock_guard<std::mutex> lock(update_mutex_);
+    RuntimeSettings settings = RuntimeSettings::fromEnvironment();
+    if (auto err = readFile(settings))
+    {
+        return err;
+    }
+    publishLocked(settings);
+    return std::nullopt;
+}
+
+void RuntimeConfig::addListener(Listener listener)
+{
+    std::lock_guard<std::mutex> lock(update_mutex_);
+    listener(*current());
+    listeners_.push_back(std::move(listener));
+}
+
+std::vector<std::string> RuntimeConfig::pendingRestart() const
+{
+    auto settings = current();
+    std::vector<std::string> pending;
+    for (const auto& field : kFields)
+    {
+        if (!field.restart)
+        {
+            continue;
+        }
+        if (!sameValue(field, *settings, *startup_))
+        {
+            pending.emplace_back(field.name);
+        }
+    }
+    return pending;
+}
+
+std::span<const RuntimeField> RuntimeConfig::fields()
+{
+    return kFields;
+}
+
+std::optional<std::string> RuntimeConfig::readFile(RuntimeSettings& settings) const
+{
+    if (path_.empty())
+    {
+        return std::nullopt;
+    }
+    std::ifstream file(path_, std::ios::binary);
+    if (!file)
+    {
+        return std::nullopt;  // Not created yet; the environment applies
+    }
+    std::ostringstream text;
+    text << file.rdbuf();
+    return applyJson(text.str(), settings);
+}
+
+std::optional<std::string> RuntimeConfig::writeFile(const RuntimeSettings& settings) const
+{
+    if (path_.empty())
+    {
+        return std::nullopt;
+    }
+
+    std::string text = "{\n";
+    for (const auto& field : kFields)
+    {
+        text += "  \"";
+        text += field.name;
+        text += "\": ";
+        if (field.text != nullptr)
+        {
+            appendJsonString(text, settings.*field.text);
+        }
+        else if (field.flag != nullptr)
+        {
+            text += settings.*field.flag ? "true" : "false";
+        }
+        else
+        {
+            text += std::to_string(settings.*field.number);
+        }
+        text += &field == &kFields[std::size(kFields) - 1] ? "\n" : ",\n";
+    }
+    text += "}\n";
+
+    // Replace the file whole so a crash never leaves it half written
+    const std::string temp_path = path_ + ".tmp";
+    {
+        std::ofstream file(temp_path, std::ios::binary | std::ios::trunc);
+        if (!file || !file.write(text.data(), static_cast<std::streamsize>(text.size())))
+        {
+            return "Failed to write " + temp_path;
+        }
+    }
+    std::error_code error;
+    std::filesystem::rename(temp_path, path_, error);
+    if (error)
+    {
+        return "Failed to replace " + path_ + ": " + error.message();
+    }
+    return std::nullopt;
+}
+
+void RuntimeConfig::publishLocked(RuntimeSettings settings)
+{
+    auto snapshot = std::make_shared<const RuntimeSettings>(std::move(settings));
+    settings_.store(snapshot, std::memory_order_release);
+    version_.fetch_add(1, std::memory_order_relaxed);
+    for (const auto& listener : listeners_)
+    {
+        listener(*snapshot);
+    }
+}
+
+}  // namespace sectorflux
@@ -0,0 +1,185 @@
+/*
+ * SectorFlux - LLM Proxy and Analytics
+ * Copyright (c) 2025 ParticleSector.com
+ *
+ * This software is dual-licensed:
+ * - GPL-3.0 for open source use
+ * - Commercial license for proprietary use
+ *
+ * See LICENSE and LICENSING.md for details.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace sectorflux
+{
+
+/**
+ * @brief Tunables that can change while the proxy is serving traffic.
+ *
+ * A snapshot is immutable once published; a change builds a new one. Every
+ * field defaults to its environment variable (see Config).
+ */
+struct RuntimeSettings
+{
+    // Concurrency
+    int http_threads = 0;  // Fixed when the listener starts; 0 is one per hardware thread
+    int chat_workers = 0;
+    int upstream_pool_size = 0;
+    int max_inflight_per_model = 0;
+    int max_inflight_per_backend = 0;
+
+    // Timeouts, in seconds
+    int queue_timeout_sec = 0;
+    int upstream_timeout_sec = 0;
+    int websocket_timeout_sec = 0;
+
+    // Response cache
+    int cache_memory_mb = 0;
+    int cache_disk_mb = 0;
+    int cache_ttl_sec = 0;
+    int cache_max_entry_kb = 0;
+    bool cache_deterministic_only = false;
+
+    // Log retention
+    int retention_rows = 0;
+    int retention_days = 0;
+    int retention_mb = 0;
+
+    // How much of each interaction is logged (see CapturePolicy)
+    std::string capture;
+
+    /**
+     * @brief Read every setting from the environment.
+     */
+    [[nodiscard]] static RuntimeSettings fromEnvironment();
+};
+
+/**
+ * @brief One named, range-checked field of RuntimeSettings.
+ *
+ * Exactly one of number, flag and text is set.
+ */
+struct RuntimeField
+{
+    const char* name;
+    int RuntimeSettings::*number = nullptr;
+    bool RuntimeSettings::*flag = nullptr;
+    std::string RuntimeSettings::*text = nullptr;
+    int min_value = 0;
+    int max_value = 0;
+    std::optional<std::string> (*validate)(const std::string&) = nullptr;  // Text only
+    bool restart = false;  // Only read at startup
+};
+
+/**
+ * @brief Owner of the current RuntimeSettings snapshot.
+ *
+ * Readers take the snapshot with current(), an atomic load that never takes
+ * the writers' mutex; fields read from one snapshot are always consistent
+ * with each other. Writers validate a change as a whole, publish a new snapshot, then
+ * notify listeners, which resize the pools and budgets that hold their own
+ * state. Requests already past a setting keep the value they read.
+ *
+ * Settings come from the environment, overlaid by an optional JSON file of
+ * the same field names. Updates made at runtime are written back to that
+ * file, so a reload or restart keeps them.
+ */
+class RuntimeConfig
+{
+public:
+    using Listener = std::function<void(const RuntimeSettings&)>;
+
+    /**
+     * @brief Load the settings from the environment and the file.
+     * @param path JSON file overlaid on the environment; empty for none. A
+     *        missing file counts as empty and is created by the first update.
+     */
+    explicit RuntimeConfig(std::string path);
+
+    RuntimeConfig(const RuntimeConfig&) = delete;
+    RuntimeConfig& operator=(const RuntimeConfig&) = delete;
+
+    /**
+     * @brief Get the current snapshot.
+     * @return std::shared_ptr<const RuntimeSettings> Valid for as long as it is held.
+     */
+    [[nodiscard]] std::shared_ptr<const RuntimeSettings> current() const
+    {
+        return settings_.load(std::memory_order_acquire);
+    }
+
+    /**
+     * @brief Apply a partial change.
+     * @param body JSON object mapping field names to new values.
+     * @return std::optional<std::string> Error message if any field is unknown,
+     *         mistyped or out of range (nothing is applied), nullopt on success.
+     */
+    std::optional<std::string> update(const std::string& body);
+
+    /**
+     * @brief Re-read the file over the environment and publish the result.
+     * @return std::optional<std::string> Error message if the file is invalid
+     *         (the current snapshot is kept), nullopt on success.
+     */
+    std::optional<std::string> reload();
+
+    /**
+     * @brief Register a callback run after each published change.
+     * @param listener Called once immediately with the current snapshot; must
+     *        stay valid for the lifetime of this object.
+     */
+    void addListener(Listener listener);
+
+    /**
+     * @brief Get the restart-only fields whose value differs from startup.
+     */
+    [[nodiscard]] std::vector<std::string> pendingRestart() const;
+
+    /**
+     * @brief Get the number of snapshots published since startup.
+     */
+    [[nodiscard]] uint64_t version() const
+    {
+        return version_.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Get the configuration file path; empty when none is used.
+     */
+    [[nodiscard]] const std::string& path() const
+    {
+        return path_;
+    }
+
+    /**
+     * @brief Get the description of every field, in display order.
+     */
+    [[nodiscard]] static std::span<const RuntimeField> fields();
+
+private:
+    std::optional<std::string> readFile(RuntimeSettings& settings) const;
+    std::optional<std::string> writeFile(const RuntimeSettings& settings) const;
+    void publishLocked(RuntimeSettings settings);
+
+    const std::string path_;
+    std::atomic<std::shared_ptr<const RuntimeSettings>> settings_;
+    std::shared_ptr<const RuntimeSettings> startup_;
+    std::atomic<uint64_t> version_{0};
+
+    // Serializes writers and listener calls; readers never take it
+    std::mutex update_mutex_;
+    std::vector<Listener> listeners_;
+};
+
+}  // namespace sectorflux
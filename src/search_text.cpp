@@ -0,0 +1,223 @@
+/*
+ * SectorFlux - LLM Proxy and Analytics
+ * Copyright (c) 2025 ParticleSector.com
+ *
+ * This software is dual-licensed:
+ * - GPL-3.0 for open source use
+ * - Commercial license for proprietary use
+ *
+ * See LICENSE and LICENSING.md for details.
+ */
+
+#include "search_text.hpp"
+
+#include <crow.h>
+
+#include <cstdint>
+
+namespace sectorflux
+{
+
+namespace
+{
+
+// Ollama encodes JSON without whitespace, so the keys are matched exactly
+constexpr std::string_view kResponseKey = "\"response\":\"";
+constexpr std::string_view kContentKey = "\"content\":\"";
+
+int hexDigit(char c)
+{
+    if (c >= '0' && c <= '9')
+    {
+        return c - '0';
+    }
+    if (c >= 'a' && c <= 'f')
+    {
+        return c - 'a' + 10;
+    }
+    if (c >= 'A' && c <= 'F')
+    {
+        return c - 'A' + 10;
+    }
+    return -1;
+}
+
+// Read the four hex digits of a \u escape starting at pos; -1 if malformed
+int32_t readCodeUnit(std::string_view text, size_t pos)
+{
+    if (pos + 4 > text.size())
+    {
+        return -1;
+    }
+    int32_t unit = 0;
+    for (size_t i = pos; i < pos + 4; ++i)
+    {
+        int digit = hexDigit(text[i]);
+        if (digit < 0)
+        {
+            return -1;
+        }
+        unit = unit * 16 + digit;
+    }
+    return unit;
+}
+
+void appendUtf8(std::string& out, uint32_t code_point)
+{
+    if (code_point < 0x80)
+    {
+        out += static_cast<char>(code_point);
+    }
+    else if (code_point < 0x800)
+    {
+        out += static_cast<char>(0xC0 | (code_point >> 6));
+        out += static_cast<char>(0x80 | (code_point & 0x3F));
+    }
+    else if (code_point < 0x10000)
+    {
+        out += static_cast<char>(0xE0 | (code_point >> 12));
+        out += static_cast<char>(0x80 | ((code_point >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (code_point & 0x3F));
+    }
+    else
+    {
+        out += static_cast<char>(0xF0 | (code_point >> 18));
+        out += static_cast<char>(0x80 | ((code_point >> 12) & 0x3F));
+        out += static_cast<char>(0x80 | ((code_point >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (code_point & 0x3F));
+    }
+}
+
+/**
+ * @brief Decode the JSON string whose contents start at pos onto out.
+ *
+ * Control escapes become spaces, which is all the tokenizer needs.
+ */
+void appendJsonString(std::string_view text, size_t pos, std::string& out)
+{
+    while (pos < text.size() && text[pos] != '"')
+    {
+        char c = text[pos++];
+        if (c != '\\')
+        {
+            out += c;
+            continue;
+        }
+        if (pos >= text.size())
+        {
+            return;
+        }
+
+        char escape = text[pos++];
+        switch (escape)
+        {
+        case '"':
+        case '\\':
+        case '/':
+            out += escape;
+            break;
+        case 'u':
+        {
+            int32_t unit = readCodeUnit(text, pos);
+            if (unit < 0)
+            {
+                return;
+            }
+            pos += 4;
+            uint32_t code_point = static_cast<uint32_t>(unit);
+            if (unit >= 0xD800 && unit <= 0xDBFF && pos + 6 <= text.size() &&
+                text[pos] == '\\' && text[pos + 1] == 'u')
+            {
+                int32_t low = readCodeUnit(text, pos + 2);
+                if (low >= 0xDC00 && low <= 0xDFFF)
+                {
+                    code_point = 0x10000 + ((code_point - 0xD800) << 10) +
+                                 static_cast<uint32_t>(low - 0xDC00);
+                    pos += 6;
+                }
+            }
+            appendUtf8(out, code_point);
+            break;
+        }
+        default:
+            out += ' ';
+            break;
+        }
+    }
+}
+
+void appendText(std::string& out, const std::string& text)
+{
+    if (text.empty())
+    {
+        return;
+    }
+    if (!out.empty())
+    {
+        out += '\n';
+    }
+    out += text;
+}
+
+}  // namespace
+
+std::string SearchText::fromRequest(std::string_view request_body)
+{
+    auto json = crow::json::load(request_body.data(), request_body.size());
+    if (!json || json.t() != crow::json::type::Object)
+    {
+        return {};
+    }
+
+    std::string text;
+    for (const char* field : {"system", "prompt"})
+    {
+        if (json.has(field) && json[field].t() == crow::json::type::String)
+        {
+            appendText(text, json[field].s());
+        }
+    }
+    if (json.has("messages") && json["messages"].t() == crow::json::type::List)
+    {
+        for (const auto& message : json["messages"])
+        {
+            if (message.t() == crow::json::type::Object && message.has("content") &&
+                message["content"].t() == crow::json::type::String)
+            {
+                appendText(text, message["content"].s());
+            }
+        }
+    }
+    return text;
+}
+
+std::string SearchText::fromResponse(std::string_view response_body)
+{
+    std::string text;
+    size_t start = 0;
+    while (start < response_body.size())
+    {
+        size_t end = response_body.find('\n', start);
+        if (end == std::string_view::npos)
+        {
+            end = response_body.size();
+        }
+        std::string_view line = response_body.substr(start, end - start);
+
+        size_t key = line.find(kResponseKey);
+        size_t key_length = kResponseKey.size();
+        if (key == std::string_view::npos)
+        {
+            key = line.find(kContentKey);
+            key_length = kContentKey.size();
+        }
+        if (key != std::string_view::npos)
+        {
+            appendJsonString(line, key + key_length, text);
+        }
+        start = end + 1;
+    }
+    return text;
+}
+
+}  // namespace sectorflux
@@ -0,0 +1,49 @@
+/*
+ * SectorFlux - LLM Proxy and Analytics
+ * Copyright (c) 2025 ParticleSector.com
+ *
+ * This software is dual-licensed:
+ * - GPL-3.0 for open source use
+ * - Commercial license for proprietary use
+ *
+ * See LICENSE and LICENSING.md for details.
+ */
+
+#pragma once
+
+#include <string>
+#include <string_view>
+
+namespace sectorflux
+{
+
+/**
+ * @brief Extracts the human-readable text of logged bodies for full-text search.
+ *
+ * Only the prompt and the generated text are indexed, not the JSON framing
+ * around them: a streamed response repeats the same keys on every token
+ * line, which would bloat the index and match almost any query.
+ */
+class SearchText
+{
+public:
+    /**
+     * @brief The prompt, system prompt and chat message contents of a request.
+     * @param request_body The raw JSON request body.
+     * @return std::string The text, empty if the body is not valid JSON.
+     */
+    [[nodiscard]] static std::string fromRequest(std::string_view request_body);
+
+    /**
+     * @brief The generated text of a response, streamed (NDJSON) or not.
+     *
+     * Lines are scanned for their `response` or `content` string rather than
+     * parsed, so a long stream costs one pass over its bytes.
+     *
+     * @param response_body The raw response body.
+     * @return std::string The concatenated generated text.
+     */
+    [[nodiscard]] static std::string fromResponse(std::string_view response_body);
+};
+
+}  // namespace sectorflux
@@ -0,0 +1,178 @@
+/*
+ * SectorFlux - LLM Proxy and Analytics
+ * Copyright (c) 2025 ParticleSector.com
+ *
+ * This software is dual-licensed:
+ * - GPL-3.0 for open source use
+ * - Commercial license for proprietary use
+ *
+ * See LICENSE and LICENSING.md for details.
+ */
+
+#include "single_flight.hpp"
+
+#include <utility>
+
+namespace sectorflux
+{
+
+void Flight::begin(int status)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        status_ = status;
+    }
+    cv_.notify_all();
+}
+
+void Flight::publish(const char* data, size_t length)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        data_.append(data, length);
+    }
+    cv_.notify_all();
+}
+
+void Flight::complete(int status, std::optional<std::string> error)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (done_)
+        {
+            return;
+        }
+        done_ = true;
+        outcome_ = Outcome{status, std::move(error)};
+    }
+    cv_.notify_all();
+}
+
+Flight::Outcome Flight::follow(const std::function<bool(const char* data, size_t length)>& sink,
+                               const std::function<void(int status)>& on_status)
+{
+    size_t offset = 0;
+    std::string slice;
+    bool announced = !on_status;
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true)
+    {
+        cv_.wait(lock, [this, offset, announced]()
+                 { return done_ || data_.size() > offset || (!announced && status_); });
+        if (!announced && status_)
+        {
+            announced = true;
+            const int status = *status_;
+            lock.unlock();
+            on_status(status);
+            lock.lock();
+            continue;
+        }
+        if (data_.size() == offset)
+        {
+            // Done and fully delivered
+            --followers_;
+            return outcome_;
+        }
+
+        // Copy out so the sink runs without the lock held
+        slice.assign(data_.view().substr(offset));
+        offset = data_.size();
+        lock.unlock();
+        bool open = sink(slice.data(), slice.size());
+        lock.lock();
+
+        if (!open)
+        {
+            --followers_;
+            return Outcome{499, "Client disconnected"};
+        }
+    }
+}
+
+bool Flight::hasFollowers() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return followers_ > 0;
+}
+
+SharedBody Flight::body() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return data_.share();
+}
+
+SingleFlight::Participation::Participation(Participation&& other) noexcept
+    : registry_(std::exchange(other.registry_, nullptr)),
+      key_(other.key_),
+      flight_(std::move(other.flight_))
+{
+}
+
+SingleFlight::Participation& SingleFlight::Participation::operator=(Participation&& other) noexcept
+{
+    if (this != &other)
+    {
+        if (registry_)
+        {
+            complete(500, "Upstream request was abandoned");
+        }
+        registry_ = std::exchange(other.registry_, nullptr);
+        key_ = other.key_;
+        flight_ = std::move(other.flight_);
+    }
+    return *this;
+}
+
+SingleFlight::Participation::~Participation()
+{
+    // Never strand followers, even if the leader bailed out early
+    if (registry_)
+    {
+        complete(500, "Upstream request was abandoned");
+    }
+}
+
+void SingleFlight::Participation::complete(int status, std::optional<std::string> error)
+{
+    if (!registry_)
+    {
+        return;
+    }
+    // Unregister first: later arrivals should find the cache, not a finished flight
+    std::exchange(registry_, nullptr)->retire(key_, flight_);
+    flight_->complete(status, std::move(error));
+}
+
+SingleFlight::Participation SingleFlight::join(const CacheKey& key)
+{
+    Participation participation;
+    participation.key_ = key;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto [it, inserted] = flights_.try_emplace(key);
+    if (inserted)
+    {
+        it->second = std::make_shared<Flight>();
+        participation.registry_ = this;
+    }
+    else
+    {
+        std::lock_guard<std::mutex> flight_lock(it->second->mutex_);
+        ++it->second->followers_;
+    }
+    participation.flight_ = it->second;
+    return participation;
+}
+
+void SingleFlight::retire(const CacheKey& key, const std::shared_ptr<Flight>& flight)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = flights_.find(key);
+    if (it != flights_.end() && it->second == flight)
+    {
+        flights_.erase(it);
+    }
+}
+
+}  // namespace sectorflux
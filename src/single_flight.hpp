@@ -0,0 +1,174 @@
+/*
+ * SectorFlux - LLM Proxy and Analytics
+ * Copyright (c) 2025 ParticleSector.com
+ *
+ * This software is dual-licensed:
+ * - GPL-3.0 for open source use
+ * - Commercial license for proprietary use
+ *
+ * See LICENSE and LICENSING.md for details.
+ */
+
+#pragma once
+
+#include "cache_key.hpp"
+#include "response_buffer.hpp"
+
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+
+namespace sectorflux
+{
+
+/**
+ * @brief One upstream generation shared by concurrent identical requests.
+ *
+ * The leader publishes response chunks into an append-only buffer; followers
+ * replay it from the start and then block for new bytes, each on its own
+ * thread, so a slow follower never holds up the leader or the others.
+ */
+class Flight
+{
+public:
+    /**
+     * @brief Final status of the shared generation.
+     */
+    struct Outcome
+    {
+        int status = 500;
+        std::optional<std::string> error;
+    };
+
+    /**
+     * @brief Record the upstream status line and wake the followers (leader only).
+     */
+    void begin(int status);
+
+    /**
+     * @brief Append a response chunk and wake the followers (leader only).
+     */
+    void publish(const char* data, size_t length);
+
+    /**
+     * @brief Mark the generation finished; no-op after the first call.
+     */
+    void complete(int status, std::optional<std::string> error);
+
+    /**
+     * @brief Stream the response to a follower until it completes.
+     * @param sink Receives each slice; returning false stops following.
+     * @param on_status Called once with the upstream status, before any slice,
+     *        if upstream answered at all.
+     * @return Outcome The leader's status, or an error if the follower gave up.
+     */
+    Outcome follow(const std::function<bool(const char* data, size_t length)>& sink,
+                   const std::function<void(int status)>& on_status = {});
+
+    /**
+     * @brief Whether anyone is still following, i.e. upstream must keep reading.
+     */
+    [[nodiscard]] bool hasFollowers() const;
+
+    /**
+     * @brief The published body, shared rather than copied.
+     *
+     * Only valid once the leader has stopped publishing, i.e. after its
+     * exchange ended or after follow() returned.
+     */
+    [[nodiscard]] SharedBody body() const;
+
+private:
+    friend class SingleFlight;
+
+    mutable std::mutex mutex_;
+    std::condition_variable cv_;
+    ResponseBuffer data_;
+    size_t followers_ = 0;
+    std::optional<int> status_;  // Upstream status line, once it arrived
+    bool done_ = false;
+    Outcome outcome_;
+};
+
+/**
+ * @brief Deduplicates identical requests that are in flight at the same time.
+ *
+ * The first request for a cache key leads and goes upstream; requests for
+ * the same key that arrive before it finishes follow its stream instead of
+ * starting their own generation.
+ */
+class SingleFlight
+{
+public:
+    /**
+     * @brief A request's place in a flight; the leader's retires the flight on destruction.
+     */
+    class Participation
+    {
+    public:
+        Participation() = default;
+        Participation(Participation&& other) noexcept;
+        Participation& operator=(Participation&& other) noexcept;
+        Participation(const Participation&) = delete;
+        Participation& operator=(const Participation&) = delete;
+        ~Participation();
+
+        /**
+         * @brief Whether the request takes part in a flight at all.
+         */
+        explicit operator bool() const
+        {
+            return flight_ != nullptr;
+        }
+
+        /**
+         * @brief Whether this request drives the upstream generation.
+         */
+        [[nodiscard]] bool leader() const
+        {
+            return registry_ != nullptr;
+        }
+
+        [[nodiscard]] Flight& flight()
+        {
+            return *flight_;
+        }
+
+        /**
+         * @brief Finish the flight and let later requests start a new one (leader only).
+         */
+        void complete(int status, std::optional<std::string> error);
+
+    private:
+        friend class SingleFlight;
+
+        SingleFlight* registry_ = nullptr;  // Set for the leader only
+        CacheKey key_;
+        std::shared_ptr<Flight> flight_;
+    };
+
+    SingleFlight() = default;
+
+    SingleFlight(const SingleFlight&) = delete;
+    SingleFlight& operator=(const SingleFlight&) = delete;
+
+    /**
+     * @brief Lead a new flight for a key, or follow the one in progress.
+     * @param key The request's cache key.
+     * @return Participation A leader handle if no flight was running, else a follower one.
+     */
+    [[nodiscard]] Participation join(const CacheKey& key);
+
+private:
+    void retire(const CacheKey& key, const std::shared_ptr<Flight>& flight);
+
+    std::mutex mutex_;
+    std::unordered_map<CacheKey, std::shared_ptr<Flight>, CacheKeyHash> flights_;
+};
+
+}  // namespace sectorflux
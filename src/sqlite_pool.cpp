@@ -0,0 +1,172 @@
+/*
+ * SectorFlux - LLM Proxy and Analytics
+ * Copyright (c) 2025 ParticleSector.com
+ *
+ * This software is dual-licensed:
+ * - GPL-3.0 for open source use
+ * - Commercial license for proprietary use
+ *
+ * See LICENSE and LICENSING.md for details.
+ */
+
+#include "sqlite_pool.hpp"
+
+#include <utility>
+
+namespace sectorflux
+{
+
+std::optional<std::string> applyTuning(sqlite3* db, const ConnectionTuning& tuning)
+{
+    // A negative cache_size is in KiB rather than pages
+    const std::string sql =
+        "PRAGMA cache_size = -" + std::to_string(tuning.cache_size_kb) + ";"
+        "PRAGMA mmap_size = " + std::to_string(tuning.mmap_bytes) + ";"
+        "PRAGMA temp_store = MEMORY;";
+
+    sqlite3_busy_timeout(db, tuning.busy_timeout_ms);
+
+    char* err_msg = nullptr;
+    if (sqlite3_exec(db, sql.c_str(), nullptr, nullptr, &err_msg) != SQLITE_OK)
+    {
+        std::string err = "Failed to tune connection: " +
+                          std::string(err_msg ? err_msg : "unknown error");
+        sqlite3_free(err_msg);
+        return err;
+    }
+    return std::nullopt;
+}
+
+StatementCache::~StatementCache()
+{
+    for (auto& [sql, stmt] : statements_)
+    {
+        sqlite3_finalize(stmt);
+    }
+}
+
+Statement StatementCache::prepare(std::string_view sql)
+{
+    auto it = statements_.find(sql);
+    if (it != statements_.end())
+    {
+        return Statement(it->second);
+    }
+
+    sqlite3_stmt* stmt = nullptr;
+    if (sqlite3_prepare_v3(db_, sql.data(), static_cast<int>(sql.size()),
+                           SQLITE_PREPARE_PERSISTENT, &stmt, nullptr) != SQLITE_OK)
+    {
+        sqlite3_finalize(stmt);
+        return Statement(nullptr);
+    }
+    statements_.emplace(std::string(sql), stmt);
+    return Statement(stmt);
+}
+
+ReadPool::Connection::~Connection()
+{
+    // close_v2 defers the close until the cached statements are finalized
+    sqlite3_close_v2(db);
+}
+
+ReadPool::~ReadPool()
+{
+    idle_.clear();
+    connections_.clear();
+}
+
+std::optional<std::string> ReadPool::open(const std::string& db_path, size_t connections,
+                                          const ConnectionTuning& tuning)
+{
+    for (size_t i = 0; i < connections; ++i)
+    {
+        // NOMUTEX: a connection is only ever used by the thread holding its lease
+        sqlite3* db = nullptr;
+        int rc = sqlite3_open_v2(db_path.c_str(), &db,
+                                 SQLITE_OPEN_READONLY | SQLITE_OPEN_NOMUTEX, nullptr);
+        if (rc != SQLITE_OK)
+        {
+            std::string err = "Can't open reader connection: " +
+                              std::string(db ? sqlite3_errmsg(db) : sqlite3_errstr(rc));
+            sqlite3_close_v2(db);
+            return err;
+        }
+
+        auto connection = std::make_unique<Connection>(db);
+        if (auto err = applyTuning(db, tuning))
+        {
+            return err;
+        }
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        idle_.push_back(connection.get());
+        connections_.push_back(std::move(connection));
+    }
+    return std::nullopt;
+}
+
+ReadPool::Lease ReadPool::acquire()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (connections_.empty())
+    {
+        return Lease();
+    }
+    cv_.wait(lock, [this]() { return !idle_.empty(); });
+    Connection* connection = idle_.back();
+    idle_.pop_back();
+    return Lease(this, connection);
+}
+
+void ReadPool::release(Connection* connection)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        idle_.push_back(connection);
+    }
+    cv_.notify_one();
+}
+
+ReadPool::Lease::~Lease()
+{
+    release();
+}
+
+ReadPool::Lease::Lease(Lease&& other) noexcept
+    : pool_(std::exchange(other.pool_, nullptr)),
+      connection_(std::exchange(other.connection_, nullptr))
+{
+}
+
+ReadPool::Lease& ReadPool::Lease::operator=(Lease&& other) noexcept
+{
+    if (this != &other)
+    {
+        release();
+        pool_ = std::exchange(other.pool_, nullptr);
+        connection_ = std::exchange(other.connection_, nullptr);
+    }
+    return *this;
+}
+
+Statement ReadPool::Lease::prepare(std::string_view sql)
+{
+    if (!connection_)
+    {
+        return Statement(nullptr);
+    }
+    return connection_->statements.prepare(sql);
+}
+
+void ReadPool::Lease::release()
+{
+    if (pool_ && connection_)
+    {
+        pool_->release(connection_);
+    }
+    pool_ = nullptr;
+    connection_ = nullptr;
+}
+
+}  // namespace sectorflux
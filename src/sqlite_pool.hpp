@@ -0,0 +1,217 @@
+/*
+ * SectorFlux - LLM Proxy and Analytics
+ * Copyright (c) 2025 ParticleSector.com
+ *
+ * This software is dual-licensed:
+ * - GPL-3.0 for open source use
+ * - Commercial license for proprietary use
+ *
+ * See LICENSE and LICENSING.md for details.
+ */
+
+#pragma once
+
+#include <sqlite3.h>
+
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace sectorflux
+{
+
+/**
+ * @brief Tuning applied to every connection when it is opened.
+ */
+struct ConnectionTuning
+{
+    int cache_size_kb = 0;     // Page cache per connection (PRAGMA cache_size)
+    long long mmap_bytes = 0;  // Memory-mapped I/O window (PRAGMA mmap_size)
+    int busy_timeout_ms = 0;
+};
+
+/**
+ * @brief Apply the tuning pragmas shared by writer and reader connections.
+ * @return std::optional<std::string> Error message on failure, nullopt on success.
+ */
+std::optional<std::string> applyTuning(sqlite3* db, const ConnectionTuning& tuning);
+
+/**
+ * @brief A cached statement in use; resets it and clears its bindings on scope exit.
+ *
+ * Resetting also ends the statement's read transaction, so a WAL reader never
+ * pins an old snapshot between requests.
+ */
+class Statement
+{
+public:
+    explicit Statement(sqlite3_stmt* stmt) : stmt_(stmt)
+    {
+    }
+
+    ~Statement()
+    {
+        if (stmt_)
+        {
+            sqlite3_reset(stmt_);
+            sqlite3_clear_bindings(stmt_);
+        }
+    }
+
+    Statement(const Statement&) = delete;
+    Statement& operator=(const Statement&) = delete;
+
+    explicit operator bool() const
+    {
+        return stmt_ != nullptr;
+    }
+
+    [[nodiscard]] sqlite3_stmt* get() const
+    {
+        return stmt_;
+    }
+
+private:
+    sqlite3_stmt* stmt_;
+};
+
+/**
+ * @brief Prepared statements of one connection, compiled on first use and kept.
+ *
+ * Not thread-safe: it belongs to whichever thread holds the connection.
+ */
+class StatementCache
+{
+public:
+    explicit StatementCache(sqlite3* db) : db_(db)
+    {
+    }
+
+    ~StatementCache();
+
+    StatementCache(const StatementCache&) = delete;
+    StatementCache& operator=(const StatementCache&) = delete;
+
+    /**
+     * @brief Get the statement for sql, preparing it the first time.
+     * @return Statement Empty if sql fails to prepare.
+     */
+    [[nodiscard]] Statement prepare(std::string_view sql);
+
+private:
+    // Lets lookups take the caller's string_view without building a key
+    struct SqlHash
+    {
+        using is_transparent = void;
+
+        size_t operator()(std::string_view sql) const
+        {
+            return std::hash<std::string_view>{}(sql);
+        }
+    };
+
+    sqlite3* db_;
+    std::unordered_map<std::string, sqlite3_stmt*, SqlHash, std::equal_to<>> statements_;
+};
+
+/**
+ * @brief Fixed pool of read-only connections for request handlers.
+ *
+ * In WAL mode readers work from a snapshot and never wait for the writer,
+ * so dashboard queries do not contend with the writer thread's batches.
+ * Each lease hands out an exclusive connection with its own statement cache.
+ */
+class ReadPool
+{
+    struct Connection;
+
+public:
+    /**
+     * @brief Exclusive, move-only handle to a pooled reader connection.
+     */
+    class Lease
+    {
+    public:
+        Lease() = default;
+        ~Lease();
+
+        Lease(Lease&& other) noexcept;
+        Lease& operator=(Lease&& other) noexcept;
+        Lease(const Lease&) = delete;
+        Lease& operator=(const Lease&) = delete;
+
+        explicit operator bool() const
+        {
+            return connection_ != nullptr;
+        }
+
+        /**
+         * @brief Get a cached statement on the leased connection.
+         */
+        [[nodiscard]] Statement prepare(std::string_view sql);
+
+    private:
+        friend class ReadPool;
+
+        Lease(ReadPool* pool, Connection* connection) : pool_(pool), connection_(connection)
+        {
+        }
+
+        void release();
+
+        ReadPool* pool_ = nullptr;
+        Connection* connection_ = nullptr;
+    };
+
+    ReadPool() = default;
+    ~ReadPool();
+
+    ReadPool(const ReadPool&) = delete;
+    ReadPool& operator=(const ReadPool&) = delete;
+
+    /**
+     * @brief Open the reader connections (call after the schema exists).
+     * @param db_path Path of the WAL database the writer opened.
+     * @param connections Number of reader connections.
+     * @param tuning Pragmas applied to each connection.
+     * @return std::optional<std::string> Error message on failure, nullopt on success.
+     */
+    std::optional<std::string> open(const std::string& db_path, size_t connections,
+                                    const ConnectionTuning& tuning);
+
+    /**
+     * @brief Lease a reader, waiting for one to be returned if all are busy.
+     * @return Lease An empty lease if the pool was never opened.
+     */
+    [[nodiscard]] Lease acquire();
+
+private:
+    struct Connection
+    {
+        explicit Connection(sqlite3* db) : db(db), statements(db)
+        {
+        }
+
+        ~Connection();
+
+        sqlite3* db;
+        StatementCache statements;
+    };
+
+    void release(Connection* connection);
+
+    std::vector<std::unique_ptr<Connection>> connections_;
+
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::vector<Connection*> idle_;
+};
+
+}  // namespace sectorflux
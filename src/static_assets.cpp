@@ -0,0 +1,203 @@
+/*
+ * SectorFlux - LLM Proxy and Analytics
+ * Copyright (c) 2025 ParticleSector.com
+ *
+ * This software is dual-licensed:
+ * - GPL-3.0 for open source use
+ * - Commercial license for proprietary use
+ *
+ * See LICENSE and LICENSING.md for details.
+ */
+
+#include "static_assets.hpp"
+
+#include "embedded_ui.hpp"
+
+#include <charconv>
+#include <string>
+
+namespace sectorflux
+{
+
+namespace
+{
+
+constexpr const char* kCacheControl = "no-cache";
+
+std::string_view trim(std::string_view text)
+{
+    while (!text.empty() && (text.front() == ' ' || text.front() == '\t'))
+    {
+        text.remove_prefix(1);
+    }
+    while (!text.empty() && (text.back() == ' ' || text.back() == '\t'))
+    {
+        text.remove_suffix(1);
+    }
+    return text;
+}
+
+bool equalsIgnoreCase(std::string_view a, std::string_view b)
+{
+    if (a.size() != b.size())
+    {
+        return false;
+    }
+    for (size_t i = 0; i < a.size(); ++i)
+    {
+        char x = a[i] >= 'A' && a[i] <= 'Z' ? static_cast<char>(a[i] - 'A' + 'a') : a[i];
+        char y = b[i] >= 'A' && b[i] <= 'Z' ? static_cast<char>(b[i] - 'A' + 'a') : b[i];
+        if (x != y)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Call visit(item) for each comma-separated, trimmed list item.
+ */
+template <typename Visitor>
+void forEachListItem(std::string_view list, Visitor visit)
+{
+    while (!list.empty())
+    {
+        size_t comma = list.find(',');
+        std::string_view item = trim(list.substr(0, comma));
+        if (!item.empty())
+        {
+            visit(item);
+        }
+        if (comma == std::string_view::npos)
+        {
+            break;
+        }
+        list.remove_prefix(comma + 1);
+    }
+}
+
+/**
+ * @brief Whether an Accept-Encoding item has a non-zero quality ("gzip;q=0" refuses).
+ */
+bool acceptable(std::string_view parameters)
+{
+    size_t q = parameters.find("q=");
+    if (q == std::string_view::npos)
+    {
+        return true;
+    }
+    double quality = 1.0;
+    std::string_view value = parameters.substr(q + 2);
+    auto [end, ec] = std::from_chars(value.data(), value.data() + value.size(), quality);
+    return ec != std::errc() || quality > 0.0;
+}
+
+std::string_view bytes(const unsigned char* data, size_t size)
+{
+    return std::string_view(reinterpret_cast<const char*>(data), size);
+}
+
+} // namespace
+
+const EmbeddedAsset* findEmbeddedAsset(std::string_view path)
+{
+    for (const auto& asset : kEmbeddedAssets)
+    {
+        if (path == asset.path)
+        {
+            return &asset;
+        }
+    }
+    return nullptr;
+}
+
+ContentEncoding negotiateEncoding(std::string_view accept_encoding, const EmbeddedAsset& asset)
+{
+    bool brotli = false;
+    bool gzip = false;
+    forEachListItem(accept_encoding, [&](std::string_view item)
+    {
+        size_t semicolon = item.find(';');
+        std::string_view coding = trim(item.substr(0, semicolon));
+        bool ok = semicolon == std::string_view::npos || acceptable(item.substr(semicolon + 1));
+        if (equalsIgnoreCase(coding, "br"))
+        {
+            brotli = ok;
+        }
+        else if (equalsIgnoreCase(coding, "gzip") || equalsIgnoreCase(coding, "x-gzip"))
+        {
+            gzip = ok;
+        }
+        else if (coding == "*" && ok)
+        {
+            brotli = true;
+            gzip = true;
+        }
+    });
+
+    if (brotli && asset.brotli_size > 0)
+    {
+        return ContentEncoding::Brotli;
+    }
+    if (gzip && asset.gzip_size > 0)
+    {
+        return ContentEncoding::Gzip;
+    }
+    return ContentEncoding::Identity;
+}
+
+bool etagMatches(std::string_view if_none_match, const EmbeddedAsset& asset)
+{
+    bool match = false;
+    forEachListItem(if_none_match, [&](std::string_view tag)
+    {
+        if (tag.starts_with("W/"))
+        {
+            tag.remove_prefix(2);
+        }
+        match = match || tag == "*" || tag == asset.etag ||
+                (asset.gzip_size > 0 && tag == asset.gzip_etag) ||
+                (asset.brotli_size > 0 && tag == asset.brotli_etag);
+    });
+    return match;
+}
+
+void serveEmbeddedAsset(const crow::request& req, crow::response& res, const EmbeddedAsset& asset)
+{
+    const ContentEncoding encoding = negotiateEncoding(req.get_header_value("Accept-Encoding"), asset);
+    const char* etag = encoding == ContentEncoding::Brotli ? asset.brotli_etag
+                       : encoding == ContentEncoding::Gzip ? asset.gzip_etag
+                                                           : asset.etag;
+    res.set_header("ETag", etag);
+    res.set_header("Vary", "Accept-Encoding");
+    res.set_header("Cache-Control", kCacheControl);
+
+    // A reload over a slow link then costs one round trip and no body
+    const std::string if_none_match = req.get_header_value("If-None-Match");
+    if (!if_none_match.empty() && etagMatches(if_none_match, asset))
+    {
+        res.code = 304;
+        res.end();
+        return;
+    }
+
+    res.set_header("Content-Type", asset.content_type);
+    switch (encoding)
+    {
+        case ContentEncoding::Brotli:
+            res.set_header("Content-Encoding", "br");
+            res.body = bytes(asset.brotli, asset.brotli_size);
+            break;
+        case ContentEncoding::Gzip:
+            res.set_header("Content-Encoding", "gzip");
+            res.body = bytes(asset.gzip, asset.gzip_size);
+            break;
+        case ContentEncoding::Identity:
+            res.body = bytes(asset.identity, asset.identity_size);
+            break;
+    }
+    res.end();
+}
+
+} // namespace sectorflux
@@ -0,0 +1,95 @@
+/*
+ * SectorFlux - LLM Proxy and Analytics
+ * Copyright (c) 2025 ParticleSector.com
+ *
+ * This software is dual-licensed:
+ * - GPL-3.0 for open source use
+ * - Commercial license for proprietary use
+ *
+ * See LICENSE and LICENSING.md for details.
+ */
+
+#pragma once
+
+#include <crow.h>
+
+#include <cstddef>
+#include <string_view>
+
+namespace sectorflux
+{
+
+/**
+ * @brief One dashboard file as embedded by scripts/embed_ui.py.
+ *
+ * The compressed variants are produced at build time; a variant that is
+ * missing (or would not be smaller) has size 0 and is never offered.
+ */
+struct EmbeddedAsset
+{
+    const char* path;          // URL path, e.g. "/app.js"
+    const char* content_type;
+    const unsigned char* identity;
+    size_t identity_size;
+    const unsigned char* gzip;
+    size_t gzip_size;
+    const unsigned char* brotli;
+    size_t brotli_size;
+    const char* etag;          // Strong ETag of the identity bytes, quoted
+    const char* gzip_etag;     // Per-encoding ETags (RFC 9110 8.8.3)
+    const char* brotli_etag;
+};
+
+/**
+ * @brief Content codings a response can be served in, best first.
+ */
+enum class ContentEncoding
+{
+    Brotli,
+    Gzip,
+    Identity
+};
+
+/**
+ * @brief Find the embedded asset served at a URL path.
+ * @param path The request path ("/" maps to index.html).
+ * @return const EmbeddedAsset* The asset, or nullptr if none.
+ */
+[[nodiscard]] const EmbeddedAsset* findEmbeddedAsset(std::string_view path);
+
+/**
+ * @brief Pick the best coding of an asset the client accepts.
+ * @param accept_encoding The Accept-Encoding header (empty: identity only).
+ * @param asset The asset whose variants are available.
+ * @return ContentEncoding The coding to respond with.
+ */
+[[nodiscard]] ContentEncoding negotiateEncoding(std::string_view accept_encoding,
+                                                const EmbeddedAsset& asset);
+
+/**
+ * @brief Check an If-None-Match header against an asset.
+ *
+ * Uses the weak comparison RFC 9110 prescribes for If-None-Match, and
+ * accepts the ETag of any of the asset's codings.
+ *
+ * @param if_none_match The header value.
+ * @param asset The asset being requested.
+ * @return bool True if the client's copy is current (respond 304).
+ */
+[[nodiscard]] bool etagMatches(std::string_view if_none_match, const EmbeddedAsset& asset);
+
+/**
+ * @brief Answer a request for an embedded asset.
+ *
+ * Responds 304 when the client's copy is current; otherwise with the
+ * best precompressed variant. Every response carries the ETag,
+ * Vary: Accept-Encoding and Cache-Control: no-cache, so browsers
+ * revalidate on each load instead of guessing freshness.
+ *
+ * @param req The client request.
+ * @param res The response to fill and end.
+ * @param asset The asset to serve.
+ */
+void serveEmbeddedAsset(const crow::request& req, crow::response& res, const EmbeddedAsset& asset);
+
+} // namespace sectorflux
@@ -0,0 +1,182 @@
+/*
+ * SectorFlux - LLM Proxy and Analytics
+ * Copyright (c) 2025 ParticleSector.com
+ *
+ * This software is dual-licensed:
+ * - GPL-3.0 for open source use
+ * - Commercial license for proprietary use
+ *
+ * See LICENSE and LICENSING.md for details.
+ */
+
+#include "stream_metrics.hpp"
+
+#include <crow.h>
+
+#include <chrono>
+#include <cstring>
+
+namespace sectorflux
+{
+
+namespace
+{
+
+constexpr long long kNanosecondsPerMillisecond = 1000000;
+
+// Ollama encodes JSON without whitespace, so the summary marker is exact
+constexpr std::string_view kDoneMarker = "\"done\":true";
+
+std::string_view trim(std::string_view text)
+{
+    size_t first = text.find_first_not_of(" \t\r\n");
+    if (first == std::string_view::npos)
+    {
+        return {};
+    }
+    size_t last = text.find_last_not_of(" \t\r\n");
+    return text.substr(first, last - first + 1);
+}
+
+}  // namespace
+
+size_t StreamMetricsParser::feed(const char* data, size_t length)
+{
+    size_t token_lines = 0;
+    std::string_view chunk(data, length);
+    size_t start = 0;
+    while (start < chunk.size())
+    {
+        const void* found = std::memchr(chunk.data() + start, '\n', chunk.size() - start);
+        if (!found)
+        {
+            partial_.append(chunk.data() + start, chunk.size() - start);
+            break;
+        }
+        size_t newline = static_cast<size_t>(static_cast<const char*>(found) - chunk.data());
+
+        // Lines inside one chunk are viewed in place; only a split line is joined
+        std::string_view line = chunk.substr(start, newline - start);
+        if (!partial_.empty())
+        {
+            partial_.append(line);
+            token_lines += onLine(partial_, false) ? 1 : 0;
+            partial_.clear();
+        }
+        else
+        {
+            token_lines += onLine(line, false) ? 1 : 0;
+        }
+        start = newline + 1;
+    }
+    return token_lines;
+}
+
+ResponseMetrics StreamMetricsParser::finish()
+{
+    if (!partial_.empty())
+    {
+        onLine(partial_, true);
+        partial_.clear();
+    }
+    return metrics_;
+}
+
+ResponseMetrics StreamMetricsParser::parse(std::string_view response)
+{
+    StreamMetricsParser parser;
+    parser.feed(response.data(), response.size());
+    return parser.finish();
+}
+
+bool StreamMetricsParser::onLine(std::string_view line, bool last)
+{
+    line = trim(line);
+    if (line.empty() || line.front() != '{')
+    {
+        return false;
+    }
+
+    // Token lines are counted, never parsed. An unterminated last line is a
+    // non-streaming body (e.g. /api/embed) and may carry counts without "done".
+    const bool summary = line.find(kDoneMarker) != std::string_view::npos;
+    if (!summary && !(last && !found_summary_))
+    {
+        return true;
+    }
+
+    try
+    {
+        auto json = crow::json::load(line.data(), line.size());
+        if (!json)
+        {
+            return false;
+        }
+        if (json.has("prompt_eval_count"))
+        {
+            metrics_.prompt_tokens = static_cast<int>(json["prompt_eval_count"].i());
+        }
+        if (json.has("eval_count"))
+        {
+            metrics_.completion_tokens = static_cast<int>(json["eval_count"].i());
+        }
+        if (json.has("prompt_eval_duration"))
+        {
+            metrics_.prompt_eval_duration_ms =
+                json["prompt_eval_duration"].i() / kNanosecondsPerMillisecond;
+        }
+        if (json.has("eval_duration"))
+        {
+            metrics_.eval_duration_ms = json["eval_duration"].i() / kNanosecondsPerMillisecond;
+        }
+        found_summary_ = true;
+    }
+    catch (...)
+    {
+        // Ignore parsing errors
+    }
+    return false;
+}
+
+int64_t RateMeter::nowSecond()
+{
+    return std::chrono::duration_cast<std::chrono::seconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void RateMeter::add(uint64_t count)
+{
+    if (count == 0)
+    {
+        return;
+    }
+    const int64_t second = nowSecond();
+    auto& bucket = buckets_[static_cast<size_t>(second) % buckets_.size()];
+
+    // The first writer of a new second recycles the bucket; a racing add may
+    // land in the old count, which a gauge can tolerate
+    int64_t seen = bucket.second.load(std::memory_order_relaxed);
+    if (seen != second &&
+        bucket.second.compare_exchange_strong(seen, second, std::memory_order_relaxed))
+    {
+        bucket.count.store(0, std::memory_order_relaxed);
+    }
+    bucket.count.fetch_add(count, std::memory_order_relaxed);
+}
+
+double RateMeter::perSecond() const
+{
+    const int64_t current = nowSecond();
+    uint64_t total = 0;
+    for (const auto& bucket : buckets_)
+    {
+        const int64_t second = bucket.second.load(std::memory_order_relaxed);
+        if (second < current && second >= current - static_cast<int64_t>(kWindowSec))
+        {
+            total += bucket.count.load(std::memory_order_relaxed);
+        }
+    }
+    return static_cast<double>(total) / static_cast<double>(kWindowSec);
+}
+
+}  // namespace sectorflux
@@ -0,0 +1,105 @@
+/*
+ * SectorFlux - LLM Proxy and Analytics
+ * Copyright (c) 2025 ParticleSector.com
+ *
+ * This software is dual-licensed:
+ * - GPL-3.0 for open source use
+ * - Commercial license for proprietary use
+ *
+ * See LICENSE and LICENSING.md for details.
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace sectorflux
+{
+
+/**
+ * @brief Metrics Ollama reports in the final object of a response.
+ */
+struct ResponseMetrics
+{
+    int prompt_tokens = 0;
+    int completion_tokens = 0;
+    long long prompt_eval_duration_ms = 0;
+    long long eval_duration_ms = 0;
+};
+
+/**
+ * @brief Incremental NDJSON scanner fed from the upstream content receiver.
+ *
+ * Tracks line boundaries as bytes arrive and only JSON-parses the summary
+ * object (the one with "done":true), so the cost is one pass over the
+ * stream instead of a backward rescan with per-line copies at the end.
+ * Only a line split across chunks is buffered.
+ */
+class StreamMetricsParser
+{
+public:
+    /**
+     * @brief Scan the next received bytes.
+     * @return size_t Number of streamed token lines completed by these bytes.
+     */
+    size_t feed(const char* data, size_t length);
+
+    /**
+     * @brief Flush a trailing unterminated line and return the metrics.
+     *
+     * A non-streaming response is a single JSON document without a trailing
+     * newline, so it is parsed here.
+     */
+    [[nodiscard]] ResponseMetrics finish();
+
+    /**
+     * @brief Parse a complete response body in one go (cache hits, stored rows).
+     */
+    [[nodiscard]] static ResponseMetrics parse(std::string_view response);
+
+private:
+    /**
+     * @brief Handle one complete line; returns true for a token line.
+     */
+    bool onLine(std::string_view line, bool last);
+
+    std::string partial_;  // Bytes of a line not yet terminated
+    ResponseMetrics metrics_;
+    bool found_summary_ = false;
+};
+
+/**
+ * @brief Lock-free events-per-second gauge over a short sliding window.
+ */
+class RateMeter
+{
+public:
+    /**
+     * @brief Count events that happened now.
+     */
+    void add(uint64_t count);
+
+    /**
+     * @brief Average rate over the last complete seconds of the window.
+     */
+    [[nodiscard]] double perSecond() const;
+
+private:
+    struct Bucket
+    {
+        std::atomic<int64_t> second{-1};
+        std::atomic<uint64_t> count{0};
+    };
+
+    static int64_t nowSecond();
+
+    static constexpr size_t kWindowSec = 5;
+    std::array<Bucket, kWindowSec + 1> buckets_;  // One extra for the current second
+};
+
+}  // namespace sectorflux
@@ -0,0 +1,355 @@
+/*
+ * SectorFlux - LLM Proxy and Analytics
+ * Copyright (c) 2025 ParticleSector.com
+ *
+ * This software is dual-licensed:
+ * - GPL-3.0 for open source use
+ * - Commercial license for proprietary use
+ *
+ * See LICENSE and LICENSING.md for details.
+ */
+
+#include "stream_server.hpp"
+
+#include <condition_variable>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <utility>
+
+namespace sectorflux
+{
+
+namespace
+{
+
+/**
+ * @brief Hands an upstream exchange running on its own thread to the client.
+ *
+ * The handler waits for the upstream status line before committing a
+ * response, so failures reach the client as real status codes the way
+ * Ollama sends them. Once upstream answers 200, chunks pass through a
+ * bounded buffer that the content provider drains; the bound keeps a slow
+ * client pushing back on the upstream read as a direct write would.
+ */
+class UpstreamRelay
+{
+public:
+    /**
+     * @brief Record the upstream status line (exchange thread).
+     */
+    void begin(int status)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            status_ = status;
+        }
+        cv_.notify_all();
+    }
+
+    /**
+     * @brief Queue a chunk for the client (exchange thread).
+     * @return bool False once the client is gone.
+     */
+    bool write(const char* data, size_t length)
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (status_ != 200)
+        {
+            return true;  // An error body is sent whole from the result
+        }
+        cv_.wait(lock, [this]() { return !client_open_ || pending_.size() < kMaxPendingBytes; });
+        if (!client_open_)
+        {
+            return false;
+        }
+        pending_.append(data, length);
+        lock.unlock();
+        cv_.notify_all();
+        return true;
+    }
+
+    /**
+     * @brief Hand over the exchange's result (exchange thread).
+     */
+    void finish(ProxyHandler::ForwardResult result)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            result_ = std::move(result);
+            finished_ = true;
+        }
+        cv_.notify_all();
+    }
+
+    /**
+     * @brief Wait until upstream answered or the exchange ended without an answer.
+     * @return std::optional<int> The upstream status, nullopt if there was none.
+     */
+    std::optional<int> waitForStatus()
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_.wait(lock, [this]() { return status_ || finished_; });
+        return status_;
+    }
+
+    /**
+     * @brief Wait for the exchange to end.
+     */
+    ProxyHandler::ForwardResult waitForResult()
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_.wait(lock, [this]() { return finished_; });
+        return result_;
+    }
+
+    /**
+     * @brief Write queued chunks to the client until the exchange ends.
+     * @return bool False if the client went away first.
+     */
+    bool drain(httplib::DataSink& sink)
+    {
+        std::string chunk;
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (true)
+        {
+            cv_.wait(lock, [this]() { return finished_ || !pending_.empty(); });
+            if (pending_.empty())
+            {
+                return true;
+            }
+            chunk.swap(pending_);
+            pending_.clear();
+            lock.unlock();
+            cv_.notify_all();
+            bool open = sink.write(chunk.data(), chunk.size());
+            lock.lock();
+            if (!open)
+            {
+                client_open_ = false;
+                cv_.notify_all();
+                return false;
+            }
+        }
+    }
+
+    /**
+     * @brief Stop accepting chunks; the exchange stops unless it is shared.
+     */
+    void abandon()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            client_open_ = false;
+        }
+        cv_.notify_all();
+    }
+
+private:
+    static constexpr size_t kMaxPendingBytes = 1024 * 1024;
+
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::optional<int> status_;
+    std::string pending_;
+    bool client_open_ = true;
+    bool finished_ = false;
+    ProxyHandler::ForwardResult result_;
+};
+
+/**
+ * @brief The exchange thread and its relay; abandons and joins it when dropped.
+ */
+struct RelayThread
+{
+    std::shared_ptr<UpstreamRelay> relay = std::make_shared<UpstreamRelay>();
+    std::jthread thread;
+
+    ~RelayThread()
+    {
+        relay->abandon();
+    }
+};
+
+std::string errorLine(const std::string& message)
+{
+    crow::json::wvalue error;
+    error["error"] = message;
+    return error.dump() + "\n";
+}
+
+}  // namespace
+
+StreamServer::StreamServer(ProxyHandler& proxy) : proxy_(proxy)
+{
+    server_.Post("/api/generate", [this](const httplib::Request& req, httplib::Response& res)
+    {
+        handleProxy(req, res, "/api/generate");
+    });
+
+    server_.Post("/api/chat", [this](const httplib::Request& req, httplib::Response& res)
+    {
+        handleProxy(req, res, "/api/chat");
+    });
+}
+
+StreamServer::~StreamServer()
+{
+    stop();
+}
+
+std::optional<std::string> StreamServer::start(int port)
+{
+    if (!server_.bind_to_port("0.0.0.0", port))
+    {
+        return "Failed to bind stream port " + std::to_string(port);
+    }
+
+    worker_ = std::jthread([this](std::stop_token /*stop_token*/)
+    {
+        server_.listen_after_bind();
+    });
+
+    return std::nullopt;
+}
+
+void StreamServer::stop()
+{
+    if (worker_.joinable())
+    {
+        server_.stop();
+        worker_.join();
+    }
+}
+
+void StreamServer::handleProxy(
+    const httplib::Request& req,
+    httplib::Response& res,
+    const std::string& target_endpoint)
+{
+    // The upstream phases run on the exchange thread, which resumes the trace
+    auto trace = std::make_shared<RequestTrace>();
+    TraceScope trace_scope(*trace);
+
+    // Headers go out before the first chunk, so the cache decision is made up front
+    auto cache = proxy_.cacheOptions(req.get_header_value("X-SectorFlux-No-Cache"),
+                                     req.get_header_value("X-SectorFlux-Cache-TTL"));
+    ScopedSpan parse(TracePhase::RequestParse);
+    auto normalized = std::make_shared<NormalizedRequest>(
+        RequestNormalizer::normalize(target_endpoint, req.body));
+    parse.end();
+    res.set_header("X-SectorFlux-Cache-Key", normalized->key.toHex());
+
+    if (cache.lookup)
+    {
+        auto cached = proxy_.serveFromCache(req.body, *normalized, target_endpoint);
+        if (cached)
+        {
+            // Replay line by line as slices of the cached buffer, which the
+            // provider keeps alive until the last chunk is written
+            auto pacing = parseReplayPacing(req.get_header_value("X-SectorFlux-Replay"));
+            res.status = cached->status;
+            if (cached->similarity < 1.0f)
+            {
+                res.set_header("X-SectorFlux-Cache", "SIMILAR");
+                res.set_header("X-SectorFlux-Similarity", std::to_string(cached->similarity));
+            }
+            else
+            {
+                res.set_header("X-SectorFlux-Cache", "HIT");
+            }
+            res.set_chunked_content_provider(
+                "application/x-ndjson",
+                [response = *std::move(cached), pacing](size_t /*offset*/,
+                                                        httplib::DataSink& sink)
+                {
+                    replayChunks(*response.body, *response.chunks, pacing,
+                                 [&sink](const char* data, size_t length)
+                                 {
+                                     return sink.write(data, length);
+                                 });
+                    sink.done();
+                    return true;
+                });
+            return;
+        }
+    }
+
+    res.set_header("X-SectorFlux-Cache", proxy_.isCacheable(*normalized) ? "MISS" : "BYPASS");
+    auto prefix = proxy_.matchPrefix(*normalized);
+    if (prefix.matched > 0)
+    {
+        res.set_header("X-SectorFlux-Prefix-Match",
+                       std::to_string(prefix.matched) + "/" + std::to_string(prefix.total));
+    }
+
+    auto hints = ProxyHandler::schedulingHints(req.get_header_value("X-SectorFlux-Priority"),
+                                               req.remote_addr);
+
+    // Admission and the upstream exchange run on their own thread, which the
+    // provider keeps streaming from once upstream has answered 200
+    auto exchange = std::make_shared<RelayThread>();
+    exchange->thread = std::jthread(
+        [&proxy = proxy_, relay = exchange->relay, request_body = req.body, normalized,
+         target_endpoint, hints, prefix, cache, trace]()
+        {
+            TraceScope exchange_trace_scope(*trace);
+            try
+            {
+                auto result = proxy.forwardUpstream(
+                    request_body, *normalized, target_endpoint, hints, prefix, cache,
+                    [&relay](const char* data, size_t length)
+                    {
+                        return relay->write(data, length);
+                    },
+                    [&relay](int status)
+                    {
+                        relay->begin(status);
+                    });
+                relay->finish(std::move(result));
+            }
+            catch (const std::exception& e)
+            {
+                std::cerr << "Exception in stream exchange: " << e.what() << std::endl;
+                relay->finish(ProxyHandler::ForwardResult{500, "Internal Server Error"});
+            }
+        });
+
+    // Queue timeouts, unknown models and unreachable backends get their real
+    // status, as Ollama reports them before streaming starts
+    if (exchange->relay->waitForStatus() != 200)
+    {
+        auto result = exchange->relay->waitForResult();
+        res.status = result.status;
+        res.set_content(result.error ? errorLine(*result.error)
+                        : result.body ? *result.body
+                                      : std::string(),
+                        "application/json");
+        return;
+    }
+
+    res.status = 200;
+    res.set_chunked_content_provider(
+        "application/x-ndjson",
+        [exchange](size_t /*offset*/, httplib::DataSink& sink)
+        {
+            if (!exchange->relay->drain(sink))
+            {
+                return false;
+            }
+
+            // The 200 status line is already sent, so a failure mid-stream is
+            // reported in-band the same way Ollama reports streaming errors
+            auto result = exchange->relay->waitForResult();
+            if (result.error)
+            {
+                std::string line = errorLine(*result.error);
+                sink.write(line.data(), line.size());
+            }
+
+            sink.done();
+            return true;
+        });
+}
+
+} // namespace sectorflux
@@ -0,0 +1,76 @@
+/*
+ * SectorFlux - LLM Proxy and Analytics
+ * Copyright (c) 2025 ParticleSector.com
+ *
+ * This software is dual-licensed:
+ * - GPL-3.0 for open source use
+ * - Commercial license for proprietary use
+ *
+ * See LICENSE and LICENSING.md for details.
+ */
+
+#pragma once
+
+#include "proxy.hpp"
+
+#include <httplib.h>
+
+#include <optional>
+#include <string>
+#include <thread>
+
+namespace sectorflux
+{
+
+/**
+ * @brief Ollama-compatible listener with true chunked pass-through streaming.
+ *
+ * Crow only sends a response once the handler has produced the whole body,
+ * so clients of the main port see nothing until generation completes. This
+ * listener serves /api/generate and /api/chat with chunked transfer encoding,
+ * writing each NDJSON chunk to the client the moment Ollama produces it.
+ */
+class StreamServer
+{
+public:
+    /**
+     * @brief Construct a new Stream Server object.
+     * @param proxy Reference to the ProxyHandler that performs forwarding.
+     */
+    explicit StreamServer(ProxyHandler& proxy);
+    ~StreamServer();
+
+    // Delete copy operations
+    StreamServer(const StreamServer&) = delete;
+    StreamServer& operator=(const StreamServer&) = delete;
+
+    /**
+     * @brief Bind the listener and start serving on a background thread.
+     * @param port The port to listen on.
+     * @return std::optional<std::string> Error message on failure, nullopt on success.
+     */
+    std::optional<std::string> start(int port);
+
+    /**
+     * @brief Stop the listener and wait for the serving thread to exit.
+     */
+    void stop();
+
+private:
+    /**
+     * @brief Serve a generation request, streaming chunks straight to the client.
+     * @param req The incoming httplib request.
+     * @param res The httplib response to populate.
+     * @param target_endpoint The Ollama endpoint to forward to.
+     */
+    void handleProxy(
+        const httplib::Request& req,
+        httplib::Response& res,
+        const std::string& target_endpoint);
+
+    ProxyHandler& proxy_;
+    httplib::Server server_;
+    std::jthread worker_;
+};
+
+} // namespace sectorflux
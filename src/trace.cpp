@@ -0,0 +1,169 @@
+/*
+ * SectorFlux - LLM Proxy and Analytics
+ * Copyright (c) 2025 ParticleSector.com
+ *
+ * This software is dual-licensed:
+ * - GPL-3.0 for open source use
+ * - Commercial license for proprietary use
+ *
+ * See LICENSE and LICENSING.md for details.
+ */
+
+#include "trace.hpp"
+
+#include <algorithm>
+#include <limits>
+
+namespace sectorflux
+{
+
+namespace
+{
+
+constexpr size_t kEncodedSpanBytes = 9;
+
+constexpr std::array<const char*, kTracePhaseCount> kPhaseNames = {
+    "request_parse",
+    "cache_lookup",
+    "scheduler_wait",
+    "upstream_connect",
+    "first_byte",
+    "stream_forward",
+    "chunk_handling",
+    "metrics_extraction",
+    "log_enqueue",
+    "semantic_embed",
+};
+
+thread_local RequestTrace* t_current_trace = nullptr;
+
+uint32_t toMicros(RequestTrace::Clock::duration duration)
+{
+    auto micros = std::chrono::duration_cast<std::chrono::microseconds>(duration).count();
+    return static_cast<uint32_t>(std::clamp<long long>(
+        micros, 0, std::numeric_limits<uint32_t>::max()));
+}
+
+void putU32(std::string& out, uint32_t value)
+{
+    for (int shift = 0; shift < 32; shift += 8)
+    {
+        out += static_cast<char>((value >> shift) & 0xff);
+    }
+}
+
+uint32_t getU32(const char* data)
+{
+    uint32_t value = 0;
+    for (int i = 0; i < 4; ++i)
+    {
+        value |= static_cast<uint32_t>(static_cast<unsigned char>(data[i])) << (8 * i);
+    }
+    return value;
+}
+
+}  // namespace
+
+const char* tracePhaseName(TracePhase phase)
+{
+    auto index = static_cast<size_t>(phase);
+    return index < kPhaseNames.size() ? kPhaseNames[index] : "unknown";
+}
+
+bool isProxyPhase(TracePhase phase)
+{
+    switch (phase)
+    {
+        case TracePhase::SchedulerWait:
+        case TracePhase::FirstByte:
+        case TracePhase::StreamForward:
+        case TracePhase::SemanticEmbed:
+            return false;
+        default:
+            return true;
+    }
+}
+
+void RequestTrace::add(TracePhase phase, Clock::time_point start, Clock::time_point end)
+{
+    if (size_ == kMaxSpans)
+    {
+        return;
+    }
+    spans_[size_++] = TraceSpan{.phase = phase,
+                                .start_us = toMicros(start - origin_),
+                                .duration_us = toMicros(end - start)};
+}
+
+RequestTrace* RequestTrace::current()
+{
+    return t_current_trace;
+}
+
+RequestTrace RequestTrace::forLog()
+{
+    if (!t_current_trace)
+    {
+        return RequestTrace();
+    }
+    RequestTrace copy = *t_current_trace;
+    copy.enqueue_start_ = Clock::now();
+    return copy;
+}
+
+void RequestTrace::markEnqueued()
+{
+    if (enqueue_start_)
+    {
+        add(TracePhase::LogEnqueue, *enqueue_start_, Clock::now());
+        enqueue_start_.reset();
+    }
+}
+
+TraceScope::TraceScope(RequestTrace& trace) : previous_(t_current_trace)
+{
+    t_current_trace = &trace;
+}
+
+TraceScope::~TraceScope()
+{
+    t_current_trace = previous_;
+}
+
+std::string encodeTrace(const RequestTrace& trace)
+{
+    std::string out;
+    out.reserve(trace.spans().size() * kEncodedSpanBytes);
+    for (const auto& span : trace.spans())
+    {
+        out += static_cast<char>(span.phase);
+        putU32(out, span.start_us);
+        putU32(out, span.duration_us);
+    }
+    return out;
+}
+
+std::vector<TraceSpan> decodeTrace(std::string_view blob)
+{
+    if (blob.size() % kEncodedSpanBytes != 0)
+    {
+        return {};
+    }
+
+    std::vector<TraceSpan> spans;
+    spans.reserve(blob.size() / kEncodedSpanBytes);
+    for (size_t pos = 0; pos < blob.size(); pos += kEncodedSpanBytes)
+    {
+        auto phase = static_cast<unsigned char>(blob[pos]);
+        if (phase >= kTracePhaseCount)
+        {
+            return {};
+        }
+        spans.push_back(TraceSpan{.phase = static_cast<TracePhase>(phase),
+                                  .start_us = getU32(blob.data() + pos + 1),
+                                  .duration_us = getU32(blob.data() + pos + 5)});
+    }
+    return spans;
+}
+
+}  // namespace sectorflux
@@ -0,0 +1,189 @@
+/*
+ * SectorFlux - LLM Proxy and Analytics
+ * Copyright (c) 2025 ParticleSector.com
+ *
+ * This software is dual-licensed:
+ * - GPL-3.0 for open source use
+ * - Commercial license for proprietary use
+ *
+ * See LICENSE and LICENSING.md for details.
+ */
+
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace sectorflux
+{
+
+/**
+ * @brief A step of handling a proxied request.
+ */
+enum class TracePhase : uint8_t
+{
+    RequestParse,       // Parsing and normalizing the request body
+    CacheLookup,        // Memory tier, then SQLite
+    SchedulerWait,      // Waiting for an upstream slot
+    UpstreamConnect,    // Checking out (or opening) a keep-alive connection
+    FirstByte,          // Request sent until the first response byte
+    StreamForward,      // First byte until the response is complete
+    ChunkHandling,      // Total time spent in SectorFlux's per-chunk work
+    MetricsExtraction,  // Final metrics, chunk index and cache insert
+    LogEnqueue,         // Handing the log entry to the writer
+    SemanticEmbed,      // Embedding the prompt for a near-duplicate lookup
+};
+
+inline constexpr size_t kTracePhaseCount = 10;
+
+/**
+ * @brief Name of a phase as exported in trace JSON.
+ */
+[[nodiscard]] const char* tracePhaseName(TracePhase phase);
+
+/**
+ * @brief Whether a phase is time spent in SectorFlux itself, rather than
+ *        waiting for capacity or for Ollama.
+ */
+[[nodiscard]] bool isProxyPhase(TracePhase phase);
+
+/**
+ * @brief One timed phase, relative to the start of its request.
+ */
+struct TraceSpan
+{
+    TracePhase phase = TracePhase::RequestParse;
+    uint32_t start_us = 0;
+    uint32_t duration_us = 0;
+};
+
+/**
+ * @brief Fixed-capacity span buffer of one request, timed on the monotonic clock.
+ *
+ * A trace lives on the stack of the thread handling its request and is made
+ * current there with a TraceScope, so the code it calls can record spans
+ * without the trace being passed down. Recording never allocates; spans
+ * beyond kMaxSpans (many upstream retries) are dropped.
+ */
+class RequestTrace
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    static constexpr size_t kMaxSpans = 16;
+
+    RequestTrace() : origin_(Clock::now())
+    {
+    }
+
+    /**
+     * @brief Record a phase that ran from start to end.
+     */
+    void add(TracePhase phase, Clock::time_point start, Clock::time_point end);
+
+    [[nodiscard]] std::span<const TraceSpan> spans() const
+    {
+        return {spans_.data(), size_};
+    }
+
+    /**
+     * @brief The trace current on this thread, or nullptr.
+     */
+    [[nodiscard]] static RequestTrace* current();
+
+    /**
+     * @brief A copy of the current trace to store with a log entry, with its
+     *        LogEnqueue phase started now; an empty trace if none is current.
+     *
+     * The log queue ends the phase with markEnqueued() once the entry is queued.
+     */
+    [[nodiscard]] static RequestTrace forLog();
+
+    /**
+     * @brief End the LogEnqueue phase started by forLog(), if any.
+     */
+    void markEnqueued();
+
+private:
+    friend class TraceScope;
+
+    Clock::time_point origin_;
+    std::optional<Clock::time_point> enqueue_start_;
+    std::array<TraceSpan, kMaxSpans> spans_{};
+    size_t size_ = 0;
+};
+
+/**
+ * @brief Makes a trace current on this thread for the scope's lifetime.
+ */
+class TraceScope
+{
+public:
+    explicit TraceScope(RequestTrace& trace);
+    ~TraceScope();
+
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+
+private:
+    RequestTrace* previous_;
+};
+
+/**
+ * @brief Times a phase into the current trace; a no-op when none is current.
+ */
+class ScopedSpan
+{
+public:
+    explicit ScopedSpan(TracePhase phase)
+        : trace_(RequestTrace::current()),
+          phase_(phase),
+          start_(trace_ ? RequestTrace::Clock::now() : RequestTrace::Clock::time_point())
+    {
+    }
+
+    ~ScopedSpan()
+    {
+        end();
+    }
+
+    ScopedSpan(const ScopedSpan&) = delete;
+    ScopedSpan& operator=(const ScopedSpan&) = delete;
+
+    /**
+     * @brief End the phase before the scope does (later calls are no-ops).
+     */
+    void end()
+    {
+        if (trace_)
+        {
+            trace_->add(phase_, start_, RequestTrace::Clock::now());
+            trace_ = nullptr;
+        }
+    }
+
+private:
+    RequestTrace* trace_;
+    TracePhase phase_;
+    RequestTrace::Clock::time_point start_;
+};
+
+/**
+ * @brief Serialize the spans as little-endian (phase, start, duration) records.
+ * @return std::string Empty for a trace without spans.
+ */
+[[nodiscard]] std::string encodeTrace(const RequestTrace& trace);
+
+/**
+ * @brief Parse spans written by encodeTrace(); malformed data yields none.
+ */
+[[nodiscard]] std::vector<TraceSpan> decodeTrace(std::string_view blob);
+
+}  // namespace sectorflux
@@ -0,0 +1,189 @@
+/*
+ * SectorFlux - LLM Proxy and Analytics
+ * Copyright (c) 2025 ParticleSector.com
+ *
+ * This software is dual-licensed:
+ * - GPL-3.0 for open source use
+ * - Commercial license for proprietary use
+ *
+ * See LICENSE and LICENSING.md for details.
+ */
+
+#include "upstream_pool.hpp"
+
+#include <chrono>
+
+namespace sectorflux
+{
+
+UpstreamPool::Lease::Lease(UpstreamPool* pool, std::shared_ptr<HostState> host,
+                           std::unique_ptr<httplib::Client> client)
+    : pool_(pool), host_(std::move(host)), client_(std::move(client))
+{
+}
+
+UpstreamPool::Lease::~Lease()
+{
+    release();
+}
+
+UpstreamPool::Lease::Lease(Lease&& other) noexcept
+    : pool_(other.pool_),
+      host_(std::move(other.host_)),
+      client_(std::move(other.client_)),
+      reusable_(other.reusable_)
+{
+    other.pool_ = nullptr;
+}
+
+UpstreamPool::Lease& UpstreamPool::Lease::operator=(Lease&& other) noexcept
+{
+    if (this != &other)
+    {
+        release();
+        pool_ = other.pool_;
+        host_ = std::move(other.host_);
+        client_ = std::move(other.client_);
+        reusable_ = other.reusable_;
+        other.pool_ = nullptr;
+    }
+    return *this;
+}
+
+void UpstreamPool::Lease::release()
+{
+    if (pool_ && host_ && client_)
+    {
+        pool_->release(*host_, std::move(client_), reusable_);
+    }
+    pool_ = nullptr;
+    host_.reset();
+}
+
+UpstreamPool::UpstreamPool(size_t max_idle_per_host)
+    : max_idle_per_host_(max_idle_per_host)
+{
+    health_worker_ = std::jthread([this](std::stop_token stop_token)
+    {
+        healthCheckLoop(stop_token);
+    });
+}
+
+UpstreamPool::~UpstreamPool()
+{
+    // Stop the prober before hosts_ is torn down
+    health_worker_.request_stop();
+    health_cv_.notify_all();
+    if (health_worker_.joinable())
+    {
+        health_worker_.join();
+    }
+}
+
+std::shared_ptr<UpstreamPool::HostState> UpstreamPool::getHost(const std::string& host)
+{
+    std::lock_guard<std::mutex> lock(hosts_mutex_);
+    auto& state = hosts_[host];
+    if (!state)
+    {
+        state = std::make_shared<HostState>(host);
+    }
+    return state;
+}
+
+UpstreamPool::Lease UpstreamPool::acquire(const std::string& host, int timeout_sec)
+{
+    auto state = getHost(host);
+
+    std::unique_ptr<httplib::Client> client;
+    {
+        std::lock_guard<std::mutex> lock(state->mutex);
+        if (!state->idle.empty())
+        {
+            client = std::move(state->idle.back());
+            state->idle.pop_back();
+        }
+    }
+
+    if (!client)
+    {
+        client = std::make_unique<httplib::Client>(host);
+        client->set_keep_alive(true);
+    }
+
+    client->set_connection_timeout(timeout_sec, 0);
+    client->set_read_timeout(timeout_sec, 0);
+
+    return Lease(this, std::move(state), std::move(client));
+}
+
+bool UpstreamPool::isHealthy(const std::string& host)
+{
+    return getHost(host)->healthy;
+}
+
+void UpstreamPool::setMaxIdlePerHost(size_t max_idle_per_host)
+{
+    max_idle_per_host_.store(max_idle_per_host, std::memory_order_relaxed);
+}
+
+void UpstreamPool::release(HostState& host,
+                           std::unique_ptr<httplib::Client> client,
+                           bool reusable)
+{
+    if (!reusable || !host.healthy)
+    {
+        return;  // Destroying the client closes its socket
+    }
+
+    std::lock_guard<std::mutex> lock(host.mutex);
+    if (host.idle.size() < max_idle_per_host_.load(std::memory_order_relaxed))
+    {
+        host.idle.push_back(std::move(client));
+    }
+}
+
+void UpstreamPool::healthCheckLoop(std::stop_token stop_token)
+{
+    while (!stop_token.stop_requested())
+    {
+        {
+            std::unique_lock<std::mutex> lock(health_mutex_);
+            health_cv_.wait_for(lock, stop_token,
+                                std::chrono::seconds(kHealthCheckIntervalSec),
+                                [] { return false; });
+        }
+        if (stop_token.stop_requested())
+        {
+            break;
+        }
+
+        std::vector<std::shared_ptr<HostState>> hosts;
+        {
+            std::lock_guard<std::mutex> lock(hosts_mutex_);
+            hosts.reserve(hosts_.size());
+            for (const auto& [url, state] : hosts_)
+            {
+                hosts.push_back(state);
+            }
+        }
+
+        for (const auto& state : hosts)
+        {
+            auto lease = acquire(state->url, kHealthCheckTimeoutSec);
+            auto res = lease->Get("/api/version");
+            bool healthy = res && res->status == 200;
+            if (!healthy)
+            {
+                lease.invalidate();
+
+                // Sockets to a host that stopped answering are likely dead
+                std::lock_guard<std::mutex> lock(state->mutex);
+                state->idle.clear();
+            }
+            state->healthy = healthy;
+        }
+    }
+}
+
+} // namespace sectorflux
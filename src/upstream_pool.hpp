@@ -0,0 +1,162 @@
+/*
+ * SectorFlux - LLM Proxy and Analytics
+ * Copyright (c) 2025 ParticleSector.com
+ *
+ * This software is dual-licensed:
+ * - GPL-3.0 for open source use
+ * - Commercial license for proprietary use
+ *
+ * See LICENSE and LICENSING.md for details.
+ */
+
+#pragma once
+
+#include <httplib.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace sectorflux
+{
+
+/**
+ * @brief Pool of keep-alive HTTP clients to upstream Ollama hosts.
+ *
+ * Each lease hands out an exclusive httplib::Client whose socket stays open
+ * between requests, so short calls skip the TCP handshake. Up to
+ * max_idle_per_host warm clients are retained per host; bursts beyond that
+ * get a fresh client that is discarded on release. A background thread
+ * probes every known host and drops idle sockets to hosts that went away.
+ */
+class UpstreamPool
+{
+    struct HostState;
+
+public:
+    /**
+     * @brief Exclusive, move-only handle to a pooled client.
+     *
+     * The client returns to the pool when the lease is destroyed.
+     */
+    class Lease
+    {
+    public:
+        Lease() = default;
+        ~Lease();
+
+        Lease(Lease&& other) noexcept;
+        Lease& operator=(Lease&& other) noexcept;
+        Lease(const Lease&) = delete;
+        Lease& operator=(const Lease&) = delete;
+
+        /**
+         * @brief Access the leased client.
+         * @return httplib::Client& The client, valid for the lease lifetime.
+         */
+        httplib::Client& client()
+        {
+            return *client_;
+        }
+
+        httplib::Client* operator->()
+        {
+            return client_.get();
+        }
+
+        /**
+         * @brief Discard the client instead of returning it to the pool.
+         *
+         * Call after a transport error so a broken socket is never reused.
+         */
+        void invalidate()
+        {
+            reusable_ = false;
+        }
+
+    private:
+        friend class UpstreamPool;
+
+        Lease(UpstreamPool* pool, std::shared_ptr<HostState> host,
+              std::unique_ptr<httplib::Client> client);
+
+        void release();
+
+        UpstreamPool* pool_ = nullptr;
+        std::shared_ptr<HostState> host_;
+        std::unique_ptr<httplib::Client> client_;
+        bool reusable_ = true;
+    };
+
+    /**
+     * @brief Construct a new Upstream Pool object.
+     * @param max_idle_per_host Number of warm connections retained per host.
+     */
+    explicit UpstreamPool(size_t max_idle_per_host);
+    ~UpstreamPool();
+
+    // Delete copy operations
+    UpstreamPool(const UpstreamPool&) = delete;
+    UpstreamPool& operator=(const UpstreamPool&) = delete;
+
+    /**
+     * @brief Lease a client connected to the given host.
+     * @param host Upstream base URL (e.g. "http://localhost:11434").
+     * @param timeout_sec Connection and read timeout applied to this lease.
+     * @return Lease Exclusive handle to a keep-alive client.
+     */
+    [[nodiscard]] Lease acquire(const std::string& host, int timeout_sec);
+
+    /**
+     * @brief Check the result of the most recent health probe for a host.
+     * @param host Upstream base URL.
+     * @return bool True if the host answered its last probe (or was never probed).
+     */
+    [[nodiscard]] bool isHealthy(const std::string& host);
+
+    /**
+     * @brief Change how many warm connections are retained per host.
+     * @param max_idle_per_host New limit; surplus idle clients close as they are released.
+     */
+    void setMaxIdlePerHost(size_t max_idle_per_host);
+
+private:
+    /**
+     * @brief Per-host idle list and health flag.
+     */
+    struct HostState
+    {
+        explicit HostState(std::string url) : url(std::move(url))
+        {
+        }
+
+        const std::string url;
+        std::mutex mutex;
+        std::vector<std::unique_ptr<httplib::Client>> idle;
+        std::atomic<bool> healthy{true};
+    };
+
+    std::shared_ptr<HostState> getHost(const std::string& host);
+    void release(HostState& host, std::unique_ptr<httplib::Client> client, bool reusable);
+    void healthCheckLoop(std::stop_token stop_token);
+
+    std::atomic<size_t> max_idle_per_host_;
+
+    std::mutex hosts_mutex_;
+    std::unordered_map<std::string, std::shared_ptr<HostState>> hosts_;
+
+    std::mutex health_mutex_;
+    std::condition_variable_any health_cv_;
+    std::jthread health_worker_;
+
+    // Constants
+    static constexpr int kHealthCheckIntervalSec = 5;
+    static constexpr int kHealthCheckTimeoutSec = 1;
+};
+
+} // namespace sectorflux
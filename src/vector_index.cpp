@@ -0,0 +1,180 @@
+/*
+ * SectorFlux - LLM Proxy and Analytics
+ * Copyright (c) 2025 ParticleSector.com
+ *
+ * This software is dual-licensed:
+ * - GPL-3.0 for open source use
+ * - Commercial license for proprietary use
+ *
+ * See LICENSE and LICENSING.md for details.
+ */
+
+#include "vector_index.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <mutex>
+
+namespace sectorflux
+{
+
+namespace
+{
+
+// Independent accumulators per block; wide enough to fill every SIMD width
+// GCC and Clang target, at -O2 as well as -O3
+constexpr size_t kLanes = 32;
+
+// Quantized components span [-kQuantScale, kQuantScale]
+constexpr float kQuantScale = 127.0f;
+
+/**
+ * @brief Scale a vector so its largest component maps to kQuantScale.
+ * @return float The factor that recovers the original components, 0 for a zero vector.
+ */
+float quantize(std::span<const float> vector, int8_t* out)
+{
+    float max_abs = 0.0f;
+    for (float component : vector)
+    {
+        max_abs = std::max(max_abs, std::fabs(component));
+    }
+    if (max_abs == 0.0f)
+    {
+        return 0.0f;
+    }
+    const float scale = kQuantScale / max_abs;
+    for (size_t i = 0; i < vector.size(); ++i)
+    {
+        out[i] = static_cast<int8_t>(std::lround(vector[i] * scale));
+    }
+    return max_abs / kQuantScale;
+}
+
+} // namespace
+
+int32_t dotProduct(const int8_t* a, const int8_t* b, size_t size)
+{
+    std::array<int32_t, kLanes> lanes{};
+    size_t i = 0;
+    for (; i + kLanes <= size; i += kLanes)
+    {
+        for (size_t lane = 0; lane < kLanes; ++lane)
+        {
+            lanes[lane] += static_cast<int16_t>(a[i + lane]) * static_cast<int16_t>(b[i + lane]);
+        }
+    }
+    int32_t sum = 0;
+    for (int32_t lane : lanes)
+    {
+        sum += lane;
+    }
+    for (; i < size; ++i)
+    {
+        sum += static_cast<int16_t>(a[i]) * static_cast<int16_t>(b[i]);
+    }
+    return sum;
+}
+
+VectorIndex::VectorIndex(size_t capacity) : capacity_(capacity)
+{
+}
+
+std::optional<VectorMatch> VectorIndex::nearest(const CacheKey& context,
+                                                std::span<const float> query) const
+{
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    if (query.size() != dimension_ || dimension_ == 0)
+    {
+        return std::nullopt;
+    }
+    std::vector<int8_t> quantized(dimension_);
+    const float query_scale = quantize(query, quantized.data());
+    if (query_scale == 0.0f)
+    {
+        return std::nullopt;
+    }
+    const float query_norm =
+        query_scale *
+        std::sqrt(static_cast<float>(dotProduct(quantized.data(), quantized.data(), dimension_)));
+
+    std::optional<VectorMatch> best;
+    for (size_t row = 0; row < slots_.size(); ++row)
+    {
+        const auto& slot = slots_[row];
+        if (slot.context != context)
+        {
+            continue;
+        }
+        const int32_t dot =
+            dotProduct(quantized.data(), vectors_.data() + row * dimension_, dimension_);
+        const float similarity = static_cast<float>(dot) * query_scale * slot.scale / query_norm;
+        if (!best || similarity > best->similarity)
+        {
+            best = VectorMatch{.key = slot.key, .similarity = similarity};
+        }
+    }
+    return best;
+}
+
+void VectorIndex::insert(const CacheKey& context, const CacheKey& key,
+                         std::span<const float> vector)
+{
+    if (vector.empty())
+    {
+        return;
+    }
+
+    // Normalize first, so each stored row has unit length and a query only
+    // divides by its own norm
+    float norm = 0.0f;
+    for (float component : vector)
+    {
+        norm += component * component;
+    }
+    norm = std::sqrt(norm);
+    if (norm == 0.0f)
+    {
+        return;
+    }
+    std::vector<float> unit(vector.begin(), vector.end());
+    for (float& component : unit)
+    {
+        component /= norm;
+    }
+
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    if (dimension_ == 0)
+    {
+        dimension_ = vector.size();
+        vectors_.reserve(capacity_ * dimension_);
+        slots_.reserve(capacity_);
+    }
+    if (vector.size() != dimension_)
+    {
+        return;
+    }
+
+    size_t row = slots_.size();
+    if (row < capacity_)
+    {
+        slots_.push_back(Slot{});
+        vectors_.resize(vectors_.size() + dimension_);
+    }
+    else
+    {
+        row = next_;
+        next_ = (next_ + 1) % capacity_;
+    }
+    const float scale = quantize(unit, vectors_.data() + row * dimension_);
+    slots_[row] = Slot{.context = context, .key = key, .scale = scale};
+}
+
+size_t VectorIndex::size() const
+{
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    return slots_.size();
+}
+
+} // namespace sectorflux
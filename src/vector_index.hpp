@@ -0,0 +1,109 @@
+/*
+ * SectorFlux - LLM Proxy and Analytics
+ * Copyright (c) 2025 ParticleSector.com
+ *
+ * This software is dual-licensed:
+ * - GPL-3.0 for open source use
+ * - Commercial license for proprietary use
+ *
+ * See LICENSE and LICENSING.md for details.
+ */
+
+#pragma once
+
+#include "cache_key.hpp"
+
+#include <cstdint>
+#include <optional>
+#include <shared_mutex>
+#include <span>
+#include <vector>
+
+namespace sectorflux
+{
+
+/**
+ * @brief The closest stored embedding to a query.
+ */
+struct VectorMatch
+{
+    CacheKey key;            // Cache key of the request the embedding belongs to
+    float similarity = 0.0f; // Cosine similarity to the query
+};
+
+/**
+ * @brief In-process nearest-neighbour index of prompt embeddings.
+ *
+ * A flat index: vectors are L2-normalized and quantized to int8 on insert
+ * and stored contiguously, so a query is one linear pass of integer dot
+ * products that the compiler vectorizes. int8 quarters the bytes a scan
+ * reads: 10,000 768-dimension embeddings are 7.5 MB, about a millisecond
+ * for one core even when every entry shares the query's context (only
+ * those are compared). Similarities are within about 0.001 of the exact
+ * cosine, and there is no recall to tune. Full, it overwrites its oldest
+ * vectors.
+ */
+class VectorIndex
+{
+public:
+    /**
+     * @brief Construct a new Vector Index object.
+     * @param capacity Maximum number of embeddings held.
+     */
+    explicit VectorIndex(size_t capacity);
+
+    // Delete copy operations
+    VectorIndex(const VectorIndex&) = delete;
+    VectorIndex& operator=(const VectorIndex&) = delete;
+
+    /**
+     * @brief Find the most similar embedding stored under a context.
+     * @param context Only embeddings inserted with this context are compared.
+     * @param query The query embedding (any length-consistent scale).
+     * @return std::optional<VectorMatch> nullopt if nothing comparable is stored.
+     */
+    [[nodiscard]] std::optional<VectorMatch> nearest(const CacheKey& context,
+                                                     std::span<const float> query) const;
+
+    /**
+     * @brief Store an embedding.
+     *
+     * The first insert fixes the dimension; vectors of another dimension
+     * (a different embedding model) are ignored.
+     *
+     * @param context Scope of the embedding (requests that differ only in it compare).
+     * @param key Cache key the embedding resolves to.
+     * @param vector The embedding.
+     */
+    void insert(const CacheKey& context, const CacheKey& key, std::span<const float> vector);
+
+    /**
+     * @brief Get the number of embeddings held.
+     */
+    [[nodiscard]] size_t size() const;
+
+private:
+    struct Slot
+    {
+        CacheKey context;
+        CacheKey key;
+        float scale = 0.0f;  // Converts the row's int8 components back to floats
+    };
+
+    const size_t capacity_;
+    mutable std::shared_mutex mutex_;
+    size_t dimension_ = 0;
+    std::vector<int8_t> vectors_;  // One row of dimension_ components per slot
+    std::vector<Slot> slots_;
+    size_t next_ = 0;              // Row the next insert overwrites once full
+};
+
+/**
+ * @brief Dot product of two int8 arrays.
+ *
+ * Products are summed into independent 32-bit lanes, so the compiler
+ * vectorizes the loop at -O2 without any target-specific code.
+ */
+[[nodiscard]] int32_t dotProduct(const int8_t* a, const int8_t* b, size_t size);
+
+} // namespace sectorflux